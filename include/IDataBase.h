@@ -8,6 +8,7 @@
 #include "IReadBatch.h"
 #include "IWriteBatch.h"
 
+#include <functional>
 #include <string>
 #include <system_error>
 
@@ -21,6 +22,13 @@ namespace CryptoNote
         virtual std::error_code write(IWriteBatch &batch) = 0;
 
         virtual std::error_code read(IReadBatch &batch) = 0;
+
+        /* Calls the callback with every key/value pair whose key starts with
+           the given prefix, in key order. Return false from the callback to
+           stop iterating. An empty prefix iterates the whole database. */
+        virtual std::error_code iterate(
+            const std::string &prefix,
+            const std::function<bool(const std::string &key, const std::string &value)> &callback) = 0;
 #if !defined (USE_LEVELDB)
         virtual std::error_code readThreadSafe(IReadBatch &batch) = 0;
 #endif
@@ -291,6 +291,11 @@ namespace CryptoNote
 
     const size_t COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT = 100;
 
+    const uint64_t RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT = 20; // seconds a /waitforchanges request is held open for at most
+
+    const size_t BLOCK_RESPONSE_CACHE_MAX_ENTRIES = 256; // encoded block responses kept for serving peers / wallets
+    const size_t BLOCK_RESPONSE_CACHE_MAX_SIZE = 64 * 1024 * 1024; // 64 MB
+
     const int P2P_DEFAULT_PORT = 63369;
 
     const int RPC_DEFAULT_PORT = 63370;
@@ -303,13 +308,16 @@ namespace CryptoNote
 
     // P2P Network Configuration Section - This defines our current P2P network version
     // and the minimum version for communication between nodes
-    const uint8_t P2P_CURRENT_VERSION = 6;
+    const uint8_t P2P_CURRENT_VERSION = 7;
 
     const uint8_t P2P_MINIMUM_VERSION = 5;
 
     // This defines the minimum P2P version required for lite blocks propogation
     const uint8_t P2P_LITE_BLOCKS_PROPOGATION_VERSION = 0;
 
+    // This defines the minimum P2P version required for announcing transactions by hash
+    const uint8_t P2P_TRANSACTION_ANNOUNCE_VERSION = 7;
+
     // This defines the number of versions ahead we must see peers before we start displaying
     // warning messages that we need to upgrade our software.
     const uint8_t P2P_UPGRADE_WINDOW = 2;
@@ -327,6 +335,20 @@ namespace CryptoNote
     const uint32_t P2P_DEFAULT_PING_CONNECTION_TIMEOUT = 2000; // 2 seconds
     const uint64_t P2P_DEFAULT_INVOKE_TIMEOUT = 60 * 2 * 1000; // 2 minutes
     const size_t P2P_DEFAULT_HANDSHAKE_INVOKE_TIMEOUT = 5000; // 5 seconds
+    const uint32_t P2P_SLOW_PEER_ROTATION_INTERVAL = 30; // seconds
+    // A sync peer which hasn't answered a block request in this long is dropped
+    const uint32_t P2P_SYNC_PEER_STALL_TIMEOUT = 30; // seconds
+    // A sync peer this many times slower than the fastest one is dropped, to make room for a faster peer
+    const uint64_t P2P_SLOW_SYNC_PEER_RATIO = 4;
+    // Transaction hashes remembered per peer, so we don't relay transactions to peers that already have them
+    const size_t P2P_KNOWN_TRANSACTIONS_FILTER_SIZE = 5000;
+    const double P2P_KNOWN_TRANSACTIONS_FILTER_FALSE_POSITIVE_RATE = 0.001;
+    // Most transaction hashes we'll fetch from one announcement
+    const size_t P2P_TRANSACTION_ANNOUNCE_MAX_COUNT = 1000;
+    // A transaction we've asked one peer for isn't asked for from another peer until this passes
+    const uint32_t P2P_TRANSACTION_REQUEST_TIMEOUT = 10; // seconds
+    // Most transaction requests we track at once. Past this, requests aren't deduplicated between peers
+    const size_t P2P_TRANSACTION_REQUESTED_MAX_COUNT = 20000;
     const char P2P_STAT_TRUSTED_PUB_KEY[] = "";
 #if !defined(USE_LEVELDB)
     const uint64_t DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE = 256; // 256 MB
@@ -341,6 +363,7 @@ namespace CryptoNote
     const uint16_t DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT = 8; //  /not using
     const uint64_t DATABASE_MAX_BYTES_FOR_LEVEL_BASE = 20 * DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE; //  /not using
 #endif
+    const uint64_t DATABASE_HOT_CACHE_MB_DEFAULT_SIZE = 128; // 128 MB, in process cache in front of the database
 
     const char LATEST_VERSION_URL[] = "https://github.com/nimbocoin/nimbocoin";
 
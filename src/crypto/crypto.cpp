@@ -17,7 +17,9 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <list>
 #include <memory>
+#include <unordered_map>
 
 namespace Crypto
 {
@@ -445,11 +447,175 @@ namespace Crypto
         return sizeof(rs_comm) + pubs_count * sizeof(((rs_comm *)0)->ab[0]);
     }
 
+    namespace
+    {
+        /* How many ring members each thread keeps decompressed. ~350 bytes
+           each. */
+        const size_t RING_MEMBER_CACHE_SIZE = 4096;
+
+        /* A ring member's public key decompressed, and hashed to a point. These
+           are the expensive parts of checking a ring member that don't depend
+           on the signature, so can be reused between rings. */
+        struct RingMemberPoints
+        {
+            bool valid;
+
+            ge_p3 point;
+
+            ge_p3 hashedPoint;
+        };
+
+        RingMemberPoints computeRingMemberPoints(const PublicKey &key)
+        {
+            RingMemberPoints points;
+
+            points.valid = ge_frombytes_vartime(&points.point, reinterpret_cast<const unsigned char *>(&key)) == 0;
+
+            if (points.valid)
+            {
+                hash_to_ec(key, points.hashedPoint);
+            }
+
+            return points;
+        }
+
+        /* Decoys are drawn from the same outputs over and over, so the same
+           keys turn up in many of the rings we check. Each thread has its own
+           cache, so validation threads don't contend on a lock. */
+        class RingMemberCache
+        {
+          public:
+            RingMemberPoints get(const PublicKey &key)
+            {
+                const auto it = m_index.find(key);
+
+                if (it != m_index.end())
+                {
+                    /* Most recently used to the front */
+                    m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+                    return it->second->second;
+                }
+
+                const RingMemberPoints points = computeRingMemberPoints(key);
+
+                /* Invalid keys are rare, and make the whole ring invalid, so
+                   there's no point keeping them */
+                if (!points.valid)
+                {
+                    return points;
+                }
+
+                m_entries.emplace_front(key, points);
+                m_index[key] = m_entries.begin();
+
+                if (m_entries.size() > RING_MEMBER_CACHE_SIZE)
+                {
+                    m_index.erase(m_entries.back().first);
+                    m_entries.pop_back();
+                }
+
+                return points;
+            }
+
+          private:
+            std::list<std::pair<PublicKey, RingMemberPoints>> m_entries;
+
+            std::unordered_map<PublicKey, std::list<std::pair<PublicKey, RingMemberPoints>>::iterator> m_index;
+        };
+
+        thread_local RingMemberCache ringMemberCache;
+
+        /* The ring signature check, with the ring member points coming from
+           getPoints, so they can be shared between rings */
+        template<typename GetPoints>
+        bool checkRing(
+            const Hash &prefixHash,
+            const KeyImage &image,
+            const std::vector<PublicKey> &pubs,
+            const std::vector<Signature> &signatures,
+            GetPoints &&getPoints)
+        {
+            ge_p3 image_unp;
+
+            ge_dsmp image_pre;
+
+            EllipticCurveScalar sum, h;
+
+            rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.size())));
+
+            if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&image)) != 0)
+            {
+                return false;
+            }
+
+            ge_dsm_precomp(image_pre, &image_unp);
+
+            if (ge_check_subgroup_precomp_vartime(image_pre) != 0)
+            {
+                return false;
+            }
+
+            sc_0(reinterpret_cast<unsigned char *>(&sum));
+
+            buf->h = prefixHash;
+
+            for (size_t i = 0; i < pubs.size(); i++)
+            {
+                ge_p2 tmp2;
+
+                if (sc_check(reinterpret_cast<const unsigned char *>(&signatures[i])) != 0
+                    || sc_check(reinterpret_cast<const unsigned char *>(&signatures[i]) + 32) != 0)
+                {
+                    return false;
+                }
+
+                const RingMemberPoints &points = getPoints(pubs[i]);
+
+                if (!points.valid)
+                {
+                    return false;
+                }
+
+                ge_double_scalarmult_base_vartime(
+                    &tmp2,
+                    reinterpret_cast<const unsigned char *>(&signatures[i]),
+                    &points.point,
+                    reinterpret_cast<const unsigned char *>(&signatures[i]) + 32);
+
+                ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &tmp2);
+
+                ge_double_scalarmult_precomp_vartime(
+                    &tmp2,
+                    reinterpret_cast<const unsigned char *>(&signatures[i]) + 32,
+                    &points.hashedPoint,
+                    reinterpret_cast<const unsigned char *>(&signatures[i]),
+                    image_pre);
+
+                ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &tmp2);
+
+                sc_add(
+                    reinterpret_cast<unsigned char *>(&sum),
+                    reinterpret_cast<unsigned char *>(&sum),
+                    reinterpret_cast<const unsigned char *>(&signatures[i]));
+            }
+
+            hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
+
+            sc_sub(
+                reinterpret_cast<unsigned char *>(&h),
+                reinterpret_cast<unsigned char *>(&h),
+                reinterpret_cast<unsigned char *>(&sum));
+
+            return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
+        }
+    } // namespace
+
     std::tuple<bool, std::vector<Signature>> crypto_ops::generateRingSignatures(
-        const Hash prefixHash,
-        const KeyImage keyImage,
-        const std::vector<PublicKey> publicKeys,
-        const Crypto::SecretKey transactionSecretKey,
+        const Hash &prefixHash,
+        const KeyImage &keyImage,
+        const std::vector<PublicKey> &publicKeys,
+        const Crypto::SecretKey &transactionSecretKey,
         uint64_t realOutput)
     {
         std::vector<Signature> signatures(publicKeys.size());
@@ -541,82 +707,47 @@ namespace Crypto
     bool crypto_ops::checkRingSignature(
         const Hash &prefix_hash,
         const KeyImage &image,
-        const std::vector<PublicKey> pubs,
-        const std::vector<Signature> signatures)
+        const std::vector<PublicKey> &pubs,
+        const std::vector<Signature> &signatures)
     {
-        ge_p3 image_unp;
-
-        ge_dsmp image_pre;
-
-        EllipticCurveScalar sum, h;
-
-        rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs.size())));
-
-        if (ge_frombytes_vartime(&image_unp, reinterpret_cast<const unsigned char *>(&image)) != 0)
-        {
-            return false;
-        }
-
-        ge_dsm_precomp(image_pre, &image_unp);
-
-        if (ge_check_subgroup_precomp_vartime(image_pre) != 0)
-        {
-            return false;
-        }
-
-        sc_0(reinterpret_cast<unsigned char *>(&sum));
+        return checkRing(prefix_hash, image, pubs, signatures, [](const PublicKey &key) {
+            return ringMemberCache.get(key);
+        });
+    }
 
-        buf->h = prefix_hash;
+    bool crypto_ops::checkRingSignatures(const std::vector<RingSignature> &rings)
+    {
+        /* Decompress and hash each distinct ring member once for the whole
+           batch, however many of the rings it appears in */
+        std::unordered_map<PublicKey, RingMemberPoints> members;
 
-        for (size_t i = 0; i < pubs.size(); i++)
+        for (const auto &ring : rings)
         {
-            ge_p2 tmp2;
-            ge_p3 tmp3;
-
-            if (sc_check(reinterpret_cast<const unsigned char *>(&signatures[i])) != 0
-                || sc_check(reinterpret_cast<const unsigned char *>(&signatures[i]) + 32) != 0)
+            for (const auto &key : ring.publicKeys)
             {
-                return false;
+                if (members.find(key) == members.end())
+                {
+                    members.emplace(key, ringMemberCache.get(key));
+                }
             }
+        }
 
-            if (ge_frombytes_vartime(&tmp3, reinterpret_cast<const unsigned char *>(&pubs[i])) != 0)
+        for (const auto &ring : rings)
+        {
+            const bool valid = checkRing(
+                ring.prefixHash,
+                ring.keyImage,
+                ring.publicKeys,
+                ring.signatures,
+                [&members](const PublicKey &key) -> const RingMemberPoints & { return members.at(key); });
+
+            if (!valid)
             {
                 return false;
             }
-
-            ge_double_scalarmult_base_vartime(
-                &tmp2,
-                reinterpret_cast<const unsigned char *>(&signatures[i]),
-                &tmp3,
-                reinterpret_cast<const unsigned char *>(&signatures[i]) + 32);
-
-            ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].a), &tmp2);
-
-            hash_to_ec(pubs[i], tmp3);
-
-            ge_double_scalarmult_precomp_vartime(
-                &tmp2,
-                reinterpret_cast<const unsigned char *>(&signatures[i]) + 32,
-                &tmp3,
-                reinterpret_cast<const unsigned char *>(&signatures[i]),
-                image_pre);
-
-            ge_tobytes(reinterpret_cast<unsigned char *>(&buf->ab[i].b), &tmp2);
-
-            sc_add(
-                reinterpret_cast<unsigned char *>(&sum),
-                reinterpret_cast<unsigned char *>(&sum),
-                reinterpret_cast<const unsigned char *>(&signatures[i]));
         }
 
-        hash_to_scalar(buf, rs_comm_size(pubs.size()), h);
-
-        sc_sub(
-            reinterpret_cast<unsigned char *>(&h),
-            reinterpret_cast<unsigned char *>(&h),
-            reinterpret_cast<unsigned char *>(&sum));
-
-        return sc_isnonzero(reinterpret_cast<unsigned char *>(&h)) == 0;
+        return true;
     }
 
     void crypto_ops::generateViewFromSpend(const Crypto::SecretKey &spend, Crypto::SecretKey &viewSecret)
@@ -28,6 +28,20 @@ namespace Crypto
         uint8_t data[32];
     };
 
+    /* A ring signature to check with crypto_ops::checkRingSignatures. It only
+       refers to the hash, key image, keys and signatures it is made from, so
+       must not outlive them. */
+    struct RingSignature
+    {
+        const Hash &prefixHash;
+
+        const KeyImage &keyImage;
+
+        const std::vector<PublicKey> &publicKeys;
+
+        const std::vector<Signature> &signatures;
+    };
+
     class crypto_ops
     {
         crypto_ops();
@@ -134,17 +148,23 @@ namespace Crypto
 
       public:
         static std::tuple<bool, std::vector<Signature>> generateRingSignatures(
-            const Hash prefixHash,
-            const KeyImage keyImage,
-            const std::vector<PublicKey> publicKeys,
-            const Crypto::SecretKey transactionSecretKey,
+            const Hash &prefixHash,
+            const KeyImage &keyImage,
+            const std::vector<PublicKey> &publicKeys,
+            const Crypto::SecretKey &transactionSecretKey,
             uint64_t realOutput);
 
         static bool checkRingSignature(
             const Hash &prefix_hash,
             const KeyImage &image,
-            const std::vector<PublicKey> pubs,
-            const std::vector<Signature> signatures);
+            const std::vector<PublicKey> &pubs,
+            const std::vector<Signature> &signatures);
+
+        /* Checks many ring signatures at once, sharing the work for ring
+           members that appear in more than one ring. Returns true if every
+           ring signature is valid. Not used by block or pool validation yet,
+           which check each input with checkRingSignature. */
+        static bool checkRingSignatures(const std::vector<RingSignature> &rings);
 
         static void generateViewFromSpend(const Crypto::SecretKey &spend, Crypto::SecretKey &viewSecret);
 
@@ -71,6 +71,14 @@ void cn_slow_hash(
     uint32_t scratchpad,
     uint32_t iterations);
 
+/* By default the slow hash scratchpad is allocated and freed on every hash.
+   Threads which do nothing but hash can call this to keep it allocated
+   between hashes instead, saving faulting in fresh pages for each hash.
+   Call slow_hash_release_state() before the thread exits. */
+void slow_hash_retain_state(void);
+
+void slow_hash_release_state(void);
+
 void hash_extra_blake(const void *data, size_t length, char *hash);
 
 void hash_extra_groestl(const void *data, size_t length, char *hash);
@@ -24,6 +24,18 @@ void slow_hash_free_state(void)
     return;
 }
 
+void slow_hash_retain_state(void)
+{
+    // As above
+    return;
+}
+
+void slow_hash_release_state(void)
+{
+    // As above
+    return;
+}
+
 #if defined(__GNUC__)
 #define RDATA_ALIGN16 __attribute__((aligned(16)))
 #define STATIC static
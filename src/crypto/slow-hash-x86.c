@@ -120,6 +120,15 @@ THREADV uint8_t *hp_state = NULL;
 
 THREADV int hp_allocated = 0;
 
+/* Size of hp_state, which may be larger than the page size of the current
+   hash if the state is retained between hashes */
+THREADV uint32_t hp_page_size = 0;
+
+/* Whether to keep hp_state allocated at the end of a hash */
+THREADV int hp_retained = 0;
+
+void slow_hash_free_state(uint32_t page_size);
+
 #if defined(_MSC_VER)
 #define cpuid(info, x) __cpuidex(info, x, 0)
 #else
@@ -417,9 +426,17 @@ void slow_hash_allocate_state(uint32_t page_size)
 {
     if (hp_state != NULL)
     {
-        return;
+        if (hp_page_size >= page_size)
+        {
+            return;
+        }
+
+        /* Retained state is too small for this hash */
+        slow_hash_free_state(hp_page_size);
     }
 
+    hp_page_size = page_size;
+
 #if defined(_MSC_VER) || defined(__MINGW32__)
     SetLockPagesPrivilege(GetCurrentProcess(), TRUE);
     hp_state = (uint8_t *)VirtualAlloc(hp_state, page_size, MEM_LARGE_PAGES | MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
@@ -465,12 +482,32 @@ void slow_hash_free_state(uint32_t page_size)
 #if defined(_MSC_VER) || defined(__MINGW32__)
         VirtualFree(hp_state, 0, MEM_RELEASE);
 #else
-        munmap(hp_state, page_size);
+        munmap(hp_state, hp_page_size);
 #endif
     }
 
     hp_state = NULL;
     hp_allocated = 0;
+    hp_page_size = 0;
+}
+
+/**
+ * @brief keeps the scratch buffer of the calling thread allocated between hashes
+ */
+
+void slow_hash_retain_state(void)
+{
+    hp_retained = 1;
+}
+
+/**
+ * @brief frees the retained scratch buffer of the calling thread
+ */
+
+void slow_hash_release_state(void)
+{
+    hp_retained = 0;
+    slow_hash_free_state(hp_page_size);
 }
 
 /**
@@ -656,7 +693,11 @@ void cn_slow_hash(
     memcpy(state.init, text, INIT_SIZE_BYTE);
     hash_permutation(&state.hs);
     extra_hashes[state.hs.b[0] & 3](&state, 200, hash);
-    slow_hash_free_state(page_size);
+
+    if (!hp_retained)
+    {
+        slow_hash_free_state(page_size);
+    }
 }
 
 #endif
@@ -0,0 +1,85 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockResponseCache.h"
+
+namespace CryptoNote
+{
+    BlockResponseCache::BlockResponseCache(const size_t maxEntries, const size_t maxSize):
+        m_maxEntries(maxEntries),
+        m_maxSize(maxSize)
+    {
+    }
+
+    std::shared_ptr<const BinaryArray> BlockResponseCache::get(const BlockResponseKey &key)
+    {
+        std::scoped_lock lock(m_mutex);
+
+        const auto it = m_index.find(key);
+
+        if (it == m_index.end())
+        {
+            return nullptr;
+        }
+
+        /* Move to the front, it's the most recently used now */
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+        return it->second->second;
+    }
+
+    void BlockResponseCache::insert(const BlockResponseKey &key, BinaryArray &&response)
+    {
+        /* Never going to fit, don't bother flushing everything else out */
+        if (response.size() > m_maxSize)
+        {
+            return;
+        }
+
+        auto value = std::make_shared<const BinaryArray>(std::move(response));
+
+        std::scoped_lock lock(m_mutex);
+
+        const auto it = m_index.find(key);
+
+        /* Another thread beat us to it */
+        if (it != m_index.end())
+        {
+            return;
+        }
+
+        m_currentSize += value->size();
+        m_entries.emplace_front(key, std::move(value));
+        m_index[key] = m_entries.begin();
+
+        evict();
+    }
+
+    void BlockResponseCache::clear()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        m_index.clear();
+        m_entries.clear();
+        m_currentSize = 0;
+    }
+
+    size_t BlockResponseCache::size() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+    void BlockResponseCache::evict()
+    {
+        while (!m_entries.empty() && (m_entries.size() > m_maxEntries || m_currentSize > m_maxSize))
+        {
+            const auto &last = m_entries.back();
+
+            m_currentSize -= last.second->size();
+            m_index.erase(last.first);
+            m_entries.pop_back();
+        }
+    }
+} // namespace CryptoNote
@@ -0,0 +1,97 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace CryptoNote
+{
+    /* The wire format a cached response was encoded with. Responses for the
+       same block range but a different encoding are cached separately. */
+    enum class BlockResponseEncoding : uint8_t
+    {
+        /* Levin / KV-binary NOTIFY_RESPONSE_GET_OBJECTS payload */
+        P2pGetObjects = 0,
+
+        /* JSON body of the /getrawblocks RPC call */
+        JsonRawBlocks = 1,
+    };
+
+    struct BlockResponseKey
+    {
+        BlockResponseEncoding encoding;
+
+        /* Identifies the requested range, i.e. a hash of the requested block
+           hashes, or of the request parameters */
+        Crypto::Hash rangeHash;
+
+        /* The chain state the response was built against. NULL_HASH if the
+           response does not depend on the current top block. */
+        Crypto::Hash stateHash;
+
+        uint32_t blockCount;
+
+        bool operator==(const BlockResponseKey &other) const
+        {
+            return encoding == other.encoding && rangeHash == other.rangeHash && stateHash == other.stateHash
+                   && blockCount == other.blockCount;
+        }
+    };
+
+    struct BlockResponseKeyHasher
+    {
+        size_t operator()(const BlockResponseKey &key) const
+        {
+            /* The range hash is already a cryptographic hash, just fold in
+               the rest */
+            return std::hash<Crypto::Hash>()(key.rangeHash) ^ std::hash<Crypto::Hash>()(key.stateHash)
+                   ^ (static_cast<size_t>(key.encoding) << 32) ^ key.blockCount;
+        }
+    };
+
+    /* Bounded LRU of ready to send, encoded block responses. Syncing peers and
+       wallets tend to request the same recent block ranges over and over, so
+       we encode each response once and hand out the same buffer afterwards.
+       Thread safe - it is shared between the P2P and RPC threads. */
+    class BlockResponseCache
+    {
+      public:
+        BlockResponseCache(const size_t maxEntries, const size_t maxSize);
+
+        /* Returns nullptr if the response is not cached */
+        std::shared_ptr<const BinaryArray> get(const BlockResponseKey &key);
+
+        void insert(const BlockResponseKey &key, BinaryArray &&response);
+
+        /* Drops every cached response. Called when the main chain is
+           reorganized, as any cached range may now refer to orphaned blocks. */
+        void clear();
+
+        size_t size() const;
+
+      private:
+        typedef std::pair<BlockResponseKey, std::shared_ptr<const BinaryArray>> Entry;
+
+        void evict();
+
+        const size_t m_maxEntries;
+
+        /* Total bytes of encoded responses we are prepared to hold */
+        const size_t m_maxSize;
+
+        size_t m_currentSize = 0;
+
+        /* Most recently used at the front */
+        std::list<Entry> m_entries;
+
+        std::unordered_map<BlockResponseKey, std::list<Entry>::iterator, BlockResponseKeyHasher> m_index;
+
+        mutable std::mutex m_mutex;
+    };
+} // namespace CryptoNote
@@ -41,14 +41,34 @@ const Crypto::Hash &CachedBlock::getBlockHash() const
 {
     if (!blockHash.is_initialized())
     {
-        BinaryArray blockBinaryArray = getBlockHashingBinaryArray();
+        const auto &hashingBinaryArray = getBlockHashingBinaryArray();
+
+        const BinaryArray *parentBlock = nullptr;
+
+        size_t size = hashingBinaryArray.size();
+
         if (BLOCK_MAJOR_VERSION_2 <= block.majorVersion)
         {
-            const auto &parentBlock = getParentBlockHashingBinaryArray(false);
-            blockBinaryArray.insert(blockBinaryArray.end(), parentBlock.begin(), parentBlock.end());
+            parentBlock = &getParentBlockHashingBinaryArray(false);
+            size += parentBlock->size();
+        }
+
+        /* The block hash is the hash of the serialized blob, i.e. prefixed
+           with its varint length. Build that in a single buffer, rather than
+           concatenating and then serializing again. */
+        BinaryArray blockBinaryArray;
+        blockBinaryArray.reserve(size + 10);
+
+        Tools::write_varint(std::back_inserter(blockBinaryArray), size);
+
+        blockBinaryArray.insert(blockBinaryArray.end(), hashingBinaryArray.begin(), hashingBinaryArray.end());
+
+        if (parentBlock)
+        {
+            blockBinaryArray.insert(blockBinaryArray.end(), parentBlock->begin(), parentBlock->end());
         }
 
-        blockHash = getObjectHash(blockBinaryArray);
+        blockHash = getBinaryArrayHash(blockBinaryArray);
     }
 
     return blockHash.get();
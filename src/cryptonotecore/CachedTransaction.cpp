@@ -19,10 +19,49 @@ CachedTransaction::CachedTransaction(const Transaction &transaction): transactio
 CachedTransaction::CachedTransaction(const BinaryArray &transactionBinaryArray):
     transactionBinaryArray(transactionBinaryArray)
 {
-    if (!fromBinaryArray<Transaction>(transaction, this->transactionBinaryArray.value()))
+    deserialize();
+}
+
+CachedTransaction::CachedTransaction(BinaryArray &&transactionBinaryArray):
+    transactionBinaryArray(std::move(transactionBinaryArray))
+{
+    deserialize();
+}
+
+void CachedTransaction::deserialize()
+{
+    const auto &blob = transactionBinaryArray.value();
+
+    try
+    {
+        /* Deserialize in place, rather than into a temporary which we then
+           have to move from */
+        Common::MemoryInputStream stream(blob.data(), blob.size());
+        BinaryInputStreamSerializer serializer(stream);
+        serialize(transaction, serializer);
+
+        if (!stream.endOfStream())
+        {
+            throw std::runtime_error("failed to unpack type");
+        }
+    }
+    catch (const std::exception &)
     {
         throw std::runtime_error("CachedTransaction::CachedTransaction(BinaryArray&&), deserealization error.");
     }
+
+    /* Signatures are fixed size and trail the prefix, so the prefix is
+       everything before them */
+    size_t signaturesSize = 0;
+
+    for (const auto &signatures : transaction.signatures)
+    {
+        signaturesSize += signatures.size() * sizeof(Crypto::Signature);
+    }
+
+    assert(signaturesSize <= blob.size());
+
+    transactionPrefixSize = blob.size() - signaturesSize;
 }
 
 const Transaction &CachedTransaction::getTransaction() const
@@ -44,7 +83,15 @@ const Crypto::Hash &CachedTransaction::getTransactionPrefixHash() const
 {
     if (!transactionPrefixHash)
     {
-        transactionPrefixHash = getObjectHash(static_cast<const TransactionPrefix &>(transaction));
+        if (transactionPrefixSize)
+        {
+            transactionPrefixHash =
+                cn_fast_hash(transactionBinaryArray->data(), transactionPrefixSize.value());
+        }
+        else
+        {
+            transactionPrefixHash = getObjectHash(static_cast<const TransactionPrefix &>(transaction));
+        }
     }
 
     return transactionPrefixHash.value();
@@ -20,6 +20,8 @@ namespace CryptoNote
 
         explicit CachedTransaction(const BinaryArray &transactionBinaryArray);
 
+        explicit CachedTransaction(BinaryArray &&transactionBinaryArray);
+
         const Transaction &getTransaction() const;
 
         const Crypto::Hash &getTransactionHash() const;
@@ -33,8 +35,15 @@ namespace CryptoNote
         uint64_t getTransactionAmount() const;
 
       private:
+        void deserialize();
+
         Transaction transaction;
 
+        /* Size of the serialized prefix, when constructed from a blob. Lets
+           us hash the prefix straight from the blob rather than serializing
+           it again. */
+        std::optional<size_t> transactionPrefixSize;
+
         mutable std::optional<BinaryArray> transactionBinaryArray;
 
         mutable std::optional<Crypto::Hash> transactionHash;
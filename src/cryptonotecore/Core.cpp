@@ -228,6 +228,10 @@ namespace CryptoNote
 
         const std::chrono::seconds OUTDATED_TRANSACTION_POLLING_INTERVAL = std::chrono::seconds(60);
 
+        /* How often we check for blocks missing from the explorer store, once
+           it has them all */
+        const std::chrono::seconds EXPLORER_STORE_FILL_INTERVAL = std::chrono::seconds(10);
+
     } // namespace
 
     Core::Core(
@@ -247,7 +251,10 @@ namespace CryptoNote
         blockchainCacheFactory(std::move(blockchainCacheFactory)),
         mainChainStorage(std::move(mainchainStorage)),
         initialized(false),
-	m_transactionValidationThreadPool(transactionValidationThreads)
+	m_transactionValidationThreadPool(transactionValidationThreads),
+        m_blockResponseCache(std::make_shared<BlockResponseCache>(
+            BLOCK_RESPONSE_CACHE_MAX_ENTRIES,
+            BLOCK_RESPONSE_CACHE_MAX_SIZE))
     {
         upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_2, currency.upgradeHeight(BLOCK_MAJOR_VERSION_2));
         upgradeManager->addMajorBlockVersion(BLOCK_MAJOR_VERSION_3, currency.upgradeHeight(BLOCK_MAJOR_VERSION_3));
@@ -279,14 +286,37 @@ namespace CryptoNote
         return queueList.remove(messageQueue);
     }
 
+    bool Core::addObserver(ICoreObserver *observer)
+    {
+        return m_observerManager.add(observer);
+    }
+
+    bool Core::removeObserver(ICoreObserver *observer)
+    {
+        return m_observerManager.remove(observer);
+    }
+
     bool Core::notifyObservers(BlockchainMessage &&msg) /* noexcept */
     {
         try
         {
+            const auto type = msg.getType();
+
             for (auto &queue : queueList)
             {
                 queue.push(std::move(msg));
             }
+
+            if (type == BlockchainMessage::Type::NewBlock || type == BlockchainMessage::Type::ChainSwitch)
+            {
+                m_observerManager.notify(&ICoreObserver::blockchainUpdated);
+            }
+            else if (type == BlockchainMessage::Type::AddTransaction
+                     || type == BlockchainMessage::Type::DeleteTransaction)
+            {
+                m_observerManager.notify(&ICoreObserver::poolUpdated);
+            }
+
             return true;
         }
         catch (std::exception &e)
@@ -1362,6 +1392,9 @@ bool Core::getRawBlocks(
 
                     ret = error::AddBlockErrorCode::ADDED_TO_MAIN;
                     logger(Logging::DEBUGGING) << "Block " << blockStr << " added to main chain.";
+
+                    pushExplorerBlock(previousBlockIndex + 1);
+
                     if ((previousBlockIndex + 1) % 100 == 0)
                     {
                         logger(Logging::INFO) << "Block " << blockStr << " added to main chain";
@@ -1398,6 +1431,7 @@ bool Core::getRawBlocks(
 			  against the pool to remove any transactions that may
 			  be in the pool that would now be considered invalid */
 			checkAndRemoveInvalidPoolTransactions(validatorState);
+                        removePoolTransactionsInChain();
                         copyTransactionsToPool(chainsLeaves[endpointIndex]);
 
                         switchMainChainStorage(chainsLeaves[0]->getStartBlockIndex(), *chainsLeaves[0]);
@@ -1484,67 +1518,74 @@ bool Core::getRawBlocks(
     }
 
     /* This method is a light version of transaction validation that is used
-      to clear the transaction pool of transactions that have been invalidated
-      by the addition of a block to the blockchain. As the transactions are already
-      in the pool, there are only a subset of normal transaction validation
-      tests that need to be completed to determine if the transaction can
-      stay in the pool at this time. */
+       to clear the transaction pool of transactions that have been invalidated
+       by the addition of a block to the blockchain. Rather than revalidating
+       every transaction in the pool, we ask the pool's indexes for the
+       transactions which spend a key image the block spent, or which no longer
+       meet the size and mixin rules, so only those transactions are touched. */
     void Core::checkAndRemoveInvalidPoolTransactions(
 	 const TransactionValidatorState blockTransactionsState)
     {
         auto &pool = *transactionPool;
 
-	const auto poolHashes = pool.getTransactionHashes();
+        const auto maxTransactionSize = getMaximumTransactionAllowedSize(blockMedianSize, currency);
 
-	const auto maxTransactionSize = getMaximumTransactionAllowedSize(blockMedianSize, currency);
+        const auto [minMixin, maxMixin, defaultMixin] = Utilities::getMixinAllowableRange(getTopBlockIndex());
 
-	for (const auto poolTxHash : poolHashes)
-	{
-		const auto poolTx = pool.tryGetTransaction(poolTxHash);
+        /* If the the transaction contains outputs that were spent in the new block, fail */
+        std::vector<Crypto::Hash> invalidHashes = pool.getConflictingTransactionHashes(blockTransactionsState);
 
-                /* Tx got removed by another thread */
-                if (!poolTx)
-                {
-                continue;
-                }
+        /* If the transaction exceeds the maximum size of a transaction, fail */
+        const auto oversizedHashes = pool.getTransactionHashesLargerThan(maxTransactionSize);
 
-		const auto poolTxState = extractSpentOutputs(*poolTx);
+        /* If the transaction does not have the right number of mixins, fail */
+        const auto mixinHashes = pool.getTransactionHashesOutsideMixinRange(minMixin, maxMixin);
 
-		auto [mixinSuccess, err] = Mixins::validate({*poolTx}, getTopBlockIndex());
+        invalidHashes.insert(invalidHashes.end(), oversizedHashes.begin(), oversizedHashes.end());
+        invalidHashes.insert(invalidHashes.end(), mixinHashes.begin(), mixinHashes.end());
 
-		bool isValid = true;
+        removePoolTransactions(invalidHashes);
+    }
+
+    /* When we switch to an alternative chain, the blocks below the new top
+       block may contain transactions which are still in our pool, so we have
+       to check the whole pool. This only happens on a reorg. */
+    void Core::removePoolTransactionsInChain()
+    {
+        std::vector<Crypto::Hash> invalidHashes;
 
-		/* If the transaction is in the chain but somehow was not previously removed, fail */
-		if (isTransactionInChain(poolTxHash))
-		{
-		    isValid = false;
-		}
-		/* If the transaction does not have the right number of mixins, fail */
-		else if (!mixinSuccess)
-		{
-			isValid = false;
-		}
-		/* If the transaction exceeds the maximum size of a transaction, fail */
-		else if (poolTx->getTransactionBinaryArray().size() > maxTransactionSize)
-		{
-			isValid = false;
-		}
-		/* If the the transaction contains outputs that were spent in the new block, fail */
-		else if (hasIntersections(blockTransactionsState, poolTxState))
-		{
-			isValid = false;
-		}
+        for (const auto &poolTxHash : transactionPool->getTransactionHashes())
+        {
+            if (isTransactionInChain(poolTxHash))
+            {
+                invalidHashes.push_back(poolTxHash);
+            }
+        }
+
+        removePoolTransactions(invalidHashes);
+    }
 
-		/* If the transaction is no longer valid, remove it from the pool
-		  and tell everyone else that they should also remove it from the pool */
-		if (!isValid)
+    /* Remove the transactions from the pool and tell everyone else that they
+       should also remove them from the pool */
+    void Core::removePoolTransactions(const std::vector<Crypto::Hash> &transactionHashes)
+    {
+        std::vector<Crypto::Hash> removedHashes;
 
-		{
-		    pool.removeTransaction(poolTxHash);
-		    notifyObservers(makeDelTransactionMessage({poolTxHash},
-		Messages::DeleteTransaction::Reason::NotActual));
+        for (const auto &poolTxHash : transactionHashes)
+        {
+            /* A transaction can fail more than one check, or be removed by
+               another thread in the meantime */
+            if (transactionPool->removeTransaction(poolTxHash))
+            {
+                removedHashes.push_back(poolTxHash);
             }
         }
+
+        if (!removedHashes.empty())
+        {
+            notifyObservers(
+                makeDelTransactionMessage(std::move(removedHashes), Messages::DeleteTransaction::Reason::NotActual));
+        }
     }
 
     /* This quickly finds out if a transaction is in the blockchain somewhere */
@@ -1566,6 +1607,10 @@ bool Core::getRawBlocks(
     {
         assert(mainChainStorage->getBlockCount() > splitBlockIndex);
 
+        /* Cached responses may refer to blocks which are no longer on the
+           main chain */
+        m_blockResponseCache->clear();
+
         auto blocksToPop = mainChainStorage->getBlockCount() - splitBlockIndex;
         for (size_t i = 0; i < blocksToPop; ++i)
         {
@@ -1576,6 +1621,16 @@ bool Core::getRawBlocks(
         {
             mainChainStorage->pushBlock(newChain.getBlockByIndex(index));
         }
+
+        if (m_explorerStore)
+        {
+            m_explorerStore->popBlocks(splitBlockIndex);
+
+            for (uint32_t index = splitBlockIndex; index <= newChain.getTopBlockIndex(); ++index)
+            {
+                pushExplorerBlock(index);
+            }
+        }
     }
 
     void Core::notifyOnSuccess(
@@ -2192,6 +2247,16 @@ bool Core::getRawBlocks(
         return result;
     }
 
+    std::shared_ptr<BlockResponseCache> Core::getBlockResponseCache() const
+    {
+        return m_blockResponseCache;
+    }
+
+    void Core::setExplorerStore(std::shared_ptr<ExplorerStore> explorerStore)
+    {
+        m_explorerStore = explorerStore;
+    }
+
     size_t Core::getPoolTransactionCount() const
     {
         throwIfNotInitialized();
@@ -2233,6 +2298,8 @@ bool Core::getRawBlocks(
         std::vector<CachedTransaction> &transactions,
         uint64_t &cumulativeSize)
     {
+        transactions.reserve(transactions.size() + rawTransactions.size());
+
         try
         {
             for (auto &rawTransaction : rawTransactions)
@@ -2494,6 +2561,11 @@ bool Core::getRawBlocks(
         }
 
         initialized = true;
+
+        if (m_explorerStore)
+        {
+            syncExplorerStore();
+        }
     }
 
     void Core::initRootSegment()
@@ -3196,6 +3268,23 @@ bool Core::getRawBlocks(
             throw std::runtime_error("Requested hash wasn't found in blockchain.");
         }
 
+        /* The store only has main chain blocks */
+        if (m_explorerStore && mainChainSet.count(segment) != 0)
+        {
+            const auto stored = m_explorerStore->getBlockDetails(segment->getBlockIndex(blockHash));
+
+            /* Check it wasn't replaced by a reorg since we looked up the index */
+            if (stored && stored->hash == blockHash)
+            {
+                return *stored;
+            }
+        }
+
+        return buildBlockDetails(blockHash, segment);
+    }
+
+    BlockDetails Core::buildBlockDetails(const Crypto::Hash &blockHash, IBlockchainCache *segment) const
+    {
         uint32_t blockIndex = segment->getBlockIndex(blockHash);
         BlockTemplate blockTemplate = restoreBlockTemplate(segment, blockIndex);
 
@@ -3295,6 +3384,14 @@ bool Core::getRawBlocks(
     {
         throwIfNotInitialized();
 
+        if (m_explorerStore)
+        {
+            if (const auto stored = m_explorerStore->getTransactionDetails(transactionHash))
+            {
+                return *stored;
+            }
+        }
+
         IBlockchainCache *segment = findSegmentContainingTransaction(transactionHash);
         bool foundInPool = transactionPool->checkIfTransactionPresent(transactionHash);
         if (segment == nullptr && !foundInPool)
@@ -3454,6 +3551,135 @@ bool Core::getRawBlocks(
         return transactionDetails;
     }
 
+    BlockDetails Core::buildMainChainBlockDetails(const uint32_t blockIndex) const
+    {
+        IBlockchainCache *segment = findMainChainSegmentContainingBlock(blockIndex);
+
+        if (segment == nullptr)
+        {
+            throw std::runtime_error("Block " + std::to_string(blockIndex) + " isn't in the main chain");
+        }
+
+        return buildBlockDetails(segment->getBlockHash(blockIndex), segment);
+    }
+
+    void Core::pushExplorerBlock(const uint32_t blockIndex)
+    {
+        /* Can only add it on top of what's there, or the store is behind and
+           it will be added when the store is filled */
+        if (!m_explorerStore || blockIndex != m_explorerStore->getStartIndex() + m_explorerStore->getBlockCount())
+        {
+            return;
+        }
+
+        try
+        {
+            m_explorerStore->pushBlock(buildMainChainBlockDetails(blockIndex));
+        }
+        catch (const std::exception &e)
+        {
+            logger(Logging::WARNING) << "Failed to add block " << blockIndex << " to explorer store: " << e.what();
+        }
+    }
+
+    void Core::syncExplorerStore()
+    {
+        const uint32_t topIndex = getTopBlockIndex();
+
+        /* The chain may have been rewound while we weren't running */
+        m_explorerStore->popBlocks(topIndex + 1);
+
+        /* Or switched to another chain without the store being told */
+        while (m_explorerStore->getBlockCount() != 0)
+        {
+            const uint32_t lastIndex = m_explorerStore->getStartIndex() + m_explorerStore->getBlockCount() - 1;
+
+            const auto stored = m_explorerStore->getBlockDetails(lastIndex);
+
+            if (stored && stored->hash == getBlockHashByIndex(lastIndex))
+            {
+                break;
+            }
+
+            m_explorerStore->popBlocks(lastIndex);
+        }
+
+        /* Start from the top, so the most requested blocks are there first */
+        if (m_explorerStore->getBlockCount() == 0)
+        {
+            m_explorerStore->reset(topIndex + 1);
+        }
+
+        logger(Logging::INFO) << "Explorer store has " << m_explorerStore->getBlockCount() << " of " << topIndex + 1
+                              << " blocks, filling in the rest in the background";
+
+        contextGroup.spawn(std::bind(&Core::explorerStoreFillingProcedure, this));
+    }
+
+    bool Core::fillExplorerStore()
+    {
+        const uint32_t startIndex = m_explorerStore->getStartIndex();
+        const uint32_t nextIndex = startIndex + m_explorerStore->getBlockCount();
+
+        /* Catch up with the top first, then work down to the genesis block */
+        if (nextIndex <= getTopBlockIndex())
+        {
+            m_explorerStore->pushBlock(buildMainChainBlockDetails(nextIndex));
+            return true;
+        }
+
+        if (startIndex > 0)
+        {
+            m_explorerStore->pushBlockBelow(buildMainChainBlockDetails(startIndex - 1));
+
+            if (startIndex - 1 == 0)
+            {
+                logger(Logging::INFO) << "Explorer store has every block";
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void Core::explorerStoreFillingProcedure()
+    {
+        System::Timer timer(dispatcher);
+
+        try
+        {
+            for (;;)
+            {
+                bool added = false;
+
+                try
+                {
+                    added = fillExplorerStore();
+                }
+                catch (const std::exception &e)
+                {
+                    logger(Logging::WARNING) << "Failed to fill explorer store: " << e.what();
+                }
+
+                /* Let blocks and transactions be processed between each block
+                   we add */
+                if (added)
+                {
+                    dispatcher.yield();
+                }
+                else
+                {
+                    timer.sleep(EXPLORER_STORE_FILL_INTERVAL);
+                }
+            }
+        }
+        catch (System::InterruptedException &)
+        {
+            logger(Logging::DEBUGGING) << "explorerStoreFillingProcedure has been interrupted";
+        }
+    }
+
     std::vector<Crypto::Hash> Core::getBlockHashesByTimestamps(uint64_t timestampBegin, size_t secondsCount) const
     {
         throwIfNotInitialized();
@@ -7,10 +7,12 @@
 
 #include "BlockchainCache.h"
 #include "BlockchainMessages.h"
+#include "BlockResponseCache.h"
 #include "CachedBlock.h"
 #include "CachedTransaction.h"
 #include "Checkpoints.h"
 #include "Currency.h"
+#include "ExplorerStore.h"
 #include "IBlockchainCache.h"
 #include "IBlockchainCacheFactory.h"
 #include "ICore.h"
@@ -24,6 +26,7 @@
 #include <utilities/ThreadPool.h>
 
 #include <WalletTypes.h>
+#include <common/ObserverManager.h>
 #include <ctime>
 #include <logging/LoggerMessage.h>
 #include <system/ContextGroup.h>
@@ -50,6 +53,10 @@ namespace CryptoNote
 
         virtual bool removeMessageQueue(MessageQueue<BlockchainMessage> &messageQueue) override;
 
+        virtual bool addObserver(ICoreObserver *observer) override;
+
+        virtual bool removeObserver(ICoreObserver *observer) override;
+
         virtual uint32_t getTopBlockIndex() const override;
 
         virtual Crypto::Hash getTopBlockHash() const override;
@@ -190,8 +197,14 @@ namespace CryptoNote
 
         virtual CoreStatistics getCoreStatistics() const override;
 
+        virtual std::shared_ptr<BlockResponseCache> getBlockResponseCache() const override;
+
         virtual std::time_t getStartTime() const;
 
+        /* Serve block and transaction details from, and keep up to date, the
+           given store. Must be called before load(). */
+        void setExplorerStore(std::shared_ptr<ExplorerStore> explorerStore);
+
         // ICoreInformation
         virtual size_t getPoolTransactionCount() const override;
 
@@ -249,12 +262,20 @@ namespace CryptoNote
 
         IntrusiveLinkedList<MessageQueue<BlockchainMessage>> queueList;
 
+        Tools::ObserverManager<ICoreObserver> m_observerManager;
+
         std::unique_ptr<IBlockchainCacheFactory> blockchainCacheFactory;
 
         std::unique_ptr<IMainChainStorage> mainChainStorage;
 
 	Utilities::ThreadPool<bool> m_transactionValidationThreadPool;
 
+        /* Encoded block responses, shared by the P2P and RPC layers */
+        std::shared_ptr<BlockResponseCache> m_blockResponseCache;
+
+        /* Precomputed block details, if enabled */
+        std::shared_ptr<ExplorerStore> m_explorerStore;
+
         bool initialized;
 
         time_t start_time;
@@ -377,6 +398,23 @@ namespace CryptoNote
             IBlockchainCache *segment,
             bool foundInPool) const;
 
+        BlockDetails buildBlockDetails(const Crypto::Hash &blockHash, IBlockchainCache *segment) const;
+
+        BlockDetails buildMainChainBlockDetails(const uint32_t blockIndex) const;
+
+        /* Adds a newly added main chain block to the explorer store */
+        void pushExplorerBlock(const uint32_t blockIndex);
+
+        /* Removes anything from the explorer store that's no longer on the
+           main chain, and starts filling it */
+        void syncExplorerStore();
+
+        /* Adds one block the explorer store is missing. Returns false if it
+           has every block. */
+        bool fillExplorerStore();
+
+        void explorerStoreFillingProcedure();
+
         void notifyOnSuccess(
             error::AddBlockErrorCode opResult,
             uint32_t previousBlockIndex,
@@ -388,6 +426,10 @@ namespace CryptoNote
 	void checkAndRemoveInvalidPoolTransactions(
 	    const TransactionValidatorState blockTransactionsState);
 
+        void removePoolTransactionsInChain();
+
+        void removePoolTransactions(const std::vector<Crypto::Hash> &transactionHashes);
+
 	bool isTransactionInChain(const Crypto::Hash &txnHash);
 
         void transactionPoolCleaningProcedure();
@@ -18,20 +18,19 @@ namespace CryptoNote
     {
         std::string serialize(const RawBlock &value, const std::string &name)
         {
-            std::stringstream ss;
-            Common::StdOutputStream stream(ss);
+            std::string result;
+            Common::StringOutputStream stream(result);
             CryptoNote::BinaryOutputStreamSerializer serializer(stream);
 
             serializer(const_cast<RawBlock &>(value).block, RAW_BLOCK_NAME);
             serializer(const_cast<RawBlock &>(value).transactions, RAW_TXS_NAME);
 
-            return ss.str();
+            return result;
         }
 
         void deserialize(const std::string &serialized, RawBlock &value, const std::string &name)
         {
-            std::stringstream ss(serialized);
-            Common::StdInputStream stream(ss);
+            Common::MemoryInputStream stream(serialized.data(), serialized.size());
             CryptoNote::BinaryInputStreamSerializer serializer(stream);
             serializer(value.block, RAW_BLOCK_NAME);
             serializer(value.transactions, RAW_TXS_NAME);
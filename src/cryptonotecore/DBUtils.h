@@ -5,16 +5,16 @@
 
 #pragma once
 
-#include "common/StdInputStream.h"
-#include "common/StdOutputStream.h"
+#include "common/MemoryInputStream.h"
+#include "common/StringOutputStream.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
+#include "serialization/BinaryInputStreamSerializer.h"
+#include "serialization/BinaryOutputStreamSerializer.h"
 #include "serialization/CryptoNoteSerialization.h"
-#include "serialization/KVBinaryInputStreamSerializer.h"
-#include "serialization/KVBinaryOutputStreamSerializer.h"
 #include "serialization/SerializationOverloads.h"
 
-#include <sstream>
 #include <string>
+#include <type_traits>
 
 namespace CryptoNote
 {
@@ -56,36 +56,82 @@ namespace CryptoNote
 
         const std::string KEY_OUTPUT_KEY_PREFIX = "j";
 
+        /* Only written when the explorer store is enabled */
+        const std::string EXPLORER_BLOCK_INDEX_TO_BLOCK_DETAILS_PREFIX = "x";
+
+        const std::string EXPLORER_TRANSACTION_HASH_TO_BLOCK_INDEX_PREFIX = "y";
+
+        const std::string EXPLORER_STATE_KEY = "explorer_state";
+
+        /* Keys are the one byte prefix, followed by the key in a fixed width,
+           big endian encoding. This means keys with the same prefix sort in
+           numeric order, so ranges of them can be iterated over. */
+        template<typename T>
+        typename std::enable_if<std::is_integral<T>::value>::type appendKey(std::string &key, const T value)
+        {
+            for (size_t i = sizeof(T); i > 0; i--)
+            {
+                key.push_back(static_cast<char>((static_cast<uint64_t>(value) >> ((i - 1) * 8)) & 0xff));
+            }
+        }
+
+        inline void appendKey(std::string &key, const Crypto::Hash &value)
+        {
+            key.append(reinterpret_cast<const char *>(value.data), sizeof(value.data));
+        }
+
+        inline void appendKey(std::string &key, const Crypto::KeyImage &value)
+        {
+            key.append(reinterpret_cast<const char *>(value.data), sizeof(value.data));
+        }
+
+        inline void appendKey(std::string &key, const std::string &value)
+        {
+            key.append(value);
+        }
+
+        template<typename T1, typename T2> void appendKey(std::string &key, const std::pair<T1, T2> &value)
+        {
+            appendKey(key, value.first);
+            appendKey(key, value.second);
+        }
+
+        /* Values are stored in the compact binary format - integers as
+           varints, hashes as raw bytes */
         template<class Value> std::string serialize(const Value &value, const std::string &name)
         {
-            CryptoNote::KVBinaryOutputStreamSerializer serializer;
-            std::stringstream ss;
-            Common::StdOutputStream stream(ss);
+            std::string result;
+            Common::StringOutputStream stream(result);
+            CryptoNote::BinaryOutputStreamSerializer serializer(stream);
 
             serializer(const_cast<Value &>(value), name);
-            serializer.dump(stream);
 
-            return ss.str();
+            return result;
         }
 
         std::string serialize(const RawBlock &value, const std::string &name);
 
-        template<class Key, class Value>
-        std::pair<std::string, std::string> serialize(const std::string &keyPrefix, const Key &key, const Value &value)
+        template<class Key> std::string serializeKey(const std::string &keyPrefix, const Key &key)
         {
-            return {DB::serialize(std::make_pair(keyPrefix, key), keyPrefix), DB::serialize(value, keyPrefix)};
+            std::string result;
+            result.reserve(keyPrefix.size() + 64);
+
+            result.append(keyPrefix);
+            appendKey(result, key);
+
+            return result;
         }
 
-        template<class Key> std::string serializeKey(const std::string &keyPrefix, const Key &key)
+        template<class Key, class Value>
+        std::pair<std::string, std::string> serialize(const std::string &keyPrefix, const Key &key, const Value &value)
         {
-            return DB::serialize(std::make_pair(keyPrefix, key), keyPrefix);
+            return {DB::serializeKey(keyPrefix, key), DB::serialize(value, keyPrefix)};
         }
 
         template<class Value> void deserialize(const std::string &serialized, Value &value, const std::string &name)
         {
-            std::stringstream ss(serialized);
-            Common::StdInputStream stream(ss);
-            CryptoNote::KVBinaryInputStreamSerializer serializer(stream);
+            Common::MemoryInputStream stream(serialized.data(), serialized.size());
+            CryptoNote::BinaryInputStreamSerializer serializer(stream);
             serializer(value, name);
         }
 
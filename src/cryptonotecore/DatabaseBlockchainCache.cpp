@@ -14,6 +14,7 @@
 #include <cryptonotecore/BlockchainStorage.h>
 #include <cryptonotecore/CryptoNoteBasicImpl.h>
 #include <cryptonotecore/DatabaseBlockchainCache.h>
+#include <cryptonotecore/DatabaseMigration.h>
 #include <cstdlib>
 #include <ctime>
 
@@ -25,6 +26,9 @@ namespace CryptoNote
 
         const CachedBlockInfo NULL_CACHED_BLOCK_INFO {Constants::NULL_HASH, 0, 0, 0, 0, 0};
 
+        /* Roughly 20MB of key outputs */
+        const size_t KEY_OUTPUT_CACHE_SIZE = 100000;
+
         bool requestPackedOutputs(
             IBlockchainCache::Amount amount,
             Common::ArrayView<uint32_t> globalIndexes,
@@ -534,7 +538,23 @@ namespace CryptoNote
             uint32_t schemeVersion;
         };
 
-        const uint32_t CURRENT_DB_SCHEME_VERSION = 2;
+        /* Version 3 moved from KV binary keys and values to fixed width keys
+           and binary values. Version 2 databases can be converted in place. */
+        const uint32_t CURRENT_DB_SCHEME_VERSION = 3;
+
+        const uint32_t MIGRATABLE_DB_SCHEME_VERSION = 2;
+
+        boost::optional<uint32_t> readDBSchemeVersion(IDataBase &database)
+        {
+            DatabaseVersionReadBatch readBatch;
+            auto ec = database.read(readBatch);
+            if (ec)
+            {
+                throw std::system_error(ec);
+            }
+
+            return readBatch.getDbSchemeVersion();
+        }
 
     } // namespace
 
@@ -554,14 +574,7 @@ namespace CryptoNote
         blockchainCacheFactory(blockchainCacheFactory),
         logger(_logger, "DatabaseBlockchainCache")
     {
-        DatabaseVersionReadBatch readBatch;
-        auto ec = database.read(readBatch);
-        if (ec)
-        {
-            throw std::system_error(ec);
-        }
-
-        auto version = readBatch.getDbSchemeVersion();
+        auto version = readDBSchemeVersion(database);
         if (!version)
         {
             logger(Logging::DEBUGGING) << "DB scheme version not found, writing: " << CURRENT_DB_SCHEME_VERSION;
@@ -589,19 +602,19 @@ namespace CryptoNote
     {
         Logging::LoggerRef logger(_logger, "DatabaseBlockchainCache");
 
-        DatabaseVersionReadBatch readBatch;
-        auto ec = database.read(readBatch);
-        if (ec)
-        {
-            throw std::system_error(ec);
-        }
-
-        auto version = readBatch.getDbSchemeVersion();
+        auto version = readDBSchemeVersion(database);
         if (!version)
         {
             // DB scheme version not found. Looks like it was just created.
             return true;
         }
+        else if (*version == MIGRATABLE_DB_SCHEME_VERSION)
+        {
+            logger(Logging::ERROR) << "DB scheme version " << *version << " is out of date, expected version "
+                                   << CURRENT_DB_SCHEME_VERSION << ". Please run the db-migrator tool to convert "
+                                   << "your database, or delete it to resync from scratch.";
+            throw std::runtime_error("DB scheme version must be migrated");
+        }
         else if (*version < CURRENT_DB_SCHEME_VERSION)
         {
             logger(Logging::WARNING) << "DB scheme version is less than expected. Expected version "
@@ -622,6 +635,47 @@ namespace CryptoNote
         }
     }
 
+    bool DatabaseBlockchainCache::migrateDBScheme(IDataBase &database, std::shared_ptr<Logging::ILogger> _logger)
+    {
+        Logging::LoggerRef logger(_logger, "DatabaseBlockchainCache");
+
+        auto version = readDBSchemeVersion(database);
+        if (!version)
+        {
+            logger(Logging::ERROR) << "DB scheme version not found, nothing to migrate.";
+            return false;
+        }
+        else if (*version == CURRENT_DB_SCHEME_VERSION)
+        {
+            logger(Logging::INFO) << "DB scheme is already at version " << CURRENT_DB_SCHEME_VERSION << ".";
+            return true;
+        }
+        else if (*version != MIGRATABLE_DB_SCHEME_VERSION)
+        {
+            logger(Logging::ERROR) << "Can't migrate DB scheme version " << *version << ", only version "
+                                   << MIGRATABLE_DB_SCHEME_VERSION << " is supported.";
+            return false;
+        }
+
+        logger(Logging::INFO) << "Migrating DB scheme from version " << *version << " to version "
+                              << CURRENT_DB_SCHEME_VERSION << ", this may take a while...";
+
+        const uint64_t converted = DB::migrateLegacyEntries(database, _logger);
+
+        /* Only bump the version once everything has been converted, so an
+           interrupted migration will simply be resumed */
+        DatabaseVersionWriteBatch writeBatch(CURRENT_DB_SCHEME_VERSION);
+        auto writeError = database.write(writeBatch);
+        if (writeError)
+        {
+            throw std::system_error(writeError);
+        }
+
+        logger(Logging::INFO) << "Migration complete, converted " << converted << " entries.";
+
+        return true;
+    }
+
     void DatabaseBlockchainCache::deleteClosestTimestampBlockIndex(
         BlockchainWriteBatch &writeBatch,
         uint32_t splitBlockIndex)
@@ -733,6 +787,16 @@ namespace CryptoNote
             throw std::runtime_error(err.message());
         }
 
+        /* The removed key outputs may be cached, so clear them out. A lookup
+           may have read them from the database before the write and still be
+           about to cache them, so bump the generation too, which stops it. */
+        {
+            std::scoped_lock<std::mutex> lock(keyOutputCacheMutex);
+            keyOutputCache.clear();
+            keyOutputCacheIndex.clear();
+            keyOutputCacheGeneration++;
+        }
+
         cutTail(unitsCache, currentTop + 1 - splitBlockIndex);
 
         children.push_back(cache.get());
@@ -1254,24 +1318,18 @@ namespace CryptoNote
         Common::ArrayView<uint32_t> globalIndexes,
         std::vector<Crypto::PublicKey> &publicKeys) const
     {
-        return extractKeyOutputs(
-            amount,
-            blockIndex,
-            globalIndexes,
-            [this, &publicKeys, blockIndex](
-                const CachedTransactionInfo &info, PackedOutIndex index, uint32_t globalIndex) {
-                if (!isTransactionSpendTimeUnlocked(info.unlockTime, blockIndex))
-                {
-                    logger(Logging::DEBUGGING) << "extractKeyOutputKeys: output " << globalIndex << " is locked";
-                    return ExtractOutputKeysResult::OUTPUT_LOCKED;
-                }
+        for (const auto &[globalIndex, info] : getKeyOutputInfos(amount, globalIndexes))
+        {
+            if (!isTransactionSpendTimeUnlocked(info.unlockTime, blockIndex))
+            {
+                logger(Logging::DEBUGGING) << "extractKeyOutputKeys: output " << globalIndex << " is locked";
+                return ExtractOutputKeysResult::OUTPUT_LOCKED;
+            }
 
-                auto &output = info.outputs[index.outputIndex];
-                assert(output.type() == typeid(KeyOutput));
-                publicKeys.push_back(boost::get<KeyOutput>(output).key);
+            publicKeys.push_back(info.publicKey);
+        }
 
-                return ExtractOutputKeysResult::SUCCESS;
-            });
+        return ExtractOutputKeysResult::SUCCESS;
     }
 
     ExtractOutputKeysResult DatabaseBlockchainCache::extractKeyOtputIndexes(
@@ -1293,14 +1351,12 @@ namespace CryptoNote
         Common::ArrayView<uint32_t> globalIndexes,
         std::vector<std::pair<Crypto::Hash, size_t>> &outputReferences) const
     {
-        return extractKeyOutputs(
-            amount,
-            getTopBlockIndex(),
-            globalIndexes,
-            [&outputReferences](const CachedTransactionInfo &info, PackedOutIndex index, uint32_t globalIndex) {
-                outputReferences.push_back(std::make_pair(info.transactionHash, index.outputIndex));
-                return ExtractOutputKeysResult::SUCCESS;
-            });
+        for (const auto &[globalIndex, info] : getKeyOutputInfos(amount, globalIndexes))
+        {
+            outputReferences.push_back(std::make_pair(info.transactionHash, info.outputIndex));
+        }
+
+        return ExtractOutputKeysResult::SUCCESS;
     }
 
     uint32_t DatabaseBlockchainCache::getTopBlockIndex() const
@@ -1975,28 +2031,19 @@ namespace CryptoNote
             ExtractOutputKeysResult(const CachedTransactionInfo &info, PackedOutIndex index, uint32_t globalIndex)>
             callback) const
     {
-        BlockchainReadBatch batch;
-        for (auto it = globalIndexes.begin(); it != globalIndexes.end(); ++it)
-        {
-            batch.requestKeyOutputInfo(amount, *it);
-        }
-
-        auto result = readDatabase(batch).getKeyOutputInfo();
-        std::map<std::pair<IBlockchainCache::Amount, IBlockchainCache::GlobalOutputIndex>, KeyOutputInfo> sortedResult(
-            result.begin(), result.end());
-        for (const auto &kv : sortedResult)
+        for (const auto &[globalIndex, info] : getKeyOutputInfos(amount, globalIndexes))
         {
             ExtendedTransactionInfo tx;
-            tx.unlockTime = kv.second.unlockTime;
-            tx.transactionHash = kv.second.transactionHash;
-            tx.outputs.resize(kv.second.outputIndex + 1);
-            tx.outputs[kv.second.outputIndex] = KeyOutput {kv.second.publicKey};
+            tx.unlockTime = info.unlockTime;
+            tx.transactionHash = info.transactionHash;
+            tx.outputs.resize(info.outputIndex + 1);
+            tx.outputs[info.outputIndex] = KeyOutput {info.publicKey};
             PackedOutIndex fakePoi;
-            fakePoi.outputIndex = kv.second.outputIndex;
+            fakePoi.outputIndex = info.outputIndex;
 
             // TODO: change the interface of extractKeyOutputs to return vector of structures instead of passing
             // callback as predicate
-            auto ret = callback(tx, fakePoi, kv.first.second);
+            auto ret = callback(tx, fakePoi, globalIndex);
             if (ret != ExtractOutputKeysResult::SUCCESS)
             {
                 logger(Logging::DEBUGGING) << "extractKeyOutputs failed : callback returned error";
@@ -2007,6 +2054,86 @@ namespace CryptoNote
         return ExtractOutputKeysResult::SUCCESS;
     }
 
+    std::vector<std::pair<IBlockchainCache::GlobalOutputIndex, KeyOutputInfo>>
+        DatabaseBlockchainCache::getKeyOutputInfos(Amount amount, Common::ArrayView<uint32_t> globalIndexes) const
+    {
+        std::vector<std::pair<GlobalOutputIndex, KeyOutputInfo>> infos;
+        infos.reserve(globalIndexes.getSize());
+
+        BlockchainReadBatch batch;
+        bool haveMisses = false;
+
+        uint64_t generation;
+
+        {
+            std::scoped_lock<std::mutex> lock(keyOutputCacheMutex);
+
+            generation = keyOutputCacheGeneration;
+
+            for (const auto globalIndex : globalIndexes)
+            {
+                const auto it = keyOutputCacheIndex.find({amount, globalIndex});
+
+                if (it == keyOutputCacheIndex.end())
+                {
+                    batch.requestKeyOutputInfo(amount, globalIndex);
+                    haveMisses = true;
+                    continue;
+                }
+
+                /* Now the most recently used */
+                keyOutputCache.splice(keyOutputCache.begin(), keyOutputCache, it->second);
+
+                infos.emplace_back(globalIndex, it->second->second);
+            }
+        }
+
+        if (haveMisses)
+        {
+            const auto result = readDatabase(batch);
+
+            std::scoped_lock<std::mutex> lock(keyOutputCacheMutex);
+
+            /* If the chain was split since we looked, what we read may be the
+               removed outputs */
+            const bool upToDate = generation == keyOutputCacheGeneration;
+
+            for (const auto &[key, info] : result.getKeyOutputInfo())
+            {
+                infos.emplace_back(key.second, info);
+
+                if (!upToDate)
+                {
+                    continue;
+                }
+
+                /* Another thread may have read it in the meantime */
+                if (keyOutputCacheIndex.find(key) != keyOutputCacheIndex.end())
+                {
+                    continue;
+                }
+
+                keyOutputCache.emplace_front(key, info);
+                keyOutputCacheIndex[key] = keyOutputCache.begin();
+
+                if (keyOutputCache.size() > KEY_OUTPUT_CACHE_SIZE)
+                {
+                    keyOutputCacheIndex.erase(keyOutputCache.back().first);
+                    keyOutputCache.pop_back();
+                }
+            }
+        }
+
+        std::sort(infos.begin(), infos.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        infos.erase(
+            std::unique(
+                infos.begin(), infos.end(), [](const auto &a, const auto &b) { return a.first == b.first; }),
+            infos.end());
+
+        return infos;
+    }
+
     std::vector<Crypto::Hash>
         DatabaseBlockchainCache::getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const
     {
@@ -27,6 +27,8 @@
 #include <cryptonotecore/BlockchainWriteBatch.h>
 #include <cryptonotecore/DatabaseCacheData.h>
 #include <cryptonotecore/IBlockchainCacheFactory.h>
+#include <list>
+#include <mutex>
 
 namespace CryptoNote
 {
@@ -55,6 +57,10 @@ namespace CryptoNote
 
         static bool checkDBSchemeVersion(IDataBase &dataBase, std::shared_ptr<Logging::ILogger> logger);
 
+        /* Converts a database in the previous scheme to the current one in
+           place. Returns false if the database can't be migrated. */
+        static bool migrateDBScheme(IDataBase &dataBase, std::shared_ptr<Logging::ILogger> logger);
+
         /*
          * This methods splits cache, upper part (ie blocks with indexes larger than splitBlockIndex)
          * is copied to new BlockchainCache. Unfortunately, implementation requires return value to be of
@@ -252,6 +258,23 @@ namespace CryptoNote
 
         std::vector<IBlockchainCache *> children;
 
+        /* Recently read key outputs, most recently used first. Popular ring
+           members are looked up over and over when validating blocks and
+           pool transactions, so this saves going to the database each time.
+           Read from the validation threads, so guarded by the mutex. */
+        mutable std::list<std::pair<std::pair<Amount, GlobalOutputIndex>, KeyOutputInfo>> keyOutputCache;
+
+        mutable std::unordered_map<
+            std::pair<Amount, GlobalOutputIndex>,
+            std::list<std::pair<std::pair<Amount, GlobalOutputIndex>, KeyOutputInfo>>::iterator>
+            keyOutputCacheIndex;
+
+        /* Bumped when the chain is split. Key outputs read from the database
+           while that happened may have been removed, so aren't cached. */
+        uint64_t keyOutputCacheGeneration = 0;
+
+        mutable std::mutex keyOutputCacheMutex;
+
         Logging::LoggerRef logger;
 
         std::deque<CachedBlockInfo> unitsCache;
@@ -268,6 +291,11 @@ namespace CryptoNote
 
         BlockchainReadResult readDatabase(BlockchainReadBatch &batch) const;
 
+        /* The key outputs with these global indexes, sorted by global index,
+           without duplicates. Indexes which don't exist are left out. */
+        std::vector<std::pair<GlobalOutputIndex, KeyOutputInfo>>
+            getKeyOutputInfos(Amount amount, Common::ArrayView<uint32_t> globalIndexes) const;
+
         void addSpentKeyImage(const Crypto::KeyImage &keyImage, uint32_t blockIndex);
 
         void pushTransaction(
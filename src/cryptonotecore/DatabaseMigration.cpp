@@ -0,0 +1,295 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "DatabaseMigration.h"
+
+#include "BlockchainCache.h"
+#include "DBUtils.h"
+#include "DatabaseCacheData.h"
+
+#include <cstring>
+#include <logging/LoggerRef.h>
+#include <serialization/KVBinaryCommon.h>
+#include <serialization/KVBinaryInputStreamSerializer.h>
+
+namespace CryptoNote
+{
+    namespace DB
+    {
+        namespace
+        {
+            /* How many converted entries to write in one go */
+            const size_t MIGRATION_BATCH_SIZE = 10000;
+
+            class MigrationWriteBatch : public IWriteBatch
+            {
+              public:
+                virtual std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
+                {
+                    return std::move(m_insert);
+                }
+
+                virtual std::vector<std::string> extractRawKeysToRemove() override
+                {
+                    return std::move(m_remove);
+                }
+
+                size_t size() const
+                {
+                    return m_insert.size() + m_remove.size();
+                }
+
+                std::vector<std::pair<std::string, std::string>> m_insert;
+
+                std::vector<std::string> m_remove;
+            };
+
+            /* Every legacy key is a KV binary object with a single root entry,
+               so they all start with the storage header followed by an entry
+               count of one. Keys in the current scheme start with their ASCII
+               prefix, so can never match this. */
+            std::string legacyKeyHeader()
+            {
+                std::string header;
+
+                header.append(reinterpret_cast<const char *>(&PORTABLE_STORAGE_SIGNATUREA), sizeof(uint32_t));
+                header.append(reinterpret_cast<const char *>(&PORTABLE_STORAGE_SIGNATUREB), sizeof(uint32_t));
+                header.push_back(static_cast<char>(PORTABLE_STORAGE_FORMAT_VER));
+                header.push_back(static_cast<char>((1 << 2) | PORTABLE_RAW_SIZE_MARK_BYTE));
+
+                return header;
+            }
+
+            const std::string LEGACY_KEY_HEADER = legacyKeyHeader();
+
+            /* The root entry is named after the key prefix */
+            std::string legacyKeyPrefix(const std::string &rawKey, const size_t headerSize)
+            {
+                if (rawKey.size() <= headerSize)
+                {
+                    throw std::runtime_error("Legacy database key is truncated");
+                }
+
+                const size_t nameLength = static_cast<uint8_t>(rawKey[headerSize]);
+
+                if (rawKey.size() < headerSize + 1 + nameLength)
+                {
+                    throw std::runtime_error("Legacy database key is truncated");
+                }
+
+                return rawKey.substr(headerSize + 1, nameLength);
+            }
+
+            /* Legacy keys were std::pair<prefix, key> objects */
+            template<typename Key> bool decodeLegacyKey(const std::string &rawKey, const std::string &prefix, Key &key)
+            {
+                std::pair<std::string, Key> legacyKey;
+
+                try
+                {
+                    KVBinaryInputStreamSerializer serializer(rawKey.data(), rawKey.size());
+
+                    if (!serializer(legacyKey, prefix))
+                    {
+                        return false;
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    return false;
+                }
+
+                key = std::move(legacyKey.second);
+
+                return true;
+            }
+
+            template<typename Value>
+            void decodeLegacyValue(const std::string &rawValue, const std::string &prefix, Value &value)
+            {
+                KVBinaryInputStreamSerializer serializer(rawValue.data(), rawValue.size());
+
+                if (!serializer(value, prefix))
+                {
+                    throw std::runtime_error("Legacy database value for prefix " + prefix + " is missing");
+                }
+            }
+
+            template<typename Key, typename Value>
+            bool convertEntry(
+                const std::string &prefix,
+                const std::string &rawKey,
+                const std::string &rawValue,
+                MigrationWriteBatch &batch)
+            {
+                Key key;
+
+                if (!decodeLegacyKey(rawKey, prefix, key))
+                {
+                    return false;
+                }
+
+                Value value;
+                decodeLegacyValue(rawValue, prefix, value);
+
+                batch.m_insert.emplace_back(DB::serialize(prefix, key, value));
+                batch.m_remove.push_back(rawKey);
+
+                return true;
+            }
+
+            /* Hashes and the special string keys are both stored as KV
+               strings, so we tell them apart by their contents */
+            bool isStringKey(const std::string &rawKey, const std::string &prefix, const std::string &stringKey)
+            {
+                std::string key;
+                return decodeLegacyKey(rawKey, prefix, key) && key == stringKey;
+            }
+
+            bool convertLegacyEntry(const std::string &rawKey, const std::string &rawValue, MigrationWriteBatch &batch)
+            {
+                const std::string prefix = legacyKeyPrefix(rawKey, LEGACY_KEY_HEADER.size());
+
+                if (prefix == BLOCK_INDEX_TO_KEY_IMAGE_PREFIX)
+                {
+                    return convertEntry<uint32_t, std::vector<Crypto::KeyImage>>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == BLOCK_INDEX_TO_TX_HASHES_PREFIX)
+                {
+                    return convertEntry<uint32_t, std::vector<Crypto::Hash>>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == BLOCK_INDEX_TO_RAW_BLOCK_PREFIX)
+                {
+                    /* Raw blocks were always stored in binary, only the key changes */
+                    uint32_t blockIndex;
+
+                    if (!decodeLegacyKey(rawKey, prefix, blockIndex))
+                    {
+                        return false;
+                    }
+
+                    batch.m_insert.emplace_back(DB::serializeKey(prefix, blockIndex), rawValue);
+                    batch.m_remove.push_back(rawKey);
+
+                    return true;
+                }
+                else if (prefix == BLOCK_HASH_TO_BLOCK_INDEX_PREFIX)
+                {
+                    return convertEntry<Crypto::Hash, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == BLOCK_INDEX_TO_BLOCK_INFO_PREFIX)
+                {
+                    return convertEntry<uint32_t, CachedBlockInfo>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == KEY_IMAGE_TO_BLOCK_INDEX_PREFIX)
+                {
+                    return convertEntry<Crypto::KeyImage, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == BLOCK_INDEX_TO_BLOCK_HASH_PREFIX)
+                {
+                    return convertEntry<std::string, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == TRANSACTION_HASH_TO_TRANSACTION_INFO_PREFIX)
+                {
+                    if (isStringKey(rawKey, prefix, TRANSACTIONS_COUNT_KEY))
+                    {
+                        return convertEntry<std::string, uint64_t>(prefix, rawKey, rawValue, batch);
+                    }
+
+                    return convertEntry<Crypto::Hash, ExtendedTransactionInfo>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == KEY_OUTPUT_AMOUNT_PREFIX)
+                {
+                    return convertEntry<std::pair<uint64_t, uint32_t>, PackedOutIndex>(prefix, rawKey, rawValue, batch)
+                           || convertEntry<uint64_t, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == CLOSEST_TIMESTAMP_BLOCK_INDEX_PREFIX)
+                {
+                    return convertEntry<uint64_t, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == PAYMENT_ID_TO_TX_HASH_PREFIX)
+                {
+                    return convertEntry<std::pair<Crypto::Hash, uint32_t>, Crypto::Hash>(prefix, rawKey, rawValue, batch)
+                           || convertEntry<Crypto::Hash, uint32_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == TIMESTAMP_TO_BLOCKHASHES_PREFIX)
+                {
+                    return convertEntry<uint64_t, std::vector<Crypto::Hash>>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == KEY_OUTPUT_AMOUNTS_COUNT_PREFIX)
+                {
+                    if (isStringKey(rawKey, prefix, KEY_OUTPUT_AMOUNTS_COUNT_KEY))
+                    {
+                        return convertEntry<std::string, uint32_t>(prefix, rawKey, rawValue, batch);
+                    }
+
+                    return convertEntry<uint32_t, uint64_t>(prefix, rawKey, rawValue, batch);
+                }
+                else if (prefix == KEY_OUTPUT_KEY_PREFIX)
+                {
+                    return convertEntry<std::pair<uint64_t, uint32_t>, KeyOutputInfo>(prefix, rawKey, rawValue, batch);
+                }
+
+                return false;
+            }
+
+            void writeBatch(IDataBase &database, MigrationWriteBatch &batch)
+            {
+                const auto error = database.write(batch);
+
+                if (error)
+                {
+                    throw std::system_error(error);
+                }
+
+                batch.m_insert.clear();
+                batch.m_remove.clear();
+            }
+        } // namespace
+
+        uint64_t migrateLegacyEntries(IDataBase &database, std::shared_ptr<Logging::ILogger> _logger)
+        {
+            Logging::LoggerRef logger(_logger, "DatabaseMigration");
+
+            MigrationWriteBatch batch;
+
+            uint64_t converted = 0;
+
+            const auto error = database.iterate(
+                LEGACY_KEY_HEADER,
+                [&](const std::string &rawKey, const std::string &rawValue)
+                {
+                    if (!convertLegacyEntry(rawKey, rawValue, batch))
+                    {
+                        throw std::runtime_error(
+                            "Unrecognised legacy database entry with prefix "
+                            + legacyKeyPrefix(rawKey, LEGACY_KEY_HEADER.size()));
+                    }
+
+                    converted++;
+
+                    if (batch.size() >= MIGRATION_BATCH_SIZE)
+                    {
+                        writeBatch(database, batch);
+                    }
+
+                    if (converted % 1000000 == 0)
+                    {
+                        logger(Logging::INFO) << "Converted " << converted << " database entries...";
+                    }
+
+                    return true;
+                });
+
+            if (error)
+            {
+                throw std::system_error(error);
+            }
+
+            writeBatch(database, batch);
+
+            return converted;
+        }
+    } // namespace DB
+} // namespace CryptoNote
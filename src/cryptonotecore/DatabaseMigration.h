@@ -0,0 +1,24 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <IDataBase.h>
+#include <logging/ILogger.h>
+#include <memory>
+
+namespace CryptoNote
+{
+    namespace DB
+    {
+        /* Rewrites every entry stored in the legacy scheme (keys and values
+           both KV binary objects) in the current fixed width key / binary
+           value scheme. Entries already in the current scheme are left alone,
+           so this can safely be rerun if it was interrupted.
+
+           Returns the number of entries converted. Throws on a corrupted or
+           unrecognised entry. */
+        uint64_t migrateLegacyEntries(IDataBase &database, std::shared_ptr<Logging::ILogger> logger);
+    } // namespace DB
+} // namespace CryptoNote
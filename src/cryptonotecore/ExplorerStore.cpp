@@ -0,0 +1,409 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "ExplorerStore.h"
+
+#include "DBUtils.h"
+
+#include <common/CryptoNoteTools.h>
+#include <serialization/BlockchainExplorerDataSerialization.h>
+
+namespace CryptoNote
+{
+    namespace
+    {
+        /* Bump this when the stored format changes, and the store will be
+           rebuilt */
+        const uint32_t EXPLORER_STORE_VERSION = 1;
+
+        /* How many entries to remove in one go when clearing the store */
+        const size_t CLEAR_BATCH_SIZE = 10000;
+
+        class ExplorerWriteBatch : public IWriteBatch
+        {
+          public:
+            virtual std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
+            {
+                return std::move(m_insert);
+            }
+
+            virtual std::vector<std::string> extractRawKeysToRemove() override
+            {
+                return std::move(m_remove);
+            }
+
+            std::vector<std::pair<std::string, std::string>> m_insert;
+
+            std::vector<std::string> m_remove;
+        };
+
+        class ExplorerReadBatch : public IReadBatch
+        {
+          public:
+            ExplorerReadBatch(const std::string &key): m_keys({key}) {}
+
+            virtual std::vector<std::string> getRawKeys() const override
+            {
+                return m_keys;
+            }
+
+            virtual void
+                submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override
+            {
+                m_values = values;
+                m_resultStates = resultStates;
+            }
+
+            /* The value read, if the key exists */
+            std::optional<std::string> value() const
+            {
+                if (m_resultStates.empty() || !m_resultStates.front())
+                {
+                    return std::nullopt;
+                }
+
+                return m_values.front();
+            }
+
+          private:
+            std::vector<std::string> m_keys;
+
+            std::vector<std::string> m_values;
+
+            std::vector<bool> m_resultStates;
+        };
+
+        struct ExplorerState
+        {
+            uint32_t version = EXPLORER_STORE_VERSION;
+
+            uint32_t startIndex = 0;
+
+            uint32_t blockCount = 0;
+        };
+
+        void serialize(ExplorerState &state, ISerializer &s)
+        {
+            s(state.version, "version");
+            s(state.startIndex, "start_index");
+            s(state.blockCount, "block_count");
+        }
+
+        struct StoredBlockDetails
+        {
+            BlockDetails block;
+        };
+
+        void serialize(StoredBlockDetails &stored, ISerializer &s)
+        {
+            s(stored.block, "block");
+
+            /* Left out of the BlockDetails serialization, since not every
+               serializer supports doubles */
+            s.binary(&stored.block.penalty, sizeof(stored.block.penalty), "penalty");
+        }
+
+        std::string blockKey(const uint32_t index)
+        {
+            return DB::serializeKey(DB::EXPLORER_BLOCK_INDEX_TO_BLOCK_DETAILS_PREFIX, index);
+        }
+
+        std::string transactionKey(const Crypto::Hash &transactionHash)
+        {
+            return DB::serializeKey(DB::EXPLORER_TRANSACTION_HASH_TO_BLOCK_INDEX_PREFIX, transactionHash);
+        }
+    } // namespace
+
+    ExplorerStore::ExplorerStore(IDataBase &database, std::shared_ptr<Logging::ILogger> logger):
+        m_database(database),
+        logger(logger, "ExplorerStore")
+    {
+        ExplorerReadBatch batch(DB::EXPLORER_STATE_KEY);
+
+        const auto error = m_database.read(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to read explorer store state from database");
+        }
+
+        ExplorerState state;
+
+        if (const auto value = batch.value())
+        {
+            DB::deserialize(*value, state, "state");
+        }
+
+        if (!batch.value() || state.version != EXPLORER_STORE_VERSION)
+        {
+            clear();
+            return;
+        }
+
+        m_startIndex = state.startIndex;
+        m_blockCount = state.blockCount;
+    }
+
+    uint32_t ExplorerStore::getStartIndex() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        return m_startIndex;
+    }
+
+    uint32_t ExplorerStore::getBlockCount() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        return m_blockCount;
+    }
+
+    void ExplorerStore::pushBlock(const BlockDetails &block)
+    {
+        if (block.index != m_startIndex + m_blockCount)
+        {
+            throw std::invalid_argument("Explorer store blocks must be contiguous");
+        }
+
+        writeBlock(block, m_startIndex, m_blockCount + 1);
+    }
+
+    void ExplorerStore::pushBlockBelow(const BlockDetails &block)
+    {
+        if (m_startIndex == 0 || block.index != m_startIndex - 1)
+        {
+            throw std::invalid_argument("Explorer store blocks must be contiguous");
+        }
+
+        writeBlock(block, m_startIndex - 1, m_blockCount + 1);
+    }
+
+    void ExplorerStore::popBlocks(const uint32_t index)
+    {
+        const uint32_t endIndex = m_startIndex + m_blockCount;
+
+        if (index >= endIndex)
+        {
+            return;
+        }
+
+        ExplorerWriteBatch batch;
+
+        for (uint32_t i = std::max(index, m_startIndex); i < endIndex; i++)
+        {
+            /* Need the transaction hashes to remove their entries */
+            if (const auto block = getBlockDetails(i))
+            {
+                for (const auto &transaction : block->transactions)
+                {
+                    batch.m_remove.push_back(transactionKey(transaction.hash));
+                }
+            }
+
+            batch.m_remove.push_back(blockKey(i));
+        }
+
+        /* If everything was removed, carry on from the lowest removed block */
+        const uint32_t startIndex = std::min(index, m_startIndex);
+        const uint32_t blockCount = index > m_startIndex ? index - m_startIndex : 0;
+
+        ExplorerState state {EXPLORER_STORE_VERSION, startIndex, blockCount};
+        batch.m_insert.push_back({DB::EXPLORER_STATE_KEY, DB::serialize(state, "state")});
+
+        const auto error = m_database.write(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to remove blocks from explorer store");
+        }
+
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        m_startIndex = startIndex;
+        m_blockCount = blockCount;
+    }
+
+    void ExplorerStore::reset(const uint32_t startIndex)
+    {
+        if (m_blockCount != 0)
+        {
+            popBlocks(m_startIndex);
+        }
+
+        writeState(startIndex, 0);
+    }
+
+    std::optional<BlockDetails> ExplorerStore::getBlockDetails(const uint32_t index) const
+    {
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            if (index < m_startIndex || index >= m_startIndex + m_blockCount)
+            {
+                return std::nullopt;
+            }
+        }
+
+        ExplorerReadBatch batch(blockKey(index));
+
+        if (m_database.read(batch))
+        {
+            return std::nullopt;
+        }
+
+        /* Removed since we checked */
+        const auto value = batch.value();
+
+        if (!value)
+        {
+            return std::nullopt;
+        }
+
+        StoredBlockDetails stored;
+
+        DB::deserialize(*value, stored, "block");
+
+        for (auto &transaction : stored.block.transactions)
+        {
+            transaction.hasPaymentId = transaction.paymentId != Constants::NULL_HASH;
+        }
+
+        return stored.block;
+    }
+
+    std::optional<TransactionDetails> ExplorerStore::getTransactionDetails(const Crypto::Hash &transactionHash) const
+    {
+        ExplorerReadBatch batch(transactionKey(transactionHash));
+
+        if (m_database.read(batch))
+        {
+            return std::nullopt;
+        }
+
+        const auto value = batch.value();
+
+        if (!value)
+        {
+            return std::nullopt;
+        }
+
+        uint32_t blockIndex;
+
+        DB::deserialize(*value, blockIndex, "block_index");
+
+        const auto block = getBlockDetails(blockIndex);
+
+        if (!block)
+        {
+            return std::nullopt;
+        }
+
+        /* Also checks the block hasn't been replaced since we read the index */
+        for (const auto &transaction : block->transactions)
+        {
+            if (transaction.hash == transactionHash)
+            {
+                return transaction;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void ExplorerStore::writeBlock(const BlockDetails &block, const uint32_t startIndex, const uint32_t blockCount)
+    {
+        ExplorerWriteBatch batch;
+
+        batch.m_insert.push_back({blockKey(block.index), DB::serialize(StoredBlockDetails {block}, "block")});
+
+        for (const auto &transaction : block.transactions)
+        {
+            batch.m_insert.push_back({transactionKey(transaction.hash), DB::serialize(block.index, "block_index")});
+        }
+
+        ExplorerState state {EXPLORER_STORE_VERSION, startIndex, blockCount};
+        batch.m_insert.push_back({DB::EXPLORER_STATE_KEY, DB::serialize(state, "state")});
+
+        const auto error = m_database.write(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to write block to explorer store");
+        }
+
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        m_startIndex = startIndex;
+        m_blockCount = blockCount;
+    }
+
+    void ExplorerStore::writeState(const uint32_t startIndex, const uint32_t blockCount)
+    {
+        ExplorerWriteBatch batch;
+
+        ExplorerState state {EXPLORER_STORE_VERSION, startIndex, blockCount};
+        batch.m_insert.push_back({DB::EXPLORER_STATE_KEY, DB::serialize(state, "state")});
+
+        const auto error = m_database.write(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to write explorer store state");
+        }
+
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        m_startIndex = startIndex;
+        m_blockCount = blockCount;
+    }
+
+    void ExplorerStore::clear()
+    {
+        for (const auto &prefix :
+             {DB::EXPLORER_BLOCK_INDEX_TO_BLOCK_DETAILS_PREFIX, DB::EXPLORER_TRANSACTION_HASH_TO_BLOCK_INDEX_PREFIX})
+        {
+            ExplorerWriteBatch batch;
+
+            size_t removed = 0;
+
+            const auto flush = [&]() {
+                const auto error = m_database.write(batch);
+
+                if (error)
+                {
+                    throw std::system_error(error, "Failed to clear explorer store");
+                }
+
+                batch = ExplorerWriteBatch();
+            };
+
+            const auto error = m_database.iterate(prefix, [&](const std::string &key, const std::string &) {
+                batch.m_remove.push_back(key);
+
+                if (batch.m_remove.size() >= CLEAR_BATCH_SIZE)
+                {
+                    removed += batch.m_remove.size();
+                    flush();
+                }
+
+                return true;
+            });
+
+            if (error)
+            {
+                throw std::system_error(error, "Failed to clear explorer store");
+            }
+
+            removed += batch.m_remove.size();
+            flush();
+
+            if (removed != 0)
+            {
+                logger(Logging::INFO) << "Removed " << removed << " outdated explorer store entries";
+            }
+        }
+
+        writeState(0, 0);
+    }
+} // namespace CryptoNote
@@ -0,0 +1,76 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "IDataBase.h"
+
+#include <BlockchainExplorerData.h>
+#include <logging/LoggerRef.h>
+#include <mutex>
+#include <optional>
+
+namespace CryptoNote
+{
+    /* Precomputed BlockDetails for a contiguous run of main chain blocks,
+       stored in the blockchain database. Building the details of a block
+       takes many database reads and reward calculations, so explorers asking
+       for the same blocks over and over are much cheaper to serve from here.
+
+       The core keeps it up to date - blocks are pushed as they're added to
+       the main chain, popped on a reorg, and the rest filled in the
+       background. Only blocks from the start index to the top are stored;
+       anything else returns nothing, and is built as before.
+
+       Reads are thread safe. Writes must all come from the core's thread. */
+    class ExplorerStore
+    {
+      public:
+        ExplorerStore(IDataBase &database, std::shared_ptr<Logging::ILogger> logger);
+
+        /* Index of the first stored block */
+        uint32_t getStartIndex() const;
+
+        /* Number of stored blocks, from the start index */
+        uint32_t getBlockCount() const;
+
+        /* Adds the block after the last stored block */
+        void pushBlock(const BlockDetails &block);
+
+        /* Adds the block before the first stored block */
+        void pushBlockBelow(const BlockDetails &block);
+
+        /* Removes every stored block from this index upwards */
+        void popBlocks(const uint32_t index);
+
+        /* Removes every stored block. The next block pushed must have this
+           index. */
+        void reset(const uint32_t startIndex);
+
+        std::optional<BlockDetails> getBlockDetails(const uint32_t index) const;
+
+        /* Details of a transaction in a stored block */
+        std::optional<TransactionDetails> getTransactionDetails(const Crypto::Hash &transactionHash) const;
+
+      private:
+        void writeBlock(const BlockDetails &block, const uint32_t startIndex, const uint32_t blockCount);
+
+        void writeState(const uint32_t startIndex, const uint32_t blockCount);
+
+        /* Removes every stored block, and any left from an older version */
+        void clear();
+
+        IDataBase &m_database;
+
+        uint32_t m_startIndex = 0;
+
+        uint32_t m_blockCount = 0;
+
+        /* Guards the start index and block count, which are read from the
+           RPC threads */
+        mutable std::mutex m_mutex;
+
+        Logging::LoggerRef logger;
+    };
+} // namespace CryptoNote
@@ -0,0 +1,275 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "HotStateCache.h"
+
+namespace CryptoNote
+{
+    namespace
+    {
+        /* Rough memory used by the list and map nodes of an entry, on top of
+           the key and value themselves */
+        const uint64_t ENTRY_OVERHEAD = 96;
+
+        /* Values bigger than this fraction of the budget aren't cached, so one
+           huge block can't push out everything else */
+        const uint64_t MAX_ENTRY_FRACTION = 16;
+
+        uint64_t entrySize(const std::string &key, const std::string &value)
+        {
+            /* The key is held in both the list and the index */
+            return key.size() * 2 + value.size() + ENTRY_OVERHEAD;
+        }
+
+        class RawWriteBatch : public IWriteBatch
+        {
+          public:
+            RawWriteBatch(
+                const std::vector<std::pair<std::string, std::string>> &insert,
+                const std::vector<std::string> &remove):
+                m_insert(insert),
+                m_remove(remove)
+            {
+            }
+
+            /* Copies, since we still need them to update the cache */
+            virtual std::vector<std::pair<std::string, std::string>> extractRawDataToInsert() override
+            {
+                return m_insert;
+            }
+
+            virtual std::vector<std::string> extractRawKeysToRemove() override
+            {
+                return m_remove;
+            }
+
+          private:
+            const std::vector<std::pair<std::string, std::string>> &m_insert;
+
+            const std::vector<std::string> &m_remove;
+        };
+
+        class RawReadBatch : public IReadBatch
+        {
+          public:
+            RawReadBatch(std::vector<std::string> keys): m_keys(std::move(keys)) {}
+
+            virtual std::vector<std::string> getRawKeys() const override
+            {
+                return m_keys;
+            }
+
+            virtual void
+                submitRawResult(const std::vector<std::string> &values, const std::vector<bool> &resultStates) override
+            {
+                m_values = values;
+                m_resultStates = resultStates;
+            }
+
+            std::vector<std::string> m_keys;
+
+            std::vector<std::string> m_values;
+
+            std::vector<bool> m_resultStates;
+        };
+    } // namespace
+
+    HotStateCache::HotStateCache(IDataBase &database, const uint64_t capacity):
+        m_database(database),
+        m_capacity(capacity)
+    {
+    }
+
+    std::error_code HotStateCache::write(IWriteBatch &batch)
+    {
+        auto toInsert = batch.extractRawDataToInsert();
+        const auto toRemove = batch.extractRawKeysToRemove();
+
+        RawWriteBatch rawBatch(toInsert, toRemove);
+
+        const auto error = m_database.write(rawBatch);
+
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        m_writeCount++;
+
+        for (const auto &key : toRemove)
+        {
+            remove(key);
+        }
+
+        for (auto &[key, value] : toInsert)
+        {
+            /* Not sure what made it to the database, so don't cache it */
+            if (error)
+            {
+                remove(key);
+            }
+            else
+            {
+                insert(std::move(key), std::move(value));
+            }
+        }
+
+        return error;
+    }
+
+    std::error_code HotStateCache::read(IReadBatch &batch)
+    {
+        return read(batch, false);
+    }
+
+#if !defined(USE_LEVELDB)
+    std::error_code HotStateCache::readThreadSafe(IReadBatch &batch)
+    {
+        return read(batch, true);
+    }
+#endif
+
+    std::error_code HotStateCache::iterate(
+        const std::string &prefix,
+        const std::function<bool(const std::string &key, const std::string &value)> &callback)
+    {
+        return m_database.iterate(prefix, callback);
+    }
+
+    HotStateCache::Stats HotStateCache::getStats() const
+    {
+        std::scoped_lock<std::mutex> lock(m_mutex);
+
+        Stats stats;
+
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.entryCount = m_index.size();
+        stats.size = m_size;
+        stats.capacity = m_capacity;
+
+        return stats;
+    }
+
+    std::error_code HotStateCache::read(IReadBatch &batch, const bool threadSafe)
+    {
+        const auto keys = batch.getRawKeys();
+
+        std::vector<std::string> values(keys.size());
+        std::vector<bool> resultStates(keys.size(), false);
+
+        /* Indexes of the keys we need to read from the database */
+        std::vector<size_t> misses;
+
+        std::vector<std::string> missedKeys;
+
+        uint64_t writeCount;
+
+        {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            writeCount = m_writeCount;
+
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                const auto it = m_index.find(keys[i]);
+
+                if (it == m_index.end())
+                {
+                    misses.push_back(i);
+                    missedKeys.push_back(keys[i]);
+                    continue;
+                }
+
+                /* Now the most recently used */
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+                values[i] = it->second->second;
+                resultStates[i] = true;
+            }
+
+            m_hits += keys.size() - misses.size();
+            m_misses += misses.size();
+        }
+
+        if (!misses.empty())
+        {
+            RawReadBatch rawBatch(std::move(missedKeys));
+
+#if !defined(USE_LEVELDB)
+            const auto error = threadSafe ? m_database.readThreadSafe(rawBatch) : m_database.read(rawBatch);
+#else
+            const auto error = m_database.read(rawBatch);
+#endif
+
+            if (error)
+            {
+                return error;
+            }
+
+            std::scoped_lock<std::mutex> lock(m_mutex);
+
+            const bool upToDate = writeCount == m_writeCount;
+
+            for (size_t i = 0; i < misses.size(); i++)
+            {
+                if (!rawBatch.m_resultStates[i])
+                {
+                    continue;
+                }
+
+                values[misses[i]] = rawBatch.m_values[i];
+                resultStates[misses[i]] = true;
+
+                if (upToDate)
+                {
+                    insert(rawBatch.m_keys[i], rawBatch.m_values[i]);
+                }
+            }
+        }
+
+        batch.submitRawResult(values, resultStates);
+
+        return std::error_code();
+    }
+
+    void HotStateCache::insert(std::string key, std::string value)
+    {
+        remove(key);
+
+        const uint64_t size = entrySize(key, value);
+
+        if (size > m_capacity / MAX_ENTRY_FRACTION)
+        {
+            return;
+        }
+
+        m_entries.emplace_front(key, std::move(value));
+        m_index[std::move(key)] = m_entries.begin();
+
+        m_size += size;
+
+        while (m_size > m_capacity)
+        {
+            const auto &[oldestKey, oldestValue] = m_entries.back();
+
+            m_size -= entrySize(oldestKey, oldestValue);
+
+            m_index.erase(oldestKey);
+            m_entries.pop_back();
+        }
+    }
+
+    void HotStateCache::remove(const std::string &key)
+    {
+        const auto it = m_index.find(key);
+
+        if (it == m_index.end())
+        {
+            return;
+        }
+
+        m_size -= entrySize(it->second->first, it->second->second);
+
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+} // namespace CryptoNote
@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "IDataBase.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace CryptoNote
+{
+    /* An in process cache sitting in front of the blockchain database.
+
+       Entries are keyed by the raw database key, which is the entity prefix
+       followed by its key - so a cached block info, block hash index or
+       transaction info is the same entity the read batches ask for. Writes go
+       straight through to the database, then update the cache, so the blocks
+       and transactions just added at the top of the chain are cached before
+       anyone asks for them. Whatever's least recently used is dropped once
+       the byte budget is reached.
+
+       Reads and writes are thread safe. Anything iterated is read directly
+       from the database. */
+    class HotStateCache : public IDataBase
+    {
+      public:
+        struct Stats
+        {
+            uint64_t hits = 0;
+
+            uint64_t misses = 0;
+
+            uint64_t entryCount = 0;
+
+            /* Approximate bytes used by the cached keys and values */
+            uint64_t size = 0;
+
+            uint64_t capacity = 0;
+        };
+
+        HotStateCache(IDataBase &database, const uint64_t capacity);
+
+        std::error_code write(IWriteBatch &batch) override;
+
+        std::error_code read(IReadBatch &batch) override;
+
+        std::error_code iterate(
+            const std::string &prefix,
+            const std::function<bool(const std::string &key, const std::string &value)> &callback) override;
+
+#if !defined(USE_LEVELDB)
+        std::error_code readThreadSafe(IReadBatch &batch) override;
+#endif
+
+        Stats getStats() const;
+
+      private:
+        std::error_code read(IReadBatch &batch, const bool threadSafe);
+
+        /* Adds or replaces the cached value, evicting if we're over budget */
+        void insert(std::string key, std::string value);
+
+        void remove(const std::string &key);
+
+        IDataBase &m_database;
+
+        const uint64_t m_capacity;
+
+        uint64_t m_size = 0;
+
+        uint64_t m_hits = 0;
+
+        uint64_t m_misses = 0;
+
+        /* Bumped on every write. Values read from the database while a write
+           happened may be out of date, so aren't cached. */
+        uint64_t m_writeCount = 0;
+
+        /* Most recently used first */
+        std::list<std::pair<std::string, std::string>> m_entries;
+
+        std::unordered_map<std::string, std::list<std::pair<std::string, std::string>>::iterator> m_index;
+
+        mutable std::mutex m_mutex;
+    };
+} // namespace CryptoNote
@@ -9,6 +9,7 @@
 #include "AddBlockErrors.h"
 #include "BlockchainExplorerData.h"
 #include "BlockchainMessages.h"
+#include "BlockResponseCache.h"
 #include "CachedBlock.h"
 #include "CachedTransaction.h"
 #include "CoreStatistics.h"
@@ -39,6 +40,11 @@ namespace CryptoNote
 
         virtual bool removeMessageQueue(MessageQueue<BlockchainMessage> &messageQueue) = 0;
 
+        /* Observers are notified from the core's thread, so must be thread safe */
+        virtual bool addObserver(ICoreObserver *observer) = 0;
+
+        virtual bool removeObserver(ICoreObserver *observer) = 0;
+
         virtual uint32_t getTopBlockIndex() const = 0;
 
         virtual Crypto::Hash getTopBlockHash() const = 0;
@@ -185,6 +191,8 @@ namespace CryptoNote
 
         virtual CoreStatistics getCoreStatistics() const = 0;
 
+        virtual std::shared_ptr<BlockResponseCache> getBlockResponseCache() const = 0;
+
         virtual void save() = 0;
 
         virtual void load() = 0;
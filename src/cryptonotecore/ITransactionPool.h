@@ -43,6 +43,17 @@ namespace CryptoNote
 
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const = 0;
 
+        /* Pool transactions which spend any of the key images in the given state */
+        virtual std::vector<Crypto::Hash>
+            getConflictingTransactionHashes(const TransactionValidatorState &state) const = 0;
+
+        /* Pool transactions whose binary size is greater than maxSize */
+        virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(const size_t maxSize) const = 0;
+
+        /* Pool transactions whose mixin is outside of [minMixin, maxMixin] */
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesOutsideMixinRange(const uint64_t minMixin, const uint64_t maxMixin) const = 0;
+
         virtual void flush() = 0;
     };
 
@@ -203,6 +203,37 @@ std::error_code LevelDBWrapper::read(IReadBatch &batch)
     return std::error_code();
 }
 
+std::error_code LevelDBWrapper::iterate(
+    const std::string &prefix,
+    const std::function<bool(const std::string &key, const std::string &value)> &callback)
+{
+    if (state.load() != INITIALIZED)
+    {
+        throw std::runtime_error("Not initialized.");
+    }
+
+    leveldb::ReadOptions readOptions;
+    readOptions.fill_cache = false;
+
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(readOptions));
+
+    for (it->Seek(leveldb::Slice(prefix)); it->Valid() && it->key().starts_with(leveldb::Slice(prefix)); it->Next())
+    {
+        if (!callback(it->key().ToString(), it->value().ToString()))
+        {
+            break;
+        }
+    }
+
+    if (!it->status().ok())
+    {
+        logger(Logging::ERROR) << "Can't iterate database: " << it->status().ToString();
+        return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+    }
+
+    return std::error_code();
+}
+
 std::string LevelDBWrapper::getDataDir(const DataBaseConfig &config)
 {
     return config.getDataDir() + '/' + DB_NAME;
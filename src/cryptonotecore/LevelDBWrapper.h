@@ -41,6 +41,10 @@ namespace CryptoNote
 
         std::error_code read(IReadBatch &batch) override;
 
+        std::error_code iterate(
+            const std::string &prefix,
+            const std::function<bool(const std::string &key, const std::string &value)> &callback) override;
+
       private:
         std::error_code write(IWriteBatch &batch, bool sync);
 
@@ -5,6 +5,7 @@
 
 #include "MainChainStorage.h"
 
+#include "BlockchainReadBatch.h"
 #include "common/CryptoNoteTools.h"
 #include "common/FileSystemShim.h"
 #include <sstream>
@@ -85,6 +86,91 @@ namespace CryptoNote
         storage.clear();
     }
 
+    DatabaseMainChainStorage::DatabaseMainChainStorage(IDataBase &database): m_database(database)
+    {
+        auto batch = BlockchainReadBatch().requestLastBlockIndex();
+
+        const auto error = m_database.read(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to read top block index from database");
+        }
+
+        const auto lastBlockIndex = batch.extractResult().getLastBlockIndex();
+
+        /* A brand new database has no blocks yet, but the root segment will
+           write the genesis block as soon as it is created */
+        m_blockCount = lastBlockIndex.second ? lastBlockIndex.first + 1 : 1;
+    }
+
+    void DatabaseMainChainStorage::pushBlock(const RawBlock &)
+    {
+        m_blockCount++;
+    }
+
+    void DatabaseMainChainStorage::popBlock()
+    {
+        m_blockCount--;
+    }
+
+    void DatabaseMainChainStorage::rewindTo(const uint32_t index) const
+    {
+        /* Matches MainChainStorage - the chain is left with index - 1 blocks.
+           The root segment is then cut to match when the core is loaded. */
+        if (index > 0 && m_blockCount >= index)
+        {
+            m_blockCount = index - 1;
+        }
+    }
+
+    RawBlock DatabaseMainChainStorage::getBlockByIndex(uint32_t index) const
+    {
+        if (index >= m_blockCount)
+        {
+            throw std::out_of_range(
+                "Block index " + std::to_string(index)
+                + " is out of range. Blocks count: " + std::to_string(m_blockCount));
+        }
+
+        auto batch = BlockchainReadBatch().requestRawBlock(index);
+
+        const auto error = m_database.read(batch);
+
+        if (error)
+        {
+            throw std::system_error(error, "Failed to read block from database");
+        }
+
+        auto result = batch.extractResult();
+
+        const auto it = result.getRawBlocks().find(index);
+
+        if (it == result.getRawBlocks().end())
+        {
+            std::stringstream errorMessage;
+
+            errorMessage << "Local blockchain cache corruption detected." << std::endl
+                         << "Block with index " << std::to_string(index)
+                         << " could not be found in the database." << std::endl << std::endl
+                         << "Please launch the node with the option: --resync" << std::endl;
+
+            throw std::runtime_error(errorMessage.str());
+        }
+
+        return it->second;
+    }
+
+    uint32_t DatabaseMainChainStorage::getBlockCount() const
+    {
+        return m_blockCount;
+    }
+
+    void DatabaseMainChainStorage::clear()
+    {
+        m_blockCount = 0;
+    }
+
     std::unique_ptr<IMainChainStorage>
         createSwappedMainChainStorage(const std::string &dataDir, const Currency &currency)
     {
@@ -103,4 +189,9 @@ namespace CryptoNote
         return storage;
     }
 
+    std::unique_ptr<IMainChainStorage> createDatabaseMainChainStorage(IDataBase &database)
+    {
+        return std::unique_ptr<IMainChainStorage>(new DatabaseMainChainStorage(database));
+    }
+
 } // namespace CryptoNote
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "Currency.h"
+#include "IDataBase.h"
 #include "IMainChainStorage.h"
 #include "SwappedVector.h"
 
@@ -34,7 +35,36 @@ namespace CryptoNote
         mutable SwappedVector<RawBlock> storage;
     };
 
+    /* Doesn't store any blocks itself - the database blockchain cache already
+       stores every raw block of the root segment, so we just read them from
+       there by index. We only keep track of how long the main chain is, which
+       may be longer than the root segment after a reorg. */
+    class DatabaseMainChainStorage : public IMainChainStorage
+    {
+      public:
+        DatabaseMainChainStorage(IDataBase &database);
+
+        virtual void pushBlock(const RawBlock &rawBlock) override;
+
+        virtual void popBlock() override;
+
+        void rewindTo(const uint32_t index) const override;
+
+        virtual RawBlock getBlockByIndex(uint32_t index) const override;
+
+        virtual uint32_t getBlockCount() const override;
+
+        virtual void clear() override;
+
+      private:
+        IDataBase &m_database;
+
+        mutable uint32_t m_blockCount;
+    };
+
     std::unique_ptr<IMainChainStorage>
         createSwappedMainChainStorage(const std::string &dataDir, const Currency &currency);
 
+    std::unique_ptr<IMainChainStorage> createDatabaseMainChainStorage(IDataBase &database);
+
 } // namespace CryptoNote
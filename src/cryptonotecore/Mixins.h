@@ -34,10 +34,9 @@ namespace CryptoNote
             return {true, std::string()};
         }
 
-        /* This method is commonly used by the node to determine if the transaction has
-           the correct mixin (anonymity) as defined by the current rules */
-        static std::tuple<bool, std::string>
-            validate(const CachedTransaction &transaction, uint64_t minMixin, uint64_t maxMixin)
+        /* The mixin of a transaction is the largest ring size of its key inputs,
+           minus one - your transaction plus the others you mix with */
+        static uint64_t getMixin(const CachedTransaction &transaction)
         {
             uint64_t ringSize = 1;
 
@@ -59,8 +58,15 @@ namespace CryptoNote
                 }
             }
 
-            /* Ring size = mixin + 1 - your transaction plus the others you mix with */
-            const uint64_t mixin = ringSize - 1;
+            return ringSize - 1;
+        }
+
+        /* This method is commonly used by the node to determine if the transaction has
+           the correct mixin (anonymity) as defined by the current rules */
+        static std::tuple<bool, std::string>
+            validate(const CachedTransaction &transaction, uint64_t minMixin, uint64_t maxMixin)
+        {
+            const uint64_t mixin = getMixin(transaction);
 
             std::stringstream str;
 
@@ -188,6 +188,37 @@ std::error_code RocksDBWrapper::read(IReadBatch &batch)
     return std::error_code();
 }
 
+std::error_code RocksDBWrapper::iterate(
+    const std::string &prefix,
+    const std::function<bool(const std::string &key, const std::string &value)> &callback)
+{
+    if (state.load() != INITIALIZED)
+    {
+        throw std::runtime_error("Not initialized.");
+    }
+
+    rocksdb::ReadOptions readOptions;
+    readOptions.fill_cache = false;
+
+    std::unique_ptr<rocksdb::Iterator> it(db->NewIterator(readOptions));
+
+    for (it->Seek(rocksdb::Slice(prefix)); it->Valid() && it->key().starts_with(rocksdb::Slice(prefix)); it->Next())
+    {
+        if (!callback(it->key().ToString(), it->value().ToString()))
+        {
+            break;
+        }
+    }
+
+    if (!it->status().ok())
+    {
+        logger(Logging::ERROR) << "Can't iterate database: " << it->status().ToString();
+        return make_error_code(CryptoNote::error::DataBaseErrorCodes::INTERNAL_ERROR);
+    }
+
+    return std::error_code();
+}
+
 std::error_code RocksDBWrapper::readThreadSafe(IReadBatch &batch)
 {
     if (state.load() != INITIALIZED)
@@ -6,6 +6,7 @@
 #include "TransactionPool.h"
 
 #include "CryptoNoteBasicImpl.h"
+#include "Mixins.h"
 #include "common/TransactionExtra.h"
 #include "common/int-util.h"
 
@@ -113,6 +114,11 @@ namespace CryptoNote
         return cachedTransaction.getTransactionHash();
     }
 
+    size_t TransactionPool::PendingTransactionInfo::getTransactionSize() const
+    {
+        return cachedTransaction.getTransactionBinaryArray().size();
+    }
+
     size_t TransactionPool::PaymentIdHasher::operator()(const boost::optional<Crypto::Hash> &paymentId) const
     {
         if (!paymentId)
@@ -127,6 +133,8 @@ namespace CryptoNote
         transactionHashIndex(transactions.get<TransactionHashTag>()),
         transactionCostIndex(transactions.get<TransactionCostTag>()),
         paymentIdIndex(transactions.get<PaymentIdTag>()),
+        transactionSizeIndex(transactions.get<TransactionSizeTag>()),
+        mixinIndex(transactions.get<MixinTag>()),
         logger(logger, "TransactionPool")
     {
     }
@@ -141,6 +149,8 @@ namespace CryptoNote
             pendingTx.paymentId = paymentId;
         }
 
+        pendingTx.mixin = Mixins::getMixin(pendingTx.cachedTransaction);
+
         std::scoped_lock lock(m_transactionsMutex);
 
         if (transactionHashIndex.count(pendingTx.getTransactionHash()) > 0)
@@ -155,11 +165,23 @@ namespace CryptoNote
             return false;
         }
 
+        const Crypto::Hash transactionHash = pendingTx.getTransactionHash();
+
+        if (!transactionHashIndex.insert(std::move(pendingTx)).second)
+        {
+            return false;
+        }
+
+        for (const auto &keyImage : transactionState.spentKeyImages)
+        {
+            m_keyImageToTransaction[keyImage] = transactionHash;
+        }
+
         mergeStates(poolState, transactionState);
 
-        logger(Logging::DEBUGGING) << "pushed transaction " << pendingTx.getTransactionHash() << " to pool";
+        logger(Logging::DEBUGGING) << "pushed transaction " << transactionHash << " to pool";
 
-        return transactionHashIndex.insert(std::move(pendingTx)).second;
+        return true;
     }
 
     const std::optional<CachedTransaction> TransactionPool::tryGetTransaction(const Crypto::Hash &hash) const
@@ -197,6 +219,14 @@ namespace CryptoNote
             return false;
         }
 
+        for (const auto &input : it->cachedTransaction.getTransaction().inputs)
+        {
+            if (input.type() == typeid(KeyInput))
+            {
+                m_keyImageToTransaction.erase(boost::get<KeyInput>(input).keyImage);
+            }
+        }
+
         excludeFromState(poolState, it->cachedTransaction);
         transactionHashIndex.erase(it);
 
@@ -323,6 +353,68 @@ namespace CryptoNote
         return transactionHashes;
     }
 
+    std::vector<Crypto::Hash>
+        TransactionPool::getConflictingTransactionHashes(const TransactionValidatorState &state) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::vector<Crypto::Hash> transactionHashes;
+
+        for (const auto &keyImage : state.spentKeyImages)
+        {
+            const auto it = m_keyImageToTransaction.find(keyImage);
+
+            if (it == m_keyImageToTransaction.end())
+            {
+                continue;
+            }
+
+            /* One transaction can spend several of the key images */
+            if (std::find(transactionHashes.begin(), transactionHashes.end(), it->second) == transactionHashes.end())
+            {
+                transactionHashes.push_back(it->second);
+            }
+        }
+
+        return transactionHashes;
+    }
+
+    std::vector<Crypto::Hash> TransactionPool::getTransactionHashesLargerThan(const size_t maxSize) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::vector<Crypto::Hash> transactionHashes;
+
+        for (auto it = transactionSizeIndex.upper_bound(maxSize); it != transactionSizeIndex.end(); ++it)
+        {
+            transactionHashes.push_back(it->getTransactionHash());
+        }
+
+        return transactionHashes;
+    }
+
+    std::vector<Crypto::Hash>
+        TransactionPool::getTransactionHashesOutsideMixinRange(const uint64_t minMixin, const uint64_t maxMixin) const
+    {
+        std::scoped_lock lock(m_transactionsMutex);
+
+        std::vector<Crypto::Hash> transactionHashes;
+
+        /* Mixin too small */
+        for (auto it = mixinIndex.begin(); it != mixinIndex.lower_bound(minMixin); ++it)
+        {
+            transactionHashes.push_back(it->getTransactionHash());
+        }
+
+        /* Mixin too large */
+        for (auto it = mixinIndex.upper_bound(maxMixin); it != mixinIndex.end(); ++it)
+        {
+            transactionHashes.push_back(it->getTransactionHash());
+        }
+
+        return transactionHashes;
+    }
+
     void TransactionPool::flush()
     {
         const auto txns = getTransactionHashes();
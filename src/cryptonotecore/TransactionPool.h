@@ -54,6 +54,14 @@ namespace CryptoNote
 
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const override;
 
+        virtual std::vector<Crypto::Hash>
+            getConflictingTransactionHashes(const TransactionValidatorState &state) const override;
+
+        virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(const size_t maxSize) const override;
+
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesOutsideMixinRange(const uint64_t minMixin, const uint64_t maxMixin) const override;
+
         virtual void flush() override;
 
       private:
@@ -67,7 +75,11 @@ namespace CryptoNote
 
             boost::optional<Crypto::Hash> paymentId;
 
+            uint64_t mixin;
+
             const Crypto::Hash &getTransactionHash() const;
+
+            size_t getTransactionSize() const;
         };
 
         struct TransactionPriorityComparator
@@ -85,6 +97,12 @@ namespace CryptoNote
         struct PaymentIdTag
         {
         };
+        struct TransactionSizeTag
+        {
+        };
+        struct MixinTag
+        {
+        };
 
         typedef boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<TransactionCostTag>,
@@ -111,9 +129,27 @@ namespace CryptoNote
             PaymentIdHasher>
             PaymentIdIndex;
 
+        typedef boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<TransactionSizeTag>,
+            boost::multi_index::const_mem_fun<
+                PendingTransactionInfo,
+                size_t,
+                &PendingTransactionInfo::getTransactionSize>>
+            TransactionSizeIndex;
+
+        typedef boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<MixinTag>,
+            BOOST_MULTI_INDEX_MEMBER(PendingTransactionInfo, uint64_t, mixin)>
+            MixinIndex;
+
         typedef boost::multi_index_container<
             PendingTransactionInfo,
-            boost::multi_index::indexed_by<TransactionHashIndex, TransactionCostIndex, PaymentIdIndex>>
+            boost::multi_index::indexed_by<
+                TransactionHashIndex,
+                TransactionCostIndex,
+                PaymentIdIndex,
+                TransactionSizeIndex,
+                MixinIndex>>
             TransactionsContainer;
 
         TransactionsContainer transactions;
@@ -124,6 +160,14 @@ namespace CryptoNote
 
         TransactionsContainer::index<PaymentIdTag>::type &paymentIdIndex;
 
+        TransactionsContainer::index<TransactionSizeTag>::type &transactionSizeIndex;
+
+        TransactionsContainer::index<MixinTag>::type &mixinIndex;
+
+        /* Which pool transaction spends each key image, so we can find the
+           transactions a new block conflicts with without scanning the pool */
+        std::unordered_map<Crypto::KeyImage, Crypto::Hash> m_keyImageToTransaction;
+
         mutable std::mutex m_transactionsMutex;
 
         Logging::LoggerRef logger;
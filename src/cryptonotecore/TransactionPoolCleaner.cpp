@@ -99,6 +99,24 @@ namespace CryptoNote
         return transactionPool->getTransactionHashesByPaymentId(paymentId);
     }
 
+    std::vector<Crypto::Hash>
+        TransactionPoolCleanWrapper::getConflictingTransactionHashes(const TransactionValidatorState &state) const
+    {
+        return transactionPool->getConflictingTransactionHashes(state);
+    }
+
+    std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesLargerThan(const size_t maxSize) const
+    {
+        return transactionPool->getTransactionHashesLargerThan(maxSize);
+    }
+
+    std::vector<Crypto::Hash> TransactionPoolCleanWrapper::getTransactionHashesOutsideMixinRange(
+        const uint64_t minMixin,
+        const uint64_t maxMixin) const
+    {
+        return transactionPool->getTransactionHashesOutsideMixinRange(minMixin, maxMixin);
+    }
+
     void TransactionPoolCleanWrapper::flush()
     {
         return transactionPool->flush();
@@ -64,6 +64,14 @@ namespace CryptoNote
 
         virtual std::vector<Crypto::Hash> getTransactionHashesByPaymentId(const Crypto::Hash &paymentId) const override;
 
+        virtual std::vector<Crypto::Hash>
+            getConflictingTransactionHashes(const TransactionValidatorState &state) const override;
+
+        virtual std::vector<Crypto::Hash> getTransactionHashesLargerThan(const size_t maxSize) const override;
+
+        virtual std::vector<Crypto::Hash>
+            getTransactionHashesOutsideMixinRange(const uint64_t minMixin, const uint64_t maxMixin) const override;
+
         virtual void flush() override;
 
         virtual std::vector<Crypto::Hash> clean(const uint32_t height) override;
@@ -207,4 +207,17 @@ namespace CryptoNote
         const static int ID = BC_COMMANDS_POOL_BASE + 10;
         typedef NOTIFY_MISSING_TXS_request request;
     };
+
+    /* Announces new transactions by hash. The peer asks for any it doesn't
+       have with NOTIFY_MISSING_TXS, with a null block hash. */
+    struct NOTIFY_NEW_TRANSACTION_HASHES_request
+    {
+        std::vector<Crypto::Hash> txs;
+    };
+
+    struct NOTIFY_NEW_TRANSACTION_HASHES
+    {
+        const static int ID = BC_COMMANDS_POOL_BASE + 11;
+        typedef NOTIFY_NEW_TRANSACTION_HASHES_request request;
+    };
 } // namespace CryptoNote
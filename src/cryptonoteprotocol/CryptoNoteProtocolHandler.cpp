@@ -14,7 +14,9 @@
 
 #include <boost/scope_exit.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <cstring>
 #include <config/Ascii.h>
+#include <config/Constants.h>
 #include <config/CryptoNoteConfig.h>
 #include <config/WalletConfig.h>
 #include <future>
@@ -60,6 +62,16 @@ namespace CryptoNote
             return legacy;
         }
 
+        /* current_blockchain_height is the last field serialized in a
+           NOTIFY_RESPONSE_GET_OBJECTS response, stored as a raw uint32_t, so
+           it occupies the final 4 bytes of the encoded payload. This lets us
+           reuse an encoded response without serializing it again. */
+        void patchResponseHeight(BinaryArray &response, const uint32_t height)
+        {
+            assert(response.size() >= sizeof(height));
+            std::memcpy(response.data() + response.size() - sizeof(height), &height, sizeof(height));
+        }
+
         std::vector<RawBlock> convertRawBlocksLegacyToRawBlocks(const std::vector<RawBlockLegacy> &legacy)
         {
             std::vector<RawBlock> rawBlocks;
@@ -175,6 +187,11 @@ namespace CryptoNote
         serializeAsBinary(request.missing_txs, "missing_txs", s);
     }
 
+    static inline void serialize(NOTIFY_NEW_TRANSACTION_HASHES_request &request, ISerializer &s)
+    {
+        serializeAsBinary(request.txs, "txs", s);
+    }
+
     CryptoNoteProtocolHandler::CryptoNoteProtocolHandler(
         const Currency &currency,
         System::Dispatcher &dispatcher,
@@ -466,6 +483,7 @@ namespace CryptoNote
             HANDLE_NOTIFY(NOTIFY_REQUEST_TX_POOL, handleRequestTxPool)
             HANDLE_NOTIFY(NOTIFY_NEW_LITE_BLOCK, handle_notify_new_lite_block)
             HANDLE_NOTIFY(NOTIFY_MISSING_TXS, handle_notify_missing_txs)
+            HANDLE_NOTIFY(NOTIFY_NEW_TRANSACTION_HASHES, handle_notify_new_transaction_hashes)
 
             default:
                 handled = false;
@@ -546,7 +564,16 @@ namespace CryptoNote
             return 1;
         }
 
-        if (context.m_pending_lite_block.has_value())
+        /* The peer may also be sending us pool transactions we asked for, or
+           relaying new ones, so check these are the ones the block needs */
+        const bool isLiteBlockResponse = context.m_pending_lite_block.has_value()
+                                         && std::all_of(arg.txs.begin(), arg.txs.end(), [&context](const auto &tx) {
+                                                return context.m_pending_lite_block->missed_transactions.count(
+                                                           getBinaryArrayHash(tx))
+                                                       != 0;
+                                            });
+
+        if (isLiteBlockResponse)
         {
             logger(Logging::TRACE)
                 << context
@@ -556,6 +583,13 @@ namespace CryptoNote
         else
         {
             const auto it = std::remove_if(arg.txs.begin(), arg.txs.end(), [this, &context](const auto &tx) {
+                const auto hash = getBinaryArrayHash(tx);
+
+                /* No need to send it back to them */
+                context.m_known_transactions.insert(hash);
+
+                this->m_requestedTransactions.erase(hash);
+
                 const auto [success, error] = this->m_core.addTransactionToPool(tx);
 
                 if (!success)
@@ -573,8 +607,7 @@ namespace CryptoNote
 
             if (arg.txs.size() > 0)
             {
-                // TODO: add announce usage here
-                relay_post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, arg, &context.m_connection_id);
+                queueTransactionRelay(std::move(arg.txs));
             }
         }
 
@@ -594,21 +627,58 @@ namespace CryptoNote
         //}
 
         rsp.current_blockchain_height = m_core.getTopBlockIndex() + 1;
-        std::vector<RawBlock> rawBlocks;
-        m_core.getBlocks(arg.blocks, rawBlocks, rsp.missed_ids);
+
         if (!arg.txs.empty())
         {
             logger(Logging::WARNING, Logging::BRIGHT_YELLOW)
                 << context << "NOTIFY_RESPONSE_GET_OBJECTS: request.txs.empty() != true";
         }
 
+        /* The response for a given list of block hashes is always the same,
+           apart from the current height, so we can serve it straight from
+           the cache */
+        const auto cache = m_core.getBlockResponseCache();
+
+        const BlockResponseKey key {
+            BlockResponseEncoding::P2pGetObjects,
+            Crypto::cn_fast_hash(arg.blocks.data(), arg.blocks.size() * sizeof(Crypto::Hash)),
+            Constants::NULL_HASH,
+            static_cast<uint32_t>(arg.blocks.size())
+        };
+
+        if (const auto cached = cache->get(key))
+        {
+            BinaryArray response = *cached;
+            patchResponseHeight(response, rsp.current_blockchain_height);
+
+            logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_GET_OBJECTS: blocks.size()=" << arg.blocks.size()
+                                   << " (cached), rsp.m_current_blockchain_height=" << rsp.current_blockchain_height;
+
+            m_p2p->invoke_notify_to_peer(NOTIFY_RESPONSE_GET_OBJECTS::ID, response, context);
+            return 1;
+        }
+
+        std::vector<RawBlock> rawBlocks;
+        m_core.getBlocks(arg.blocks, rawBlocks, rsp.missed_ids);
+
         rsp.blocks = convertRawBlocksToRawBlocksLegacy(rawBlocks);
 
         logger(Logging::TRACE) << context << "-->>NOTIFY_RESPONSE_GET_OBJECTS: blocks.size()=" << rsp.blocks.size()
                                << ", txs.size()=" << rsp.txs.size()
                                << ", rsp.m_current_blockchain_height=" << rsp.current_blockchain_height
                                << ", missed_ids.size()=" << rsp.missed_ids.size();
-        post_notify<NOTIFY_RESPONSE_GET_OBJECTS>(*m_p2p, rsp, context);
+
+        BinaryArray response = LevinProtocol::encode(rsp);
+
+        m_p2p->invoke_notify_to_peer(NOTIFY_RESPONSE_GET_OBJECTS::ID, response, context);
+
+        /* Don't cache partial responses - we may receive the missing blocks
+           later */
+        if (rsp.missed_ids.empty() && !rsp.blocks.empty())
+        {
+            cache->insert(key, std::move(response));
+        }
+
         return 1;
     }
 
@@ -1134,9 +1204,44 @@ namespace CryptoNote
 
         NOTIFY_NEW_TRANSACTIONS::request req;
 
+        /* Without a block hash, the peer is asking for transactions we
+           announced. We only announce pool transactions, and never more than
+           this many at once, so that's all we'll send. Some may have been
+           mined or dropped from the pool since, so send what we still have. */
+        if (arg.blockHash == Constants::NULL_HASH)
+        {
+            if (arg.missing_txs.size() > P2P_TRANSACTION_ANNOUNCE_MAX_COUNT)
+            {
+                logger(Logging::DEBUGGING) << context << "NOTIFY_MISSING_TXS asked for " << arg.missing_txs.size()
+                                           << " announced transactions, Dropping Connection";
+                context.m_state = CryptoNoteConnectionContext::state_shutdown;
+                return 1;
+            }
+
+            for (const auto &hash : arg.missing_txs)
+            {
+                context.m_known_transactions.insert(hash);
+
+                auto [found, transaction] = m_core.getPoolTransaction(hash);
+
+                if (found)
+                {
+                    req.txs.push_back(std::move(transaction));
+                }
+            }
+
+            if (!req.txs.empty())
+            {
+                post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, req, context);
+            }
+
+            return 1;
+        }
+
         std::vector<BinaryArray> txs;
         std::vector<Crypto::Hash> missedHashes;
         m_core.getTransactions(arg.missing_txs, txs, missedHashes);
+
         if (!missedHashes.empty())
         {
             logger(Logging::DEBUGGING) << "Failed to Handle NOTIFY_MISSING_TXS, Unable to retrieve requested "
@@ -1210,10 +1315,162 @@ namespace CryptoNote
         }
     }
 
+    int CryptoNoteProtocolHandler::handle_notify_new_transaction_hashes(
+        int command,
+        NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+        CryptoNoteConnectionContext &context)
+    {
+        logger(Logging::TRACE) << context << "NOTIFY_NEW_TRANSACTION_HASHES: txs.size() = " << arg.txs.size();
+
+        if (context.m_state != CryptoNoteConnectionContext::state_normal)
+        {
+            return 1;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        NOTIFY_MISSING_TXS::request req;
+        req.current_blockchain_height = get_current_blockchain_height();
+        req.blockHash = Constants::NULL_HASH;
+
+        for (const auto &hash : arg.txs)
+        {
+            context.m_known_transactions.insert(hash);
+
+            if (req.missing_txs.size() >= P2P_TRANSACTION_ANNOUNCE_MAX_COUNT || m_core.hasTransaction(hash))
+            {
+                continue;
+            }
+
+            /* Already waiting on another peer to send it */
+            if (const auto it = m_requestedTransactions.find(hash); it != m_requestedTransactions.end()
+                && now - it->second < std::chrono::seconds(P2P_TRANSACTION_REQUEST_TIMEOUT))
+            {
+                continue;
+            }
+
+            /* Bound the memory a peer announcing made up hashes can use */
+            if (m_requestedTransactions.size() < P2P_TRANSACTION_REQUESTED_MAX_COUNT)
+            {
+                m_requestedTransactions[hash] = now;
+            }
+
+            req.missing_txs.push_back(hash);
+        }
+
+        if (!req.missing_txs.empty())
+        {
+            logger(Logging::TRACE) << context << "-->>NOTIFY_MISSING_TXS: missing_txs.size() = "
+                                   << req.missing_txs.size();
+
+            post_notify<NOTIFY_MISSING_TXS>(*m_p2p, req, context);
+        }
+
+        return 1;
+    }
+
     void CryptoNoteProtocolHandler::relayTransactions(const std::vector<BinaryArray> &transactions)
     {
-        auto buf = LevinProtocol::encode(NOTIFY_NEW_TRANSACTIONS::request {transactions});
-        m_p2p->externalRelayNotifyToAll(NOTIFY_NEW_TRANSACTIONS::ID, buf, nullptr);
+        queueTransactionRelay(transactions);
+    }
+
+    void CryptoNoteProtocolHandler::queueTransactionRelay(std::vector<BinaryArray> transactions)
+    {
+        std::scoped_lock<std::mutex> lock(m_relayMutex);
+
+        m_pendingRelays.insert(
+            m_pendingRelays.end(),
+            std::make_move_iterator(transactions.begin()),
+            std::make_move_iterator(transactions.end()));
+    }
+
+    void CryptoNoteProtocolHandler::flushTransactionRelays()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        /* Long enough ago that we'll ask another peer if it's announced again */
+        for (auto it = m_requestedTransactions.begin(); it != m_requestedTransactions.end();)
+        {
+            if (now - it->second >= std::chrono::seconds(P2P_TRANSACTION_REQUEST_TIMEOUT))
+            {
+                it = m_requestedTransactions.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        std::vector<BinaryArray> transactions;
+
+        {
+            std::scoped_lock<std::mutex> lock(m_relayMutex);
+            transactions.swap(m_pendingRelays);
+        }
+
+        if (transactions.empty())
+        {
+            return;
+        }
+
+        std::vector<Crypto::Hash> hashes;
+        hashes.reserve(transactions.size());
+
+        for (const auto &transaction : transactions)
+        {
+            hashes.push_back(getBinaryArrayHash(transaction));
+        }
+
+        m_p2p->for_each_connection([&](CryptoNoteConnectionContext &context, uint64_t peerId) {
+            if (!peerId
+                || (context.m_state != CryptoNoteConnectionContext::state_normal
+                    && context.m_state != CryptoNoteConnectionContext::state_synchronizing))
+            {
+                return;
+            }
+
+            const bool supportsAnnounce = context.version >= P2P_TRANSACTION_ANNOUNCE_VERSION;
+
+            NOTIFY_NEW_TRANSACTION_HASHES::request announcement;
+            NOTIFY_NEW_TRANSACTIONS::request notification;
+
+            for (size_t i = 0; i < transactions.size(); i++)
+            {
+                if (context.m_known_transactions.contains(hashes[i]))
+                {
+                    continue;
+                }
+
+                context.m_known_transactions.insert(hashes[i]);
+
+                /* Peers that support it fetch the transactions they don't
+                   have, the rest get every transaction in full */
+                if (supportsAnnounce)
+                {
+                    announcement.txs.push_back(hashes[i]);
+                }
+                else
+                {
+                    notification.txs.push_back(transactions[i]);
+                }
+            }
+
+            /* Peers only fetch so many transactions from each announcement */
+            for (size_t start = 0; start < announcement.txs.size(); start += P2P_TRANSACTION_ANNOUNCE_MAX_COUNT)
+            {
+                const size_t end = std::min(start + P2P_TRANSACTION_ANNOUNCE_MAX_COUNT, announcement.txs.size());
+
+                NOTIFY_NEW_TRANSACTION_HASHES::request chunk;
+                chunk.txs.assign(announcement.txs.begin() + start, announcement.txs.begin() + end);
+
+                post_notify<NOTIFY_NEW_TRANSACTION_HASHES>(*m_p2p, chunk, context);
+            }
+
+            if (!notification.txs.empty())
+            {
+                post_notify<NOTIFY_NEW_TRANSACTIONS>(*m_p2p, notification, context);
+            }
+        });
     }
 
     void CryptoNoteProtocolHandler::requestMissingPoolTransactions(const CryptoNoteConnectionContext &context)
@@ -16,8 +16,11 @@
 #include "p2p/P2pProtocolDefinitions.h"
 
 #include <atomic>
+#include <chrono>
 #include <common/ObserverManager.h>
 #include <logging/LoggerRef.h>
+#include <mutex>
+#include <unordered_map>
 
 namespace System
 {
@@ -86,6 +89,12 @@ namespace CryptoNote
 
         void requestMissingPoolTransactions(const CryptoNoteConnectionContext &context);
 
+        /* Sends the transactions queued for relay since the last call to each
+           peer that doesn't already have them. Called once a second by the
+           node server, so each peer gets one message per interval rather than
+           one per transaction. */
+        void flushTransactionRelays();
+
       private:
         //----------------- commands handlers ----------------------------------------------
         int handle_notify_new_block(int command, NOTIFY_NEW_BLOCK::request &arg, CryptoNoteConnectionContext &context);
@@ -127,6 +136,11 @@ namespace CryptoNote
             NOTIFY_MISSING_TXS::request &arg,
             CryptoNoteConnectionContext &context);
 
+        int handle_notify_new_transaction_hashes(
+            int command,
+            NOTIFY_NEW_TRANSACTION_HASHES::request &arg,
+            CryptoNoteConnectionContext &context);
+
         //----------------- i_cryptonote_protocol ----------------------------------
         virtual void relayBlock(NOTIFY_NEW_BLOCK::request &arg) override;
 
@@ -156,6 +170,8 @@ namespace CryptoNote
             CryptoNoteConnectionContext &context,
             std::vector<BinaryArray> missingTxs);
 
+        void queueTransactionRelay(std::vector<BinaryArray> transactions);
+
       private:
         System::Dispatcher &m_dispatcher;
 
@@ -182,5 +198,15 @@ namespace CryptoNote
         std::atomic<size_t> m_peersCount;
 
         Tools::ObserverManager<ICryptoNoteProtocolObserver> m_observerManager;
+
+        /* Transactions waiting to be relayed. Queued from the RPC threads as
+           well as the dispatcher. */
+        std::mutex m_relayMutex;
+
+        std::vector<BinaryArray> m_pendingRelays;
+
+        /* Transactions we've asked a peer for, and when. Only used from the
+           dispatcher. */
+        std::unordered_map<Crypto::Hash, std::chrono::steady_clock::time_point> m_requestedTransactions;
     };
 } // namespace CryptoNote
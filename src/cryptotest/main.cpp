@@ -6,12 +6,16 @@
 #include "CryptoTypes.h"
 #include "common/StringTools.h"
 #include "crypto/crypto.h"
+#include "unittests/Check.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
 #include <chrono>
 #include <config/CliHeader.h>
 #include <cxxopts.hpp>
 #include <iostream>
+#include <thread>
 
 #define PERFORMANCE_ITERATIONS 1000
 #define PERFORMANCE_ITERATIONS_LONG_MULTIPLIER 10
@@ -114,6 +118,43 @@ const std::string CN_SOFT_SHELL_V2[] = {"b2172ec9466e1aee70ec8572a14c233ee354582
                                         "b2623a2b041dc5ae3132b964b75e193558c7095e725d882a3946aae172179cf1",
                                         "b2172ec9466e1aee70ec8572a14c233ee354582bcb93f869d429744de5726a26"};
 
+/* Ring signatures generated with the original implementation. The two rings
+   share three members, so the batch check shares work between them. */
+const std::string RING_SIGNATURE_PREFIX_HASH = "b542df5b6e7f5f05275c98e7345884e2ac726aeeb07e03e44e0389eb86cd05f0";
+
+const std::string RING_SIGNATURE_KEY_IMAGES[] = {"a2f32414815e9fd289807c79e31ccc5fb5a2fa1c5561fd7a177cca6bef8c4578",
+                                                 "d7f88f3c80f2f7dbbc8072a654b34bc5016e4c1eb7cacfa5882c10a874bbfcba"};
+
+const std::vector<std::string> RING_SIGNATURE_PUBLIC_KEYS[] = {
+    {"823f02b52d5e1eba37cad758a925d2c55446273ed6355aa370f59297eeacab94",
+     "6e83e3f81b0220158ccd18648771b5e476a495602fd02e9f7ae5f9f66b9f9d59",
+     "64bd384c8012a5fdef164f78fa3f577cd31310913d6cb27eb08952656be5642e",
+     "4248dc21463c74f858a7f815a203aa5a023d61b483bd1ac78ce7268989453b4d"},
+    {"823f02b52d5e1eba37cad758a925d2c55446273ed6355aa370f59297eeacab94",
+     "64bd384c8012a5fdef164f78fa3f577cd31310913d6cb27eb08952656be5642e",
+     "4248dc21463c74f858a7f815a203aa5a023d61b483bd1ac78ce7268989453b4d",
+     "942c98059a9204284f87b75d92dad61be6240c28b342c695412739d271c22986"}};
+
+const std::vector<std::string> RING_SIGNATURE_SIGNATURES[] = {
+    {"571f96f144ac83645e68953d5bfb808870466fbf5ba92037bae47e3c8469670146109e00ecab1500f163caed18072dd2368ea357e5ee"
+     "6451a66a2cfd9b3bc907",
+     "a463a5382ca857486562d4a25d5968761d24e7729baa0d2539b8e699efe8ec05ebbff2a0ea03dabe7f3e5a99267200eeebb9aed105c7"
+     "843ed56b547728fb360b",
+     "2a91a184e8e3948ac395128589cce8578ac95aa746009da6227f7e2b573d3a04e340a2ed2d8fed6f930788ce30a1fefe70b22ac9006c"
+     "f615d0526c8a6aa5000b",
+     "a46831a2d0168c218f99055c8742be393d60d1466fedc20fee77c6eb197a2a0336458e781e266a0fecd47c7280314455b31429ac90b1"
+     "53918f6f041773dd3909"},
+    {"ab52e471608a94e1630f8fa42a4ee099d46d5b74e8868d5f38dd2b525a2d0c06dba975e22c7fcd65bd3aa83e8f09ae97fb7b947ee9a4"
+     "17e3dae81a5f44d1a20c",
+     "e305a33529b012a55a4ebf4b1bd67944e22332865a38b6913348f9f3020b2f048b5ce4540ddfee7b84ff00e4a331be1d496de5c771e0"
+     "d0e9d4e06dc95802e90e",
+     "358d582bd8d33cea6aed702f4fc1b97b2b7708c7b38a2101e89172ecd4398b05520061156c38c096ac55d9ef0e7da2a29f0a75024eb3"
+     "0572f64b0c955853f508",
+     "345bd7d9f1910ce05b6112470cede201a1ffe8221728fb494cbd3b95c271870ce73a7f073c9768e8dabcf476d957ecd71cd57dc34bd4"
+     "499630cb9378d46a6a0a"}};
+
+/* The bytes malloc currently has handed out, so the memory benchmarks can
+   measure the containers they fill. Only glibc can tell us this. */
 static inline bool CompareHashes(const Hash leftHash, const std::string right)
 {
     Hash rightHash = Hash();
@@ -270,6 +311,259 @@ void benchmarkGenerateKeyDerivation()
     std::cout << "Time to perform generateKeyDerivation: " << timePerDerivation / 1000.0 << " ms" << std::endl;
 }
 
+template<typename T> std::vector<T> podsFromHex(const std::vector<std::string> &hexStrings)
+{
+    std::vector<T> result(hexStrings.size());
+
+    for (size_t i = 0; i < hexStrings.size(); i++)
+    {
+        Common::podFromHex(hexStrings[i], result[i]);
+    }
+
+    return result;
+}
+
+void testRingSignature(const std::string name, const bool valid, const bool expected)
+{
+    Tests::check(
+        name,
+        valid == expected,
+        std::string("Ring signature check gave the wrong result!\nExpected: ") + (expected ? "valid" : "invalid"));
+}
+
+void testRingSignatures()
+{
+    Crypto::Hash prefixHash;
+    Common::podFromHex(RING_SIGNATURE_PREFIX_HASH, prefixHash);
+
+    std::vector<Crypto::KeyImage> keyImages(2);
+    std::vector<std::vector<Crypto::PublicKey>> publicKeys;
+    std::vector<std::vector<Crypto::Signature>> signatures;
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        Common::podFromHex(RING_SIGNATURE_KEY_IMAGES[i], keyImages[i]);
+        publicKeys.push_back(podsFromHex<Crypto::PublicKey>(RING_SIGNATURE_PUBLIC_KEYS[i]));
+        signatures.push_back(podsFromHex<Crypto::Signature>(RING_SIGNATURE_SIGNATURES[i]));
+    }
+
+    /* Twice, so the second check uses the cached ring members */
+    for (size_t i = 0; i < 2; i++)
+    {
+        testRingSignature(
+            "checkRingSignature",
+            crypto_ops::checkRingSignature(prefixHash, keyImages[0], publicKeys[0], signatures[0]),
+            true);
+    }
+
+    testRingSignature(
+        "checkRingSignature (wrong key image)",
+        crypto_ops::checkRingSignature(prefixHash, keyImages[1], publicKeys[0], signatures[0]),
+        false);
+
+    auto tamperedSignatures = signatures[0];
+    tamperedSignatures[2].data[0] ^= 1;
+
+    testRingSignature(
+        "checkRingSignature (tampered signature)",
+        crypto_ops::checkRingSignature(prefixHash, keyImages[0], publicKeys[0], tamperedSignatures),
+        false);
+
+    auto tamperedPublicKeys = publicKeys[0];
+    tamperedPublicKeys[1].data[0] ^= 1;
+
+    testRingSignature(
+        "checkRingSignature (tampered public key)",
+        crypto_ops::checkRingSignature(prefixHash, keyImages[0], tamperedPublicKeys, signatures[0]),
+        false);
+
+    testRingSignature(
+        "checkRingSignatures",
+        crypto_ops::checkRingSignatures({{prefixHash, keyImages[0], publicKeys[0], signatures[0]},
+                                         {prefixHash, keyImages[1], publicKeys[1], signatures[1]}}),
+        true);
+
+    testRingSignature(
+        "checkRingSignatures (one tampered)",
+        crypto_ops::checkRingSignatures({{prefixHash, keyImages[0], publicKeys[0], signatures[0]},
+                                         {prefixHash, keyImages[0], publicKeys[0], tamperedSignatures},
+                                         {prefixHash, keyImages[1], publicKeys[1], signatures[1]}}),
+        false);
+}
+
+void benchmarkCheckRingSignatures()
+{
+    /* A block's worth of inputs, drawing decoys from a smaller set of
+       outputs, as recent outputs are picked more often */
+    const size_t ringCount = 500;
+
+    const size_t ringSize = 4;
+
+    const size_t outputCount = 500;
+
+    Crypto::Hash prefixHash;
+    Common::podFromHex(RING_SIGNATURE_PREFIX_HASH, prefixHash);
+
+    std::vector<Crypto::PublicKey> outputKeys(outputCount);
+    std::vector<Crypto::SecretKey> outputSecretKeys(outputCount);
+
+    for (size_t i = 0; i < outputCount; i++)
+    {
+        Crypto::generate_keys(outputKeys[i], outputSecretKeys[i]);
+    }
+
+    std::vector<std::vector<Crypto::PublicKey>> rings(ringCount);
+    std::vector<Crypto::KeyImage> keyImages(ringCount);
+    std::vector<std::vector<Crypto::Signature>> signatures(ringCount);
+
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        for (size_t j = 0; j < ringSize; j++)
+        {
+            rings[i].push_back(outputKeys[(i * 7 + j * 131) % outputCount]);
+        }
+
+        const size_t realOutput = (i * 7) % outputCount;
+
+        Crypto::generate_key_image(outputKeys[realOutput], outputSecretKeys[realOutput], keyImages[i]);
+
+        bool success;
+
+        std::tie(success, signatures[i]) = crypto_ops::generateRingSignatures(
+            prefixHash, keyImages[i], rings[i], outputSecretKeys[realOutput], 0);
+    }
+
+    std::vector<Crypto::RingSignature> batch;
+
+    for (size_t i = 0; i < ringCount; i++)
+    {
+        batch.push_back({prefixHash, keyImages[i], rings[i], signatures[i]});
+    }
+
+    /* The ring member cache is per thread, so time each on a fresh thread,
+       or the second would find every ring member already cached */
+    const auto timeOnNewThread = [](const auto &check) {
+        std::chrono::high_resolution_clock::duration elapsedTime;
+
+        std::thread([&] {
+            const auto startTimer = std::chrono::high_resolution_clock::now();
+            check();
+            elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+        }).join();
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count();
+    };
+
+    const auto oneAtATime = timeOnNewThread([&] {
+        for (size_t i = 0; i < ringCount; i++)
+        {
+            crypto_ops::checkRingSignature(prefixHash, keyImages[i], rings[i], signatures[i]);
+        }
+    });
+
+    std::cout << "Time to check " << ringCount << " ring signatures: " << oneAtATime << " ms" << std::endl;
+
+    const auto atOnce = timeOnNewThread([&] { crypto_ops::checkRingSignatures(batch); });
+
+    std::cout << "Time to check " << ringCount << " ring signatures at once: " << atOnce << " ms" << std::endl;
+}
+
+void benchmarkGenerateRingSignatures()
+{
+    /* A large fusion or payout transaction */
+    const size_t inputCount = 90;
+
+    const size_t ringSize = 4;
+
+    Crypto::Hash prefixHash;
+    Common::podFromHex("b542df5b6e7f5f05275c98e7345884e2ac726aeeb07e03e44e0389eb86cd05f0", prefixHash);
+
+    std::vector<std::vector<Crypto::PublicKey>> rings(inputCount);
+    std::vector<Crypto::SecretKey> secretKeys(inputCount);
+    std::vector<Crypto::KeyImage> keyImages(inputCount);
+
+    for (size_t i = 0; i < inputCount; i++)
+    {
+        for (size_t j = 0; j < ringSize; j++)
+        {
+            Crypto::PublicKey publicKey;
+            Crypto::SecretKey secretKey;
+
+            Crypto::generate_keys(publicKey, secretKey);
+
+            rings[i].push_back(publicKey);
+
+            /* Our real output is always the first in this test */
+            if (j == 0)
+            {
+                secretKeys[i] = secretKey;
+                Crypto::generate_key_image(publicKey, secretKey, keyImages[i]);
+            }
+        }
+    }
+
+    /* Signs and verifies each input, as the wallet does */
+    const auto signInput = [&](const size_t i) {
+        const auto [success, signatures] =
+            crypto_ops::generateRingSignatures(prefixHash, keyImages[i], rings[i], secretKeys[i], 0);
+
+        if (!success || !crypto_ops::checkRingSignature(prefixHash, keyImages[i], rings[i], signatures))
+        {
+            std::cout << "Ring signature generation failed for input " << i << std::endl;
+        }
+    };
+
+    const uint64_t loopIterations = 10;
+
+    auto startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t iteration = 0; iteration < loopIterations; iteration++)
+    {
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            signInput(i);
+        }
+    }
+
+    auto elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Time to sign a " << inputCount << " input transaction: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() / loopIterations
+              << " ms" << std::endl;
+
+    const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    startTimer = std::chrono::high_resolution_clock::now();
+
+    for (uint64_t iteration = 0; iteration < loopIterations; iteration++)
+    {
+        std::atomic<size_t> nextInput = 0;
+
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(std::thread([&] {
+                for (size_t input = nextInput++; input < inputCount; input = nextInput++)
+                {
+                    signInput(input);
+                }
+            }));
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    elapsedTime = std::chrono::high_resolution_clock::now() - startTimer;
+
+    std::cout << "Time to sign a " << inputCount << " input transaction with " << threadCount << " threads: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime).count() / loopIterations
+              << " ms" << std::endl;
+}
+
 int main(int argc, char **argv)
 {
     bool o_help, o_version, o_benchmark;
@@ -384,12 +678,20 @@ int main(int argc, char **argv)
             TEST_HASH_FUNCTION_WITH_HEIGHT(cn_soft_shell_slow_hash_v2, CN_SOFT_SHELL_V2[height / 512], height);
         }
 
+        std::cout << std::endl;
+
+        testRingSignatures();
+
+        std::cout << std::endl;
+
         if (o_benchmark)
         {
             std::cout << "\nPerformance Tests: Please wait, this may take a while depending on your system...\n\n";
 
             benchmarkUnderivePublicKey();
             benchmarkGenerateKeyDerivation();
+            benchmarkGenerateRingSignatures();
+            benchmarkCheckRingSignatures();
 
             BENCHMARK(cn_slow_hash_v0, o_iterations);
             BENCHMARK(cn_slow_hash_v1, o_iterations);
@@ -419,5 +721,7 @@ int main(int argc, char **argv)
     catch (std::exception &e)
     {
         std::cout << "Something went terribly wrong...\n" << e.what() << "\n\n";
+
+        return 1;
     }
 }
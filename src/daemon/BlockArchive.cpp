@@ -0,0 +1,466 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "BlockArchive.h"
+
+#include <array>
+#include <common/CryptoNoteTools.h>
+#include <common/MemoryInputStream.h>
+#include <common/VectorOutputStream.h>
+#include <crypto/hash.h>
+#include <cryptonotecore/CachedBlock.h>
+#include <cryptonotecore/Core.h>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <logging/LoggerRef.h>
+#include <serialization/BinaryInputStreamSerializer.h>
+#include <serialization/BinaryOutputStreamSerializer.h>
+#include <utilities/ThreadPool.h>
+
+#if defined(ENABLE_ZSTD_COMPRESSION)
+#include <lib/zstd.h>
+#endif
+
+namespace BlockArchive
+{
+    namespace
+    {
+        const std::array<char, 8> FILE_MAGIC = {'B', 'L', 'K', 'A', 'R', 'C', 'H', 'V'};
+
+        const uint32_t FILE_VERSION = 1;
+
+        /* How many blocks are checksummed and compressed together */
+        const uint32_t BLOCKS_PER_CHUNK = 1000;
+
+        /* How many chunks to read ahead of the one being added, per thread */
+        const size_t PREFETCH_CHUNKS_PER_THREAD = 2;
+
+        /* Progress is logged every this many chunks */
+        const uint32_t LOG_INTERVAL_CHUNKS = 10;
+
+        /* Stops a corrupt chunk header making us allocate silly amounts of
+           memory */
+        const uint64_t MAX_CHUNK_SIZE = 1024 * 1024 * 1024;
+
+#if defined(ENABLE_ZSTD_COMPRESSION)
+        const int ZSTD_COMPRESSION_LEVEL = 3;
+#endif
+
+        enum Compression : uint8_t
+        {
+            NONE = 0,
+            ZSTD = 1
+        };
+
+#pragma pack(push, 1)
+        struct FileHeader
+        {
+            std::array<char, 8> magic;
+
+            uint32_t version;
+
+            /* So we don't try and import blocks from another network */
+            Crypto::Hash genesisBlockHash;
+        };
+
+        struct ChunkHeader
+        {
+            uint32_t startIndex;
+
+            uint32_t blockCount;
+
+            uint8_t compression;
+
+            /* Size of the chunk in the file */
+            uint64_t storedSize;
+
+            /* Size of the chunk once decompressed */
+            uint64_t rawSize;
+
+            /* Hash of the chunk as stored in the file */
+            Crypto::Hash checksum;
+        };
+#pragma pack(pop)
+
+        struct PreparedChunk
+        {
+            ChunkHeader header;
+
+            std::vector<CryptoNote::RawBlock> rawBlocks;
+
+            /* The cached blocks reference these, so this must not be resized
+               once they are created */
+            std::vector<CryptoNote::BlockTemplate> blockTemplates;
+
+            std::vector<CryptoNote::CachedBlock> cachedBlocks;
+
+            /* Set if the chunk could not be read */
+            std::string error;
+        };
+
+        template<typename T> void writePod(std::ofstream &file, const T &value)
+        {
+            file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        std::vector<uint8_t> compressChunk(const std::vector<uint8_t> &raw, ChunkHeader &header)
+        {
+#if defined(ENABLE_ZSTD_COMPRESSION)
+            std::vector<uint8_t> compressed(ZSTD_compressBound(raw.size()));
+
+            const size_t size =
+                ZSTD_compress(compressed.data(), compressed.size(), raw.data(), raw.size(), ZSTD_COMPRESSION_LEVEL);
+
+            if (ZSTD_isError(size))
+            {
+                throw std::runtime_error(std::string("Failed to compress blocks: ") + ZSTD_getErrorName(size));
+            }
+
+            compressed.resize(size);
+
+            header.compression = ZSTD;
+
+            return compressed;
+#else
+            header.compression = NONE;
+
+            return raw;
+#endif
+        }
+
+        std::vector<uint8_t> decompressChunk(const std::vector<uint8_t> &stored, const ChunkHeader &header)
+        {
+            if (header.compression == NONE)
+            {
+                if (stored.size() != header.rawSize)
+                {
+                    throw std::runtime_error("Chunk size does not match its header");
+                }
+
+                return stored;
+            }
+
+#if defined(ENABLE_ZSTD_COMPRESSION)
+            if (header.compression == ZSTD)
+            {
+                std::vector<uint8_t> raw(header.rawSize);
+
+                const size_t size = ZSTD_decompress(raw.data(), raw.size(), stored.data(), stored.size());
+
+                if (ZSTD_isError(size) || size != raw.size())
+                {
+                    throw std::runtime_error("Failed to decompress chunk");
+                }
+
+                return raw;
+            }
+#endif
+
+            throw std::runtime_error(
+                "Chunk uses an unsupported compression type. This daemon may have been built without zstd.");
+        }
+
+        /* Runs on the thread pool, so reports errors in the result rather
+           than throwing */
+        PreparedChunk prepareChunk(
+            const ChunkHeader header,
+            const std::vector<uint8_t> &stored,
+            const CryptoNote::Checkpoints &checkpoints)
+        {
+            PreparedChunk chunk;
+
+            chunk.header = header;
+
+            try
+            {
+                if (Crypto::cn_fast_hash(stored.data(), stored.size()) != header.checksum)
+                {
+                    throw std::runtime_error("Checksum mismatch");
+                }
+
+                const std::vector<uint8_t> raw = decompressChunk(stored, header);
+
+                Common::MemoryInputStream stream(raw.data(), raw.size());
+                CryptoNote::BinaryInputStreamSerializer serializer(stream);
+
+                chunk.rawBlocks.resize(header.blockCount);
+                chunk.blockTemplates.resize(header.blockCount);
+                chunk.cachedBlocks.reserve(header.blockCount);
+
+                for (uint32_t i = 0; i < header.blockCount; i++)
+                {
+                    serialize(chunk.rawBlocks[i], serializer);
+
+                    if (!fromBinaryArray(chunk.blockTemplates[i], chunk.rawBlocks[i].block))
+                    {
+                        throw std::runtime_error(
+                            "Failed to deserialize block " + std::to_string(header.startIndex + i));
+                    }
+
+                    const auto &cachedBlock = chunk.cachedBlocks.emplace_back(chunk.blockTemplates[i]);
+
+                    /* These are cached in the block, so the core doesn't
+                       have to compute them again when it validates it. The
+                       proof of work isn't checked for checkpointed blocks. */
+                    cachedBlock.getBlockHash();
+
+                    if (!checkpoints.isInCheckpointZone(cachedBlock.getBlockIndex()))
+                    {
+                        cachedBlock.getBlockLongHash();
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                chunk.error = e.what();
+            }
+
+            return chunk;
+        }
+
+        /* Returns false at the end of the file */
+        bool readChunkHeader(std::ifstream &file, ChunkHeader &header)
+        {
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+            if (file.gcount() == 0 && file.eof())
+            {
+                return false;
+            }
+
+            if (!file)
+            {
+                throw std::runtime_error("Block archive is truncated");
+            }
+
+            return true;
+        }
+    } // namespace
+
+    void exportBlocks(
+        const CryptoNote::Core &core,
+        const std::string &path,
+        const std::shared_ptr<Logging::ILogger> _logger)
+    {
+        Logging::LoggerRef logger(_logger, "BlockArchive");
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open " + path + " for writing");
+        }
+
+        FileHeader fileHeader;
+
+        fileHeader.magic = FILE_MAGIC;
+        fileHeader.version = FILE_VERSION;
+        fileHeader.genesisBlockHash = core.getBlockHashByIndex(0);
+
+        writePod(file, fileHeader);
+
+        const uint32_t topIndex = core.getTopBlockIndex();
+
+        uint32_t chunks = 0;
+
+        for (uint64_t startIndex = 0; startIndex <= topIndex; startIndex += BLOCKS_PER_CHUNK)
+        {
+            const uint32_t blockCount =
+                static_cast<uint32_t>(std::min<uint64_t>(BLOCKS_PER_CHUNK, topIndex - startIndex + 1));
+
+            auto blocks = core.getBlocks(static_cast<uint32_t>(startIndex), blockCount);
+
+            if (blocks.size() != blockCount)
+            {
+                throw std::runtime_error("Failed to read block " + std::to_string(startIndex + blocks.size()));
+            }
+
+            std::vector<uint8_t> raw;
+
+            {
+                Common::VectorOutputStream stream(raw);
+                CryptoNote::BinaryOutputStreamSerializer serializer(stream);
+
+                for (auto &block : blocks)
+                {
+                    serialize(block, serializer);
+                }
+            }
+
+            ChunkHeader header;
+
+            header.startIndex = static_cast<uint32_t>(startIndex);
+            header.blockCount = blockCount;
+            header.rawSize = raw.size();
+
+            const std::vector<uint8_t> stored = compressChunk(raw, header);
+
+            header.storedSize = stored.size();
+            header.checksum = Crypto::cn_fast_hash(stored.data(), stored.size());
+
+            writePod(file, header);
+            file.write(reinterpret_cast<const char *>(stored.data()), stored.size());
+
+            if (!file)
+            {
+                throw std::runtime_error("Failed to write to " + path);
+            }
+
+            if (++chunks % LOG_INTERVAL_CHUNKS == 0 || startIndex + blockCount > topIndex)
+            {
+                logger(Logging::INFO) << "Exported " << startIndex + blockCount << " of " << topIndex + 1 << " blocks";
+            }
+        }
+
+        file.close();
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write to " + path);
+        }
+    }
+
+    uint64_t importBlocks(
+        CryptoNote::Core &core,
+        const CryptoNote::Checkpoints &checkpoints,
+        const std::string &path,
+        const uint32_t threadCount,
+        const std::shared_ptr<Logging::ILogger> _logger)
+    {
+        Logging::LoggerRef logger(_logger, "BlockArchive");
+
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open " + path);
+        }
+
+        FileHeader fileHeader;
+
+        file.read(reinterpret_cast<char *>(&fileHeader), sizeof(fileHeader));
+
+        if (!file || fileHeader.magic != FILE_MAGIC)
+        {
+            throw std::runtime_error(path + " is not a block archive");
+        }
+
+        if (fileHeader.version != FILE_VERSION)
+        {
+            throw std::runtime_error(
+                "Unsupported block archive version " + std::to_string(fileHeader.version) + ", expected "
+                + std::to_string(FILE_VERSION));
+        }
+
+        if (fileHeader.genesisBlockHash != core.getBlockHashByIndex(0))
+        {
+            throw std::runtime_error("Block archive is for a different network");
+        }
+
+        /* Blocks at or below this are already in our chain */
+        const uint32_t startTopIndex = core.getTopBlockIndex();
+
+        logger(Logging::INFO) << "Importing blocks above height " << startTopIndex + 1 << " from " << path;
+
+        const size_t prefetchChunks = std::max<size_t>(threadCount, 1) * PREFETCH_CHUNKS_PER_THREAD;
+
+        Utilities::ThreadPool<PreparedChunk> threadPool(threadCount);
+
+        /* Chunks being prepared on the thread pool, in file order */
+        std::deque<std::future<PreparedChunk>> pendingChunks;
+
+        uint64_t nextStartIndex = 0;
+
+        uint64_t blocksAdded = 0;
+
+        uint32_t chunks = 0;
+
+        bool endOfFile = false;
+
+        while (true)
+        {
+            /* Keep the thread pool busy with the chunks after the one we're
+               adding */
+            while (!endOfFile && pendingChunks.size() < prefetchChunks)
+            {
+                ChunkHeader header;
+
+                if (!readChunkHeader(file, header))
+                {
+                    endOfFile = true;
+                    break;
+                }
+
+                if (header.startIndex != nextStartIndex || header.blockCount == 0
+                    || header.storedSize > MAX_CHUNK_SIZE || header.rawSize > MAX_CHUNK_SIZE)
+                {
+                    throw std::runtime_error("Block archive is corrupt at block " + std::to_string(nextStartIndex));
+                }
+
+                nextStartIndex += header.blockCount;
+
+                /* Already have every block in this chunk */
+                if (nextStartIndex - 1 <= startTopIndex)
+                {
+                    file.seekg(header.storedSize, std::ios::cur);
+                    continue;
+                }
+
+                auto stored = std::make_shared<std::vector<uint8_t>>(header.storedSize);
+
+                if (!file.read(reinterpret_cast<char *>(stored->data()), stored->size()))
+                {
+                    throw std::runtime_error("Block archive is truncated");
+                }
+
+                pendingChunks.push_back(threadPool.addJob(
+                    [header, stored, &checkpoints] { return prepareChunk(header, *stored, checkpoints); }));
+            }
+
+            if (pendingChunks.empty())
+            {
+                break;
+            }
+
+            PreparedChunk chunk = pendingChunks.front().get();
+            pendingChunks.pop_front();
+
+            if (!chunk.error.empty())
+            {
+                throw std::runtime_error(
+                    "Block archive is corrupt at block " + std::to_string(chunk.header.startIndex) + ": "
+                    + chunk.error);
+            }
+
+            for (uint32_t i = 0; i < chunk.header.blockCount; i++)
+            {
+                const uint32_t blockIndex = chunk.header.startIndex + i;
+
+                if (blockIndex <= startTopIndex)
+                {
+                    continue;
+                }
+
+                const auto result = core.addBlock(chunk.cachedBlocks[i], std::move(chunk.rawBlocks[i]));
+
+                if (result != CryptoNote::error::AddBlockErrorCode::ADDED_TO_MAIN)
+                {
+                    throw std::runtime_error(
+                        "Failed to add block " + std::to_string(blockIndex) + ": " + result.message());
+                }
+
+                blocksAdded++;
+            }
+
+            if (++chunks % LOG_INTERVAL_CHUNKS == 0 || (endOfFile && pendingChunks.empty()))
+            {
+                logger(Logging::INFO) << "Imported blocks up to height "
+                                      << chunk.header.startIndex + chunk.header.blockCount;
+            }
+        }
+
+        return blocksAdded;
+    }
+} // namespace BlockArchive
@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cryptonotecore/Checkpoints.h>
+#include <logging/ILogger.h>
+#include <memory>
+#include <string>
+
+namespace CryptoNote
+{
+    class Core;
+} // namespace CryptoNote
+
+/* Exports the blockchain to a single file, and imports it again, so nodes
+   can be provisioned without syncing from the p2p network.
+
+   The file is a small header followed by chunks of consecutive raw blocks.
+   Each chunk is checksummed, and zstd compressed when the daemon is built
+   with zstd support. */
+namespace BlockArchive
+{
+    /* Writes every block in the local main chain to the file, overwriting it
+       if it exists. Throws on failure. */
+    void exportBlocks(
+        const CryptoNote::Core &core,
+        const std::string &path,
+        const std::shared_ptr<Logging::ILogger> logger);
+
+    /* Adds the blocks in the file which are above the local top block. The
+       blocks are fully validated by the core, as if they had come from a
+       peer. Reading, checksumming, decompressing and hashing the blocks
+       happens on a pool of threads, ahead of the blocks being added in
+       order.
+
+       Returns the number of blocks added. Throws if the file is corrupt,
+       for a different network, or contains an invalid block; any blocks
+       before that point remain added. */
+    uint64_t importBlocks(
+        CryptoNote::Core &core,
+        const CryptoNote::Checkpoints &checkpoints,
+        const std::string &path,
+        const uint32_t threadCount,
+        const std::shared_ptr<Logging::ILogger> logger);
+} // namespace BlockArchive
@@ -5,6 +5,7 @@
 //
 // Please see the included LICENSE file for more information.
 
+#include "BlockArchive.h"
 #include "DaemonCommandsHandler.h"
 #include "DaemonConfiguration.h"
 #include "common/CryptoNoteTools.h"
@@ -20,6 +21,7 @@
 #include "cryptonotecore/Currency.h"
 #include "cryptonotecore/DatabaseBlockchainCache.h"
 #include "cryptonotecore/DatabaseBlockchainCacheFactory.h"
+#include "cryptonotecore/HotStateCache.h"
 #include "cryptonotecore/MainChainStorage.h"
 #if defined (USE_LEVELDB)
 #include "cryptonotecore/LevelDBWrapper.h"
@@ -242,7 +244,9 @@ int main(int argc, char *argv[])
         // configure logging
         logManager->configure(buildLoggerConfiguration(cfgLogLevel, cfgLogFile.string()));
 
-        Logger::logger.setLogLevel(Logger::DEBUG);
+        /* Match the new logger to the old one, so messages which would be
+           filtered out are dropped before we format them */
+        matchLoggerLevel(cfgLogLevel);
 
         /* New logger, for now just passing through messages to old logger */
         Logger::logger.setLogCallback([&logger](
@@ -312,19 +316,6 @@ int main(int argc, char *argv[])
             config.dbMaxByteLevelSizeMB,
             config.enableDbCompression);
 
-        /* If we were told to rewind the blockchain to a certain height
-           we will remove blocks until we're back at the height specified */
-        if (config.rewindToHeight > 0)
-        {
-            logger(INFO) << "Rewinding blockchain to: " << config.rewindToHeight << std::endl;
-
-            std::unique_ptr<IMainChainStorage> mainChainStorage = createSwappedMainChainStorage(config.dataDirectory, currency);
-
-            mainChainStorage->rewindTo(config.rewindToHeight);
-
-            logger(INFO) << "Blockchain rewound to: " << config.rewindToHeight << std::endl;
-        }
-
         bool use_checkpoints = !config.checkPoints.empty();
         CryptoNote::Checkpoints checkpoints(logManager);
 
@@ -377,6 +368,16 @@ int main(int argc, char *argv[])
 
         if (!DatabaseBlockchainCache::checkDBSchemeVersion(database, logManager))
         {
+            /* The database holds the only copy of the blocks in db only mode,
+               so wiping it would throw away the whole chain */
+            if (config.dbOnlyBlockStorage)
+            {
+                logger(ERROR, BRIGHT_RED) << "The database scheme version doesn't match, and the database holds the "
+                                          << "only copy of the blocks. Convert it with db-migrator, or remove "
+                                          << dbConfig.getDataDir() << " to resync from the network.";
+                return 1;
+            }
+
             dbShutdownOnExit.cancel();
             database.shutdown();
 
@@ -386,24 +387,98 @@ int main(int argc, char *argv[])
             dbShutdownOnExit.resume();
         }
 
+        /* Keeps the recently read and written blockchain state in memory, so
+           queries about the top of the chain don't touch the database */
+        std::shared_ptr<HotStateCache> hotStateCache;
+
+        if (config.dbHotCacheSizeMB > 0)
+        {
+            hotStateCache = std::make_shared<HotStateCache>(
+                database, static_cast<uint64_t>(config.dbHotCacheSizeMB) * 1024 * 1024);
+        }
+
+        IDataBase &blockchainDatabase = hotStateCache ? static_cast<IDataBase &>(*hotStateCache) : database;
+
         System::Dispatcher dispatcher;
         logger(INFO) << "Initializing core...";
 
-        std::unique_ptr<IMainChainStorage> tmainChainStorage = createSwappedMainChainStorage(config.dataDirectory, currency);
+        /* In db only mode the raw blocks are read straight out of the database,
+           rather than being duplicated in the blocks file */
+        std::unique_ptr<IMainChainStorage> tmainChainStorage = config.dbOnlyBlockStorage
+            ? createDatabaseMainChainStorage(blockchainDatabase)
+            : createSwappedMainChainStorage(config.dataDirectory, currency);
+
+        /* If we were told to rewind the blockchain to a certain height
+           we will remove blocks until we're back at the height specified.
+           The database is cut to match when the core is loaded. */
+        if (config.rewindToHeight > 0)
+        {
+            logger(INFO) << "Rewinding blockchain to: " << config.rewindToHeight << std::endl;
+
+            tmainChainStorage->rewindTo(config.rewindToHeight);
+
+            logger(INFO) << "Blockchain rewound to: " << config.rewindToHeight << std::endl;
+        }
 
         const auto ccore = std::make_shared<CryptoNote::Core>(
             currency,
             logManager,
-            std::move(checkpoints),
+            CryptoNote::Checkpoints(checkpoints),
             dispatcher,
-            std::unique_ptr<IBlockchainCacheFactory>(new DatabaseBlockchainCacheFactory(database, logger.getLogger())),
+            std::unique_ptr<IBlockchainCacheFactory>(
+                new DatabaseBlockchainCacheFactory(blockchainDatabase, logger.getLogger())),
             std::move(tmainChainStorage),
             config.transactionValidationThreads);
 
+        if (config.enableExplorerStore)
+        {
+            ccore->setExplorerStore(std::make_shared<CryptoNote::ExplorerStore>(blockchainDatabase, logManager));
+        }
+
         ccore->load();
 
         logger(INFO) << "Core initialized OK";
 
+        if (!config.exportBlocksFile.empty())
+        {
+            BlockArchive::exportBlocks(*ccore, config.exportBlocksFile, logManager);
+
+            logger(INFO) << "Blocks exported to " << config.exportBlocksFile;
+
+            return 0;
+        }
+
+        if (!config.importBlocksFile.empty())
+        {
+            uint64_t blocksAdded = 0;
+
+            try
+            {
+                blocksAdded = BlockArchive::importBlocks(
+                    *ccore,
+                    checkpoints,
+                    config.importBlocksFile,
+                    config.transactionValidationThreads,
+                    logManager);
+            }
+            catch (const std::exception &e)
+            {
+                /* Keep the blocks imported before the failure */
+                ccore->save();
+
+                logger(ERROR, BRIGHT_RED) << "Failed to import blocks from " << config.importBlocksFile << ": "
+                                          << e.what();
+
+                return 1;
+            }
+
+            ccore->save();
+
+            logger(INFO) << "Imported " << blocksAdded << " blocks from " << config.importBlocksFile;
+
+            return 0;
+        }
+
         const auto cprotocol = std::make_shared<CryptoNote::CryptoNoteProtocolHandler>(
             currency,
             dispatcher,
@@ -445,7 +520,8 @@ int main(int argc, char *argv[])
             rpcMode,
             ccore,
             p2psrv,
-            cprotocol
+            cprotocol,
+            hotStateCache
         );
 
         cprotocol->set_p2p_endpoint(&(*p2psrv));
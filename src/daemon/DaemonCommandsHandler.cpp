@@ -13,6 +13,7 @@
 #include <cryptonoteprotocol/CryptoNoteProtocolHandler.h>
 #include <ctime>
 #include <daemon/DaemonCommandsHandler.h>
+#include <logger/Logger.h>
 #include <p2p/NetNode.h>
 #include <rpc/JsonRpc.h>
 #include <serialization/SerializationTools.h>
@@ -50,6 +51,26 @@ namespace
 
 } // namespace
 
+void matchLoggerLevel(const Logging::Level level)
+{
+    if (level >= Logging::DEBUGGING)
+    {
+        Logger::logger.setLogLevel(Logger::DEBUG);
+    }
+    else if (level >= Logging::INFO)
+    {
+        Logger::logger.setLogLevel(Logger::INFO);
+    }
+    else if (level >= Logging::WARNING)
+    {
+        Logger::logger.setLogLevel(Logger::WARNING);
+    }
+    else
+    {
+        Logger::logger.setLogLevel(Logger::FATAL);
+    }
+}
+
 DaemonCommandsHandler::DaemonCommandsHandler(
     CryptoNote::Core &core,
     CryptoNote::NodeServer &srv,
@@ -131,6 +152,7 @@ bool DaemonCommandsHandler::exit(const std::vector<std::string> &args)
     /* Set log to max when exiting. Sometimes this takes a while, and it helps
        to let users know the daemon is still doing stuff */
     m_logManager->setMaxLevel(Logging::TRACE);
+    matchLoggerLevel(Logging::TRACE);
     m_consoleHandler.requestStop();
     m_srv.sendStopSignal();
     return true;
@@ -182,6 +204,7 @@ bool DaemonCommandsHandler::set_log(const std::vector<std::string> &args)
     }
 
     m_logManager->setMaxLevel(static_cast<Logging::Level>(l));
+    matchLoggerLevel(static_cast<Logging::Level>(l));
     return true;
 }
 
@@ -20,6 +20,10 @@ namespace CryptoNote
     class NodeServer;
 } // namespace CryptoNote
 
+/* Sets Logger::logger to the level matching the given Logging level, so
+   both loggers filter the same messages */
+void matchLoggerLevel(const Logging::Level level);
+
 class DaemonCommandsHandler
 {
   public:
@@ -36,7 +36,15 @@ namespace DaemonConfig
         cxxopts::Options options(argv[0], CryptoNote::getProjectCLIHeader());
 
         options.add_options("Core")(
+            "export-blocks",
+            "Writes the local blockchain to the given <file> and exits",
+            cxxopts::value<std::string>(),
+            "<file>")(
             "help", "Display this help message", cxxopts::value<bool>()->implicit_value("true"))(
+            "import-blocks",
+            "Adds the blocks from a <file> written by --export-blocks to the local blockchain and exits",
+            cxxopts::value<std::string>(),
+            "<file>")(
             "os-version",
             "Output Operating System version information",
             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
@@ -90,6 +98,10 @@ namespace DaemonConfig
             "enable-blockexplorer-detailed",
             "Enable the Blockchain Explorer Detailed RPC",
             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
+            "enable-explorer-store",
+            "Store precomputed block details in the database to speed up the Blockchain Explorer RPCs. Uses more "
+            "disk space.",
+            cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
             "enable-mining",
             "Enable Mining RPC",
             cxxopts::value<bool>()->default_value("false")->implicit_value("true"))(
@@ -184,12 +196,20 @@ namespace DaemonConfig
                     cxxopts::value<int>()->default_value(std::to_string(config.dbMaxByteLevelSizeMB)),
                     "#")
 #endif
-                    ;
+                    ("db-hot-cache-size",
+                     "Size of the in process cache of recent blockchain state in megabytes (MB), 0 to disable",
+                     cxxopts::value<int>()->default_value(std::to_string(config.dbHotCacheSizeMB)),
+                     "#");
         options.add_options("Syncing")(
             "transaction-validation-threads",
             "Number of threads to use to validate a transaction's inputs in parallel",
             cxxopts::value<uint32_t>()->default_value(std::to_string(config.transactionValidationThreads)),
-            "#");
+            "#")(
+            "db-only-block-storage",
+            "Store blocks only in the database, rather than in both the database and the blocks file. "
+            "Halves disk usage, but the database can no longer be rebuilt from the blocks file. "
+            "Turning this off again requires a resync",
+            cxxopts::value<bool>()->default_value("false")->implicit_value("true"));
 
         try
         {
@@ -237,6 +257,16 @@ namespace DaemonConfig
                 }
             }
 
+            if (cli.count("export-blocks") > 0)
+            {
+                config.exportBlocksFile = cli["export-blocks"].as<std::string>();
+            }
+
+            if (cli.count("import-blocks") > 0)
+            {
+                config.importBlocksFile = cli["import-blocks"].as<std::string>();
+            }
+
             if (cli.count("print-genesis-tx") > 0)
             {
                 config.printGenesisTx = cli["print-genesis-tx"].as<bool>();
@@ -304,6 +334,11 @@ namespace DaemonConfig
                 config.dbWriteBufferSizeMB = cli["db-max-bytes-for-level-base"].as<int>();
             }
 
+            if (cli.count("db-hot-cache-size") > 0)
+            {
+                config.dbHotCacheSizeMB = cli["db-hot-cache-size"].as<int>();
+            }
+
             if (cli.count("local-ip") > 0)
             {
                 config.localIp = cli["local-ip"].as<bool>();
@@ -374,6 +409,11 @@ namespace DaemonConfig
                 config.enableBlockExplorerDetailed = cli["enable-blockexplorer-detailed"].as<bool>();
             }
 
+            if (cli.count("enable-explorer-store") > 0)
+            {
+                config.enableExplorerStore = cli["enable-explorer-store"].as<bool>();
+            }
+
             if (cli.count("enable-mining") > 0)
             {
                 config.enableMining = cli["enable-mining"].as<bool>();
@@ -399,6 +439,11 @@ namespace DaemonConfig
                 config.transactionValidationThreads = cli["transaction-validation-threads"].as<uint32_t>();
             }
 
+            if (cli.count("db-only-block-storage") > 0)
+            {
+                config.dbOnlyBlockStorage = cli["db-only-block-storage"].as<bool>();
+            }
+
             if (config.help) // Do we want to display the help message?
             {
                 std::cout << options.help({}) << std::endl;
@@ -564,6 +609,18 @@ namespace DaemonConfig
                     }
                 }
 #endif
+                else if (cfgKey.compare("db-hot-cache-size") == 0)
+                {
+                    try
+                    {
+                        config.dbHotCacheSizeMB = std::stoi(cfgValue);
+                        updated = true;
+                    }
+                    catch (std::exception &e)
+                    {
+                        throw std::runtime_error(std::string(e.what()) + " - Invalid value for " + cfgKey);
+                    }
+                }
                 else if (cfgKey.compare("allow-local-ip") == 0)
                 {
                     config.localIp = cfgValue.at(0) == '1';
@@ -574,6 +631,11 @@ namespace DaemonConfig
                     config.hideMyPort = cfgValue.at(0) == '1';
                     updated = true;
                 }
+                else if (cfgKey.compare("db-only-block-storage") == 0)
+                {
+                    config.dbOnlyBlockStorage = cfgValue.at(0) == '1';
+                    updated = true;
+                }
                 else if (cfgKey.compare("p2p-bind-ip") == 0)
                 {
                     config.p2pInterface = cfgValue;
@@ -659,6 +721,11 @@ namespace DaemonConfig
                     config.enableBlockExplorerDetailed = cfgValue.at(0) == '1';
                     updated = true;
                 }
+                else if (cfgKey.compare("enable-explorer-store") == 0)
+                {
+                    config.enableExplorerStore = cfgValue.at(0) == '1';
+                    updated = true;
+                }
                 else if (cfgKey.compare("enable-mining") == 0)
                 {
                     config.enableMining = cfgValue.at(0) == '1';
@@ -803,6 +870,11 @@ namespace DaemonConfig
             config.dbMaxByteLevelSizeMB = j["db-max-bytes-for-level-base"].GetInt();
         }
 #endif
+        if (j.HasMember("db-hot-cache-size"))
+        {
+            config.dbHotCacheSizeMB = j["db-hot-cache-size"].GetInt();
+        }
+
         if (j.HasMember("allow-local-ip"))
         {
             config.localIp = j["allow-local-ip"].GetBool();
@@ -813,6 +885,11 @@ namespace DaemonConfig
             config.hideMyPort = j["hide-my-port"].GetBool();
         }
 
+        if (j.HasMember("db-only-block-storage"))
+        {
+            config.dbOnlyBlockStorage = j["db-only-block-storage"].GetBool();
+        }
+
         if (j.HasMember("p2p-bind-ip"))
         {
             config.p2pInterface = j["p2p-bind-ip"].GetString();
@@ -889,6 +966,11 @@ namespace DaemonConfig
             config.enableBlockExplorerDetailed = j["enable-blockexplorer-detailed"].GetBool();
         }
 
+        if (j.HasMember("enable-explorer-store"))
+        {
+            config.enableExplorerStore = j["enable-explorer-store"].GetBool();
+        }
+
         if (j.HasMember("enable-mining"))
         {
             config.enableMining = j["enable-mining"].GetBool();
@@ -935,8 +1017,10 @@ namespace DaemonConfig
         j.AddMember("db-write-buffer-size", (config.dbWriteBufferSizeMB), alloc);
         j.AddMember("db-max-bytes-for-level-base", (config.dbMaxByteLevelSizeMB), alloc);
 #endif
+        j.AddMember("db-hot-cache-size", config.dbHotCacheSizeMB, alloc);
         j.AddMember("allow-local-ip", config.localIp, alloc);
         j.AddMember("hide-my-port", config.hideMyPort, alloc);
+        j.AddMember("db-only-block-storage", config.dbOnlyBlockStorage, alloc);
         j.AddMember("p2p-bind-ip", config.p2pInterface, alloc);
         j.AddMember("p2p-bind-port", config.p2pPort, alloc);
         j.AddMember("p2p-external-port", config.p2pExternalPort, alloc);
@@ -991,6 +1075,7 @@ namespace DaemonConfig
 
         j.AddMember("enable-blockexplorer", config.enableBlockExplorer, alloc);
         j.AddMember("enable-blockexplorer-detailed", config.enableBlockExplorerDetailed, alloc);
+        j.AddMember("enable-explorer-store", config.enableExplorerStore, alloc);
         j.AddMember("enable-mining", config.enableMining, alloc);
         j.AddMember("fee-address", config.feeAddress, alloc);
         j.AddMember("fee-amount", config.feeAmount, alloc);
@@ -33,6 +33,7 @@ namespace DaemonConfig
             dbThreads = CryptoNote::DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT;
             dbWriteBufferSizeMB = CryptoNote::DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE;
             dbMaxByteLevelSizeMB = CryptoNote::DATABASE_MAX_BYTES_FOR_LEVEL_BASE;
+            dbHotCacheSizeMB = CryptoNote::DATABASE_HOT_CACHE_MB_DEFAULT_SIZE;
             rewindToHeight = 0;
             p2pInterface = "0.0.0.0";
             p2pPort = CryptoNote::P2P_DEFAULT_PORT;
@@ -43,6 +44,7 @@ namespace DaemonConfig
             noConsole = false;
             enableBlockExplorer = false;
             enableBlockExplorerDetailed = false;
+            enableExplorerStore = false;
             enableMining = false;
             localIp = false;
             hideMyPort = false;
@@ -53,6 +55,7 @@ namespace DaemonConfig
             printGenesisTx = false;
             dumpConfig = false;
             enableDbCompression = false;
+            dbOnlyBlockStorage = false;
             resync = false;
         }
 
@@ -100,20 +103,30 @@ namespace DaemonConfig
 
         int dbReadCacheSizeMB;
 
+        int dbHotCacheSizeMB;
+
         uint32_t rewindToHeight;
 
+        std::string exportBlocksFile;
+
+        std::string importBlocksFile;
+
         bool noConsole;
 
         bool enableBlockExplorer;
 
         bool enableBlockExplorerDetailed;
 
+        bool enableExplorerStore;
+
         bool enableMining;
 
         bool localIp;
 
         bool hideMyPort;
 
+        bool dbOnlyBlockStorage;
+
         bool resync;
 
         bool p2pResetPeerstate;
@@ -0,0 +1,117 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include <iostream>
+
+#include <common/FileSystemShim.h>
+#include <common/ScopeExit.h>
+#include <common/Util.h>
+#include <config/CliHeader.h>
+#include <config/CryptoNoteConfig.h>
+#include <cryptonotecore/DataBaseConfig.h>
+#include <cryptonotecore/DatabaseBlockchainCache.h>
+#include <cxxopts.hpp>
+#include <logging/ConsoleLogger.h>
+#include <utilities/ColouredMsg.h>
+
+#if defined (USE_LEVELDB)
+#include <cryptonotecore/LevelDBWrapper.h>
+#else
+#include <cryptonotecore/RocksDBWrapper.h>
+#endif
+
+int main(int argc, char **argv)
+{
+    std::string dataDirectory = Tools::getDefaultDataDirectory();
+
+    bool help;
+    bool version;
+
+    cxxopts::Options options(argv[0], CryptoNote::getProjectCLIHeader());
+
+    options.add_options("Core")(
+        "h,help", "Display this help message", cxxopts::value<bool>(help)->implicit_value("true"))
+
+        ("v,version",
+         "Output software version information",
+         cxxopts::value<bool>(version)->default_value("false")->implicit_value("true"));
+
+    options.add_options("Database")(
+        "data-dir",
+        "Specify the <path> to the daemon data directory",
+        cxxopts::value<std::string>(dataDirectory)->default_value(dataDirectory),
+        "<path>");
+
+    try
+    {
+        options.parse(argc, argv);
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cout << "Error: Unable to parse command line argument options: " << e.what() << std::endl << std::endl;
+        std::cout << options.help({}) << std::endl;
+        exit(1);
+    }
+
+    if (help) // Do we want to display the help message?
+    {
+        std::cout << options.help({}) << std::endl;
+        exit(0);
+    }
+    else if (version) // Do we want to display the software version?
+    {
+        std::cout << CryptoNote::getProjectCLIHeader() << std::endl;
+        exit(0);
+    }
+
+    if (!fs::exists(dataDirectory))
+    {
+        std::cout << WarningMsg("The data directory ") << InformationMsg(dataDirectory)
+                  << WarningMsg(" doesn't exist!") << std::endl;
+        return 1;
+    }
+
+    const auto logger = std::make_shared<Logging::ConsoleLogger>(Logging::INFO);
+
+    CryptoNote::DataBaseConfig dbConfig;
+    dbConfig.init(
+        dataDirectory,
+        CryptoNote::DATABASE_DEFAULT_BACKGROUND_THREADS_COUNT,
+        CryptoNote::DATABASE_DEFAULT_MAX_OPEN_FILES,
+        CryptoNote::DATABASE_WRITE_BUFFER_MB_DEFAULT_SIZE,
+        CryptoNote::DATABASE_READ_BUFFER_MB_DEFAULT_SIZE,
+        CryptoNote::DATABASE_MAX_BYTES_FOR_LEVEL_BASE,
+        false);
+
+    std::cout << InformationMsg("Migrating database in ") << SuccessMsg(dbConfig.getDataDir())
+              << InformationMsg("\nMake sure the daemon is not running, and do not close this window until the "
+                                "migration completes.\n")
+              << std::endl;
+
+    try
+    {
+#if defined (USE_LEVELDB)
+        CryptoNote::LevelDBWrapper database(logger);
+#else
+        CryptoNote::RocksDBWrapper database(logger);
+#endif
+        database.init(dbConfig);
+        Tools::ScopeExit dbShutdownOnExit([&database]() { database.shutdown(); });
+
+        if (!CryptoNote::DatabaseBlockchainCache::migrateDBScheme(database, logger))
+        {
+            std::cout << WarningMsg("\nDatabase could not be migrated. Delete it and resync instead.") << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << WarningMsg("\nFailed to migrate database: ") << WarningMsg(e.what()) << std::endl;
+        return 1;
+    }
+
+    std::cout << SuccessMsg("\nDatabase migrated successfully! You can now start the daemon.") << std::endl;
+
+    return 0;
+}
@@ -36,6 +36,10 @@ namespace CryptoNote
         {
             return CryptoNote::HttpResponse::STATUS_200;
         }
+        else if (status == "400 Bad Request")
+        {
+            return CryptoNote::HttpResponse::STATUS_400;
+        }
         else if (status == "404 Not Found")
         {
             return CryptoNote::HttpResponse::STATUS_404;
@@ -16,6 +16,8 @@ namespace
         {
             case CryptoNote::HttpResponse::STATUS_200:
                 return "200 OK";
+            case CryptoNote::HttpResponse::STATUS_400:
+                return "400 Bad Request";
             case CryptoNote::HttpResponse::STATUS_404:
                 return "404 Not Found";
             case CryptoNote::HttpResponse::STATUS_500:
@@ -29,6 +31,8 @@ namespace
     {
         switch (status)
         {
+            case CryptoNote::HttpResponse::STATUS_400:
+                return "Bad request\n";
             case CryptoNote::HttpResponse::STATUS_404:
                 return "Requested url is not found\n";
             case CryptoNote::HttpResponse::STATUS_500:
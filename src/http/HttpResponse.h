@@ -17,6 +17,7 @@ namespace CryptoNote
         enum HTTP_STATUS
         {
             STATUS_200,
+            STATUS_400,
             STATUS_404,
             STATUS_500
         };
@@ -111,10 +111,12 @@ namespace Logger
 
     void Logger::log(const std::string message, const LogLevel level, const std::vector<LogCategory> categories) const
     {
-        if (level == DISABLED)
+        /* Filter before doing any formatting */
+        if (!shouldLog(level))
         {
             return;
         }
+
         const std::time_t now = std::time(nullptr);
         std::stringstream output;
         output << "[" << std::put_time(std::localtime(&now), "%H:%M:%S") << "] "
@@ -124,17 +126,15 @@ namespace Logger
             output << " [" << logCategoryToString(category) << "]";
         }
         output << ": " << message;
-        if (level <= m_logLevel)
+
+        /* If the user provides a callback, log to that instead */
+        if (m_callback)
         {
-            /* If the user provides a callback, log to that instead */
-            if (m_callback)
-            {
-                m_callback(output.str(), message, level, categories);
-            }
-            else
-            {
-                std::cout << output.str() << std::endl;
-            }
+            m_callback(output.str(), message, level, categories);
+        }
+        else
+        {
+            std::cout << output.str() << std::endl;
         }
     }
 
@@ -143,6 +143,11 @@ namespace Logger
         m_logLevel = level;
     }
 
+    bool Logger::shouldLog(const LogLevel level) const
+    {
+        return level != DISABLED && level <= m_logLevel;
+    }
+
     void Logger::setLogCallback(std::function<void(
                                     const std::string prettyMessage,
                                     const std::string message,
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <vector>
@@ -44,6 +45,10 @@ namespace Logger
 
         void setLogLevel(const LogLevel level);
 
+        /* Whether a message at this level would be logged. Useful to avoid
+           building an expensive message which will just be discarded. */
+        bool shouldLog(const LogLevel level) const;
+
         void setLogCallback(std::function<void(
                                 const std::string prettyMessage,
                                 const std::string message,
@@ -52,7 +57,7 @@ namespace Logger
 
       private:
         /* Logging disabled by default */
-        LogLevel m_logLevel = DISABLED;
+        std::atomic<LogLevel> m_logLevel {DISABLED};
 
         std::function<void(
             const std::string prettyMessage,
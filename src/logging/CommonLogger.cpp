@@ -29,11 +29,14 @@ namespace Logging
                         case 'C':
                             s << category;
                             break;
+                        /* to_simple_string gives the same output as streaming
+                           the date / time, without constructing a new facet
+                           for every message */
                         case 'D':
-                            s << time.date();
+                            s << boost::gregorian::to_simple_string(time.date());
                             break;
                         case 'T':
-                            s << time.time_of_day();
+                            s << boost::posix_time::to_simple_string(time.time_of_day());
                             break;
                         case 'L':
                             s << std::setw(7) << std::left << ILogger::LEVEL_NAMES[level];
@@ -97,4 +100,6 @@ namespace Logging
 
     void CommonLogger::doLogString(const std::string &message) {}
 
+    void CommonLogger::flush() {}
+
 } // namespace Logging
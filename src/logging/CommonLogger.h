@@ -26,6 +26,9 @@ namespace Logging
 
         void setPattern(const std::string &pattern);
 
+        /* Writes out anything buffered */
+        virtual void flush();
+
       protected:
         std::set<std::string> disabledCategories;
 
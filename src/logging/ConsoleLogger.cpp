@@ -15,6 +15,12 @@ namespace Logging
 
     ConsoleLogger::ConsoleLogger(Level level): CommonLogger(level) {}
 
+    void ConsoleLogger::flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::cout << std::flush;
+    }
+
     void ConsoleLogger::doLogString(const std::string &message)
     {
         std::lock_guard<std::mutex> lock(mutex);
@@ -8,24 +8,165 @@
 #include "ConsoleLogger.h"
 #include "FileLogger.h"
 
-#include <thread>
+#include <algorithm>
 
 namespace Logging
 {
     using Common::JsonValue;
 
-    LoggerManager::LoggerManager() {}
+    namespace
+    {
+        /* If the writer can't keep up, we start dropping messages rather than
+           letting the queue grow without bound */
+        const size_t MAX_PENDING_MESSAGES = 50000;
+
+        const size_t MAX_PENDING_SIZE = 16 * 1024 * 1024;
+    } // namespace
+
+    LoggerManager::LoggerManager():
+        m_maxLevel(TRACE),
+        m_droppedMessages(0),
+        m_writerThread(&LoggerManager::writerLoop, this)
+    {
+    }
+
+    LoggerManager::~LoggerManager()
+    {
+        {
+            std::scoped_lock lock(m_pendingMutex);
+            m_shouldStop = true;
+        }
+
+        m_haveMessages.notify_one();
+
+        if (m_writerThread.joinable())
+        {
+            m_writerThread.join();
+        }
+    }
 
     void LoggerManager::
         operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
     {
-        std::unique_lock<std::mutex> lock(reconfigureLock);
-        LoggerGroup::operator()(category, level, time, body);
+        /* Not going to be written anywhere, don't bother queueing it */
+        if (level > m_maxLevel)
+        {
+            return;
+        }
+
+        /* Errors are written straight away, so they're not lost if we're
+           about to exit */
+        if (level <= ERROR)
+        {
+            std::scoped_lock lock(reconfigureLock);
+
+            writePending();
+
+            LoggerGroup::operator()(category, level, time, body);
+
+            for (const auto &logger : loggers)
+            {
+                logger->flush();
+            }
+
+            return;
+        }
+
+        {
+            std::scoped_lock lock(m_pendingMutex);
+
+            if (m_pending.size() >= MAX_PENDING_MESSAGES || m_pendingSize + body.size() > MAX_PENDING_SIZE)
+            {
+                m_droppedMessages++;
+                return;
+            }
+
+            m_pending.push_back({category, level, time, body});
+            m_pendingSize += body.size();
+        }
+
+        m_haveMessages.notify_one();
+    }
+
+    void LoggerManager::setMaxLevel(Level level)
+    {
+        LoggerGroup::setMaxLevel(level);
+        m_maxLevel = std::min(level, m_maxLoggerLevel);
+    }
+
+    uint64_t LoggerManager::getDroppedMessageCount() const
+    {
+        return m_droppedMessages;
+    }
+
+    void LoggerManager::writerLoop()
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_pendingMutex);
+
+                m_haveMessages.wait(lock, [this] { return m_shouldStop || !m_pending.empty(); });
+
+                if (m_shouldStop && m_pending.empty())
+                {
+                    return;
+                }
+            }
+
+            std::scoped_lock lock(reconfigureLock);
+            writePending();
+        }
+    }
+
+    void LoggerManager::writePending()
+    {
+        std::vector<PendingMessage> batch;
+
+        {
+            std::scoped_lock lock(m_pendingMutex);
+            batch.swap(m_pending);
+            m_pendingSize = 0;
+        }
+
+        const uint64_t dropped = m_droppedMessages;
+
+        if (batch.empty() && dropped == m_reportedDroppedMessages)
+        {
+            return;
+        }
+
+        for (const auto &message : batch)
+        {
+            LoggerGroup::operator()(message.category, message.level, message.time, message.body);
+        }
+
+        if (dropped != m_reportedDroppedMessages)
+        {
+            LoggerGroup::operator()(
+                "logging",
+                WARNING,
+                boost::posix_time::microsec_clock::local_time(),
+                std::to_string(dropped - m_reportedDroppedMessages)
+                    + " log messages were dropped, as they were produced faster than they could be written\n");
+
+            m_reportedDroppedMessages = dropped;
+        }
+
+        /* One flush per batch, rather than one per message */
+        for (const auto &logger : loggers)
+        {
+            logger->flush();
+        }
     }
 
     void LoggerManager::configure(const JsonValue &val)
     {
         std::unique_lock<std::mutex> lock(reconfigureLock);
+
+        /* Write out anything queued for the old loggers first */
+        writePending();
+
         loggers.clear();
         LoggerGroup::loggers.clear();
         Level globalLevel;
@@ -68,6 +209,8 @@ namespace Logging
             }
         }
 
+        m_maxLoggerLevel = FATAL;
+
         if (val.contains("loggers"))
         {
             auto loggersList = val("loggers");
@@ -100,6 +243,8 @@ namespace Logging
                         std::string filename = loggerConfiguration("filename").getString();
                         auto fileLogger = new FileLogger(level);
                         fileLogger->init(filename);
+                        /* We flush after each batch instead */
+                        fileLogger->setAutoFlush(false);
                         logger.reset(fileLogger);
                     }
                     else
@@ -127,6 +272,8 @@ namespace Logging
                         }
                     }
 
+                    m_maxLoggerLevel = std::max(m_maxLoggerLevel, level);
+
                     loggers.emplace_back(std::move(logger));
                     addLogger(*loggers.back());
                 }
@@ -141,6 +288,7 @@ namespace Logging
             throw std::runtime_error("loggers parameter missing");
         }
         setMaxLevel(globalLevel);
+
         for (const auto &category : globalDisabledCategories)
         {
             disableCategory(category);
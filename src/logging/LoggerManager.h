@@ -8,9 +8,12 @@
 #include "../common/JsonValue.h"
 #include "LoggerGroup.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 namespace Logging
 {
@@ -19,16 +22,67 @@ namespace Logging
       public:
         LoggerManager();
 
+        ~LoggerManager();
+
         void configure(const Common::JsonValue &val);
 
+        /* Messages are queued and written out in batches by a background
+           thread. Errors and fatal messages are written immediately, along
+           with anything queued before them. */
         virtual void
             operator()(const std::string &category, Level level, boost::posix_time::ptime time, const std::string &body)
                 override;
 
+        virtual void setMaxLevel(Level level) override;
+
+        /* Number of messages discarded because the queue was full */
+        uint64_t getDroppedMessageCount() const;
+
       private:
+        struct PendingMessage
+        {
+            std::string category;
+
+            Level level;
+
+            boost::posix_time::ptime time;
+
+            std::string body;
+        };
+
+        void writerLoop();
+
+        /* Must hold reconfigureLock */
+        void writePending();
+
         std::vector<std::unique_ptr<CommonLogger>> loggers;
 
         std::mutex reconfigureLock;
+
+        /* The most verbose level any configured logger will output. Anything
+           above this is discarded before it is copied or queued. */
+        std::atomic<Level> m_maxLevel;
+
+        /* The most verbose level of the configured loggers */
+        Level m_maxLoggerLevel = TRACE;
+
+        std::vector<PendingMessage> m_pending;
+
+        /* Total size of the message bodies in m_pending */
+        size_t m_pendingSize = 0;
+
+        std::mutex m_pendingMutex;
+
+        std::condition_variable m_haveMessages;
+
+        std::atomic<uint64_t> m_droppedMessages;
+
+        /* How many of m_droppedMessages we have told the user about */
+        uint64_t m_reportedDroppedMessages = 0;
+
+        bool m_shouldStop = false;
+
+        std::thread m_writerThread;
     };
 
 } // namespace Logging
@@ -19,6 +19,20 @@ namespace Logging
         this->stream = &stream;
     }
 
+    void StreamLogger::setAutoFlush(bool autoFlush)
+    {
+        this->autoFlush = autoFlush;
+    }
+
+    void StreamLogger::flush()
+    {
+        if (stream != nullptr && stream->good())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stream->flush();
+        }
+    }
+
     void StreamLogger::doLogString(const std::string &message)
     {
         if (stream != nullptr && stream->good())
@@ -37,7 +51,10 @@ namespace Logging
                 }
             }
 
-            *stream << std::flush;
+            if (autoFlush)
+            {
+                *stream << std::flush;
+            }
         }
     }
 
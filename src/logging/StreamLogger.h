@@ -20,6 +20,11 @@ namespace Logging
 
         void attachToStream(std::ostream &stream);
 
+        /* Whether to flush the stream after every message */
+        void setAutoFlush(bool autoFlush);
+
+        virtual void flush() override;
+
       protected:
         virtual void doLogString(const std::string &message) override;
 
@@ -28,6 +33,8 @@ namespace Logging
 
       private:
         std::mutex mutex;
+
+        bool autoFlush = true;
     };
 
 } // namespace Logging
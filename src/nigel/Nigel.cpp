@@ -39,6 +39,20 @@ inline std::shared_ptr<httplib::Client> getClient(
 #endif
 }
 
+/* How long we ask the daemon to hold a /waitforchanges request open for. We
+   can't interrupt the request, so keep it within our usual timeout so
+   stopping isn't held up for longer than any other request could. */
+inline std::chrono::seconds waitForChangesDuration(const std::chrono::seconds timeout)
+{
+    return std::min(timeout, std::chrono::seconds(CryptoNote::RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT));
+}
+
+/* The request is held open by the daemon, on top of the usual timeout */
+inline std::chrono::seconds statusTimeout(const std::chrono::seconds timeout)
+{
+    return timeout + waitForChangesDuration(timeout);
+}
+
 ////////////////////////////////
 /* Constructors / Destructors */
 ////////////////////////////////
@@ -63,6 +77,7 @@ Nigel::Nigel(
 
     m_requestHeaders = {{"User-Agent", userAgent.str()}};
     m_nodeClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout);
+    m_statusClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, statusTimeout(m_timeout));
 }
 
 Nigel::~Nigel()
@@ -86,12 +101,15 @@ void Nigel::swapNode(const std::string daemonHost, const uint16_t daemonPort, co
     m_isBlockchainCache = false;
     m_nodeFeeAddress = "";
     m_nodeFeeAmount = 0;
+    m_topBlockHash = Crypto::Hash();
+    m_poolVersion = 0;
 
     m_daemonHost = daemonHost;
     m_daemonPort = daemonPort;
     m_daemonSSL = daemonSSL;
 
     m_nodeClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, m_timeout);
+    m_statusClient = getClient(m_daemonHost, m_daemonPort, m_daemonSSL, statusTimeout(m_timeout));
 
     init();
 }
@@ -109,9 +127,38 @@ void Nigel::resetRequestedBlockCount()
     m_blockCount = CryptoNote::BLOCKS_SYNCHRONIZING_DEFAULT_COUNT;
 }
 
+void Nigel::setBlockCache(const std::shared_ptr<SharedBlockCache> blockCache)
+{
+    std::atomic_store(&m_blockCache, blockCache);
+}
+
 std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
     Nigel::getWalletSyncData(
+        const std::vector<Crypto::Hash> blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const bool skipCoinbaseTransactions) const
+{
+    const auto blockCache = std::atomic_load(&m_blockCache);
+
+    if (blockCache == nullptr)
+    {
+        return fetchWalletSyncData(blockHashCheckpoints, startHeight, startTimestamp, skipCoinbaseTransactions);
+    }
+
+    return blockCache->getWalletSyncData(
+        blockHashCheckpoints,
+        startHeight,
+        startTimestamp,
+        skipCoinbaseTransactions,
+        m_blockCount,
+        [&]() {
+            return fetchWalletSyncData(blockHashCheckpoints, startHeight, startTimestamp, skipCoinbaseTransactions);
+        });
+}
 
+std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+    Nigel::fetchWalletSyncData(
         const std::vector<Crypto::Hash> blockHashCheckpoints,
         const uint64_t startHeight,
         const uint64_t startTimestamp,
@@ -290,13 +337,57 @@ bool Nigel::getFeeInfo()
     return false;
 }
 
+/* Returns once the daemon's top block or pool differs from what we last
+   saw, or the wait times out. Returns false if the daemon doesn't support
+   /waitforchanges, or the request failed. */
+bool Nigel::waitForDaemonChanges()
+{
+    json j = {{"topBlockHash", m_topBlockHash},
+              {"poolVersion", m_poolVersion},
+              {"timeout", waitForChangesDuration(m_timeout).count()}};
+
+    auto res = m_statusClient->Post("/waitforchanges", m_requestHeaders, j.dump(), "application/json");
+
+    if (res && res->status == 200)
+    {
+        try
+        {
+            json j = json::parse(res->body);
+
+            if (j.at("status").get<std::string>() != "OK")
+            {
+                return false;
+            }
+
+            m_topBlockHash = j.at("topBlockHash").get<Crypto::Hash>();
+            m_poolVersion = j.at("poolVersion").get<uint64_t>();
+
+            return true;
+        }
+        catch (const json::exception &e)
+        {
+            Logger::logger.log(
+                std::string("Failed to parse /waitforchanges response: ") + e.what(),
+                Logger::DEBUG,
+                {Logger::DAEMON});
+        }
+    }
+
+    return false;
+}
+
 void Nigel::backgroundRefresh()
 {
     while (!m_shouldStop)
     {
         getDaemonInfo();
 
-        Utilities::sleepUnlessStopping(std::chrono::seconds(10), m_shouldStop);
+        /* Let the daemon tell us when something changes, rather than
+           polling it. Older daemons don't support this, so poll them. */
+        if (!m_shouldStop && !waitForDaemonChanges())
+        {
+            Utilities::sleepUnlessStopping(std::chrono::seconds(10), m_shouldStop);
+        }
     }
 }
 
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <config/CryptoNoteConfig.h>
+#include <nigel/SharedBlockCache.h>
 #include <rpc/CoreRpcServerCommandsDefinitions.h>
 #include <string>
 #include <thread>
@@ -43,6 +44,9 @@ class Nigel
 
     void resetRequestedBlockCount();
 
+    /* Share downloaded blocks with other wallets using the same cache */
+    void setBlockCache(const std::shared_ptr<SharedBlockCache> blockCache);
+
     /* Returns whether we've received info from the daemon at some point */
     bool isOnline() const;
 
@@ -91,8 +95,17 @@ class Nigel
 
     bool getDaemonInfo();
 
+    bool waitForDaemonChanges();
+
     bool getFeeInfo();
 
+    std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+        fetchWalletSyncData(
+            const std::vector<Crypto::Hash> blockHashCheckpoints,
+            const uint64_t startHeight,
+            const uint64_t startTimestamp,
+            const bool skipCoinbaseTransactions) const;
+
     //////////////////////////////
     /* Private member variables */
     //////////////////////////////
@@ -101,6 +114,10 @@ class Nigel
        and making our functions non const) */
     std::shared_ptr<httplib::Client> m_nodeClient = nullptr;
 
+    /* A separate client for /waitforchanges, since those requests are held
+       open by the daemon for longer than our usual timeout */
+    std::shared_ptr<httplib::Client> m_statusClient = nullptr;
+
     /* Stores the HTTP headers included in all Nigel requests */
     httplib::Headers m_requestHeaders;
 
@@ -122,6 +139,12 @@ class Nigel
     /* The amount of peers we're connected to */
     std::atomic<uint64_t> m_peerCount = 0;
 
+    /* The daemon's top block hash, as of the last /waitforchanges */
+    Crypto::Hash m_topBlockHash = Crypto::Hash();
+
+    /* The daemon's pool version, as of the last /waitforchanges */
+    uint64_t m_poolVersion = 0;
+
     /* The hashrate (based on the last local block the daemon has synced) */
     std::atomic<uint64_t> m_lastKnownHashrate = 0;
 
@@ -146,4 +169,8 @@ class Nigel
 
     /* If the daemon is SSL */
     bool m_daemonSSL = false;
+
+    /* Blocks shared with other wallets, if any. Accessed atomically, since it
+       can be set while syncing. */
+    std::shared_ptr<SharedBlockCache> m_blockCache = nullptr;
 };
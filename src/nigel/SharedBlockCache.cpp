@@ -0,0 +1,431 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+/////////////////////////////////////
+#include <nigel/SharedBlockCache.h>
+/////////////////////////////////////
+
+#include <common/StringTools.h>
+#include <logger/Logger.h>
+
+namespace
+{
+    /* How long we keep telling wallets at the top block that they're synced
+       before asking the daemon again. Stops every synced wallet polling the
+       daemon separately. */
+    const auto SYNCED_RESPONSE_LIFETIME = std::chrono::seconds(2);
+} // namespace
+
+SharedBlockCache::SharedBlockCache(const bool skipCoinbaseTransactions, const size_t memoryLimit):
+    m_skipCoinbaseTransactions(skipCoinbaseTransactions),
+    m_memoryLimit(memoryLimit)
+{
+}
+
+SharedBlockCache::WalletSyncData SharedBlockCache::getWalletSyncData(
+    const std::vector<Crypto::Hash> &blockHashCheckpoints,
+    const uint64_t startHeight,
+    const uint64_t startTimestamp,
+    const bool skipCoinbaseTransactions,
+    const uint64_t blockCount,
+    const std::function<WalletSyncData()> &fetchFromDaemon)
+{
+    /* The stored blocks won't match what the daemon would return */
+    if (skipCoinbaseTransactions != m_skipCoinbaseTransactions)
+    {
+        return fetchFromDaemon();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (const auto cached = lookup(blockHashCheckpoints, startHeight, startTimestamp, blockCount))
+    {
+        return *cached;
+    }
+
+    const std::string key = (blockHashCheckpoints.empty() ? "" : Common::podToHex(blockHashCheckpoints.front())) + ":"
+                            + std::to_string(startHeight) + ":" + std::to_string(startTimestamp);
+
+    /* Another wallet is already asking the daemon for this, wait for it
+       rather than asking again */
+    if (const auto pending = m_pendingRequests.find(key); pending != m_pendingRequests.end())
+    {
+        const auto result = pending->second;
+
+        lock.unlock();
+
+        return result.get();
+    }
+
+    std::promise<WalletSyncData> promise;
+
+    m_pendingRequests[key] = promise.get_future().share();
+
+    lock.unlock();
+
+    WalletSyncData data;
+
+    try
+    {
+        data = fetchFromDaemon();
+    }
+    catch (...)
+    {
+        {
+            std::scoped_lock<std::mutex> pendingLock(m_mutex);
+            m_pendingRequests.erase(key);
+        }
+
+        promise.set_exception(std::current_exception());
+
+        throw;
+    }
+
+    lock.lock();
+
+    store(blockHashCheckpoints, startHeight, startTimestamp, data);
+
+    m_pendingRequests.erase(key);
+
+    lock.unlock();
+
+    promise.set_value(data);
+
+    return data;
+}
+
+size_t SharedBlockCache::memoryUsage() const
+{
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    return m_memoryUsage;
+}
+
+std::optional<uint64_t> SharedBlockCache::findHeight(const Crypto::Hash &hash) const
+{
+    const auto it = m_heights.find(hash);
+
+    if (it == m_heights.end())
+    {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+std::map<uint64_t, uint64_t>::const_iterator SharedBlockCache::findRange(const uint64_t height) const
+{
+    auto it = m_ranges.upper_bound(height);
+
+    if (it == m_ranges.begin())
+    {
+        return m_ranges.end();
+    }
+
+    it--;
+
+    if (it->second < height)
+    {
+        return m_ranges.end();
+    }
+
+    return it;
+}
+
+std::optional<uint64_t> SharedBlockCache::getNextHeight(
+    const std::vector<Crypto::Hash> &blockHashCheckpoints,
+    const uint64_t startHeight,
+    const uint64_t startTimestamp) const
+{
+    /* The daemon has to look up the height for the timestamp */
+    if (startTimestamp != 0)
+    {
+        return std::nullopt;
+    }
+
+    /* A new wallet, which gets every block from the start height */
+    if (blockHashCheckpoints.empty())
+    {
+        return startHeight;
+    }
+
+    /* The first checkpoint is the wallet's most recent block */
+    if (const auto height = findHeight(blockHashCheckpoints.front()))
+    {
+        return *height + 1;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<SharedBlockCache::WalletSyncData> SharedBlockCache::lookup(
+    const std::vector<Crypto::Hash> &blockHashCheckpoints,
+    const uint64_t startHeight,
+    const uint64_t startTimestamp,
+    const uint64_t blockCount) const
+{
+    const auto nextHeight = getNextHeight(blockHashCheckpoints, startHeight, startTimestamp);
+
+    if (nextHeight && *nextHeight >= startHeight)
+    {
+        const auto range = findRange(*nextHeight);
+
+        bool continuesRange = range != m_ranges.end();
+
+        /* The wallet's block must be part of the same chain as the blocks
+           after it - either in the range, or the anchor it starts from */
+        if (continuesRange && !blockHashCheckpoints.empty() && range->first == *nextHeight)
+        {
+            const auto anchor = m_anchors.find(*nextHeight - 1);
+
+            continuesRange = anchor != m_anchors.end() && anchor->second == blockHashCheckpoints.front();
+        }
+
+        if (continuesRange)
+        {
+            std::vector<WalletTypes::WalletBlockInfo> blocks;
+
+            for (auto it = m_blocks.lower_bound(*nextHeight);
+                 it != m_blocks.end() && it->first <= range->second && blocks.size() < blockCount;
+                 it++)
+            {
+                blocks.push_back(it->second);
+            }
+
+            if (!blocks.empty())
+            {
+                Logger::logger.log(
+                    "Fetched " + std::to_string(blocks.size()) + " blocks from shared block cache",
+                    Logger::DEBUG,
+                    {Logger::SYNC});
+
+                return WalletSyncData {true, blocks, std::nullopt};
+            }
+        }
+    }
+
+    /* Nothing stored after the wallet's block. If the daemon recently told us
+       that block is the top block, pass that on. */
+    if (!blockHashCheckpoints.empty() && m_syncedTopBlock && m_syncedTopBlock->hash == blockHashCheckpoints.front()
+        && std::chrono::steady_clock::now() - m_syncedAt < SYNCED_RESPONSE_LIFETIME)
+    {
+        return WalletSyncData {true, {}, m_syncedTopBlock};
+    }
+
+    return std::nullopt;
+}
+
+void SharedBlockCache::store(
+    const std::vector<Crypto::Hash> &blockHashCheckpoints,
+    const uint64_t startHeight,
+    const uint64_t startTimestamp,
+    const WalletSyncData &data)
+{
+    const auto &[success, blocks, topBlock] = data;
+
+    if (!success)
+    {
+        return;
+    }
+
+    if (blocks.empty())
+    {
+        if (topBlock)
+        {
+            m_syncedTopBlock = topBlock;
+            m_syncedAt = std::chrono::steady_clock::now();
+        }
+
+        return;
+    }
+
+    /* Work this out before we change anything */
+    const auto nextHeight = getNextHeight(blockHashCheckpoints, startHeight, startTimestamp);
+
+    /* If any block differs from the one we have at that height, the chain
+       has forked, and everything we have from there on is stale */
+    for (const auto &block : blocks)
+    {
+        std::optional<Crypto::Hash> storedHash;
+
+        if (const auto it = m_blocks.find(block.blockHeight); it != m_blocks.end())
+        {
+            storedHash = it->second.blockHash;
+        }
+        else if (const auto it = m_anchors.find(block.blockHeight); it != m_anchors.end())
+        {
+            storedHash = it->second;
+        }
+
+        if (storedHash && *storedHash != block.blockHash)
+        {
+            Logger::logger.log(
+                "Shared block cache detected fork at height " + std::to_string(block.blockHeight),
+                Logger::DEBUG,
+                {Logger::SYNC});
+
+            removeFrom(block.blockHeight);
+
+            break;
+        }
+    }
+
+    uint64_t firstHeight = blocks.front().blockHeight;
+
+    const uint64_t lastHeight = blocks.back().blockHeight;
+
+    /* Whether the blocks carry on from the wallet's most recent block */
+    bool continuesFromWallet = false;
+
+    if (nextHeight && blockHashCheckpoints.empty())
+    {
+        /* A new wallet gets everything from the start height, even if the
+           first blocks had nothing to return */
+        firstHeight = *nextHeight;
+    }
+    else if (nextHeight && *nextHeight == firstHeight)
+    {
+        continuesFromWallet = true;
+
+        if (m_blocks.find(firstHeight - 1) == m_blocks.end())
+        {
+            m_anchors[firstHeight - 1] = blockHashCheckpoints.front();
+            m_heights[blockHashCheckpoints.front()] = firstHeight - 1;
+        }
+    }
+
+    for (const auto &block : blocks)
+    {
+        const auto [it, inserted] = m_blocks.try_emplace(block.blockHeight, block);
+
+        /* Same block as we had, since we removed any that differed above */
+        if (!inserted)
+        {
+            continue;
+        }
+
+        m_memoryUsage += block.memoryUsage();
+
+        m_heights[block.blockHash] = block.blockHeight;
+    }
+
+    uint64_t rangeFirst = firstHeight;
+    uint64_t rangeLast = lastHeight;
+
+    const auto continuingAnchor = m_anchors.find(lastHeight);
+
+    /* Merge with any ranges we overlap, or that we know are the same chain
+       as us, since they carry on from one another */
+    for (auto it = m_ranges.begin(); it != m_ranges.end();)
+    {
+        const auto [first, last] = *it;
+
+        const bool overlaps = first <= lastHeight && last >= firstHeight;
+
+        const bool continuesRange = continuesFromWallet && last + 1 == firstHeight;
+
+        const bool rangeContinues = first == lastHeight + 1 && continuingAnchor != m_anchors.end()
+                                    && continuingAnchor->second == blocks.back().blockHash;
+
+        if (overlaps || continuesRange || rangeContinues)
+        {
+            rangeFirst = std::min(rangeFirst, first);
+            rangeLast = std::max(rangeLast, last);
+
+            it = m_ranges.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    m_ranges[rangeFirst] = rangeLast;
+
+    /* We know of newer blocks now */
+    m_syncedTopBlock.reset();
+
+    evict();
+}
+
+void SharedBlockCache::removeFrom(const uint64_t height)
+{
+    for (auto it = m_blocks.lower_bound(height); it != m_blocks.end();)
+    {
+        m_memoryUsage -= it->second.memoryUsage();
+        m_heights.erase(it->second.blockHash);
+
+        it = m_blocks.erase(it);
+    }
+
+    for (auto it = m_anchors.lower_bound(height); it != m_anchors.end();)
+    {
+        m_heights.erase(it->second);
+
+        it = m_anchors.erase(it);
+    }
+
+    for (auto it = m_ranges.begin(); it != m_ranges.end();)
+    {
+        if (it->first >= height)
+        {
+            it = m_ranges.erase(it);
+        }
+        else
+        {
+            it->second = std::min(it->second, height - 1);
+            it++;
+        }
+    }
+}
+
+void SharedBlockCache::evict()
+{
+    while (m_memoryUsage > m_memoryLimit && !m_blocks.empty())
+    {
+        const auto lowest = m_blocks.begin();
+
+        const uint64_t height = lowest->first;
+        const Crypto::Hash hash = lowest->second.blockHash;
+
+        m_memoryUsage -= lowest->second.memoryUsage();
+        m_blocks.erase(lowest);
+
+        /* The ranges these were for no longer reach down to them */
+        for (auto it = m_anchors.begin(); it != m_anchors.end() && it->first < height;)
+        {
+            m_heights.erase(it->second);
+
+            it = m_anchors.erase(it);
+        }
+
+        for (auto it = m_ranges.begin(); it != m_ranges.end() && it->second < height;)
+        {
+            it = m_ranges.erase(it);
+        }
+
+        const auto range = findRange(height);
+
+        /* The rest of the range starts after the removed block, which we
+           keep the hash of so wallets at that block can continue from it */
+        if (range != m_ranges.end() && range->second > height)
+        {
+            const uint64_t last = range->second;
+
+            m_ranges.erase(range);
+            m_ranges[height + 1] = last;
+
+            m_anchors[height] = hash;
+        }
+        else
+        {
+            if (range != m_ranges.end())
+            {
+                m_ranges.erase(range);
+            }
+
+            m_heights.erase(hash);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "WalletTypes.h"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+/* Shares the blocks downloaded from the daemon between many wallets synced
+   in the same process, so each block range is only downloaded and parsed
+   once, no matter how many wallets need it.
+
+   Each daemon response is stored as a run of blocks, along with the range
+   of heights it covers. A wallet's request is answered from the cache if
+   its most recent block hash is in a stored run, and there are blocks
+   after it in the same run - since the run is one chain, those are the
+   blocks the daemon would have returned. Otherwise, the request is passed
+   to the daemon, and the response stored for the next wallet. Identical
+   requests made at the same time share one daemon request.
+
+   On a fork, the blocks the daemon returns replace any stored blocks at
+   the same heights. Wallets still on the orphaned chain no longer match
+   the cache, so they ask the daemon, which rewinds them as usual. */
+class SharedBlockCache
+{
+  public:
+    typedef std::tuple<bool, std::vector<WalletTypes::WalletBlockInfo>, std::optional<WalletTypes::TopBlock>>
+        WalletSyncData;
+
+    //////////////////
+    /* Constructors */
+    //////////////////
+
+    SharedBlockCache(const bool skipCoinbaseTransactions, const size_t memoryLimit = DEFAULT_MEMORY_LIMIT);
+
+    /////////////////////////////
+    /* Public member functions */
+    /////////////////////////////
+
+    /* Takes the same parameters as the /getwalletsyncdata request.
+       fetchFromDaemon is called to make the request if the cache can't
+       answer it. */
+    WalletSyncData getWalletSyncData(
+        const std::vector<Crypto::Hash> &blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const bool skipCoinbaseTransactions,
+        const uint64_t blockCount,
+        const std::function<WalletSyncData()> &fetchFromDaemon);
+
+    /* Approximate memory used by the stored blocks */
+    size_t memoryUsage() const;
+
+    /* 512MB */
+    static const size_t DEFAULT_MEMORY_LIMIT = 1024 * 1024 * 512;
+
+  private:
+    //////////////////////////////
+    /* Private member functions */
+    //////////////////////////////
+
+    /* Height of the block with this hash, if it's part of a stored run */
+    std::optional<uint64_t> findHeight(const Crypto::Hash &hash) const;
+
+    /* The stored run containing this height, if any */
+    std::map<uint64_t, uint64_t>::const_iterator findRange(const uint64_t height) const;
+
+    /* The first height the daemon would return blocks from for this
+       request, if we know it without asking the daemon */
+    std::optional<uint64_t> getNextHeight(
+        const std::vector<Crypto::Hash> &blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp) const;
+
+    std::optional<WalletSyncData> lookup(
+        const std::vector<Crypto::Hash> &blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const uint64_t blockCount) const;
+
+    void store(
+        const std::vector<Crypto::Hash> &blockHashCheckpoints,
+        const uint64_t startHeight,
+        const uint64_t startTimestamp,
+        const WalletSyncData &data);
+
+    /* Removes everything stored at this height or above */
+    void removeFrom(const uint64_t height);
+
+    /* Removes the lowest blocks until we're under the memory limit */
+    void evict();
+
+    //////////////////////////////
+    /* Private member variables */
+    //////////////////////////////
+
+    /* The skipCoinbaseTransactions value the stored blocks were requested
+       with */
+    const bool m_skipCoinbaseTransactions;
+
+    const size_t m_memoryLimit;
+
+    size_t m_memoryUsage = 0;
+
+    /* The stored blocks, by height */
+    std::map<uint64_t, WalletTypes::WalletBlockInfo> m_blocks;
+
+    /* Ranges of heights, first to last inclusive, which we have every block
+       the daemon returns for. Each range is a single chain. */
+    std::map<uint64_t, uint64_t> m_ranges;
+
+    /* Hashes of the blocks just below a range, which we no longer store
+       but can still continue from */
+    std::map<uint64_t, Crypto::Hash> m_anchors;
+
+    /* Heights of the stored blocks and anchors, by hash */
+    std::unordered_map<Crypto::Hash, uint64_t> m_heights;
+
+    /* The top block, the last time the daemon told us a wallet was synced */
+    std::optional<WalletTypes::TopBlock> m_syncedTopBlock;
+
+    std::chrono::steady_clock::time_point m_syncedAt;
+
+    /* Requests currently being made to the daemon */
+    std::unordered_map<std::string, std::shared_future<WalletSyncData>> m_pendingRequests;
+
+    mutable std::mutex m_mutex;
+};
@@ -22,7 +22,8 @@ namespace CryptoNote
             INTERNAL_NODE_ERROR,
             REQUEST_ERROR,
             CONNECT_ERROR,
-            TIMEOUT
+            TIMEOUT,
+            NOT_SUPPORTED
         };
 
         // custom category:
@@ -61,6 +62,8 @@ namespace CryptoNote
                         return "Can't connect to daemon";
                     case TIMEOUT:
                         return "Operation timed out";
+                    case NOT_SUPPORTED:
+                        return "Request is not supported by the daemon";
                     default:
                         return "Unknown error";
                 }
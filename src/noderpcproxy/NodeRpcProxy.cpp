@@ -55,6 +55,21 @@ namespace CryptoNote
             return std::error_code();
         }
 
+        std::error_code interpretHttpStatus(const HttpResponse::HTTP_STATUS status)
+        {
+            switch (status)
+            {
+                case HttpResponse::STATUS_400:
+                    return make_error_code(NodeError::REQUEST_ERROR);
+                case HttpResponse::STATUS_404:
+                    return make_error_code(NodeError::NOT_SUPPORTED);
+                case HttpResponse::STATUS_500:
+                    return make_error_code(NodeError::INTERNAL_NODE_ERROR);
+                default:
+                    return make_error_code(NodeError::NETWORK_ERROR);
+            }
+        }
+
     } // namespace
 
     NodeRpcProxy::NodeRpcProxy(
@@ -119,6 +134,8 @@ namespace CryptoNote
         lastLocalBlockHeaderInfo.difficulty = 0;
         lastLocalBlockHeaderInfo.reward = 0;
         m_knownTxs.clear();
+        m_poolVersion = 0;
+        m_binaryEndpointsSupported = true;
     }
 
     void NodeRpcProxy::init(const INode::Callback &callback)
@@ -187,12 +204,19 @@ namespace CryptoNote
 
             getFeeInfo();
 
-            contextGroup.spawn([this]() {
+            /* Status long polls get their own connection, so they don't hold
+               up other requests while the node has nothing to tell us */
+            HttpClient statusClient(dispatcher, m_nodeHost, m_nodePort);
+
+            contextGroup.spawn([this, &statusClient]() {
                 Timer pullTimer(*m_dispatcher);
                 while (!m_stop)
                 {
                     updateNodeStatus();
-                    if (!m_stop)
+
+                    /* Fall back to polling if the node doesn't support
+                       /waitforchanges, or the request failed */
+                    if (!m_stop && !waitForNodeStatusChange(statusClient) && !m_stop)
                     {
                         pullTimer.sleep(std::chrono::milliseconds(m_pullInterval));
                     }
@@ -225,6 +249,42 @@ namespace CryptoNote
         }
     }
 
+    /* Asks the node to hold our request open until its top block or pool
+       differs from what we last saw, so we only refresh when something has
+       actually changed */
+    bool NodeRpcProxy::waitForNodeStatusChange(HttpClient &statusClient)
+    {
+        CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::request req = AUTO_VAL_INIT(req);
+        CryptoNote::COMMAND_RPC_WAIT_FOR_CHANGES::response rsp = AUTO_VAL_INIT(rsp);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            req.topBlockHash = lastLocalBlockHeaderInfo.hash;
+        }
+
+        req.poolVersion = m_poolVersion;
+        req.timeout = CryptoNote::RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT;
+
+        try
+        {
+            invokeJsonCommand(statusClient, "/waitforchanges", "POST", req, rsp);
+        }
+        catch (const std::exception &e)
+        {
+            m_logger(TRACE) << "/waitforchanges request failed: " << e.what();
+            return false;
+        }
+
+        if (rsp.status != CORE_RPC_STATUS_OK)
+        {
+            return false;
+        }
+
+        m_poolVersion = rsp.poolVersion;
+
+        return true;
+    }
+
     bool NodeRpcProxy::updatePoolStatus()
     {
         std::vector<Crypto::Hash> knownTxs = getKnownTxsVector();
@@ -636,7 +696,7 @@ namespace CryptoNote
         req.outs_count = outsCount;
 
         m_logger(TRACE) << "Send getrandom_outs request";
-        std::error_code ec = jsonCommand("/getrandom_outs", "POST", req, rsp);
+        std::error_code ec = binaryOrJsonCommand("/getrandom_outs", req, rsp);
         if (!ec)
         {
             m_logger(TRACE) << "getrandom_outs complete";
@@ -690,7 +750,7 @@ namespace CryptoNote
 
         m_logger(TRACE) << "Send get_global_indexes_for_range request";
 
-        std::error_code ec = jsonCommand("/get_global_indexes_for_range", "POST", req, rsp);
+        std::error_code ec = binaryOrJsonCommand("/get_global_indexes_for_range", req, rsp);
 
         if (!ec)
         {
@@ -750,7 +810,7 @@ namespace CryptoNote
         req.timestamp = timestamp;
 
         m_logger(TRACE) << "Send queryblockslite request, timestamp " << req.timestamp;
-        std::error_code ec = jsonCommand("/queryblockslite", "POST", req, rsp);
+        std::error_code ec = binaryOrJsonCommand("/queryblockslite", req, rsp);
         if (ec)
         {
             m_logger(TRACE) << "queryblockslite failed: " << ec << ", " << ec.message();
@@ -807,7 +867,7 @@ namespace CryptoNote
         m_logger(TRACE) << "Send getwalletsyncdata request, start timestamp: " << req.startTimestamp
                         << ", start height: " << req.startHeight;
 
-        std::error_code ec = jsonCommand("/getwalletsyncdata", "POST", req, rsp);
+        std::error_code ec = binaryOrJsonCommand("/getwalletsyncdata", req, rsp);
         if (ec)
         {
             m_logger(TRACE) << "getwalletsyncdata failed: " << ec << ", " << ec.message();
@@ -835,7 +895,7 @@ namespace CryptoNote
         req.knownTxsIds = knownPoolTxIds;
 
         m_logger(TRACE) << "Send get_pool_changes_lite request, tailBlockId " << req.tailBlockId;
-        std::error_code ec = jsonCommand("/get_pool_changes_lite", "POST", req, rsp);
+        std::error_code ec = binaryOrJsonCommand("/get_pool_changes_lite", req, rsp);
 
         if (ec)
         {
@@ -929,6 +989,7 @@ namespace CryptoNote
 
         try
         {
+            m_logger(TRACE) << "Send " << url << " binary request";
             EventLock eventLock(*m_httpEvent);
             invokeBinaryCommand(*m_httpClient, url, req, res);
             ec = interpretResponseStatus(res.status);
@@ -937,14 +998,56 @@ namespace CryptoNote
         {
             ec = make_error_code(NodeError::CONNECT_ERROR);
         }
+        catch (const HttpStatusException &e)
+        {
+            ec = interpretHttpStatus(e.getStatus());
+
+            /* The binary endpoints give the reason for a failure in the
+               status field of a KV binary body */
+            STATUS_STRUCT error;
+
+            if (loadFromBinaryKeyValue(error, e.getBody()) && !error.status.empty())
+            {
+                m_logger(TRACE) << url << " binary request error: " << error.status;
+            }
+        }
         catch (const std::exception &)
         {
             ec = make_error_code(NodeError::NETWORK_ERROR);
         }
 
+        if (ec)
+        {
+            m_logger(TRACE) << url << " binary request failed: " << ec << ", " << ec.message();
+        }
+        else
+        {
+            m_logger(TRACE) << url << " binary request complete";
+        }
+
         return ec;
     }
 
+    template<typename Request, typename Response>
+    std::error_code NodeRpcProxy::binaryOrJsonCommand(const std::string &url, const Request &req, Response &res)
+    {
+        if (m_binaryEndpointsSupported)
+        {
+            const std::error_code ec = binaryCommand(url + ".bin", req, res);
+
+            if (ec != make_error_code(NodeError::NOT_SUPPORTED))
+            {
+                return ec;
+            }
+
+            m_logger(DEBUGGING) << "Daemon does not support " << url << ".bin, using JSON endpoints instead";
+
+            m_binaryEndpointsSupported = false;
+        }
+
+        return jsonCommand(url, "POST", req, res);
+    }
+
     template<typename Request, typename Response>
     std::error_code NodeRpcProxy::jsonCommand(const std::string &url, const std::string &method, const Request &req, Response &res)
     {
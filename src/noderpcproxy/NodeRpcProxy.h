@@ -154,6 +154,8 @@ namespace CryptoNote
 
         void updateNodeStatus();
 
+        bool waitForNodeStatusChange(HttpClient &statusClient);
+
         void updateBlockchainStatus();
 
         bool updatePoolStatus();
@@ -215,6 +217,11 @@ namespace CryptoNote
         template<typename Request, typename Response>
         std::error_code binaryCommand(const std::string &url, const Request &req, Response &res);
 
+        /* Uses the KV binary variant of the endpoint (url + ".bin") if the
+           daemon supports it, falling back to JSON if not */
+        template<typename Request, typename Response>
+        std::error_code binaryOrJsonCommand(const std::string &url, const Request &req, Response &res);
+
         template<typename Request, typename Response>
         std::error_code jsonCommand(const std::string &url, const std::string &method, const Request &req, Response &res);
 
@@ -275,6 +282,12 @@ namespace CryptoNote
         // protect it with mutex if decided to add worker threads
         std::unordered_set<Crypto::Hash> m_knownTxs;
 
+        /* The pool version the node last reported to /waitforchanges */
+        uint64_t m_poolVersion = 0;
+
+        /* Older daemons don't have the .bin endpoints */
+        bool m_binaryEndpointsSupported = true;
+
         bool m_connected;
 
         std::string m_fee_address;
@@ -8,6 +8,9 @@
 #include "common/StringTools.h"
 #include "crypto/hash.h"
 #include "p2p/PendingLiteBlock.h"
+#include "p2p/RollingBloomFilter.h"
+
+#include <config/CryptoNoteConfig.h>
 
 #include <boost/uuid/uuid.hpp>
 #include <list>
@@ -43,6 +46,11 @@ namespace CryptoNote
         std::unordered_set<Crypto::Hash> m_requested_objects;
         uint32_t m_remote_blockchain_height = 0;
         uint32_t m_last_response_height = 0;
+
+        /* Transactions the peer has sent or announced to us, or we have to
+           them, which we don't need to relay to them again */
+        RollingBloomFilter m_known_transactions {P2P_KNOWN_TRANSACTIONS_FILTER_SIZE,
+                                                 P2P_KNOWN_TRANSACTIONS_FILTER_FALSE_POSITIVE_RATE};
     };
 
     inline std::string get_protocol_state_string(CryptoNoteConnectionContext::state s)
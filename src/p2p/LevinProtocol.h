@@ -82,8 +82,7 @@ namespace CryptoNote
         {
             try
             {
-                Common::MemoryInputStream stream(buf.data(), buf.size());
-                KVBinaryInputStreamSerializer serializer(stream);
+                KVBinaryInputStreamSerializer serializer(buf.data(), buf.size());
                 serialize(value, serializer);
             }
             catch (std::exception &)
@@ -240,7 +240,8 @@ namespace CryptoNote
         // intervals
         // m_peer_handshake_idle_maker_interval(CryptoNote::P2P_DEFAULT_HANDSHAKE_INTERVAL),
         m_connections_maker_interval(1),
-        m_peerlist_store_interval(60 * 30, false)
+        m_peerlist_store_interval(60 * 30, false),
+        m_slow_peer_rotation_interval(P2P_SLOW_PEER_ROTATION_INTERVAL, false)
     {
     }
 
@@ -286,6 +287,11 @@ namespace CryptoNote
             return 0;
         }
 
+        if (cmd.command == NOTIFY_RESPONSE_GET_OBJECTS::ID || cmd.command == NOTIFY_RESPONSE_CHAIN_ENTRY::ID)
+        {
+            record_sync_response(cmd, ctx);
+        }
+
         switch (cmd.command)
         {
             INVOKE_HANDLER(COMMAND_HANDSHAKE, &NodeServer::handle_handshake)
@@ -707,6 +713,7 @@ namespace CryptoNote
                 && (conn.m_state == CryptoNoteConnectionContext::state_normal
                     || conn.m_state == CryptoNoteConnectionContext::state_idle))
             {
+                conn.timedSyncSentAt = P2pConnectionContext::Clock::now();
                 conn.pushMessage(P2pMessage(P2pMessage::COMMAND, COMMAND_TIMED_SYNC::ID, cmdBuf));
             }
         });
@@ -732,8 +739,18 @@ namespace CryptoNote
         if (!context.m_is_income)
         {
             m_peerlist.set_peer_just_seen(context.peerId, context.m_remote_ip, context.m_remote_port);
+
+            if (context.timedSyncSentAt)
+            {
+                m_peerlist.record_peer_rtt(
+                    NetworkAddress {context.m_remote_ip, context.m_remote_port},
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                        P2pConnectionContext::Clock::now() - *context.timedSyncSentAt));
+            }
         }
 
+        context.timedSyncSentAt.reset();
+
         if (!m_payload_handler.process_payload_sync_data(rsp.payload_data, context, false))
         {
             return false;
@@ -830,6 +847,7 @@ namespace CryptoNote
             catch (System::InterruptedException &)
             {
                 logger(DEBUGGING) << "Connection timed out";
+                m_peerlist.record_peer_failure(na);
                 return false;
             }
 
@@ -859,12 +877,14 @@ namespace CryptoNote
                 if (!handshakeContext.get())
                 {
                     logger(DEBUGGING) << "Failed to HANDSHAKE with peer " << na;
+                    m_peerlist.record_peer_failure(na);
                     return false;
                 }
             }
             catch (System::InterruptedException &)
             {
                 logger(DEBUGGING) << "Handshake timed out";
+                m_peerlist.record_peer_failure(na);
                 return false;
             }
 
@@ -902,6 +922,7 @@ namespace CryptoNote
         catch (const std::exception &e)
         {
             logger(DEBUGGING) << "Connection to " << na << " failed: " << e.what();
+            m_peerlist.record_peer_failure(na);
         }
 
         return false;
@@ -921,6 +942,9 @@ namespace CryptoNote
 
         std::set<size_t> tried_peers;
 
+        /* The usable peer drawn before the current one */
+        std::optional<PeerlistEntry> candidate;
+
         size_t try_count = 0;
         size_t rand_count = 0;
         while (rand_count < (max_random_index + 1) * 3 && try_count < 10 && !m_stop)
@@ -948,26 +972,56 @@ namespace CryptoNote
                 return false;
             }
 
-            ++try_count;
+            if (is_peer_used(pe) || m_peerlist.is_peer_backed_off(pe.adr))
+            {
+                ++try_count;
+                continue;
+            }
 
-            if (is_peer_used(pe))
+            /* Compare each peer with the one drawn before it, and connect to
+               whichever has served us faster. Recently seen peers are still
+               drawn most often, but a slow or unreliable one loses out.
+               Drawing the first one to compare with isn't an attempt. */
+            if (!candidate)
             {
+                candidate = pe;
                 continue;
             }
 
-            logger(DEBUGGING) << "Selected peer: " << pe.id << " " << pe.adr << " [white=" << use_white_list
-                              << "] last_seen: "
-                              << (pe.last_seen ? Common::timeIntervalToString(time(NULL) - pe.last_seen) : "never");
+            ++try_count;
 
-            if (!try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list))
+            if (m_peerlist.get_peer_cost(candidate->adr) < m_peerlist.get_peer_cost(pe.adr))
             {
-                continue;
+                std::swap(pe, *candidate);
             }
 
-            return true;
+            if (connect_to_selected_peer(pe, use_white_list))
+            {
+                return true;
+            }
         }
+
+        /* Only one usable peer was drawn, or the last one drawn lost out */
+        if (candidate && !m_stop)
+        {
+            return connect_to_selected_peer(*candidate, use_white_list);
+        }
+
         return false;
     }
+
+    bool NodeServer::connect_to_selected_peer(const PeerlistEntry &pe, bool use_white_list)
+    {
+        const auto performance = m_peerlist.get_peer_performance(pe.adr);
+
+        logger(DEBUGGING) << "Selected peer: " << pe.id << " " << pe.adr << " [white=" << use_white_list
+                          << "] last_seen: "
+                          << (pe.last_seen ? Common::timeIntervalToString(time(NULL) - pe.last_seen) : "never")
+                          << ", rtt: " << performance.rtt << "ms, speed: " << performance.bytesPerSecond
+                          << " B/s, failures: " << performance.failures;
+
+        return try_to_connect_and_handshake_with_new_peer(pe.adr, false, pe.last_seen, use_white_list);
+    }
     //-----------------------------------------------------------------------------------
 
     bool NodeServer::connections_maker()
@@ -1090,6 +1144,8 @@ namespace CryptoNote
         {
             m_connections_maker_interval.call(std::bind(&NodeServer::connections_maker, this));
             m_peerlist_store_interval.call(std::bind(&NodeServer::store_config, this));
+            m_slow_peer_rotation_interval.call(std::bind(&NodeServer::rotate_slow_sync_peers, this));
+            m_payload_handler.flushTransactionRelays();
         }
         catch (std::exception &e)
         {
@@ -1098,6 +1154,113 @@ namespace CryptoNote
         return true;
     }
 
+    //-----------------------------------------------------------------------------------
+    bool NodeServer::rotate_slow_sync_peers()
+    {
+        std::vector<P2pConnectionContext *> syncPeers;
+
+        for (auto &kv : m_connections)
+        {
+            if (kv.second.m_state == CryptoNoteConnectionContext::state_synchronizing)
+            {
+                syncPeers.push_back(&kv.second);
+            }
+        }
+
+        /* Nobody to carry on syncing from if we drop one */
+        if (syncPeers.size() < 2)
+        {
+            return true;
+        }
+
+        const auto now = P2pConnectionContext::Clock::now();
+
+        P2pConnectionContext *fastest = nullptr;
+        P2pConnectionContext *slowest = nullptr;
+
+        for (auto *ctx : syncPeers)
+        {
+            if (ctx->syncRequestSentAt
+                && now - *ctx->syncRequestSentAt > std::chrono::seconds(P2P_SYNC_PEER_STALL_TIMEOUT))
+            {
+                logger(DEBUGGING) << *ctx << "Sync peer hasn't answered in " << P2P_SYNC_PEER_STALL_TIMEOUT
+                                  << " seconds, dropping connection";
+
+                if (!ctx->m_is_income)
+                {
+                    m_peerlist.record_peer_failure(NetworkAddress {ctx->m_remote_ip, ctx->m_remote_port});
+                }
+
+                safeInterrupt(*ctx);
+
+                return true;
+            }
+
+            if (ctx->syncBytesPerSecond == 0)
+            {
+                continue;
+            }
+
+            if (!fastest || ctx->syncBytesPerSecond > fastest->syncBytesPerSecond)
+            {
+                fastest = ctx;
+            }
+
+            if (!slowest || ctx->syncBytesPerSecond < slowest->syncBytesPerSecond)
+            {
+                slowest = ctx;
+            }
+        }
+
+        if (fastest && slowest != fastest
+            && slowest->syncBytesPerSecond * P2P_SLOW_SYNC_PEER_RATIO < fastest->syncBytesPerSecond)
+        {
+            logger(DEBUGGING) << *slowest << "Sync peer is sending blocks at " << slowest->syncBytesPerSecond
+                              << " B/s, fastest peer is at " << fastest->syncBytesPerSecond
+                              << " B/s, dropping connection";
+
+            safeInterrupt(*slowest);
+        }
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    void NodeServer::record_sync_response(const LevinProtocol::Command &cmd, P2pConnectionContext &context)
+    {
+        if (!context.syncRequestSentAt)
+        {
+            return;
+        }
+
+        const auto elapsed = std::max<int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                P2pConnectionContext::Clock::now() - *context.syncRequestSentAt)
+                .count(),
+            1);
+
+        context.syncRequestSentAt.reset();
+
+        /* Chain entries are too small to say much about the peer's speed */
+        if (cmd.command != NOTIFY_RESPONSE_GET_OBJECTS::ID)
+        {
+            return;
+        }
+
+        const uint64_t bytesPerSecond = (cmd.buf.size() * 1000) / elapsed;
+
+        context.syncBytesPerSecond = context.syncBytesPerSecond
+                                         ? (context.syncBytesPerSecond * 3 + bytesPerSecond) / 4
+                                         : std::max<uint64_t>(bytesPerSecond, 1);
+
+        /* An incoming connection's port isn't the one it listens on */
+        if (!context.m_is_income)
+        {
+            m_peerlist.record_peer_throughput(
+                NetworkAddress {context.m_remote_ip, context.m_remote_port}, bytesPerSecond);
+        }
+    }
+
     //-----------------------------------------------------------------------------------
     bool NodeServer::fix_time_delta(std::list<PeerlistEntry> &local_peerlist, time_t local_time, int64_t &delta)
     {
@@ -1291,6 +1454,11 @@ namespace CryptoNote
             return false;
         }
 
+        if (command == NOTIFY_REQUEST_GET_OBJECTS::ID || command == NOTIFY_REQUEST_CHAIN::ID)
+        {
+            it->second.syncRequestSentAt = P2pConnectionContext::Clock::now();
+        }
+
         it->second.pushMessage(P2pMessage(P2pMessage::NOTIFY, command, buffer));
 
         return true;
@@ -1318,9 +1486,11 @@ namespace CryptoNote
         {
             COMMAND_PING::request req;
             COMMAND_PING::response rsp;
+            P2pConnectionContext::TimePoint sentAt;
             System::Context<> pingContext(m_dispatcher, [&] {
                 System::TcpConnector connector(m_dispatcher);
                 auto connection = connector.connect(System::Ipv4Address(ip), static_cast<uint16_t>(port));
+                sentAt = P2pConnectionContext::Clock::now();
                 LevinProtocol(connection).invoke(COMMAND_PING::ID, req, rsp);
             });
 
@@ -1339,6 +1509,10 @@ namespace CryptoNote
                                   << ":" << port << ", hsh_peer_id=" << peerId << ", rsp.peer_id=" << rsp.peer_id;
                 return false;
             }
+
+            m_peerlist.record_peer_rtt(
+                NetworkAddress {actual_ip, port},
+                std::chrono::duration_cast<std::chrono::milliseconds>(P2pConnectionContext::Clock::now() - sentAt));
         }
         catch (std::exception &e)
         {
@@ -90,6 +90,15 @@ namespace CryptoNote
 
         System::TcpConnection connection;
 
+        /* When we sent the timed sync we're waiting on a reply to */
+        std::optional<TimePoint> timedSyncSentAt;
+
+        /* When we sent the block or chain request we're waiting on a reply to */
+        std::optional<TimePoint> syncRequestSentAt;
+
+        /* Smoothed rate the peer has sent us blocks at on this connection */
+        uint64_t syncBytesPerSecond = 0;
+
         P2pConnectionContext(
             System::Dispatcher &dispatcher,
             std::shared_ptr<Logging::ILogger> log,
@@ -108,6 +117,9 @@ namespace CryptoNote
             context(ctx.context),
             peerId(ctx.peerId),
             connection(std::move(ctx.connection)),
+            timedSyncSentAt(ctx.timedSyncSentAt),
+            syncRequestSentAt(ctx.syncRequestSentAt),
+            syncBytesPerSecond(ctx.syncBytesPerSecond),
             logger(ctx.logger.getLogger(), "node_server"),
             queueEvent(std::move(ctx.queueEvent)),
             stopped(std::move(ctx.stopped))
@@ -274,6 +286,13 @@ namespace CryptoNote
 
         bool idle_worker();
 
+        /* Drops a sync peer which has stalled, or is far slower than the
+           others, so the connections maker can replace it */
+        bool rotate_slow_sync_peers();
+
+        /* Measures how fast the peer answered our last block request */
+        void record_sync_response(const LevinProtocol::Command &cmd, P2pConnectionContext &context);
+
         bool handle_remote_peerlist(
             const std::list<PeerlistEntry> &peerlist,
             time_t local_time,
@@ -289,6 +308,8 @@ namespace CryptoNote
 
         bool make_new_connection_from_peerlist(bool use_white_list);
 
+        bool connect_to_selected_peer(const PeerlistEntry &pe, bool use_white_list);
+
         bool try_to_connect_and_handshake_with_new_peer(
             const NetworkAddress &na,
             bool just_take_peerlist = false,
@@ -389,6 +410,8 @@ namespace CryptoNote
 
         OnceInInterval m_peerlist_store_interval;
 
+        OnceInInterval m_slow_peer_rotation_interval;
+
         System::Timer m_timedSyncTimer;
 
         std::string m_bind_ip;
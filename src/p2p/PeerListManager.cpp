@@ -7,23 +7,68 @@
 #include "serialization/SerializationOverloads.h"
 
 #include <algorithm>
+#include <functional>
 #include <system/Ipv4Address.h>
 #include <time.h>
 
+namespace
+{
+    /* Estimates for peers we haven't measured */
+    const uint64_t UNKNOWN_PEER_RTT = 500; // milliseconds
+    const uint64_t UNKNOWN_PEER_BYTES_PER_SECOND = 256 * 1024;
+
+    /* The response size we estimate the cost of a peer for, roughly a batch
+       of blocks during sync */
+    const uint64_t REFERENCE_RESPONSE_SIZE = 1024 * 1024;
+
+    /* How long we wait before retrying a peer after its first failure, and
+       the most we'll wait after several */
+    const uint64_t FAILURE_BACKOFF = 60; // seconds
+    const uint64_t MAX_FAILURE_BACKOFF = 60 * 60; // seconds
+
+    uint64_t addressKey(const NetworkAddress &addr)
+    {
+        return (static_cast<uint64_t>(addr.ip) << 32) | addr.port;
+    }
+
+    /* Moves a quarter of the way towards the new measurement, so one unusual
+       reading doesn't outweigh the history */
+    uint64_t smooth(const uint64_t previous, const uint64_t measured)
+    {
+        if (previous == 0)
+        {
+            return measured;
+        }
+
+        return (previous * 3 + measured) / 4;
+    }
+} // namespace
+
 void PeerlistManager::serialize(CryptoNote::ISerializer &s)
 {
-    const uint8_t currentVersion = 1;
+    const uint8_t currentVersion = 2;
     uint8_t version = currentVersion;
 
     s(version, "version");
 
-    if (version != currentVersion)
+    if (version == 0 || version > currentVersion)
     {
         return;
     }
 
+    if (s.type() == CryptoNote::ISerializer::OUTPUT)
+    {
+        prune_performance();
+    }
+
     s(m_peers_white, "whitelist");
     s(m_peers_gray, "graylist");
+
+    /* Version 1 didn't store peer performance */
+    if (version >= 2)
+    {
+        s(m_performance, "performance");
+    }
 }
 
 void serialize(NetworkAddress &na, CryptoNote::ISerializer &s)
@@ -39,6 +84,14 @@ void serialize(PeerlistEntry &pe, CryptoNote::ISerializer &s)
     s(pe.last_seen, "last_seen");
 }
 
+void serialize(PeerPerformance &pp, CryptoNote::ISerializer &s)
+{
+    s(pp.rtt, "rtt");
+    s(pp.bytesPerSecond, "bytes_per_second");
+    s(pp.failures, "failures");
+    s(pp.lastFailure, "last_failure");
+}
+
 PeerlistManager::PeerlistManager():
     m_whitePeerlist(m_peers_white, CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT),
     m_grayPeerlist(m_peers_gray, CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT)
@@ -148,6 +201,12 @@ bool PeerlistManager::set_peer_just_seen(uint64_t peer, uint32_t ip, uint32_t po
 
 bool PeerlistManager::set_peer_just_seen(uint64_t peer, const NetworkAddress &addr)
 {
+    /* We're connected to it, so it's reachable again */
+    if (const auto it = m_performance.find(addressKey(addr)); it != m_performance.end())
+    {
+        it->second.failures = 0;
+    }
+
     try
     {
         // find in white list
@@ -256,6 +315,104 @@ bool PeerlistManager::append_with_peer_gray(const PeerlistEntry &newPeer)
     return false;
 }
 
+void PeerlistManager::record_peer_rtt(const NetworkAddress &addr, std::chrono::milliseconds rtt)
+{
+    auto &performance = m_performance[addressKey(addr)];
+
+    /* Zero means unmeasured */
+    performance.rtt = smooth(performance.rtt, std::max<uint64_t>(rtt.count(), 1));
+
+    prune_performance();
+}
+
+void PeerlistManager::record_peer_throughput(const NetworkAddress &addr, uint64_t bytesPerSecond)
+{
+    auto &performance = m_performance[addressKey(addr)];
+
+    performance.bytesPerSecond = smooth(performance.bytesPerSecond, std::max<uint64_t>(bytesPerSecond, 1));
+
+    prune_performance();
+}
+
+void PeerlistManager::record_peer_failure(const NetworkAddress &addr)
+{
+    auto &performance = m_performance[addressKey(addr)];
+
+    performance.failures++;
+    performance.lastFailure = time(nullptr);
+
+    prune_performance();
+}
+
+PeerPerformance PeerlistManager::get_peer_performance(const NetworkAddress &addr) const
+{
+    const auto it = m_performance.find(addressKey(addr));
+
+    if (it == m_performance.end())
+    {
+        return PeerPerformance();
+    }
+
+    return it->second;
+}
+
+bool PeerlistManager::is_peer_backed_off(const NetworkAddress &addr) const
+{
+    const auto performance = get_peer_performance(addr);
+
+    if (performance.failures == 0)
+    {
+        return false;
+    }
+
+    /* Stop doubling before we overflow */
+    const uint32_t doublings = std::min<uint32_t>(performance.failures - 1, 16);
+
+    const uint64_t backoff = std::min(FAILURE_BACKOFF << doublings, MAX_FAILURE_BACKOFF);
+
+    return static_cast<uint64_t>(time(nullptr)) < performance.lastFailure + backoff;
+}
+
+uint64_t PeerlistManager::get_peer_cost(const NetworkAddress &addr) const
+{
+    const auto performance = get_peer_performance(addr);
+
+    const uint64_t rtt = performance.rtt ? performance.rtt : UNKNOWN_PEER_RTT;
+
+    const uint64_t bytesPerSecond =
+        performance.bytesPerSecond ? performance.bytesPerSecond : UNKNOWN_PEER_BYTES_PER_SECOND;
+
+    const uint64_t cost = rtt + (REFERENCE_RESPONSE_SIZE * 1000) / bytesPerSecond;
+
+    /* Every failed connection in a row counts as another slow response */
+    return cost * (1 + performance.failures);
+}
+
+void PeerlistManager::prune_performance()
+{
+    /* Peers come and go from the gray list all the time, so only prune once
+       we've got more than the lists can hold */
+    if (m_performance.size() <= CryptoNote::P2P_LOCAL_WHITE_PEERLIST_LIMIT + CryptoNote::P2P_LOCAL_GRAY_PEERLIST_LIMIT)
+    {
+        return;
+    }
+
+    std::unordered_map<uint64_t, PeerPerformance> performance;
+
+    for (const auto &peers : {std::cref(m_peers_white), std::cref(m_peers_gray)})
+    {
+        for (const auto &peer : peers.get())
+        {
+            if (const auto it = m_performance.find(addressKey(peer.adr)); it != m_performance.end())
+            {
+                performance.insert(*it);
+            }
+        }
+    }
+
+    m_performance = std::move(performance);
+}
+
 Peerlist &PeerlistManager::getWhite()
 {
     return m_whitePeerlist;
@@ -4,11 +4,30 @@
 
 #pragma once
 
+#include <chrono>
 #include <config/CryptoNoteConfig.h>
 #include <list>
 #include <p2p/P2pProtocolTypes.h>
 #include <p2p/Peerlist.h>
 #include <serialization/ISerializer.h>
+#include <unordered_map>
+
+/* What we've measured of a peer when connected to it. Kept separately from
+   the peer list entries, since those are sent to other peers as is. */
+struct PeerPerformance
+{
+    /* Smoothed round trip time, in milliseconds. Zero if never measured. */
+    uint64_t rtt = 0;
+
+    /* Smoothed rate the peer sent us blocks at. Zero if never measured. */
+    uint64_t bytesPerSecond = 0;
+
+    /* Failed connections since we were last connected to the peer */
+    uint32_t failures = 0;
+
+    /* Timestamp of the last failed connection */
+    uint64_t lastFailure = 0;
+};
 
 class PeerlistManager
 {
@@ -51,6 +70,23 @@ class PeerlistManager
 
     bool is_ip_allowed(uint32_t ip) const;
 
+    void record_peer_rtt(const NetworkAddress &addr, std::chrono::milliseconds rtt);
+
+    void record_peer_throughput(const NetworkAddress &addr, uint64_t bytesPerSecond);
+
+    void record_peer_failure(const NetworkAddress &addr);
+
+    PeerPerformance get_peer_performance(const NetworkAddress &addr) const;
+
+    /* Whether the peer failed recently enough that we shouldn't try it yet.
+       The wait doubles with each failure in a row. */
+    bool is_peer_backed_off(const NetworkAddress &addr) const;
+
+    /* Estimated milliseconds for the peer to answer a block request, based
+       on what we've measured. Lower is better. Peers we know nothing about
+       get an average estimate, so they still get tried. */
+    uint64_t get_peer_cost(const NetworkAddress &addr) const;
+
     void trim_white_peerlist();
 
     void trim_gray_peerlist();
@@ -62,6 +98,9 @@ class PeerlistManager
     Peerlist &getGray();
 
   private:
+    /* Removes the performance of peers no longer in either list */
+    void prune_performance();
+
     std::string m_config_folder;
 
     bool m_allow_local_ip;
@@ -73,4 +112,7 @@ class PeerlistManager
     Peerlist m_whitePeerlist;
 
     Peerlist m_grayPeerlist;
+
+    /* Indexed by address, see addressKey() */
+    std::unordered_map<uint64_t, PeerPerformance> m_performance;
 };
@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "RollingBloomFilter.h"
+
+#include "crypto/random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace CryptoNote
+{
+    RollingBloomFilter::RollingBloomFilter(const size_t capacity, const double falsePositiveRate):
+        m_capacity(std::max<size_t>(capacity, 1)),
+        m_seed(Random::randomValue<uint64_t>())
+    {
+        /* The usual optimal sizes for a bloom filter holding the capacity */
+        const double ln2 = std::log(2.0);
+
+        m_bitCount = std::max<size_t>(
+            static_cast<size_t>(std::ceil(-(m_capacity * std::log(falsePositiveRate)) / (ln2 * ln2))), 64);
+
+        m_hashCount = std::max<size_t>(static_cast<size_t>(std::round(m_bitCount * ln2 / m_capacity)), 1);
+
+        m_current.resize(m_bitCount);
+    }
+
+    void RollingBloomFilter::insert(const Crypto::Hash &hash)
+    {
+        if (m_currentCount == m_capacity)
+        {
+            m_previous.swap(m_current);
+
+            m_current.assign(m_bitCount, false);
+
+            m_currentCount = 0;
+        }
+
+        for (size_t i = 0; i < m_hashCount; i++)
+        {
+            m_current[bitIndex(hash, i)] = true;
+        }
+
+        m_currentCount++;
+    }
+
+    bool RollingBloomFilter::contains(const Crypto::Hash &hash) const
+    {
+        bool inCurrent = true;
+        bool inPrevious = !m_previous.empty();
+
+        for (size_t i = 0; i < m_hashCount && (inCurrent || inPrevious); i++)
+        {
+            const size_t index = bitIndex(hash, i);
+
+            inCurrent = inCurrent && m_current[index];
+            inPrevious = inPrevious && m_previous[index];
+        }
+
+        return inCurrent || inPrevious;
+    }
+
+    size_t RollingBloomFilter::bitIndex(const Crypto::Hash &hash, const size_t i) const
+    {
+        /* The hash is already uniformly distributed, so two words of it are
+           enough to derive every index from, by double hashing */
+        uint64_t first;
+        uint64_t second;
+
+        std::memcpy(&first, hash.data, sizeof(first));
+        std::memcpy(&second, hash.data + sizeof(first), sizeof(second));
+
+        first ^= m_seed;
+        second = (second ^ (m_seed >> 32 | m_seed << 32)) | 1;
+
+        return (first + i * second) % m_bitCount;
+    }
+} // namespace CryptoNote
@@ -0,0 +1,55 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "crypto/hash.h"
+
+#include <vector>
+
+namespace CryptoNote
+{
+    /* A bloom filter of hashes which forgets the oldest ones as new ones are
+       added, so it can be kept for the lifetime of a connection without
+       growing or filling up.
+
+       Hashes are added to the current of two generations. Once it holds the
+       capacity, it becomes the previous generation, replacing the one before,
+       and a new generation starts. So the last capacity hashes added are always
+       remembered, along with up to the capacity before them.
+
+       Like any bloom filter, it may claim to contain a hash that was never
+       added, roughly at the given rate per generation, but never the other
+       way round. */
+    class RollingBloomFilter
+    {
+      public:
+        RollingBloomFilter(const size_t capacity, const double falsePositiveRate);
+
+        void insert(const Crypto::Hash &hash);
+
+        bool contains(const Crypto::Hash &hash) const;
+
+      private:
+        /* The i'th bit index for this hash, which is the same in each
+           generation */
+        size_t bitIndex(const Crypto::Hash &hash, const size_t i) const;
+
+        size_t m_capacity;
+
+        size_t m_bitCount;
+
+        size_t m_hashCount;
+
+        /* Makes the bit indexes unpredictable, so transactions can't be
+           crafted to collide in everyone's filters */
+        uint64_t m_seed;
+
+        size_t m_currentCount = 0;
+
+        std::vector<bool> m_current;
+
+        std::vector<bool> m_previous;
+    };
+} // namespace CryptoNote
@@ -1078,7 +1078,16 @@ namespace CryptoNote
                 KV_MEMBER(items);
                 KV_MEMBER(synced);
 
-                if (topBlock)
+                if (s.type() == ISerializer::INPUT)
+                {
+                    WalletTypes::TopBlock block;
+
+                    if (s(block, "topBlock"))
+                    {
+                        topBlock = block;
+                    }
+                }
+                else if (topBlock)
                 {
                     s(*topBlock, "topBlock");
                 }
@@ -1323,6 +1332,45 @@ namespace CryptoNote
         };
     };
 
+    struct COMMAND_RPC_WAIT_FOR_CHANGES
+    {
+        struct request
+        {
+            Crypto::Hash topBlockHash;
+
+            uint64_t poolVersion;
+
+            /* Seconds */
+            uint64_t timeout;
+
+            void serialize(ISerializer &s)
+            {
+                KV_MEMBER(topBlockHash)
+                KV_MEMBER(poolVersion)
+                KV_MEMBER(timeout)
+            }
+        };
+
+        struct response
+        {
+            Crypto::Hash topBlockHash;
+
+            uint64_t height;
+
+            uint64_t poolVersion;
+
+            std::string status;
+
+            void serialize(ISerializer &s)
+            {
+                KV_MEMBER(topBlockHash)
+                KV_MEMBER(height)
+                KV_MEMBER(poolVersion)
+                KV_MEMBER(status)
+            }
+        };
+    };
+
     static inline void serialize(COMMAND_RPC_GET_BLOCKS_FAST::response &response, ISerializer &s)
     {
         KV_MEMBER(response.blocks)
@@ -1353,7 +1401,17 @@ namespace CryptoNote
 
     inline void serialize(WalletTypes::WalletBlockInfo &walletBlockInfo, ISerializer &s)
     {
-        if (walletBlockInfo.coinbaseTransaction)
+        /* Optional, so only present in the stream if set */
+        if (s.type() == ISerializer::INPUT)
+        {
+            WalletTypes::RawCoinbaseTransaction coinbaseTransaction;
+
+            if (s(coinbaseTransaction, "coinbaseTX"))
+            {
+                walletBlockInfo.coinbaseTransaction = coinbaseTransaction;
+            }
+        }
+        else if (walletBlockInfo.coinbaseTransaction)
         {
             s(*(walletBlockInfo.coinbaseTransaction), "coinbaseTX");
         }
@@ -97,4 +97,11 @@ namespace CryptoNote
 
     ConnectException::ConnectException(const std::string &whatArg): std::runtime_error(whatArg.c_str()) {}
 
+    HttpStatusException::HttpStatusException(const HttpResponse::HTTP_STATUS status, const std::string &body):
+        std::runtime_error("Unexpected HTTP status in response"),
+        m_status(status),
+        m_body(body)
+    {
+    }
+
 } // namespace CryptoNote
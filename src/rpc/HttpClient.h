@@ -21,6 +21,29 @@ namespace CryptoNote
         ConnectException(const std::string &whatArg);
     };
 
+    /* The server responded, but with something other than 200 OK */
+    class HttpStatusException : public std::runtime_error
+    {
+      public:
+        HttpStatusException(const HttpResponse::HTTP_STATUS status, const std::string &body);
+
+        HttpResponse::HTTP_STATUS getStatus() const
+        {
+            return m_status;
+        }
+
+        /* May hold an encoded error response, explaining the failure */
+        const std::string &getBody() const
+        {
+            return m_body;
+        }
+
+      private:
+        HttpResponse::HTTP_STATUS m_status;
+
+        std::string m_body;
+    };
+
     class HttpClient
     {
       public:
@@ -87,10 +110,17 @@ namespace CryptoNote
         HttpRequest hreq;
         HttpResponse hres;
 
+        hreq.addHeader("Content-Type", "application/octet-stream");
         hreq.setUrl(url);
         hreq.setBody(storeToBinaryKeyValue(req));
         client.request(hreq, hres);
 
+        /* An error body won't parse as the response, so check this first */
+        if (hres.getStatus() != HttpResponse::STATUS_200)
+        {
+            throw HttpStatusException(hres.getStatus(), hres.getBody());
+        }
+
         if (!loadFromBinaryKeyValue(res, hres.getBody()))
         {
             throw std::runtime_error("Failed to parse binary response");
@@ -29,7 +29,8 @@ RpcServer::RpcServer(
     const RpcMode rpcMode,
     const std::shared_ptr<CryptoNote::Core> core,
     const std::shared_ptr<CryptoNote::NodeServer> p2p,
-    const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager):
+    const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager,
+    const std::shared_ptr<CryptoNote::HotStateCache> hotStateCache):
     m_port(bindPort),
     m_host(rpcBindIp),
     m_corsHeader(corsHeader),
@@ -38,7 +39,9 @@ RpcServer::RpcServer(
     m_rpcMode(rpcMode),
     m_core(core),
     m_p2p(p2p),
-    m_syncManager(syncManager)
+    m_syncManager(syncManager),
+    m_hotStateCache(hotStateCache),
+    m_topBlockHash(core->getTopBlockHash())
 {
     if (m_feeAddress != "")
     {
@@ -154,6 +157,15 @@ RpcServer::RpcServer(
             .Post("/queryblocksdetailed", router(&RpcServer::queryBlocksDetailed, RpcMode::AllMethodsEnabled, bodyRequired, syncNotRequired))
             .Post("/get_o_indexes", router(&RpcServer::getGlobalIndexesDeprecated, RpcMode::Default, bodyRequired, syncNotRequired))
             .Post("/getrawblocks", router(&RpcServer::getRawBlocks, RpcMode::Default, bodyRequired, syncNotRequired))
+            .Post("/waitforchanges", router(&RpcServer::waitForChanges, RpcMode::Default, bodyRequired, syncNotRequired))
+
+            /* KV binary encoded variants of the high volume wallet methods.
+               NOTE: The body is parsed by the handler, not the middleware */
+            .Post("/getrandom_outs.bin", router(&RpcServer::getRandomOutsBinary, RpcMode::Default, bodyNotRequired, syncNotRequired))
+            .Post("/getwalletsyncdata.bin", router(&RpcServer::getWalletSyncDataBinary, RpcMode::Default, bodyNotRequired, syncNotRequired))
+            .Post("/get_global_indexes_for_range.bin", router(&RpcServer::getGlobalIndexesBinary, RpcMode::Default, bodyNotRequired, syncNotRequired))
+            .Post("/queryblockslite.bin", router(&RpcServer::queryBlocksLiteBinary, RpcMode::Default, bodyNotRequired, syncNotRequired))
+            .Post("/get_pool_changes_lite.bin", router(&RpcServer::getPoolChangesBinary, RpcMode::Default, bodyNotRequired, syncNotRequired))
 
             /* Matches everything */
             /* NOTE: Not passing through middleware */
@@ -167,6 +179,8 @@ RpcServer::~RpcServer()
 
 void RpcServer::start()
 {
+    m_core->addObserver(this);
+
     m_serverThread = std::thread(&RpcServer::listen, this);
 }
 
@@ -184,6 +198,16 @@ void RpcServer::listen()
 
 void RpcServer::stop()
 {
+    m_core->removeObserver(this);
+
+    /* Release any requests waiting for changes */
+    {
+        std::scoped_lock lock(m_changesMutex);
+        m_stopping = true;
+    }
+
+    m_changesCondition.notify_all();
+
     m_server.stop();
 
     if (m_serverThread.joinable())
@@ -197,6 +221,28 @@ std::tuple<std::string, uint16_t> RpcServer::getConnectionInfo()
     return {m_host, m_port};
 }
 
+void RpcServer::blockchainUpdated()
+{
+    const Crypto::Hash topBlockHash = m_core->getTopBlockHash();
+
+    {
+        std::scoped_lock lock(m_changesMutex);
+        m_topBlockHash = topBlockHash;
+    }
+
+    m_changesCondition.notify_all();
+}
+
+void RpcServer::poolUpdated()
+{
+    {
+        std::scoped_lock lock(m_changesMutex);
+        m_poolVersion++;
+    }
+
+    m_changesCondition.notify_all();
+}
+
 std::optional<rapidjson::Document> RpcServer::getJsonBody(
     const httplib::Request &req,
     httplib::Response &res,
@@ -250,11 +296,15 @@ void RpcServer::middleware(
         httplib::Response &res,
         const rapidjson::Document &body)> handler)
 {
-    Logger::logger.log(
-        "[" + req.get_header_value("REMOTE_ADDR") + "] Incoming " + req.method + " request: " + req.path + ", User-Agent: " + req.get_header_value("User-Agent"),
-        Logger::DEBUG,
-        { Logger::DAEMON_RPC }
-    );
+    /* Don't bother building the message if it's going to be discarded */
+    if (Logger::logger.shouldLog(Logger::DEBUG))
+    {
+        Logger::logger.log(
+            "[" + req.get_header_value("REMOTE_ADDR") + "] Incoming " + req.method + " request: " + req.path + ", User-Agent: " + req.get_header_value("User-Agent"),
+            Logger::DEBUG,
+            { Logger::DAEMON_RPC }
+        );
+    }
 
     if (m_corsHeader != "")
     {
@@ -386,6 +436,36 @@ void RpcServer::failRequest(uint16_t statusCode, std::string body, httplib::Resp
     res.status = statusCode;
 }
 
+template<typename Request>
+bool RpcServer::getBinaryBody(const httplib::Request &req, httplib::Response &res, Request &request)
+{
+    if (!CryptoNote::loadFromBinaryKeyValue(request, req.body))
+    {
+        failBinaryRequest(400, "Failed to parse request body as KV binary", res);
+        return false;
+    }
+
+    return true;
+}
+
+template<typename Response>
+void RpcServer::setBinaryBody(httplib::Response &res, const Response &response)
+{
+    /* Replace the JSON content type the middleware set */
+    res.headers.erase("Content-Type");
+    res.set_content(CryptoNote::storeToBinaryKeyValue(response), "application/octet-stream");
+}
+
+void RpcServer::failBinaryRequest(uint16_t statusCode, std::string status, httplib::Response &res)
+{
+    CryptoNote::STATUS_STRUCT response;
+    response.status = status;
+
+    setBinaryBody(res, response);
+
+    res.status = statusCode;
+}
+
 void RpcServer::failJsonRpcRequest(
     const int64_t errorCode,
     const std::string errorMessage,
@@ -542,6 +622,31 @@ std::tuple<Error, uint16_t> RpcServer::info(
     writer.Key("start_time");
     writer.Uint64(m_core->getStartTime());
 
+    if (m_hotStateCache)
+    {
+        const auto stats = m_hotStateCache->getStats();
+
+        writer.Key("db_cache");
+        writer.StartObject();
+        {
+            writer.Key("hits");
+            writer.Uint64(stats.hits);
+
+            writer.Key("misses");
+            writer.Uint64(stats.misses);
+
+            writer.Key("entries");
+            writer.Uint64(stats.entryCount);
+
+            writer.Key("size");
+            writer.Uint64(stats.size);
+
+            writer.Key("capacity");
+            writer.Uint64(stats.capacity);
+        }
+        writer.EndObject();
+    }
+
     writer.EndObject();
 
     res.body = sb.GetString();
@@ -1681,7 +1786,6 @@ std::tuple<Error, uint16_t> RpcServer::getBlocksByHeight(
                 writer.StartObject();
 
                 const auto hash = m_core->getBlockHashByIndex(i);
-                const auto block = m_core->getBlockByHash(hash);
                 const auto extraDetails = m_core->getBlockDetails(hash);
 
                 writer.Key("cumul_size");
@@ -1697,11 +1801,11 @@ std::tuple<Error, uint16_t> RpcServer::getBlocksByHeight(
                 writer.Uint64(i);
 
                 writer.Key("timestamp");
-                writer.Uint64(block.timestamp);
+                writer.Uint64(extraDetails.timestamp);
 
-                /* Plus one for coinbase tx */
+                /* Includes the coinbase tx */
                 writer.Key("tx_count");
-                writer.Uint64(block.transactionHashes.size() + 1);
+                writer.Uint64(extraDetails.transactions.size());
 
                 writer.EndObject();
             }
@@ -1787,29 +1891,18 @@ std::tuple<Error, uint16_t> RpcServer::getBlockDetailsByHash(
         }
     }
 
-    const auto block = m_core->getBlockByHash(hash);
+    /* Everything we need is in the block details, which are stored
+       precomputed when the explorer store is enabled */
     const auto extraDetails = m_core->getBlockDetails(hash);
-    const auto height = CryptoNote::CachedBlock(block).getBlockIndex();
-    const auto outputs = block.baseTransaction.outputs;
-
-    const uint64_t reward = std::accumulate(outputs.begin(), outputs.end(), 0ull,
-        [](const auto acc, const auto out) {
-            return acc + out.amount;
-        }
-    );
+    const auto height = extraDetails.index;
 
     const uint64_t blockSizeMedian = std::max(
         extraDetails.sizeMedian,
         static_cast<uint64_t>(
-            m_core->getCurrency().blockGrantedFullRewardZoneByBlockVersion(block.majorVersion)
+            m_core->getCurrency().blockGrantedFullRewardZoneByBlockVersion(extraDetails.majorVersion)
         )
     );
 
-    std::vector<Crypto::Hash> ignore;
-    std::vector<std::vector<uint8_t>> transactions;
-
-    m_core->getTransactions(block.transactionHashes, transactions, ignore);
-
     writer.StartObject();
 
     writer.Key("jsonrpc");
@@ -1825,19 +1918,19 @@ std::tuple<Error, uint16_t> RpcServer::getBlockDetailsByHash(
         writer.StartObject();
         {
             writer.Key("major_version");
-            writer.Uint64(block.majorVersion);
+            writer.Uint64(extraDetails.majorVersion);
 
             writer.Key("minor_version");
-            writer.Uint64(block.minorVersion);
+            writer.Uint64(extraDetails.minorVersion);
 
             writer.Key("timestamp");
-            writer.Uint64(block.timestamp);
+            writer.Uint64(extraDetails.timestamp);
 
             writer.Key("prev_hash");
-            writer.String(Common::podToHex(block.previousBlockHash));
+            writer.String(Common::podToHex(extraDetails.prevBlockHash));
 
             writer.Key("nonce");
-            writer.Uint64(block.nonce);
+            writer.Uint64(extraDetails.nonce);
 
             writer.Key("orphan_status");
             writer.Bool(extraDetails.isAlternative);
@@ -1852,10 +1945,10 @@ std::tuple<Error, uint16_t> RpcServer::getBlockDetailsByHash(
             writer.String(Common::podToHex(hash));
 
             writer.Key("difficulty");
-            writer.Uint64(m_core->getBlockDifficulty(height));
+            writer.Uint64(extraDetails.difficulty);
 
             writer.Key("reward");
-            writer.Uint64(reward);
+            writer.Uint64(extraDetails.reward);
 
             writer.Key("blockSize");
             writer.Uint64(extraDetails.blockSize);
@@ -1881,76 +1974,25 @@ std::tuple<Error, uint16_t> RpcServer::getBlockDetailsByHash(
             writer.Key("effectiveSizeMedian");
             writer.Uint64(blockSizeMedian);
 
-            uint64_t totalFee = 0;
-
             writer.Key("transactions");
             writer.StartArray();
             {
-                /* Coinbase transaction */
-                writer.StartObject();
-                {
-                    const auto txOutputs = block.baseTransaction.outputs;
-
-                    const uint64_t outputAmount = std::accumulate(txOutputs.begin(), txOutputs.end(), 0ull,
-                        [](const auto acc, const auto out) {
-                            return acc + out.amount;
-                        }
-                    );
-
-                    writer.Key("hash");
-                    writer.String(Common::podToHex(getObjectHash(block.baseTransaction)));
-
-                    writer.Key("fee");
-                    writer.Uint64(0);
-
-                    writer.Key("amount_out");
-                    writer.Uint64(outputAmount);
-
-                    writer.Key("size");
-                    writer.Uint64(getObjectBinarySize(block.baseTransaction));
-                }
-                writer.EndObject();
-
-                for (const std::vector<uint8_t> rawTX : transactions)
+                /* Coinbase transaction first, which has no fee */
+                for (const auto &tx : extraDetails.transactions)
                 {
                     writer.StartObject();
                     {
-                        CryptoNote::Transaction tx;
-
-                        fromBinaryArray(tx, rawTX);
-
-                        const uint64_t outputAmount = std::accumulate(tx.outputs.begin(), tx.outputs.end(), 0ull,
-                            [](const auto acc, const auto out) {
-                                return acc + out.amount;
-                            }
-                        );
-
-                        const uint64_t inputAmount = std::accumulate(tx.inputs.begin(), tx.inputs.end(), 0ull,
-                            [](const auto acc, const auto in) {
-                                if (in.type() == typeid(CryptoNote::KeyInput))
-                                {
-                                    return acc + boost::get<CryptoNote::KeyInput>(in).amount;
-                                }
-
-                                return acc;
-                            }
-                        );
-
-                        const uint64_t fee = inputAmount - outputAmount;
-
                         writer.Key("hash");
-                        writer.String(Common::podToHex(getObjectHash(tx)));
+                        writer.String(Common::podToHex(tx.hash));
 
                         writer.Key("fee");
-                        writer.Uint64(fee);
+                        writer.Uint64(tx.fee);
 
                         writer.Key("amount_out");
-                        writer.Uint64(outputAmount);
+                        writer.Uint64(tx.totalOutputsAmount);
 
                         writer.Key("size");
-                        writer.Uint64(getObjectBinarySize(tx));
-
-                        totalFee += fee;
+                        writer.Uint64(tx.size);
                     }
                     writer.EndObject();
                 }
@@ -1958,7 +2000,7 @@ std::tuple<Error, uint16_t> RpcServer::getBlockDetailsByHash(
             writer.EndArray();
 
             writer.Key("totalFeeAmount");
-            writer.Uint64(totalFee);
+            writer.Uint64(extraDetails.totalFeeAmount);
         }
         writer.EndObject();
     }
@@ -2017,7 +2059,6 @@ std::tuple<Error, uint16_t> RpcServer::getTransactionDetailsByHash(
 
     const uint64_t blockHeight = txDetails.blockIndex;
     const auto blockHash = m_core->getBlockHashByIndex(blockHeight);
-    const auto block = m_core->getBlockByHash(blockHash);
     const auto extraDetails = m_core->getBlockDetails(blockHash);
 
     fromBinaryArray(transaction, rawTXs[0]);
@@ -2049,11 +2090,11 @@ std::tuple<Error, uint16_t> RpcServer::getTransactionDetailsByHash(
             writer.Uint64(blockHeight);
 
             writer.Key("timestamp");
-            writer.Uint64(block.timestamp);
+            writer.Uint64(extraDetails.timestamp);
 
-            /* Plus one for coinbase tx */
+            /* Includes the coinbase tx */
             writer.Key("tx_count");
-            writer.Uint64(block.transactionHashes.size() + 1);
+            writer.Uint64(extraDetails.transactions.size());
         }
         writer.EndObject();
 
@@ -3119,6 +3160,25 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
     httplib::Response &res,
     const rapidjson::Document &body)
 {
+    /* The response is fully determined by the request and the state of the
+       main chain, so identical requests can share an encoded response until
+       the top block changes */
+    const auto cache = m_core->getBlockResponseCache();
+    const Crypto::Hash topBlockHash = m_core->getTopBlockHash();
+
+    const CryptoNote::BlockResponseKey key {
+        CryptoNote::BlockResponseEncoding::JsonRawBlocks,
+        Crypto::cn_fast_hash(req.body.data(), req.body.size()),
+        topBlockHash,
+        0
+    };
+
+    if (const auto cached = cache->get(key))
+    {
+        res.body.assign(cached->begin(), cached->end());
+        return {SUCCESS, 200};
+    }
+
     rapidjson::StringBuffer sb;
     rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
 
@@ -3220,6 +3280,264 @@ std::tuple<Error, uint16_t> RpcServer::getRawBlocks(
 
     res.body = sb.GetString();
 
+    /* Don't cache if a block arrived whilst we were building the response,
+       it may not match the key any more */
+    if (!blocks.empty() && m_core->getTopBlockHash() == topBlockHash)
+    {
+        cache->insert(key, CryptoNote::BinaryArray(res.body.begin(), res.body.end()));
+    }
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> RpcServer::waitForChanges(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    Crypto::Hash knownTopBlockHash;
+
+    if (!Common::podFromHex(getStringFromJSON(body, "topBlockHash"), knownTopBlockHash))
+    {
+        failRequest(400, "topBlockHash specified is not a valid hex string!", res);
+        return {SUCCESS, 400};
+    }
+
+    const uint64_t knownPoolVersion = hasMember(body, "poolVersion")
+        ? getUint64FromJSON(body, "poolVersion")
+        : 0;
+
+    const uint64_t timeout = hasMember(body, "timeout")
+        ? std::min(getUint64FromJSON(body, "timeout"), CryptoNote::RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT)
+        : CryptoNote::RPC_WAIT_FOR_CHANGES_MAX_TIMEOUT;
+
+    Crypto::Hash topBlockHash;
+    uint64_t poolVersion;
+
+    {
+        std::unique_lock<std::mutex> lock(m_changesMutex);
+
+        /* Hold the request open until the caller's view of the chain or the
+           pool is out of date, rather than having them poll us */
+        m_changesCondition.wait_for(lock, std::chrono::seconds(timeout), [&] {
+            return m_stopping || m_topBlockHash != knownTopBlockHash || m_poolVersion != knownPoolVersion;
+        });
+
+        topBlockHash = m_topBlockHash;
+        poolVersion = m_poolVersion;
+    }
+
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+
+    writer.StartObject();
+
+    writer.Key("topBlockHash");
+    writer.String(Common::podToHex(topBlockHash));
+
+    writer.Key("height");
+    writer.Uint64(m_core->getTopBlockIndex() + 1);
+
+    writer.Key("poolVersion");
+    writer.Uint64(poolVersion);
+
+    writer.Key("status");
+    writer.String("OK");
+
+    writer.EndObject();
+
+    res.body = sb.GetString();
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> RpcServer::getRandomOutsBinary(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::request request;
+    CryptoNote::COMMAND_RPC_GET_RANDOM_OUTPUTS_FOR_AMOUNTS::response response;
+
+    request.outs_count = 0;
+
+    if (!getBinaryBody(req, res, request))
+    {
+        return {SUCCESS, 400};
+    }
+
+    for (const auto amount : request.amounts)
+    {
+        std::vector<uint32_t> globalIndexes;
+        std::vector<Crypto::PublicKey> publicKeys;
+
+        const auto [success, error] = m_core->getRandomOutputs(
+            amount, request.outs_count, globalIndexes, publicKeys
+        );
+
+        if (!success)
+        {
+            failBinaryRequest(400, error, res);
+            return {SUCCESS, 400};
+        }
+
+        if (globalIndexes.size() != request.outs_count)
+        {
+            std::stringstream stream;
+
+            stream << "Failed to get enough matching outputs for amount " << amount << " ("
+                   << Utilities::formatAmount(amount) << "). Requested outputs: " << request.outs_count
+                   << ", found outputs: " << globalIndexes.size();
+
+            failBinaryRequest(400, stream.str(), res);
+            return {SUCCESS, 400};
+        }
+
+        CryptoNote::RandomOuts outs;
+        outs.amount = amount;
+
+        for (size_t i = 0; i < globalIndexes.size(); i++)
+        {
+            outs.outs.push_back({globalIndexes[i], publicKeys[i]});
+        }
+
+        response.outs.push_back(std::move(outs));
+    }
+
+    response.status = CORE_RPC_STATUS_OK;
+
+    setBinaryBody(res, response);
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> RpcServer::getWalletSyncDataBinary(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    CryptoNote::COMMAND_RPC_GET_WALLET_SYNC_DATA::request request;
+    CryptoNote::COMMAND_RPC_GET_WALLET_SYNC_DATA::response response;
+
+    /* Same defaults as the JSON method, for any fields not given */
+    request.startHeight = 0;
+    request.startTimestamp = 0;
+    request.blockCount = 100;
+    request.skipCoinbaseTransactions = false;
+
+    if (!getBinaryBody(req, res, request))
+    {
+        return {SUCCESS, 400};
+    }
+
+    const bool success = m_core->getWalletSyncData(
+        request.blockIds,
+        request.startHeight,
+        request.startTimestamp,
+        request.blockCount,
+        request.skipCoinbaseTransactions,
+        response.items,
+        response.topBlock
+    );
+
+    if (!success)
+    {
+        failBinaryRequest(500, "Internal error: failed to get wallet sync data", res);
+        return {SUCCESS, 500};
+    }
+
+    response.synced = response.topBlock.has_value();
+    response.status = CORE_RPC_STATUS_OK;
+
+    setBinaryBody(res, response);
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> RpcServer::getGlobalIndexesBinary(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    CryptoNote::COMMAND_RPC_GET_GLOBAL_INDEXES_FOR_RANGE::request request;
+    CryptoNote::COMMAND_RPC_GET_GLOBAL_INDEXES_FOR_RANGE::response response;
+
+    request.startHeight = 0;
+    request.endHeight = 0;
+
+    if (!getBinaryBody(req, res, request))
+    {
+        return {SUCCESS, 400};
+    }
+
+    if (!m_core->getGlobalIndexesForRange(request.startHeight, request.endHeight, response.indexes))
+    {
+        failBinaryRequest(500, "Internal error: failed to get global indexes", res);
+        return {SUCCESS, 500};
+    }
+
+    response.status = CORE_RPC_STATUS_OK;
+
+    setBinaryBody(res, response);
+
     return {SUCCESS, 200};
 }
 
+std::tuple<Error, uint16_t> RpcServer::queryBlocksLiteBinary(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    CryptoNote::COMMAND_RPC_QUERY_BLOCKS_LITE::request request;
+    CryptoNote::COMMAND_RPC_QUERY_BLOCKS_LITE::response response;
+
+    request.timestamp = 0;
+
+    if (!getBinaryBody(req, res, request))
+    {
+        return {SUCCESS, 400};
+    }
+
+    uint32_t startHeight;
+    uint32_t currentHeight;
+    uint32_t fullOffset;
+
+    if (!m_core->queryBlocksLite(request.blockIds, request.timestamp, startHeight, currentHeight, fullOffset, response.items))
+    {
+        failBinaryRequest(500, "Internal error: failed to queryblockslite", res);
+        return {SUCCESS, 500};
+    }
+
+    response.startHeight = startHeight;
+    response.currentHeight = currentHeight;
+    response.fullOffset = fullOffset;
+    response.status = CORE_RPC_STATUS_OK;
+
+    setBinaryBody(res, response);
+
+    return {SUCCESS, 200};
+}
+
+std::tuple<Error, uint16_t> RpcServer::getPoolChangesBinary(
+    const httplib::Request &req,
+    httplib::Response &res,
+    const rapidjson::Document &body)
+{
+    CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::request request;
+    CryptoNote::COMMAND_RPC_GET_POOL_CHANGES_LITE::response response;
+
+    if (!getBinaryBody(req, res, request))
+    {
+        return {SUCCESS, 400};
+    }
+
+    response.isTailBlockActual = m_core->getPoolChangesLite(
+        request.tailBlockId, request.knownTxsIds, response.addedTxs, response.deletedTxsIds
+    );
+
+    response.status = CORE_RPC_STATUS_OK;
+
+    setBinaryBody(res, response);
+
+    return {SUCCESS, 200};
+}
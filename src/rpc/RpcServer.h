@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -15,6 +17,7 @@
 #include "rapidjson/writer.h"
 
 #include <cryptonotecore/Core.h>
+#include <cryptonotecore/HotStateCache.h>
 #include <cryptonoteprotocol/CryptoNoteProtocolHandlerCommon.h>
 #include <errors/Errors.h>
 #include <p2p/NetNode.h>
@@ -26,7 +29,7 @@ enum class RpcMode
     AllMethodsEnabled = 2,
 };
 
-class RpcServer
+class RpcServer : public CryptoNote::ICoreObserver
 {
   public:
 
@@ -42,7 +45,8 @@ class RpcServer
         const RpcMode rpcMode,
         const std::shared_ptr<CryptoNote::Core> core,
         const std::shared_ptr<CryptoNote::NodeServer> p2p,
-        const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager);
+        const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> syncManager,
+        const std::shared_ptr<CryptoNote::HotStateCache> hotStateCache = nullptr);
 
     ~RpcServer();
 
@@ -59,6 +63,14 @@ class RpcServer
     /* Gets the IP/port combo the server is running on */
     std::tuple<std::string, uint16_t> getConnectionInfo();
 
+    ///////////////////////////
+    /* ICoreObserver methods */
+    ///////////////////////////
+
+    virtual void blockchainUpdated() override;
+
+    virtual void poolUpdated() override;
+
   private:
     //////////////////////////////
     /* Private member functions */
@@ -86,6 +98,19 @@ class RpcServer
 
     void failRequest(uint16_t statusCode, std::string body, httplib::Response &res);
 
+    /* Parses a KV binary encoded request body, failing the request if it
+       is not valid */
+    template<typename Request>
+    bool getBinaryBody(const httplib::Request &req, httplib::Response &res, Request &request);
+
+    /* Writes a KV binary encoded response body */
+    template<typename Response>
+    void setBinaryBody(httplib::Response &res, const Response &response);
+
+    /* Like failRequest, but for the KV binary routes - the reason is given in
+       the status field of a KV binary body, rather than as JSON */
+    void failBinaryRequest(uint16_t statusCode, std::string status, httplib::Response &res);
+
     void failJsonRpcRequest(
         const int64_t errorCode,
         const std::string errorMessage,
@@ -148,6 +173,28 @@ class RpcServer
     std::tuple<Error, uint16_t>
         getRawBlocks(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
 
+    std::tuple<Error, uint16_t>
+        waitForChanges(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
+    //////////////////////////
+    /* BINARY (KV) REQUESTS */
+    //////////////////////////
+
+    std::tuple<Error, uint16_t>
+        getRandomOutsBinary(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
+    std::tuple<Error, uint16_t>
+        getWalletSyncDataBinary(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
+    std::tuple<Error, uint16_t>
+        getGlobalIndexesBinary(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
+    std::tuple<Error, uint16_t>
+        queryBlocksLiteBinary(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
+    std::tuple<Error, uint16_t>
+        getPoolChangesBinary(const httplib::Request &req, httplib::Response &res, const rapidjson::Document &body);
+
     ///////////////////////
     /* JSON RPC REQUESTS */
     ///////////////////////
@@ -221,4 +268,23 @@ class RpcServer
     const std::shared_ptr<CryptoNote::NodeServer> m_p2p;
 
     const std::shared_ptr<CryptoNote::ICryptoNoteProtocolHandler> m_syncManager;
+
+    /* The cache in front of the blockchain database, if enabled. Only used
+       to report its stats. */
+    const std::shared_ptr<CryptoNote::HotStateCache> m_hotStateCache;
+
+    /* Guards the state below, which /waitforchanges requests wait on */
+    std::mutex m_changesMutex;
+
+    /* Signalled when the top block or the pool changes, or we are stopping */
+    std::condition_variable m_changesCondition;
+
+    /* The top block hash as of the last blockchain update */
+    Crypto::Hash m_topBlockHash;
+
+    /* Incremented every time the pool changes */
+    uint64_t m_poolVersion = 0;
+
+    /* Whether we are stopping, to release any waiting requests */
+    bool m_stopping = false;
 };
@@ -0,0 +1,328 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <CryptoNote.h>
+#include <boost/variant/get.hpp>
+#include <cassert>
+#include <config/CryptoNoteConfig.h>
+#include <cstring>
+#include <stdexcept>
+
+/* A compile time alternative to BinaryOutputStreamSerializer for the types
+   we serialize constantly when hashing - transaction prefixes, transactions
+   and block headers.
+
+   Rather than going through the virtual ISerializer interface and a growing
+   VectorOutputStream, each type has a specialization which first computes
+   the exact serialized size, and then writes into a buffer allocated once
+   with that size.
+
+   The output is byte for byte identical to BinaryOutputStreamSerializer, and
+   throws in the same situations. If you change the serialization of one of
+   these types in CryptoNoteSerialization.cpp, you must change it here too. */
+namespace CryptoNote
+{
+    namespace BinaryFast
+    {
+        inline size_t varintSize(uint64_t value)
+        {
+            size_t size = 1;
+
+            while (value >= 0x80)
+            {
+                value >>= 7;
+                size++;
+            }
+
+            return size;
+        }
+
+        inline void writeVarint(uint8_t *&out, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                *out++ = static_cast<uint8_t>(value | 0x80);
+                value >>= 7;
+            }
+
+            *out++ = static_cast<uint8_t>(value);
+        }
+
+        inline void writeRaw(uint8_t *&out, const void *data, const size_t size)
+        {
+            if (size != 0)
+            {
+                std::memcpy(out, data, size);
+                out += size;
+            }
+        }
+
+        template<typename T> struct Serializer;
+
+        template<> struct Serializer<BaseInput>
+        {
+            static size_t size(const BaseInput &input)
+            {
+                return varintSize(input.blockIndex);
+            }
+
+            static void write(uint8_t *&out, const BaseInput &input)
+            {
+                writeVarint(out, input.blockIndex);
+            }
+        };
+
+        template<> struct Serializer<KeyInput>
+        {
+            static size_t size(const KeyInput &input)
+            {
+                size_t size = varintSize(input.amount) + varintSize(input.outputIndexes.size());
+
+                for (const auto index : input.outputIndexes)
+                {
+                    size += varintSize(index);
+                }
+
+                return size + sizeof(input.keyImage);
+            }
+
+            static void write(uint8_t *&out, const KeyInput &input)
+            {
+                writeVarint(out, input.amount);
+                writeVarint(out, input.outputIndexes.size());
+
+                for (const auto index : input.outputIndexes)
+                {
+                    writeVarint(out, index);
+                }
+
+                writeRaw(out, &input.keyImage, sizeof(input.keyImage));
+            }
+        };
+
+        template<> struct Serializer<KeyOutput>
+        {
+            static size_t size(const KeyOutput &output)
+            {
+                return sizeof(output.key);
+            }
+
+            static void write(uint8_t *&out, const KeyOutput &output)
+            {
+                writeRaw(out, &output.key, sizeof(output.key));
+            }
+        };
+
+        /* The variant tags match BinaryVariantTagGetter in CryptoNoteSerialization.cpp */
+        template<> struct Serializer<TransactionInput>
+        {
+            static size_t size(const TransactionInput &input)
+            {
+                if (input.type() == typeid(KeyInput))
+                {
+                    return 1 + Serializer<KeyInput>::size(boost::get<KeyInput>(input));
+                }
+
+                return 1 + Serializer<BaseInput>::size(boost::get<BaseInput>(input));
+            }
+
+            static void write(uint8_t *&out, const TransactionInput &input)
+            {
+                if (input.type() == typeid(KeyInput))
+                {
+                    *out++ = 0x2;
+                    Serializer<KeyInput>::write(out, boost::get<KeyInput>(input));
+                }
+                else
+                {
+                    *out++ = 0xff;
+                    Serializer<BaseInput>::write(out, boost::get<BaseInput>(input));
+                }
+            }
+        };
+
+        template<> struct Serializer<TransactionOutput>
+        {
+            static size_t size(const TransactionOutput &output)
+            {
+                return varintSize(output.amount) + 1
+                       + Serializer<KeyOutput>::size(boost::get<KeyOutput>(output.target));
+            }
+
+            static void write(uint8_t *&out, const TransactionOutput &output)
+            {
+                writeVarint(out, output.amount);
+                *out++ = 0x2;
+                Serializer<KeyOutput>::write(out, boost::get<KeyOutput>(output.target));
+            }
+        };
+
+        template<> struct Serializer<TransactionPrefix>
+        {
+            static size_t size(const TransactionPrefix &prefix)
+            {
+                size_t size = varintSize(prefix.version) + varintSize(prefix.unlockTime);
+
+                size += varintSize(prefix.inputs.size());
+
+                for (const auto &input : prefix.inputs)
+                {
+                    size += Serializer<TransactionInput>::size(input);
+                }
+
+                size += varintSize(prefix.outputs.size());
+
+                for (const auto &output : prefix.outputs)
+                {
+                    size += Serializer<TransactionOutput>::size(output);
+                }
+
+                return size + varintSize(prefix.extra.size()) + prefix.extra.size();
+            }
+
+            static void write(uint8_t *&out, const TransactionPrefix &prefix)
+            {
+                writeVarint(out, prefix.version);
+                writeVarint(out, prefix.unlockTime);
+
+                writeVarint(out, prefix.inputs.size());
+
+                for (const auto &input : prefix.inputs)
+                {
+                    Serializer<TransactionInput>::write(out, input);
+                }
+
+                writeVarint(out, prefix.outputs.size());
+
+                for (const auto &output : prefix.outputs)
+                {
+                    Serializer<TransactionOutput>::write(out, output);
+                }
+
+                writeVarint(out, prefix.extra.size());
+                writeRaw(out, prefix.extra.data(), prefix.extra.size());
+            }
+        };
+
+        template<> struct Serializer<Transaction>
+        {
+            static size_t size(const Transaction &transaction)
+            {
+                return Serializer<TransactionPrefix>::size(transaction) + signaturesSize(transaction);
+            }
+
+            static void write(uint8_t *&out, const Transaction &transaction)
+            {
+                Serializer<TransactionPrefix>::write(out, transaction);
+
+                for (const auto &signatures : transaction.signatures)
+                {
+                    writeRaw(out, signatures.data(), signatures.size() * sizeof(Crypto::Signature));
+                }
+            }
+
+          private:
+            static size_t signaturesCount(const TransactionInput &input)
+            {
+                return input.type() == typeid(KeyInput) ? boost::get<KeyInput>(input).outputIndexes.size() : 0;
+            }
+
+            /* Performs the same consistency checks as serialize(Transaction &) */
+            static size_t signaturesSize(const Transaction &transaction)
+            {
+                const bool signaturesNotExpected = transaction.signatures.empty();
+
+                if (!signaturesNotExpected && transaction.inputs.size() != transaction.signatures.size())
+                {
+                    throw std::runtime_error("Serialization error: unexpected signatures size");
+                }
+
+                size_t count = 0;
+
+                for (size_t i = 0; i < transaction.inputs.size(); i++)
+                {
+                    const size_t expected = signaturesCount(transaction.inputs[i]);
+
+                    if (signaturesNotExpected)
+                    {
+                        if (expected != 0)
+                        {
+                            throw std::runtime_error("Serialization error: signatures are not expected");
+                        }
+
+                        continue;
+                    }
+
+                    if (expected != transaction.signatures[i].size())
+                    {
+                        throw std::runtime_error("Serialization error: unexpected signatures size");
+                    }
+
+                    count += expected;
+                }
+
+                return count * sizeof(Crypto::Signature);
+            }
+        };
+
+        template<> struct Serializer<BlockHeader>
+        {
+            static size_t size(const BlockHeader &header)
+            {
+                checkVersion(header);
+
+                size_t size = varintSize(header.majorVersion) + varintSize(header.minorVersion);
+
+                if (header.majorVersion == BLOCK_MAJOR_VERSION_1)
+                {
+                    size += varintSize(header.timestamp) + sizeof(header.nonce);
+                }
+
+                return size + sizeof(header.previousBlockHash);
+            }
+
+            static void write(uint8_t *&out, const BlockHeader &header)
+            {
+                writeVarint(out, header.majorVersion);
+                writeVarint(out, header.minorVersion);
+
+                if (header.majorVersion == BLOCK_MAJOR_VERSION_1)
+                {
+                    writeVarint(out, header.timestamp);
+                    writeRaw(out, &header.previousBlockHash, sizeof(header.previousBlockHash));
+                    writeRaw(out, &header.nonce, sizeof(header.nonce));
+                }
+                else
+                {
+                    writeRaw(out, &header.previousBlockHash, sizeof(header.previousBlockHash));
+                }
+            }
+
+          private:
+            static void checkVersion(const BlockHeader &header)
+            {
+                if (header.majorVersion > BLOCK_MAJOR_VERSION_6 || header.majorVersion < BLOCK_MAJOR_VERSION_1)
+                {
+                    throw std::runtime_error("Wrong major version");
+                }
+            }
+        };
+
+        /* Serializes the object into a buffer allocated once, at the exact
+           size needed */
+        template<typename T> BinaryArray toBinaryArray(const T &object)
+        {
+            BinaryArray result(Serializer<T>::size(object));
+
+            uint8_t *out = result.data();
+            Serializer<T>::write(out, object);
+
+            assert(out == result.data() + result.size());
+
+            return result;
+        }
+    } // namespace BinaryFast
+} // namespace CryptoNote
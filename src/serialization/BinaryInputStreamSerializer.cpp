@@ -119,11 +119,10 @@ namespace CryptoNote
 
         if (size > 0)
         {
-            std::vector<char> temp;
-            temp.resize(size);
-            checkedRead(&temp[0], size);
-            value.reserve(size);
-            value.assign(&temp[0], size);
+            /* Read directly into the string, rather than going via a
+               temporary buffer */
+            value.resize(size);
+            checkedRead(&value[0], size);
         }
         else
         {
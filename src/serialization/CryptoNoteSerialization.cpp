@@ -96,14 +96,15 @@ namespace
             {
                 CryptoNote::BaseInput v;
                 serializer(v, "value");
-                in = v;
+                in = std::move(v);
                 break;
             }
             case 0x2:
             {
                 CryptoNote::KeyInput v;
                 serializer(v, "value");
-                in = v;
+                /* Move, so we don't copy the output indexes */
+                in = std::move(v);
                 break;
             }
             default:
@@ -119,7 +120,7 @@ namespace
             {
                 CryptoNote::KeyOutput v;
                 serializer(v, "data");
-                out = v;
+                out = std::move(v);
                 break;
             }
             default:
@@ -283,13 +284,14 @@ namespace CryptoNote
             }
             else
             {
-                std::vector<Crypto::Signature> signatures(signatureSize);
+                /* Read straight into place */
+                auto &signatures = tx.signatures[i];
+                signatures.resize(signatureSize);
+
                 for (Crypto::Signature &sig : signatures)
                 {
                     serializePod(sig, "", serializer);
                 }
-
-                tx.signatures[i] = std::move(signatures);
             }
         }
         //  serializer.endArray();
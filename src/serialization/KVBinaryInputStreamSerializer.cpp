@@ -9,7 +9,6 @@
 
 #include <algorithm>
 #include <cassert>
-#include <common/StreamTools.h>
 #include <cstring>
 #include <stdexcept>
 
@@ -18,28 +17,28 @@ using namespace CryptoNote;
 
 namespace
 {
-    template<typename T> T readPod(Common::IInputStream &s)
+    void checkAvailable(const uint8_t *ptr, const uint8_t *end, uint64_t size)
     {
-        T v;
-        read(s, &v, sizeof(T));
-        return v;
+        if (size > static_cast<uint64_t>(end - ptr))
+        {
+            throw std::runtime_error("Unexpected end of KV binary data");
+        }
     }
 
-    template<typename T, typename JsonT = T> JsonValue readPodJson(Common::IInputStream &s)
+    template<typename T> T readPod(const uint8_t *&ptr, const uint8_t *end)
     {
-        JsonValue jv;
-        jv = static_cast<JsonT>(readPod<T>(s));
-        return jv;
-    }
+        checkAvailable(ptr, end, sizeof(T));
 
-    template<typename T> JsonValue readIntegerJson(Common::IInputStream &s)
-    {
-        return readPodJson<T, int64_t>(s);
+        T v;
+        std::memcpy(&v, ptr, sizeof(T));
+        ptr += sizeof(T);
+
+        return v;
     }
 
-    uint64_t readVarint(Common::IInputStream &s)
+    uint64_t readVarint(const uint8_t *&ptr, const uint8_t *end)
     {
-        uint8_t b = read<uint8_t>(s);
+        uint8_t b = readPod<uint8_t>(ptr, end);
         uint8_t size_mask = b & PORTABLE_RAW_SIZE_MARK_MASK;
         uint64_t bytesLeft = 0;
 
@@ -63,7 +62,7 @@ namespace
 
         for (uint64_t i = 1; i <= bytesLeft; ++i)
         {
-            uint64_t n = read<uint8_t>(s);
+            uint64_t n = readPod<uint8_t>(ptr, end);
             value |= n << (i * 8);
         }
 
@@ -71,157 +70,465 @@ namespace
         return value;
     }
 
-    std::string readString(Common::IInputStream &s)
+    StringView readName(const uint8_t *&ptr, const uint8_t *end)
     {
-        auto size = readVarint(s);
-        std::string str;
-        str.resize(size);
-        if (size)
-        {
-            read(s, &str[0], size);
-        }
-        return str;
-    }
+        const uint8_t len = readPod<uint8_t>(ptr, end);
+        checkAvailable(ptr, end, len);
 
-    JsonValue readStringJson(Common::IInputStream &s)
-    {
-        return JsonValue(readString(s));
+        StringView name(reinterpret_cast<const char *>(ptr), len);
+        ptr += len;
+
+        return name;
     }
 
-    void readName(Common::IInputStream &s, std::string &name)
+    size_t podSize(uint8_t type)
     {
-        uint8_t len = readPod<uint8_t>(s);
-        if (len)
+        switch (type)
         {
-            name.resize(len);
-            read(s, &name[0], len);
+            case BIN_KV_SERIALIZE_TYPE_INT64:
+            case BIN_KV_SERIALIZE_TYPE_UINT64:
+            case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+                return 8;
+            case BIN_KV_SERIALIZE_TYPE_INT32:
+            case BIN_KV_SERIALIZE_TYPE_UINT32:
+                return 4;
+            case BIN_KV_SERIALIZE_TYPE_INT16:
+            case BIN_KV_SERIALIZE_TYPE_UINT16:
+                return 2;
+            case BIN_KV_SERIALIZE_TYPE_INT8:
+            case BIN_KV_SERIALIZE_TYPE_UINT8:
+            case BIN_KV_SERIALIZE_TYPE_BOOL:
+                return 1;
+            default:
+                return 0;
         }
     }
 
-    JsonValue loadValue(Common::IInputStream &stream, uint8_t type);
-
-    JsonValue loadSection(Common::IInputStream &stream);
+    void skipSection(const uint8_t *&ptr, const uint8_t *end);
 
-    JsonValue loadEntry(Common::IInputStream &stream);
-
-    JsonValue loadArray(Common::IInputStream &stream, uint8_t itemType);
-
-    JsonValue loadSection(Common::IInputStream &stream)
+    /* Moves ptr past a value of the given type. This is also how we validate
+       the buffer - every value is bounds checked as we skip over it. */
+    void skipValue(uint8_t type, bool isArray, const uint8_t *&ptr, const uint8_t *end)
     {
-        JsonValue sec(JsonValue::OBJECT);
-        uint64_t count = readVarint(stream);
-        std::string name;
-
-        while (count--)
+        if (isArray)
         {
-            readName(stream, name);
-            sec.insert(name, loadEntry(stream));
+            uint64_t count = readVarint(ptr, end);
+
+            /* Fixed size items can be skipped in one go */
+            if (const size_t size = podSize(type))
+            {
+                if (count > static_cast<uint64_t>(end - ptr) / size)
+                {
+                    throw std::runtime_error("Unexpected end of KV binary data");
+                }
+
+                ptr += count * size;
+                return;
+            }
+
+            while (count--)
+            {
+                skipValue(type, type == BIN_KV_SERIALIZE_TYPE_ARRAY, ptr, end);
+            }
+
+            return;
         }
 
-        return sec;
-    }
-
-    JsonValue loadValue(Common::IInputStream &stream, uint8_t type)
-    {
         switch (type)
         {
-            case BIN_KV_SERIALIZE_TYPE_INT64:
-                return readIntegerJson<int64_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_INT32:
-                return readIntegerJson<int32_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_INT16:
-                return readIntegerJson<int16_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_INT8:
-                return readIntegerJson<int8_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_UINT64:
-                return readIntegerJson<uint64_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_UINT32:
-                return readIntegerJson<uint32_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_UINT16:
-                return readIntegerJson<uint16_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_UINT8:
-                return readIntegerJson<uint8_t>(stream);
-            case BIN_KV_SERIALIZE_TYPE_DOUBLE:
-                return readPodJson<double>(stream);
-            case BIN_KV_SERIALIZE_TYPE_BOOL:
-                return JsonValue(read<uint8_t>(stream) != 0);
             case BIN_KV_SERIALIZE_TYPE_STRING:
-                return readStringJson(stream);
+            {
+                const uint64_t size = readVarint(ptr, end);
+                checkAvailable(ptr, end, size);
+                ptr += size;
+                break;
+            }
             case BIN_KV_SERIALIZE_TYPE_OBJECT:
-                return loadSection(stream);
-            case BIN_KV_SERIALIZE_TYPE_ARRAY:
-                return loadArray(stream, type);
+            {
+                skipSection(ptr, end);
+                break;
+            }
             default:
-                throw std::runtime_error("Unknown data type");
+            {
+                const size_t size = podSize(type);
+
+                if (size == 0)
+                {
+                    throw std::runtime_error("Unknown data type");
+                }
+
+                checkAvailable(ptr, end, size);
+                ptr += size;
                 break;
+            }
         }
     }
 
-    JsonValue loadEntry(Common::IInputStream &stream)
+    /* Splits an entry type into the value type, and whether it is an array */
+    void decodeEntryType(uint8_t entryType, uint8_t &type, bool &isArray)
     {
-        uint8_t type = readPod<uint8_t>(stream);
-
-        if (type & BIN_KV_SERIALIZE_FLAG_ARRAY)
+        if (entryType & BIN_KV_SERIALIZE_FLAG_ARRAY)
         {
-            type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-            return loadArray(stream, type);
+            type = entryType & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+            isArray = true;
+        }
+        else
+        {
+            type = entryType;
+            isArray = type == BIN_KV_SERIALIZE_TYPE_ARRAY;
         }
-
-        return loadValue(stream, type);
     }
 
-    JsonValue loadArray(Common::IInputStream &stream, uint8_t itemType)
+    void skipSection(const uint8_t *&ptr, const uint8_t *end)
     {
-        JsonValue arr(JsonValue::ARRAY);
-        uint64_t count = readVarint(stream);
+        uint64_t count = readVarint(ptr, end);
 
         while (count--)
         {
-            arr.pushBack(loadValue(stream, itemType));
+            readName(ptr, end);
+
+            uint8_t type;
+            bool isArray;
+            decodeEntryType(readPod<uint8_t>(ptr, end), type, isArray);
+
+            skipValue(type, isArray, ptr, end);
         }
+    }
+
+} // namespace
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream &strm)
+{
+    uint8_t chunk[4096];
+
+    while (const uint64_t read = strm.readSome(chunk, sizeof(chunk)))
+    {
+        m_ownedBuffer.insert(m_ownedBuffer.end(), chunk, chunk + read);
+    }
+
+    parseHeader(m_ownedBuffer.data(), m_ownedBuffer.size());
+}
+
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(const void *data, uint64_t size)
+{
+    parseHeader(static_cast<const uint8_t *>(data), size);
+}
+
+void KVBinaryInputStreamSerializer::parseHeader(const uint8_t *data, uint64_t size)
+{
+    const uint8_t *ptr = data;
+    m_end = data + size;
+
+    auto hdr = readPod<KVBinaryStorageBlockHeader>(ptr, m_end);
 
-        return arr;
+    if (hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA || hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB)
+    {
+        throw std::runtime_error("Invalid binary storage signature");
     }
 
-    JsonValue parseBinary(Common::IInputStream &stream)
+    if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER)
     {
-        auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+        throw std::runtime_error("Unknown binary storage format version");
+    }
+
+    /* Walk the whole thing once up front, so malformed data is rejected here,
+       as it always has been, and not halfway through filling in a struct */
+    const uint8_t *root = ptr;
+    skipSection(ptr, m_end);
+
+    Level level;
+    level.isArray = false;
+    level.position = root;
+    level.count = readVarint(level.position, m_end);
+    level.itemType = 0;
+
+    m_chain.push_back(level);
+}
+
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const
+{
+    return ISerializer::INPUT;
+}
 
-        if (hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA || hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB)
+bool KVBinaryInputStreamSerializer::findValue(Common::StringView name, Value &value)
+{
+    assert(!m_chain.empty());
+
+    Level &level = m_chain.back();
+
+    if (level.isArray)
+    {
+        if (level.count == 0)
         {
-            throw std::runtime_error("Invalid binary storage signature");
+            throw std::runtime_error("Array index out of range");
         }
 
-        if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER)
+        value.type = level.itemType;
+        value.isArray = level.itemType == BIN_KV_SERIALIZE_TYPE_ARRAY;
+        value.data = level.position;
+
+        skipValue(value.type, value.isArray, level.position, m_end);
+        level.count--;
+
+        return true;
+    }
+
+    const uint8_t *ptr = level.position;
+
+    for (uint64_t i = 0; i < level.count; i++)
+    {
+        const StringView entryName = readName(ptr, m_end);
+
+        uint8_t type;
+        bool isArray;
+        decodeEntryType(readPod<uint8_t>(ptr, m_end), type, isArray);
+
+        if (entryName == name)
         {
-            throw std::runtime_error("Unknown binary storage format version");
+            value.type = type;
+            value.isArray = isArray;
+            value.data = ptr;
+
+            return true;
         }
 
-        return loadSection(stream);
+        skipValue(type, isArray, ptr, m_end);
     }
 
-} // namespace
+    return false;
+}
+
+int64_t KVBinaryInputStreamSerializer::getInteger(const Value &value) const
+{
+    if (value.isArray)
+    {
+        throw std::runtime_error("KV binary value is not an integer");
+    }
+
+    const uint8_t *ptr = value.data;
+
+    switch (value.type)
+    {
+        case BIN_KV_SERIALIZE_TYPE_INT64:
+            return readPod<int64_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_INT32:
+            return readPod<int32_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_INT16:
+            return readPod<int16_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_INT8:
+            return readPod<int8_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_UINT64:
+            return static_cast<int64_t>(readPod<uint64_t>(ptr, m_end));
+        case BIN_KV_SERIALIZE_TYPE_UINT32:
+            return readPod<uint32_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_UINT16:
+            return readPod<uint16_t>(ptr, m_end);
+        case BIN_KV_SERIALIZE_TYPE_UINT8:
+            return readPod<uint8_t>(ptr, m_end);
+        default:
+            throw std::runtime_error("KV binary value is not an integer");
+    }
+}
+
+bool KVBinaryInputStreamSerializer::getString(Common::StringView name, const uint8_t *&data, uint64_t &size)
+{
+    Value value;
 
-KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(Common::IInputStream &strm):
-    JsonInputValueSerializer(parseBinary(strm))
+    if (!findValue(name, value))
+    {
+        return false;
+    }
+
+    if (value.isArray || value.type != BIN_KV_SERIALIZE_TYPE_STRING)
+    {
+        throw std::runtime_error("KV binary value is not a string");
+    }
+
+    data = value.data;
+    size = readVarint(data, m_end);
+
+    checkAvailable(data, m_end, size);
+
+    return true;
+}
+
+bool KVBinaryInputStreamSerializer::beginObject(Common::StringView name)
+{
+    Value value;
+
+    if (!findValue(name, value))
+    {
+        return false;
+    }
+
+    if (value.isArray || value.type != BIN_KV_SERIALIZE_TYPE_OBJECT)
+    {
+        throw std::runtime_error("KV binary value is not an object");
+    }
+
+    Level level;
+    level.isArray = false;
+    level.position = value.data;
+    level.count = readVarint(level.position, m_end);
+    level.itemType = 0;
+
+    m_chain.push_back(level);
+
+    return true;
+}
+
+void KVBinaryInputStreamSerializer::endObject()
+{
+    assert(!m_chain.empty());
+    m_chain.pop_back();
+}
+
+bool KVBinaryInputStreamSerializer::beginArray(uint64_t &size, Common::StringView name)
+{
+    Value value;
+
+    if (!findValue(name, value))
+    {
+        size = 0;
+        return false;
+    }
+
+    if (!value.isArray)
+    {
+        throw std::runtime_error("KV binary value is not an array");
+    }
+
+    Level level;
+    level.isArray = true;
+    level.position = value.data;
+    level.count = readVarint(level.position, m_end);
+    level.itemType = value.type;
+
+    size = level.count;
+
+    m_chain.push_back(level);
+
+    return true;
+}
+
+void KVBinaryInputStreamSerializer::endArray()
+{
+    assert(!m_chain.empty());
+    m_chain.pop_back();
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint8_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int16_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint16_t &value, Common::StringView name)
 {
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int32_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint32_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(int64_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(uint64_t &value, Common::StringView name)
+{
+    return getNumber(name, value);
+}
+
+bool KVBinaryInputStreamSerializer::operator()(double &value, Common::StringView name)
+{
+    Value v;
+
+    if (!findValue(name, v))
+    {
+        return false;
+    }
+
+    if (!v.isArray && v.type == BIN_KV_SERIALIZE_TYPE_DOUBLE)
+    {
+        const uint8_t *ptr = v.data;
+        value = readPod<double>(ptr, m_end);
+    }
+    else
+    {
+        value = static_cast<double>(getInteger(v));
+    }
+
+    return true;
+}
+
+bool KVBinaryInputStreamSerializer::operator()(bool &value, Common::StringView name)
+{
+    Value v;
+
+    if (!findValue(name, v))
+    {
+        return false;
+    }
+
+    if (v.isArray || v.type != BIN_KV_SERIALIZE_TYPE_BOOL)
+    {
+        throw std::runtime_error("KV binary value is not a bool");
+    }
+
+    const uint8_t *ptr = v.data;
+    value = readPod<uint8_t>(ptr, m_end) != 0;
+
+    return true;
+}
+
+bool KVBinaryInputStreamSerializer::operator()(std::string &value, Common::StringView name)
+{
+    const uint8_t *data;
+    uint64_t size;
+
+    if (!getString(name, data, size))
+    {
+        return false;
+    }
+
+    value.assign(reinterpret_cast<const char *>(data), size);
+
+    return true;
 }
 
 bool KVBinaryInputStreamSerializer::binary(void *value, uint64_t size, Common::StringView name)
 {
-    std::string str;
+    const uint8_t *data;
+    uint64_t blobSize;
 
-    if (!(*this)(str, name))
+    if (!getString(name, data, blobSize))
     {
         return false;
     }
 
-    if (str.size() != size)
+    if (blobSize != size)
     {
         throw std::runtime_error("Binary block size mismatch");
     }
 
-    memcpy(value, str.data(), size);
+    if (size != 0)
+    {
+        memcpy(value, data, size);
+    }
+
     return true;
 }
 
@@ -6,20 +6,120 @@
 #pragma once
 
 #include "ISerializer.h"
-#include "JsonInputValueSerializer.h"
 
 #include <common/IInputStream.h>
+#include <vector>
 
 namespace CryptoNote
 {
-    class KVBinaryInputStreamSerializer : public JsonInputValueSerializer
+    /* Reads the KV binary (portable storage) format directly from the
+       underlying buffer. Nothing is copied or allocated up front - values are
+       located on demand as the serialize() functions ask for them, and strings
+       and blobs are copied straight from the buffer into their destination. */
+    class KVBinaryInputStreamSerializer : public ISerializer
     {
       public:
+        /* Reads the whole stream into an internal buffer */
         KVBinaryInputStreamSerializer(Common::IInputStream &strm);
 
+        /* Reads from the given buffer without copying it. The buffer must
+           outlive the serializer. */
+        KVBinaryInputStreamSerializer(const void *data, uint64_t size);
+
+        virtual SerializerType type() const override;
+
+        virtual bool beginObject(Common::StringView name) override;
+
+        virtual void endObject() override;
+
+        virtual bool beginArray(uint64_t &size, Common::StringView name) override;
+
+        virtual void endArray() override;
+
+        virtual bool operator()(uint8_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint16_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint32_t &value, Common::StringView name) override;
+
+        virtual bool operator()(int64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(uint64_t &value, Common::StringView name) override;
+
+        virtual bool operator()(double &value, Common::StringView name) override;
+
+        virtual bool operator()(bool &value, Common::StringView name) override;
+
+        virtual bool operator()(std::string &value, Common::StringView name) override;
+
         virtual bool binary(void *value, uint64_t size, Common::StringView name) override;
 
         virtual bool binary(std::string &value, Common::StringView name) override;
+
+        template<typename T> bool operator()(T &value, Common::StringView name)
+        {
+            return ISerializer::operator()(value, name);
+        }
+
+      private:
+        /* Location of a value in the buffer. For arrays, type is the item type
+           and data points at the item count. */
+        struct Value
+        {
+            uint8_t type;
+
+            bool isArray;
+
+            const uint8_t *data;
+        };
+
+        /* An object or array we are currently inside of */
+        struct Level
+        {
+            bool isArray;
+
+            /* Objects: the first entry. Arrays: the next item to read. */
+            const uint8_t *position;
+
+            /* Objects: number of entries. Arrays: number of items left. */
+            uint64_t count;
+
+            /* Arrays only */
+            uint8_t itemType;
+        };
+
+        void parseHeader(const uint8_t *data, uint64_t size);
+
+        /* Finds the value with the given name in the current object, or the
+           next item of the current array */
+        bool findValue(Common::StringView name, Value &value);
+
+        int64_t getInteger(const Value &value) const;
+
+        bool getString(Common::StringView name, const uint8_t *&data, uint64_t &size);
+
+        template<typename T> bool getNumber(Common::StringView name, T &v)
+        {
+            Value value;
+
+            if (!findValue(name, value))
+            {
+                return false;
+            }
+
+            v = static_cast<T>(getInteger(value));
+            return true;
+        }
+
+        std::vector<uint8_t> m_ownedBuffer;
+
+        const uint8_t *m_end = nullptr;
+
+        std::vector<Level> m_chain;
     };
 
 } // namespace CryptoNote
@@ -14,6 +14,7 @@
 #include <common/StringOutputStream.h>
 #include <common/VectorOutputStream.h>
 #include <list>
+#include <serialization/BinaryFastSerializer.h>
 #include <serialization/BinaryInputStreamSerializer.h>
 #include <serialization/BinaryOutputStreamSerializer.h>
 #include <serialization/CryptoNoteSerialization.h>
@@ -154,8 +155,7 @@ namespace CryptoNote
     {
         try
         {
-            Common::MemoryInputStream stream(buf.data(), buf.size());
-            KVBinaryInputStreamSerializer s(stream);
+            KVBinaryInputStreamSerializer s(buf.data(), buf.size());
             serialize(v, s);
             return true;
         }
@@ -175,6 +175,23 @@ namespace CryptoNote
         return ba;
     }
 
+    /* The types we hash over and over again skip the generic serializer and
+       write straight into a buffer of the exact size. See BinaryFastSerializer.h */
+    template<> inline std::vector<uint8_t> toBinaryArray(const TransactionPrefix &object)
+    {
+        return BinaryFast::toBinaryArray(object);
+    }
+
+    template<> inline std::vector<uint8_t> toBinaryArray(const Transaction &object)
+    {
+        return BinaryFast::toBinaryArray(object);
+    }
+
+    template<> inline std::vector<uint8_t> toBinaryArray(const BlockHeader &object)
+    {
+        return BinaryFast::toBinaryArray(object);
+    }
+
     // noexcept
     template<class T> bool toBinaryArray(const T &object, std::vector<uint8_t> &binaryArray)
     {
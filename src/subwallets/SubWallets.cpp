@@ -41,6 +41,8 @@ SubWallets::SubWallets(
         SubWallet(publicSpendKey, privateSpendKey, address, scanHeight, timestamp, isPrimaryAddress);
 
     m_publicSpendKeys.push_back(publicSpendKey);
+
+    publishSnapshot();
 }
 
 /* Makes a new view only subwallet */
@@ -62,6 +64,8 @@ SubWallets::SubWallets(
     m_subWallets[publicSpendKey] = SubWallet(publicSpendKey, address, scanHeight, timestamp, isPrimaryAddress);
 
     m_publicSpendKeys.push_back(publicSpendKey);
+
+    publishSnapshot();
 }
 
 /* Copy constructor */
@@ -74,6 +78,7 @@ SubWallets::SubWallets(const SubWallets &other):
     m_publicSpendKeys(other.m_publicSpendKeys),
     m_transactionPrivateKeys(other.m_transactionPrivateKeys)
 {
+    publishSnapshot();
 }
 
 /////////////////////
@@ -111,6 +116,9 @@ std::tuple<Error, std::string, Crypto::SecretKey> SubWallets::addSubWallet()
 
     m_publicSpendKeys.push_back(spendKey.publicKey);
 
+    markSubWalletDirty(spendKey.publicKey);
+    publishSnapshotLocked();
+
     return {SUCCESS, address, spendKey.secretKey};
 }
 
@@ -145,6 +153,9 @@ std::tuple<Error, std::string>
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    markSubWalletDirty(publicSpendKey);
+    publishSnapshotLocked();
+
     return {SUCCESS, address};
 }
 
@@ -178,6 +189,9 @@ std::tuple<Error, std::string>
 
     m_publicSpendKeys.push_back(publicSpendKey);
 
+    markSubWalletDirty(publicSpendKey);
+    publishSnapshotLocked();
+
     return {SUCCESS, address};
 }
 
@@ -213,6 +227,12 @@ Error SubWallets::deleteSubWallet(const std::string address)
         m_publicSpendKeys.erase(it2, m_publicSpendKeys.end());
     }
 
+    m_transactionsDirty = true;
+    m_lockedTransactionsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
+
     return SUCCESS;
 }
 
@@ -321,6 +341,11 @@ void SubWallets::addUnconfirmedTransaction(const WalletTypes::Transaction tx)
     }
 
     m_lockedTransactions.push_back(tx);
+
+    m_lockedTransactionsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
 }
 
 void SubWallets::addTransaction(const WalletTypes::Transaction tx)
@@ -340,6 +365,9 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
     {
         /* Remove from the locked container */
         m_lockedTransactions.erase(it, m_lockedTransactions.end());
+
+        m_lockedTransactionsDirty = true;
+        m_snapshotDirty = true;
     }
 
     const auto it2 = std::find_if(m_transactions.begin(), m_transactions.end(), [tx](const auto transaction) {
@@ -362,6 +390,9 @@ void SubWallets::addTransaction(const WalletTypes::Transaction tx)
     }
 
     m_transactions.push_back(tx);
+
+    m_transactionsDirty = true;
+    m_snapshotDirty = true;
 }
 
 Crypto::KeyImage SubWallets::getTxInputKeyImage(
@@ -401,6 +432,8 @@ void SubWallets::storeTransactionInput(
             m_keyImageOwners[input.keyImage] = publicSpendKey;
         }
 
+        markSubWalletDirty(publicSpendKey);
+
         /* If we have a view wallet, don't attempt to derive the key image */
         return it->second.storeTransactionInput(input, m_isViewWallet);
     }
@@ -611,27 +644,27 @@ std::tuple<std::vector<WalletTypes::TxInputAndOwner>, uint64_t, uint64_t> SubWal
    wallet */
 std::string SubWallets::getPrimaryAddress() const
 {
-    std::scoped_lock lock(m_mutex);
+    const auto snapshot = getSnapshot();
 
-    const auto it = std::find_if(m_subWallets.begin(), m_subWallets.end(), [](const auto subWallet) {
-        return subWallet.second.isPrimaryAddress();
+    const auto it = std::find_if(snapshot->subWallets.begin(), snapshot->subWallets.end(), [](const auto &subWallet) {
+        return subWallet.second->isPrimaryAddress();
     });
 
-    if (it == m_subWallets.end())
+    if (it == snapshot->subWallets.end())
     {
         throw std::runtime_error("This container has no primary address!");
     }
 
-    return it->second.address();
+    return it->second->address();
 }
 
 std::vector<std::string> SubWallets::getAddresses() const
 {
     std::vector<std::string> addresses;
 
-    for (const auto &[pubKey, subWallet] : m_subWallets)
+    for (const auto &[pubKey, subWallet] : getSnapshot()->subWallets)
     {
-        addresses.push_back(subWallet.address());
+        addresses.push_back(subWallet->address());
     }
 
     return addresses;
@@ -639,7 +672,7 @@ std::vector<std::string> SubWallets::getAddresses() const
 
 uint64_t SubWallets::getWalletCount() const
 {
-    return m_subWallets.size();
+    return getSnapshot()->subWallets.size();
 }
 
 /* Will throw if the public keys given don't exist */
@@ -648,13 +681,13 @@ std::tuple<uint64_t, uint64_t> SubWallets::getBalance(
     const bool takeFromAll,
     const uint64_t currentHeight) const
 {
-    std::scoped_lock lock(m_mutex);
+    const auto snapshot = getSnapshot();
 
     /* If we're able to take from every subwallet, set the wallets to take from
        to all our public spend keys */
     if (takeFromAll)
     {
-        subWalletsToTakeFrom = m_publicSpendKeys;
+        subWalletsToTakeFrom = snapshot->publicSpendKeys;
     }
 
     uint64_t unlockedBalance = 0;
@@ -663,7 +696,7 @@ std::tuple<uint64_t, uint64_t> SubWallets::getBalance(
 
     for (const auto &pubKey : subWalletsToTakeFrom)
     {
-        const auto [unlocked, locked] = m_subWallets.at(pubKey).getBalance(currentHeight);
+        const auto [unlocked, locked] = snapshot->subWallets.at(pubKey)->getBalance(currentHeight);
 
         unlockedBalance += unlocked;
         lockedBalance += locked;
@@ -685,6 +718,8 @@ void SubWallets::markInputAsSpent(
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsSpent(keyImage, spendHeight);
+
+    markSubWalletDirty(publicKey);
 }
 
 /* Mark a key image as locked, can no longer be used in transactions till it
@@ -698,6 +733,9 @@ void SubWallets::markInputAsLocked(const Crypto::KeyImage keyImage, const Crypto
     std::scoped_lock lock(m_mutex);
 
     m_subWallets.at(publicKey).markInputAsLocked(keyImage);
+
+    markSubWalletDirty(publicKey);
+    publishSnapshotLocked();
 }
 
 /* Remove transactions and key images that occured on a forked chain */
@@ -728,6 +766,10 @@ void SubWallets::removeForkedTransactions(const uint64_t forkHeight)
     {
         m_keyImageOwners.erase(keyImage);
     }
+
+    m_allSubWalletsDirty = true;
+    m_transactionsDirty = true;
+    m_snapshotDirty = true;
 }
 
 void SubWallets::removeCancelledTransactions(const std::unordered_set<Crypto::Hash> cancelledTransactions)
@@ -753,6 +795,12 @@ void SubWallets::removeCancelledTransactions(const std::unordered_set<Crypto::Ha
     {
         subWallet.removeCancelledTransactions(cancelledTransactions);
     }
+
+    m_allSubWalletsDirty = true;
+    m_lockedTransactionsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
 }
 
 Crypto::SecretKey SubWallets::getPrivateViewKey() const
@@ -818,6 +866,13 @@ void SubWallets::reset(
     {
         subWallet.reset(startHeight, startTimestamp);
     }
+
+    m_allSubWalletsDirty = true;
+    m_transactionsDirty = true;
+    m_lockedTransactionsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
 }
 
 std::vector<Crypto::SecretKey> SubWallets::getPrivateSpendKeys() const
@@ -850,7 +905,7 @@ Crypto::SecretKey SubWallets::getPrimaryPrivateSpendKey() const
 
 std::vector<WalletTypes::Transaction> SubWallets::getTransactions() const
 {
-    return m_transactions;
+    return *getSnapshot()->transactions;
 }
 
 /* Note that this DOES NOT return incoming transactions in the pool. It only
@@ -858,16 +913,18 @@ std::vector<WalletTypes::Transaction> SubWallets::getTransactions() const
    block yet. */
 std::vector<WalletTypes::Transaction> SubWallets::getUnconfirmedTransactions() const
 {
-    return m_lockedTransactions;
+    return *getSnapshot()->lockedTransactions;
 }
 
 std::tuple<Error, std::string> SubWallets::getAddress(const Crypto::PublicKey spendKey) const
 {
-    const auto it = m_subWallets.find(spendKey);
+    const auto snapshot = getSnapshot();
 
-    if (it != m_subWallets.end())
+    const auto it = snapshot->subWallets.find(spendKey);
+
+    if (it != snapshot->subWallets.end())
     {
-        return {SUCCESS, it->second.address()};
+        return {SUCCESS, it->second->address()};
     }
 
     return {ADDRESS_NOT_IN_WALLET, std::string()};
@@ -901,6 +958,9 @@ void SubWallets::storeUnconfirmedIncomingInput(
     if (it != m_subWallets.end())
     {
         it->second.storeUnconfirmedIncomingInput(input);
+
+        markSubWalletDirty(publicSpendKey);
+        publishSnapshotLocked();
     }
 }
 
@@ -912,17 +972,22 @@ void SubWallets::convertSyncTimestampToHeight(const uint64_t timestamp, const ui
     {
         subWallet.convertSyncTimestampToHeight(timestamp, height);
     }
+
+    m_allSubWalletsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
 }
 
 std::vector<std::tuple<std::string, uint64_t, uint64_t>> SubWallets::getBalances(const uint64_t currentHeight) const
 {
     std::vector<std::tuple<std::string, uint64_t, uint64_t>> balances;
 
-    for (const auto &[pubKey, subWallet] : m_subWallets)
+    for (const auto &[pubKey, subWallet] : getSnapshot()->subWallets)
     {
-        const auto [unlocked, locked] = subWallet.getBalance(currentHeight);
+        const auto [unlocked, locked] = subWallet->getBalance(currentHeight);
 
-        balances.emplace_back(subWallet.address(), unlocked, locked);
+        balances.emplace_back(subWallet->address(), unlocked, locked);
     }
 
     return balances;
@@ -930,10 +995,80 @@ std::vector<std::tuple<std::string, uint64_t, uint64_t>> SubWallets::getBalances
 
 void SubWallets::pruneSpentInputs(const uint64_t pruneHeight)
 {
+    std::scoped_lock lock(m_mutex);
+
     for (auto &[pubKey, subWallet] : m_subWallets)
     {
         subWallet.pruneSpentInputs(pruneHeight);
     }
+
+    m_allSubWalletsDirty = true;
+    m_snapshotDirty = true;
+}
+
+void SubWallets::publishSnapshot()
+{
+    std::scoped_lock lock(m_mutex);
+
+    publishSnapshotLocked();
+}
+
+std::shared_ptr<const SubWallets::Snapshot> SubWallets::getSnapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void SubWallets::publishSnapshotLocked()
+{
+    if (!m_snapshotDirty)
+    {
+        return;
+    }
+
+    const auto previous = std::atomic_load(&m_snapshot);
+
+    auto snapshot = std::make_shared<Snapshot>();
+
+    for (const auto &[pubKey, subWallet] : m_subWallets)
+    {
+        const auto it = previous->subWallets.find(pubKey);
+
+        /* Unchanged, share it with the previous snapshot */
+        if (!m_allSubWalletsDirty && it != previous->subWallets.end()
+            && m_dirtySubWallets.find(pubKey) == m_dirtySubWallets.end())
+        {
+            snapshot->subWallets[pubKey] = it->second;
+        }
+        else
+        {
+            snapshot->subWallets[pubKey] = std::make_shared<const SubWallet>(subWallet);
+        }
+    }
+
+    snapshot->publicSpendKeys = m_publicSpendKeys;
+
+    snapshot->transactions = m_transactionsDirty
+                                 ? std::make_shared<const std::vector<WalletTypes::Transaction>>(m_transactions)
+                                 : previous->transactions;
+
+    snapshot->lockedTransactions =
+        m_lockedTransactionsDirty
+            ? std::make_shared<const std::vector<WalletTypes::Transaction>>(m_lockedTransactions)
+            : previous->lockedTransactions;
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+
+    m_snapshotDirty = false;
+    m_allSubWalletsDirty = false;
+    m_transactionsDirty = false;
+    m_lockedTransactionsDirty = false;
+    m_dirtySubWallets.clear();
+}
+
+void SubWallets::markSubWalletDirty(const Crypto::PublicKey publicSpendKey)
+{
+    m_dirtySubWallets.insert(publicSpendKey);
+    m_snapshotDirty = true;
 }
 
 void SubWallets::fromJSON(const JSONObject &j)
@@ -992,6 +1127,15 @@ void SubWallets::fromJSON(const JSONObject &j)
 
         m_transactionPrivateKeys[txHash] = privateKey;
     }
+
+    std::scoped_lock lock(m_mutex);
+
+    m_allSubWalletsDirty = true;
+    m_transactionsDirty = true;
+    m_lockedTransactionsDirty = true;
+    m_snapshotDirty = true;
+
+    publishSnapshotLocked();
 }
 
 void SubWallets::toJSON(rapidjson::Writer<rapidjson::StringBuffer> &writer) const
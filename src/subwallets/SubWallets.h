@@ -5,6 +5,7 @@
 #pragma once
 
 #include <crypto/crypto.h>
+#include <memory>
 #include <subwallets/SubWallet.h>
 
 class SubWallets
@@ -60,7 +61,8 @@ class SubWallets
     /* Initializes the class from a json string */
     void fromJSON(const JSONObject &j);
 
-    /* Store a transaction */
+    /* Store a transaction. Called by the sync thread, so the change is not
+       visible to readers until publishSnapshot() is called */
     void addTransaction(const WalletTypes::Transaction tx);
 
     /* Store an outgoing tx, not yet in a block */
@@ -74,6 +76,7 @@ class SubWallets
         const Crypto::KeyDerivation derivation,
         const size_t outputIndex) const;
 
+    /* Called by the sync thread, see publishSnapshot() */
     void storeTransactionInput(const Crypto::PublicKey publicSpendKey, const WalletTypes::TransactionInput input);
 
     /* Get key images + amounts for the specified transfer amount. We
@@ -111,7 +114,7 @@ class SubWallets
         const uint64_t currentHeight) const;
 
     /* Remove any transactions at this height or above, they were on a
-       forked chain */
+       forked chain. Called by the sync thread, see publishSnapshot() */
     void removeForkedTransactions(const uint64_t forkHeight);
 
     Crypto::SecretKey getPrivateViewKey() const;
@@ -123,6 +126,7 @@ class SubWallets
 
     Crypto::SecretKey getPrimaryPrivateSpendKey() const;
 
+    /* Called by the sync thread, see publishSnapshot() */
     void markInputAsSpent(
         const Crypto::KeyImage keyImage,
         const Crypto::PublicKey publicKey,
@@ -163,8 +167,21 @@ class SubWallets
 
     std::vector<std::tuple<std::string, uint64_t, uint64_t>> getBalances(const uint64_t currentHeight) const;
 
+    /* Called by the sync thread, see publishSnapshot() */
     void pruneSpentInputs(const uint64_t pruneHeight);
 
+    /* The balance, address and transaction getters never take the mutex,
+       so API calls don't have to wait for the sync thread. Instead, they
+       read from an immutable snapshot of the wallet state, which is
+       replaced whenever the state changes.
+
+       Changes made by the sync thread while processing blocks are only
+       published once it calls this at the end of a batch of blocks, so
+       readers don't see a half processed block, and we don't copy the
+       wallet state for every block. Other changes are published
+       immediately. */
+    void publishSnapshot();
+
     /////////////////////////////
     /* Public member variables */
     /////////////////////////////
@@ -174,12 +191,36 @@ class SubWallets
     std::vector<Crypto::PublicKey> m_publicSpendKeys;
 
   private:
+    /* The state used by the read only getters. Subwallets and transaction
+       lists which haven't changed since the previous snapshot are shared
+       with it, rather than copied again. */
+    struct Snapshot
+    {
+        std::unordered_map<Crypto::PublicKey, std::shared_ptr<const SubWallet>> subWallets;
+
+        std::vector<Crypto::PublicKey> publicSpendKeys;
+
+        std::shared_ptr<const std::vector<WalletTypes::Transaction>> transactions =
+            std::make_shared<const std::vector<WalletTypes::Transaction>>();
+
+        std::shared_ptr<const std::vector<WalletTypes::Transaction>> lockedTransactions =
+            std::make_shared<const std::vector<WalletTypes::Transaction>>();
+    };
+
     //////////////////////////////
     /* Private member functions */
     //////////////////////////////
 
     void throwIfViewWallet() const;
 
+    std::shared_ptr<const Snapshot> getSnapshot() const;
+
+    /* Must hold m_mutex */
+    void publishSnapshotLocked();
+
+    /* Must hold m_mutex */
+    void markSubWalletDirty(const Crypto::PublicKey publicSpendKey);
+
     /* Deletes any transactions containing the given spend key, or just
        removes from the transfers array if there are multiple transfers
        in the tx */
@@ -211,4 +252,19 @@ class SubWallets
     /* Need a mutex for accessing inputs, transactions, and locked
        transactions, etc as these are modified on multiple threads */
     mutable std::mutex m_mutex;
+
+    /* The last published snapshot. Only accessed with std::atomic_load and
+       std::atomic_store. */
+    std::shared_ptr<const Snapshot> m_snapshot = std::make_shared<const Snapshot>();
+
+    /* What has changed since m_snapshot was published. Guarded by m_mutex. */
+    bool m_snapshotDirty = true;
+
+    bool m_allSubWalletsDirty = true;
+
+    bool m_transactionsDirty = true;
+
+    bool m_lockedTransactionsDirty = true;
+
+    std::unordered_set<Crypto::PublicKey> m_dirtySubWallets;
 };
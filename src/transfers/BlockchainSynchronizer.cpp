@@ -384,6 +384,8 @@ namespace CryptoNote
 
         actualizeFutureState();
 
+        discardPrefetchedBlocks();
+
         m_logger(DEBUGGING) << "Working thread stopped";
     }
 
@@ -535,20 +537,29 @@ namespace CryptoNote
         {
             if (!req.knownBlocks.empty())
             {
-                auto queryBlocksCompleted = std::promise<std::error_code>();
-                auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
-
-                m_node.queryBlocks(
-                    std::move(req.knownBlocks),
-                    req.syncStart.timestamp,
-                    response.newBlocks,
-                    response.startHeight,
-                    [&queryBlocksCompleted](std::error_code ec) {
-                        auto detachedPromise = std::move(queryBlocksCompleted);
-                        detachedPromise.set_value(ec);
-                    });
+                std::error_code ec;
 
-                std::error_code ec = queryBlocksWaitFuture.get();
+                if (takePrefetchedBlocks(req, response))
+                {
+                    m_logger(DEBUGGING) << "Using prefetched blocks";
+                }
+                else
+                {
+                    auto queryBlocksCompleted = std::promise<std::error_code>();
+                    auto queryBlocksWaitFuture = queryBlocksCompleted.get_future();
+
+                    m_node.queryBlocks(
+                        std::move(req.knownBlocks),
+                        req.syncStart.timestamp,
+                        response.newBlocks,
+                        response.startHeight,
+                        [&queryBlocksCompleted](std::error_code ec) {
+                            auto detachedPromise = std::move(queryBlocksCompleted);
+                            detachedPromise.set_value(ec);
+                        });
+
+                    ec = queryBlocksWaitFuture.get();
+                }
 
                 if (ec)
                 {
@@ -560,6 +571,10 @@ namespace CryptoNote
                 {
                     m_logger(DEBUGGING) << "Blocks received, start index " << response.startHeight << ", count "
                                         << response.newBlocks.size();
+
+                    /* Download the next batch while the consumers process this one */
+                    prefetchBlocks(response, req.syncStart.timestamp);
+
                     processBlocks(response);
                 }
             }
@@ -574,6 +589,84 @@ namespace CryptoNote
         }
     }
 
+    void BlockchainSynchronizer::prefetchBlocks(const GetBlocksResponse &response, uint64_t timestamp)
+    {
+        discardPrefetchedBlocks();
+
+        /* Only the known block itself, we're synced */
+        if (response.newBlocks.size() <= 1)
+        {
+            return;
+        }
+
+        const uint32_t lastHeight = response.startHeight + static_cast<uint32_t>(response.newBlocks.size()) - 1;
+
+        if (lastHeight >= m_node.getLastLocalBlockHeight())
+        {
+            return;
+        }
+
+        m_prefetchedBlocks = std::make_unique<PrefetchedBlocks>();
+        m_prefetchedBlocks->lastKnownBlock = response.newBlocks.back().blockHash;
+        m_prefetchedBlocks->lastKnownBlockHeight = lastHeight;
+        m_prefetchedBlocks->timestamp = timestamp;
+
+        auto queryBlocksCompleted = std::make_shared<std::promise<std::error_code>>();
+        m_prefetchedBlocks->completed = queryBlocksCompleted->get_future();
+
+        m_logger(DEBUGGING) << "Prefetching blocks from index " << lastHeight;
+
+        m_node.queryBlocks(
+            {m_prefetchedBlocks->lastKnownBlock, m_genesisBlockHash},
+            timestamp,
+            m_prefetchedBlocks->response.newBlocks,
+            m_prefetchedBlocks->response.startHeight,
+            [queryBlocksCompleted](std::error_code ec) { queryBlocksCompleted->set_value(ec); });
+    }
+
+    /* The prefetched blocks can only be used if the consumers have reached
+       the end of the previous batch, and the node resumed from that block
+       rather than an earlier one because of a reorg */
+    bool BlockchainSynchronizer::takePrefetchedBlocks(const GetBlocksRequest &request, GetBlocksResponse &response)
+    {
+        if (!m_prefetchedBlocks)
+        {
+            return false;
+        }
+
+        std::unique_ptr<PrefetchedBlocks> prefetched = std::move(m_prefetchedBlocks);
+
+        /* Must always wait, the node is writing into the response */
+        const std::error_code ec = prefetched->completed.get();
+
+        if (ec || request.knownBlocks.front() != prefetched->lastKnownBlock
+            || request.syncStart.timestamp != prefetched->timestamp)
+        {
+            return false;
+        }
+
+        const auto &newBlocks = prefetched->response.newBlocks;
+
+        if (prefetched->response.startHeight != prefetched->lastKnownBlockHeight || newBlocks.empty()
+            || newBlocks.front().blockHash != prefetched->lastKnownBlock)
+        {
+            return false;
+        }
+
+        response = std::move(prefetched->response);
+
+        return true;
+    }
+
+    void BlockchainSynchronizer::discardPrefetchedBlocks()
+    {
+        if (m_prefetchedBlocks)
+        {
+            m_prefetchedBlocks->completed.wait();
+            m_prefetchedBlocks.reset();
+        }
+    }
+
     void BlockchainSynchronizer::processBlocks(GetBlocksResponse &response)
     {
         m_logger(DEBUGGING) << "Process blocks, start index " << response.startHeight << ", count "
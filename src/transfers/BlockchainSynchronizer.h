@@ -147,6 +147,12 @@ namespace CryptoNote
 
         GetBlocksRequest getCommonHistory();
 
+        void prefetchBlocks(const GetBlocksResponse &response, uint64_t timestamp);
+
+        bool takePrefetchedBlocks(const GetBlocksRequest &request, GetBlocksResponse &response);
+
+        void discardPrefetchedBlocks();
+
         void getPoolUnionAndIntersection(
             std::unordered_set<Crypto::Hash> &poolUnion,
             std::unordered_set<Crypto::Hash> &poolIntersection) const;
@@ -182,6 +188,25 @@ namespace CryptoNote
         std::condition_variable m_hasWork;
 
         bool wasStarted = false;
+
+        /* The batch of blocks following the one currently being processed,
+           requested from the node while the consumers handle the current one */
+        struct PrefetchedBlocks
+        {
+            /* The last block of the previous batch, which the node should
+               resume from */
+            Crypto::Hash lastKnownBlock;
+
+            uint32_t lastKnownBlockHeight;
+
+            uint64_t timestamp;
+
+            GetBlocksResponse response;
+
+            std::future<std::error_code> completed;
+        };
+
+        std::unique_ptr<PrefetchedBlocks> m_prefetchedBlocks;
     };
 
 } // namespace CryptoNote
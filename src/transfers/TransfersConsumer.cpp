@@ -10,7 +10,6 @@
 #include "CommonTypes.h"
 #include "INode.h"
 #include "WalletGreenTypes.h"
-#include "common/BlockingQueue.h"
 #include "cryptonotecore/CryptoNoteBasicImpl.h"
 #include "cryptonotecore/CryptoNoteFormatUtils.h"
 #include "cryptonotecore/TransactionApi.h"
@@ -18,6 +17,7 @@
 #include <config/Constants.h>
 #include <future>
 #include <numeric>
+#include <utilities/ThreadPool.h>
 
 using namespace Crypto;
 using namespace Logging;
@@ -109,6 +109,26 @@ namespace
         return result;
     }
 
+    size_t preprocessingThreadCount()
+    {
+        const size_t threads = std::thread::hardware_concurrency();
+
+        return threads == 0 ? 2 : threads;
+    }
+
+    const size_t PREPROCESSING_THREAD_COUNT = preprocessingThreadCount();
+
+    /* Shared by every consumer in the process - each wallet has a consumer
+       per view key, and a thread per core for each of them would quickly add
+       up. Created on first use, and kept alive, so we don't create and join a
+       thread per core for every batch of blocks either. */
+    Utilities::ThreadPool<std::error_code> &getPreprocessingThreadPool()
+    {
+        static Utilities::ThreadPool<std::error_code> threadPool(PREPROCESSING_THREAD_COUNT);
+
+        return threadPool;
+    }
+
 } // namespace
 
 namespace CryptoNote
@@ -244,111 +264,120 @@ namespace CryptoNote
         {
         };
 
-        std::vector<PreprocessedTx> preprocessedTransactions;
-        std::mutex preprocessedTransactionsMutex;
+        std::vector<Tx> inputTransactions;
 
-        size_t workers = std::thread::hardware_concurrency();
-        if (workers == 0)
+        size_t emptyBlockCount = 0;
+
+        for (uint32_t i = 0; i < count; ++i)
         {
-            workers = 2;
-        }
+            const auto &block = blocks[i].block;
 
-        BlockingQueue<Tx> inputQueue(workers * 2);
+            if (!block.is_initialized())
+            {
+                ++emptyBlockCount;
+                continue;
+            }
 
-        std::atomic<bool> stopProcessing(false);
-        std::atomic<size_t> emptyBlockCount(0);
+            // filter by syncStartTimestamp
+            if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp)
+            {
+                ++emptyBlockCount;
+                continue;
+            }
+
+            TransactionBlockInfo blockInfo;
+            blockInfo.height = startHeight + i;
+            blockInfo.timestamp = block->timestamp;
+            blockInfo.transactionIndex = 0; // position in block
 
-        auto pushingThread = std::async(std::launch::async, [&] {
-            for (uint32_t i = 0; i < count && !stopProcessing; ++i)
+            for (const auto &tx : blocks[i].transactions)
             {
-                const auto &block = blocks[i].block;
+                auto pubKey = tx->getTransactionPublicKey();
+                bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
 
-                if (!block.is_initialized())
+                /* Need to ensure we add the last tx in the block even if it
+                 * has a null pub key, as we use this to indicate when we
+                 * have finished processing a block. */
+                if (pubKey == Constants::NULL_PUBLIC_KEY && !isLastTransactionInBlock)
                 {
-                    ++emptyBlockCount;
+                    ++blockInfo.transactionIndex;
                     continue;
                 }
 
-                // filter by syncStartTimestamp
-                if (m_syncStart.timestamp && block->timestamp < m_syncStart.timestamp)
-                {
-                    ++emptyBlockCount;
-                    continue;
-                }
+                inputTransactions.push_back({blockInfo, tx.get(), isLastTransactionInBlock});
+                ++blockInfo.transactionIndex;
+            }
+        }
 
-                TransactionBlockInfo blockInfo;
-                blockInfo.height = startHeight + i;
-                blockInfo.timestamp = block->timestamp;
-                blockInfo.transactionIndex = 0; // position in block
+        /* Split the transactions into one contiguous range per worker. Each
+           worker writes to its own output buffer, so no locking is needed, and
+           as the ranges are in block order, concatenating the buffers in order
+           gives us the transactions sorted by height and index in block. */
+        const size_t chunkCount = std::max<size_t>(1, std::min(PREPROCESSING_THREAD_COUNT, inputTransactions.size()));
+        const size_t chunkSize = (inputTransactions.size() + chunkCount - 1) / std::max<size_t>(1, chunkCount);
 
-                for (const auto &tx : blocks[i].transactions)
-                {
-                    auto pubKey = tx->getTransactionPublicKey();
-                    bool isLastTransactionInBlock = blockInfo.transactionIndex + 1 == blocks[i].transactions.size();
+        std::vector<std::vector<PreprocessedTx>> preprocessedChunks(chunkCount);
+
+        std::atomic<bool> stopProcessing(false);
+
+        std::vector<std::future<std::error_code>> processingJobs;
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const size_t begin = std::min(chunk * chunkSize, inputTransactions.size());
+            const size_t end = std::min(begin + chunkSize, inputTransactions.size());
+
+            processingJobs.push_back(getPreprocessingThreadPool().addJob([&, chunk, begin, end]() {
+                auto &output = preprocessedChunks[chunk];
+                output.reserve(end - begin);
 
-                    /* Need to ensure we add the last tx in the block even if it
-                     * has a null pub key, as we use this to indicate when we
-                     * have finished processing a block. */
-                    if (pubKey == Constants::NULL_PUBLIC_KEY && !isLastTransactionInBlock)
+                std::error_code ec;
+
+                try
+                {
+                    for (size_t i = begin; i < end && !stopProcessing; ++i)
                     {
-                        ++blockInfo.transactionIndex;
-                        continue;
-                    }
+                        PreprocessedTx preprocessed;
+                        static_cast<Tx &>(preprocessed) = inputTransactions[i];
 
-                    Tx item = {blockInfo, tx.get(), isLastTransactionInBlock};
-                    inputQueue.push(item);
-                    ++blockInfo.transactionIndex;
-                }
-            }
+                        ec = preprocessOutputs(preprocessed.blockInfo, *preprocessed.tx, preprocessed);
 
-            inputQueue.close();
-        });
+                        if (ec)
+                        {
+                            break;
+                        }
 
-        auto processingFunction = [&] {
-            Tx item;
-            std::error_code ec;
-            while (!stopProcessing && inputQueue.pop(item))
-            {
-                PreprocessedTx output;
-                static_cast<Tx &>(output) = item;
+                        output.push_back(std::move(preprocessed));
+                    }
+                }
+                catch (const std::system_error &e)
+                {
+                    ec = e.code();
+                }
+                catch (const std::exception &)
+                {
+                    ec = std::make_error_code(std::errc::operation_canceled);
+                }
 
-                ec = preprocessOutputs(item.blockInfo, *item.tx, output);
                 if (ec)
                 {
                     stopProcessing = true;
-                    break;
                 }
 
-                std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-                preprocessedTransactions.push_back(std::move(output));
-            }
-            return ec;
-        };
-
-        std::vector<std::future<std::error_code>> processingThreads;
-        for (size_t i = 0; i < workers; ++i)
-        {
-            processingThreads.push_back(std::async(std::launch::async, processingFunction));
+                return ec;
+            }));
         }
 
         std::error_code processingError;
-        for (auto &f : processingThreads)
+
+        /* Always wait for every job, they reference our local state */
+        for (auto &job : processingJobs)
         {
-            try
-            {
-                std::error_code ec = f.get();
-                if (!processingError && ec)
-                {
-                    processingError = ec;
-                }
-            }
-            catch (const std::system_error &e)
-            {
-                processingError = e.code();
-            }
-            catch (const std::exception &)
+            std::error_code ec = job.get();
+
+            if (!processingError && ec)
             {
-                processingError = std::make_error_code(std::errc::operation_canceled);
+                processingError = ec;
             }
         }
 
@@ -362,31 +391,25 @@ namespace CryptoNote
         std::vector<Crypto::Hash> blockHashes = getBlockHashes(blocks, count);
         m_observerManager.notify(&IBlockchainConsumerObserver::onBlocksAdded, this, blockHashes);
 
-        // sort by block height and transaction index in block
-        std::sort(
-            preprocessedTransactions.begin(),
-            preprocessedTransactions.end(),
-            [](const PreprocessedTx &a, const PreprocessedTx &b) {
-                return std::tie(a.blockInfo.height, a.blockInfo.transactionIndex)
-                       < std::tie(b.blockInfo.height, b.blockInfo.transactionIndex);
-            });
-
         uint32_t processedBlockCount = static_cast<uint32_t>(emptyBlockCount);
         try
         {
-            for (const auto &tx : preprocessedTransactions)
+            for (const auto &chunk : preprocessedChunks)
             {
-                processTransaction(tx.blockInfo, *tx.tx, tx);
-
-                if (tx.isLastTransactionInBlock)
+                for (const auto &tx : chunk)
                 {
-                    ++processedBlockCount;
-                    m_logger(TRACE) << "Processed block " << processedBlockCount << " of " << count
-                                    << ", last processed block index " << tx.blockInfo.height << ", hash "
-                                    << blocks[processedBlockCount - 1].blockHash;
+                    processTransaction(tx.blockInfo, *tx.tx, tx);
+
+                    if (tx.isLastTransactionInBlock)
+                    {
+                        ++processedBlockCount;
+                        m_logger(TRACE) << "Processed block " << processedBlockCount << " of " << count
+                                        << ", last processed block index " << tx.blockInfo.height << ", hash "
+                                        << blocks[processedBlockCount - 1].blockHash;
 
-                    auto newHeight = startHeight + processedBlockCount - 1;
-                    forEachSubscription([newHeight](TransfersSubscription &sub) { sub.advanceHeight(newHeight); });
+                        auto newHeight = startHeight + processedBlockCount - 1;
+                        forEachSubscription([newHeight](TransfersSubscription &sub) { sub.advanceHeight(newHeight); });
+                    }
                 }
             }
         }
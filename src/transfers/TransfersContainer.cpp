@@ -13,7 +13,10 @@
 #include "serialization/BinaryOutputStreamSerializer.h"
 #include "serialization/SerializationOverloads.h"
 
+#include <algorithm>
 #include <config/Constants.h>
+#include <cstring>
+#include <limits>
 
 using namespace Common;
 using namespace Crypto;
@@ -38,122 +41,56 @@ namespace CryptoNote
 
     namespace
     {
-        template<typename TIterator> class TransferIteratorList
-        {
-          public:
-            TransferIteratorList(const TIterator &begin, const TIterator &end): m_end(end)
-            {
-                for (auto it = begin; it != end; ++it)
-                {
-                    m_list.emplace_back(it);
-                }
-            }
-
-            TransferIteratorList(TransferIteratorList<TIterator> &&other)
-            {
-                m_list = std::move(other.m_list);
-                m_end = std::move(other.m_end);
-            }
-
-            TransferIteratorList &operator=(TransferIteratorList<TIterator> &&other)
-            {
-                m_list = std::move(other.m_list);
-                m_end = std::move(other.m_end);
-                return *this;
-            }
-
-            void sort()
-            {
-                std::sort(m_list.begin(), m_list.end(), &TransferIteratorList::lessTIterator);
-            }
+        /* Marks the end of an output list */
+        const uint32_t NO_OUTPUT = std::numeric_limits<uint32_t>::max();
 
-            TIterator findFirstByAmount(uint64_t amount) const
-            {
-                auto listIt = std::find_if(
-                    m_list.begin(), m_list.end(), [amount](const TIterator &it) { return it->amount == amount; });
-                return listIt == m_list.end() ? m_end : *listIt;
-            }
+        /* Key images are effectively random, so the leading bytes are as good
+           as a hash of the whole thing */
+        uint64_t keyImagePrefix(const KeyImage &keyImage)
+        {
+            uint64_t prefix;
+            std::memcpy(&prefix, keyImage.data, sizeof(prefix));
+            return prefix;
+        }
 
-            TIterator minElement() const
-            {
-                auto listIt = std::min_element(m_list.begin(), m_list.end(), &TransferIteratorList::lessTIterator);
-                return listIt == m_list.end() ? m_end : *listIt;
-            }
+        /* Appends to the end of the list, so lists keep the order outputs
+           were added in. Transactions only have a handful of outputs and
+           inputs, so walking the list is cheap. */
+        template<typename Record>
+        void appendToList(std::vector<Record> &records, uint32_t &head, uint32_t Record::*next, uint32_t id)
+        {
+            uint32_t *link = &head;
 
-          private:
-            static bool lessTIterator(const TIterator &it1, const TIterator &it2)
+            while (*link != NO_OUTPUT)
             {
-                return (it1->blockHeight < it2->blockHeight)
-                       || (it1->blockHeight == it2->blockHeight && it1->transactionIndex < it2->transactionIndex);
+                link = &(records[*link].*next);
             }
 
-          private:
-            std::vector<TIterator> m_list;
-
-            TIterator m_end;
-        };
-
-        template<typename TIterator>
-        TransferIteratorList<TIterator> createTransferIteratorList(const std::pair<TIterator, TIterator> &itPair)
-        {
-            return TransferIteratorList<TIterator>(itPair.first, itPair.second);
+            *link = id;
+            records[id].*next = NO_OUTPUT;
         }
-    } // namespace
-
-    SpentOutputDescriptor::SpentOutputDescriptor(): m_type(TransactionTypes::OutputType::Invalid) {}
 
-    SpentOutputDescriptor::SpentOutputDescriptor(const TransactionOutputInformationIn &transactionInfo):
-        m_type(transactionInfo.type),
-        m_amount(0),
-        m_globalOutputIndex(0)
-    {
-        if (m_type == TransactionTypes::OutputType::Key)
-        {
-            m_keyImage = &transactionInfo.keyImage;
-        }
-        else
+        template<typename Record>
+        void removeFromList(std::vector<Record> &records, uint32_t &head, uint32_t Record::*next, uint32_t id)
         {
-            assert(false);
-        }
-    }
-
-    SpentOutputDescriptor::SpentOutputDescriptor(const KeyImage *keyImage)
-    {
-        assign(keyImage);
-    }
+            uint32_t *link = &head;
 
-    void SpentOutputDescriptor::assign(const KeyImage *keyImage)
-    {
-        m_type = TransactionTypes::OutputType::Key;
-        m_keyImage = keyImage;
-    }
+            while (*link != id)
+            {
+                assert(*link != NO_OUTPUT);
+                link = &(records[*link].*next);
+            }
 
-    bool SpentOutputDescriptor::operator==(const SpentOutputDescriptor &other) const
-    {
-        if (m_type == TransactionTypes::OutputType::Key)
-        {
-            return other.m_type == m_type && *other.m_keyImage == *m_keyImage;
+            *link = records[id].*next;
         }
-        else
-        {
-            assert(false);
-            return false;
-        }
-    }
 
-    size_t SpentOutputDescriptor::hash() const
-    {
-        if (m_type == TransactionTypes::OutputType::Key)
+        template<typename Record> bool isEarlier(const Record &first, const Record &second)
         {
-            static_assert(sizeof(size_t) < sizeof(*m_keyImage), "sizeof(size_t) < sizeof(*m_keyImage)");
-            return *reinterpret_cast<const size_t *>(m_keyImage->data);
+            return (first.transaction->blockHeight < second.transaction->blockHeight)
+                   || (first.transaction->blockHeight == second.transaction->blockHeight
+                       && first.transaction->transactionIndex < second.transaction->transactionIndex);
         }
-        else
-        {
-            assert(false);
-            return 0;
-        }
-    }
+    } // namespace
 
     TransfersContainer::TransfersContainer(
         const Currency &currency,
@@ -164,6 +101,7 @@ namespace CryptoNote
         m_logger(logger, "TransfersContainer"),
         m_transactionSpendableAge(transactionSpendableAge)
     {
+        clearStateLists();
     }
 
     bool TransfersContainer::addTransaction(
@@ -171,61 +109,66 @@ namespace CryptoNote
         const ITransactionReader &tx,
         const std::vector<TransactionOutputInformationIn> &transfers)
     {
-        try
-        {
-            std::unique_lock<std::mutex> lock(m_mutex);
-
-            if (block.height < m_currentHeight)
-            {
-                auto message = "Failed to add transaction: block index < m_currentHeight";
-                m_logger(ERROR, BRIGHT_RED)
-                    << message << ", block " << block.height << ", m_currentHeight " << m_currentHeight;
-                throw std::invalid_argument(message);
-            }
+        std::unique_lock<std::mutex> lock(m_mutex);
 
-            if (m_transactions.count(tx.getTransactionHash()) > 0)
-            {
-                auto message = "Transaction is already added";
-                m_logger(ERROR, BRIGHT_RED) << message << ", hash " << tx.getTransactionHash();
-                throw std::invalid_argument(message);
-            }
+        if (block.height < m_currentHeight)
+        {
+            auto message = "Failed to add transaction: block index < m_currentHeight";
+            m_logger(ERROR, BRIGHT_RED) << message << ", block " << block.height << ", m_currentHeight "
+                                        << m_currentHeight;
+            throw std::invalid_argument(message);
+        }
 
-            bool added = addTransactionOutputs(block, tx, transfers);
-            added |= addTransactionInputs(block, tx);
+        if (m_transactions.count(tx.getTransactionHash()) > 0)
+        {
+            auto message = "Transaction is already added";
+            m_logger(ERROR, BRIGHT_RED) << message << ", hash " << tx.getTransactionHash();
+            throw std::invalid_argument(message);
+        }
 
-            if (added)
-            {
-                addTransaction(block, tx);
-            }
+        /* The outputs point at the transaction, so it has to go in first.
+           It's removed again if none of the transfers belong to us. */
+        const TransactionEntry &transaction = addTransaction(block, tx);
 
-            if (block.height != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
-            {
-                m_currentHeight = block.height;
-            }
+        bool added = false;
 
-            return added;
+        try
+        {
+            added = addTransactionOutputs(transaction, tx, transfers);
+            added |= addTransactionInputs(transaction, tx);
         }
         catch (...)
         {
-            if (m_transactions.count(tx.getTransactionHash()) == 0)
-            {
-                m_logger(ERROR, BRIGHT_RED) << "Failed to add transaction, remove transaction transfers, block "
-                                            << block.height << ", transaction hash " << tx.getTransactionHash();
-                deleteTransactionTransfers(tx.getTransactionHash());
-            }
+            m_logger(ERROR, BRIGHT_RED) << "Failed to add transaction, remove transaction transfers, block "
+                                        << block.height << ", transaction hash " << tx.getTransactionHash();
+            deleteTransactionTransfers(transaction);
+            m_transactions.erase(tx.getTransactionHash());
 
             throw;
         }
+
+        if (!added)
+        {
+            m_transactions.erase(tx.getTransactionHash());
+        }
+
+        if (block.height != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
+        {
+            m_currentHeight = block.height;
+        }
+
+        return added;
     }
 
     /**
      * \pre m_mutex is locked.
      */
-    void TransfersContainer::addTransaction(const TransactionBlockInfo &block, const ITransactionReader &tx)
+    const TransfersContainer::TransactionEntry &
+        TransfersContainer::addTransaction(const TransactionBlockInfo &block, const ITransactionReader &tx)
     {
         auto txHash = tx.getTransactionHash();
 
-        TransactionInformation txInfo;
+        TransactionEntry txInfo;
         txInfo.blockHeight = block.height;
         txInfo.timestamp = block.timestamp;
         txInfo.transactionHash = txHash;
@@ -234,6 +177,9 @@ namespace CryptoNote
         txInfo.totalAmountIn = tx.getInputTotalAmount();
         txInfo.totalAmountOut = tx.getOutputTotalAmount();
         txInfo.extra = tx.getExtra();
+        txInfo.transactionIndex = block.transactionIndex;
+        txInfo.firstOutput = NO_OUTPUT;
+        txInfo.firstSpentOutput = NO_OUTPUT;
 
         if (!tx.getPaymentId(txInfo.paymentId))
         {
@@ -241,22 +187,22 @@ namespace CryptoNote
         }
 
         auto result = m_transactions.insert(std::move(txInfo));
-        (void)result; // Disable unused warning
         assert(result.second);
+
+        return *result.first;
     }
 
     /**
      * \pre m_mutex is locked.
      */
     bool TransfersContainer::addTransactionOutputs(
-        const TransactionBlockInfo &block,
+        const TransactionEntry &transaction,
         const ITransactionReader &tx,
         const std::vector<TransactionOutputInformationIn> &transfers)
     {
         bool outputsAdded = false;
 
-        auto txHash = tx.getTransactionHash();
-        bool transactionIsUnconfimed = (block.height == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
+        bool transactionIsUnconfimed = (transaction.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
         for (const auto &transfer : transfers)
         {
             assert(transfer.outputInTransaction < tx.getOutputCount());
@@ -272,66 +218,33 @@ namespace CryptoNote
                 throw std::invalid_argument(message);
             }
 
-            TransactionOutputInformationEx info;
-            static_cast<TransactionOutputInformationIn &>(info) = transfer;
-            info.blockHeight = block.height;
-            info.transactionIndex = block.transactionIndex;
-            info.unlockTime = tx.getUnlockTime();
-            info.transactionHash = txHash;
-            info.visible = true;
-
-            if (transferIsUnconfirmed)
+            if (!transferIsUnconfirmed && transfer.type == TransactionTypes::OutputType::Key)
             {
-                auto result = m_unconfirmedTransfers.insert(std::move(info));
-                (void)result; // Disable unused warning
-                assert(result.second);
-            }
-            else
-            {
-                if (info.type == TransactionTypes::OutputType::Key)
-                {
-                    bool duplicate = false;
-                    SpentOutputDescriptor descriptor(transfer);
+                const uint32_t head = findKeyImageListHead(transfer.keyImage);
 
-                    auto availableRange =
-                        m_availableTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
-                    for (auto it = availableRange.first; !duplicate && it != availableRange.second; ++it)
-                    {
-                        if (it->transactionHash == info.transactionHash
-                            && it->outputInTransaction == info.outputInTransaction)
-                        {
-                            duplicate = true;
-                        }
-                    }
-
-                    auto spentRange = m_spentTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
-                    for (auto it = spentRange.first; !duplicate && it != spentRange.second; ++it)
-                    {
-                        if (it->transactionHash == info.transactionHash
-                            && it->outputInTransaction == info.outputInTransaction)
-                        {
-                            duplicate = true;
-                        }
-                    }
+                for (uint32_t id = head; id != NO_OUTPUT; id = m_outputs[id].nextWithKeyImage)
+                {
+                    const auto &output = m_outputs[id];
 
-                    if (duplicate)
+                    if (output.state != OutputState::Unconfirmed && output.keyImage == transfer.keyImage
+                        && output.transaction->transactionHash == transaction.transactionHash
+                        && output.outputInTransaction == transfer.outputInTransaction)
                     {
                         auto message = "Failed to add transaction output: key output already exists";
                         m_logger(ERROR, BRIGHT_RED)
-                            << message << ", transaction hash " << info.transactionHash << ", output index "
-                            << info.outputInTransaction << ", key image " << info.keyImage;
+                            << message << ", transaction hash " << transaction.transactionHash << ", output index "
+                            << transfer.outputInTransaction << ", key image " << transfer.keyImage;
                         throw std::runtime_error(message);
                     }
                 }
-
-                auto result = m_availableTransfers.insert(std::move(info));
-                (void)result; // Disable unused warning
-                assert(result.second);
             }
 
-            if (info.type == TransactionTypes::OutputType::Key)
+            insertOutput(
+                transfer, transaction, transferIsUnconfirmed ? OutputState::Unconfirmed : OutputState::Available, true);
+
+            if (transfer.type == TransactionTypes::OutputType::Key)
             {
-                updateTransfersVisibility(info.keyImage);
+                updateTransfersVisibility(transfer.keyImage);
             }
 
             outputsAdded = true;
@@ -343,7 +256,7 @@ namespace CryptoNote
     /**
      * \pre m_mutex is locked.
      */
-    bool TransfersContainer::addTransactionInputs(const TransactionBlockInfo &block, const ITransactionReader &tx)
+    bool TransfersContainer::addTransactionInputs(const TransactionEntry &transaction, const ITransactionReader &tx)
     {
         bool inputsAdded = false;
 
@@ -356,18 +269,51 @@ namespace CryptoNote
                 KeyInput input;
                 tx.getInput(i, input);
 
-                SpentOutputDescriptor descriptor(&input.keyImage);
-                auto spentRange = m_spentTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
-                if (std::distance(spentRange.first, spentRange.second) > 0)
+                uint32_t spentId = NO_OUTPUT;
+                uint32_t spendingId = NO_OUTPUT;
+                size_t availableCount = 0;
+                size_t unconfirmedCount = 0;
+
+                for (uint32_t id = findKeyImageListHead(input.keyImage); id != NO_OUTPUT;
+                     id = m_outputs[id].nextWithKeyImage)
+                {
+                    const auto &output = m_outputs[id];
+
+                    if (!(output.keyImage == input.keyImage))
+                    {
+                        continue;
+                    }
+
+                    if (output.state == OutputState::Spent)
+                    {
+                        spentId = id;
+                    }
+                    else if (output.state == OutputState::Unconfirmed)
+                    {
+                        unconfirmedCount++;
+                    }
+                    else
+                    {
+                        availableCount++;
+
+                        /* Spend the earliest output with a matching amount */
+                        if (output.amount == input.amount
+                            && (spendingId == NO_OUTPUT || isEarlier(output, m_outputs[spendingId])))
+                        {
+                            spendingId = id;
+                        }
+                    }
+                }
+
+                if (spentId != NO_OUTPUT)
                 {
-                    assert(std::distance(spentRange.first, spentRange.second) == 1);
-                    const auto &spentOutput = *spentRange.first;
+                    const auto spentOutput = getSpentOutput(m_outputs[spentId]);
                     auto message = "Failed add key input: key image already spent";
                     m_logger(ERROR, BRIGHT_RED)
                         << message << ", key image " << input.keyImage << '\n'
                         << "    rejected transaction"
-                        << ": hash " << tx.getTransactionHash() << ", block " << block.height << ", transaction index "
-                        << block.transactionIndex << ", input " << i << '\n'
+                        << ": hash " << tx.getTransactionHash() << ", block " << transaction.blockHeight
+                        << ", transaction index " << transaction.transactionIndex << ", input " << i << '\n'
                         << "    spending transaction"
                         << ": hash " << spentOutput.spendingTransactionHash << ", block "
                         << spentOutput.spendingBlock.height << ", input " << spentOutput.inputInTransaction << '\n'
@@ -379,12 +325,6 @@ namespace CryptoNote
                     throw std::runtime_error(message);
                 }
 
-                auto availableRange = m_availableTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
-                auto unconfirmedRange =
-                    m_unconfirmedTransfers.get<SpentOutputDescriptorIndex>().equal_range(descriptor);
-                size_t availableCount = std::distance(availableRange.first, availableRange.second);
-                size_t unconfirmedCount = std::distance(unconfirmedRange.first, unconfirmedRange.second);
-
                 if (availableCount == 0)
                 {
                     if (unconfirmedCount > 0)
@@ -400,14 +340,7 @@ namespace CryptoNote
                     }
                 }
 
-                auto &outputDescriptorIndex = m_availableTransfers.get<SpentOutputDescriptorIndex>();
-                auto availableOutputsRange = outputDescriptorIndex.equal_range(SpentOutputDescriptor(&input.keyImage));
-
-                auto iteratorList = createTransferIteratorList(availableOutputsRange);
-                iteratorList.sort();
-                auto spendingTransferIt = iteratorList.findFirstByAmount(input.amount);
-
-                if (spendingTransferIt == availableOutputsRange.second)
+                if (spendingId == NO_OUTPUT)
                 {
                     auto message = "Failed to add key input: invalid amount";
                     m_logger(ERROR, BRIGHT_RED) << message << ", key image " << input.keyImage << ", amount "
@@ -415,10 +348,7 @@ namespace CryptoNote
                     throw std::runtime_error(message);
                 }
 
-                assert(spendingTransferIt->keyImage == input.keyImage);
-                copyToSpent(block, tx, i, *spendingTransferIt);
-                // erase from available outputs
-                outputDescriptorIndex.erase(spendingTransferIt);
+                spendOutput(transaction, i, spendingId);
                 updateTransfersVisibility(input.keyImage);
 
                 inputsAdded = true;
@@ -447,7 +377,7 @@ namespace CryptoNote
         }
         else
         {
-            deleteTransactionTransfers(it->transactionHash);
+            deleteTransactionTransfers(*it);
             m_transactions.erase(it);
             return true;
         }
@@ -478,180 +408,308 @@ namespace CryptoNote
             return false;
         }
 
-        try
+        /* Validate everything up front, so there is nothing to roll back */
+        for (uint32_t id = transactionIt->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
         {
-            auto txInfo = *transactionIt;
-            txInfo.blockHeight = block.height;
-            txInfo.timestamp = block.timestamp;
-            m_transactions.replace(transactionIt, txInfo);
+            const auto &output = m_outputs[id];
 
-            auto availableRange = m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-            for (auto transferIt = availableRange.first; transferIt != availableRange.second;)
+            if (output.outputInTransaction >= globalIndices.size())
             {
-                auto transfer = *transferIt;
-                assert(transfer.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
-                assert(transfer.globalOutputIndex == UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
-                if (transfer.outputInTransaction >= globalIndices.size())
-                {
-                    auto message = "Failed to confirm transaction: not enough elements in globalIndices";
-                    m_logger(ERROR, BRIGHT_RED) << message << ", globalIndices.size() " << globalIndices.size()
-                                                << ", output index " << transfer.outputInTransaction;
-                    throw std::invalid_argument(message);
-                }
+                auto message = "Failed to confirm transaction: not enough elements in globalIndices";
+                m_logger(ERROR, BRIGHT_RED) << message << ", globalIndices.size() " << globalIndices.size()
+                                            << ", output index " << output.outputInTransaction;
+                throw std::invalid_argument(message);
+            }
+        }
 
-                transfer.blockHeight = block.height;
-                transfer.transactionIndex = block.transactionIndex;
-                transfer.globalOutputIndex = globalIndices[transfer.outputInTransaction];
+        /* The outputs, and the outputs this transaction spends, take their
+           block from the transaction, so only it needs updating */
+        m_transactions.modify(transactionIt, [&block](TransactionEntry &transaction) {
+            transaction.blockHeight = block.height;
+            transaction.timestamp = block.timestamp;
+            transaction.transactionIndex = block.transactionIndex;
+        });
 
-                auto result = m_availableTransfers.insert(std::move(transfer));
-                (void)result; // Disable unused warning
-                assert(result.second);
+        for (uint32_t id = transactionIt->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
+        {
+            auto &output = m_outputs[id];
 
-                transferIt = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(transferIt);
+            assert(output.state == OutputState::Unconfirmed);
+            assert(output.globalOutputIndex == UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
 
-                if (transfer.type == TransactionTypes::OutputType::Key)
-                {
-                    updateTransfersVisibility(transfer.keyImage);
-                }
-            }
+            output.globalOutputIndex = globalIndices[output.outputInTransaction];
+            setOutputState(id, OutputState::Available);
 
-            auto &spendingTransactionIndex = m_spentTransfers.get<SpendingTransactionIndex>();
-            auto spentRange = spendingTransactionIndex.equal_range(transactionHash);
-            for (auto transferIt = spentRange.first; transferIt != spentRange.second; ++transferIt)
+            if (output.type == TransactionTypes::OutputType::Key)
             {
-                auto transfer = *transferIt;
-                assert(transfer.spendingBlock.height == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
-
-                transfer.spendingBlock = block;
-                spendingTransactionIndex.replace(transferIt, transfer);
+                updateTransfersVisibility(output.keyImage);
             }
         }
-        catch (std::exception &e)
+
+        return true;
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    void TransfersContainer::deleteTransactionTransfers(const TransactionEntry &transaction)
+    {
+        while (transaction.firstSpentOutput != NO_OUTPUT)
+        {
+            const uint32_t id = transaction.firstSpentOutput;
+
+            assert(m_outputs[id].transaction->blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
+            assert(m_outputs[id].globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
+
+            unspendOutput(id);
+            updateTransfersVisibility(m_outputs[id].keyImage);
+        }
+
+        /* This includes any outputs which have been spent, as they can't
+           outlive the transaction they point at */
+        while (transaction.firstOutput != NO_OUTPUT)
         {
-            m_logger(ERROR, BRIGHT_RED) << "markTransactionConfirmed failed: " << e.what()
-                                        << ", rollback changes, block index " << block.height << ", tx "
-                                        << transactionHash;
+            const uint32_t id = transaction.firstOutput;
+            const KeyImage keyImage = m_outputs[id].keyImage;
+            const auto type = m_outputs[id].type;
 
-            auto txInfo = *transactionIt;
-            txInfo.blockHeight = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
-            txInfo.timestamp = 0;
-            m_transactions.replace(transactionIt, txInfo);
+            eraseOutput(id);
 
-            auto availableRange = m_availableTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-            for (auto transferIt = availableRange.first; transferIt != availableRange.second;)
+            if (type == TransactionTypes::OutputType::Key)
             {
-                TransactionOutputInformationEx unconfirmedTransfer = *transferIt;
-                assert(unconfirmedTransfer.blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
-                assert(unconfirmedTransfer.globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
-                unconfirmedTransfer.blockHeight = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
-                unconfirmedTransfer.transactionIndex = 0;
-                unconfirmedTransfer.globalOutputIndex = UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX;
+                updateTransfersVisibility(keyImage);
+            }
+        }
+    }
 
-                auto result = m_unconfirmedTransfers.insert(std::move(unconfirmedTransfer));
-                (void)result; // Disable unused warning
-                assert(result.second);
+    /**
+     * \pre m_mutex is locked.
+     */
+    void TransfersContainer::spendOutput(const TransactionEntry &transaction, size_t inputIndex, uint32_t outputId)
+    {
+        auto &output = m_outputs[outputId];
 
-                transferIt = m_availableTransfers.get<ContainingTransactionIndex>().erase(transferIt);
+        assert(output.state == OutputState::Available);
+        assert(output.transaction->blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
+        assert(output.globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
 
-                if (unconfirmedTransfer.type == TransactionTypes::OutputType::Key)
-                {
-                    updateTransfersVisibility(unconfirmedTransfer.keyImage);
-                }
-            }
+        setOutputState(outputId, OutputState::Spent);
+        output.spendingTransaction = &transaction;
+        output.inputInTransaction = static_cast<uint32_t>(inputIndex);
 
-            auto &spendingTransactionIndex = m_spentTransfers.get<SpendingTransactionIndex>();
-            auto spentRange = spendingTransactionIndex.equal_range(transactionHash);
-            for (auto transferIt = spentRange.first; transferIt != spentRange.second; ++transferIt)
-            {
-                auto spentTransfer = *transferIt;
-                spentTransfer.spendingBlock.height = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
-                spentTransfer.spendingBlock.timestamp = 0;
-                spentTransfer.spendingBlock.transactionIndex = 0;
+        appendToList(m_outputs, transaction.firstSpentOutput, &OutputRecord::nextSpentInTransaction, outputId);
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    void TransfersContainer::unspendOutput(uint32_t outputId)
+    {
+        auto &output = m_outputs[outputId];
 
-                spendingTransactionIndex.replace(transferIt, spentTransfer);
+        assert(output.state == OutputState::Spent);
+
+        removeFromList(
+            m_outputs, output.spendingTransaction->firstSpentOutput, &OutputRecord::nextSpentInTransaction, outputId);
+
+        setOutputState(outputId, OutputState::Available);
+        output.spendingTransaction = nullptr;
+        output.inputInTransaction = 0;
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    uint32_t TransfersContainer::insertOutput(
+        const TransactionOutputInformationIn &output,
+        const TransactionEntry &transaction,
+        OutputState state,
+        bool visible)
+    {
+        OutputRecord record;
+        record.outputKey = output.outputKey;
+        record.keyImage = output.keyImage;
+        record.amount = output.amount;
+        record.transaction = &transaction;
+        record.spendingTransaction = nullptr;
+        record.globalOutputIndex = output.globalOutputIndex;
+        record.outputInTransaction = output.outputInTransaction;
+        record.inputInTransaction = 0;
+        record.nextInTransaction = NO_OUTPUT;
+        record.nextSpentInTransaction = NO_OUTPUT;
+        record.type = output.type;
+        record.state = OutputState::Free;
+        record.visible = visible;
+
+        uint32_t id;
+
+        if (!m_freeOutputs.empty())
+        {
+            id = m_freeOutputs.back();
+            m_freeOutputs.pop_back();
+            m_outputs[id] = record;
+        }
+        else
+        {
+            if (m_outputs.size() >= NO_OUTPUT)
+            {
+                throw std::runtime_error("Too many outputs in transfers container");
             }
 
-            throw;
+            id = static_cast<uint32_t>(m_outputs.size());
+            m_outputs.push_back(record);
         }
 
-        return true;
+        appendToList(m_outputs, transaction.firstOutput, &OutputRecord::nextInTransaction, id);
+        setOutputState(id, state);
+
+        /* Order doesn't matter here, so push onto the front */
+        auto head = m_keyImageIndex.try_emplace(keyImagePrefix(record.keyImage), NO_OUTPUT).first;
+        m_outputs[id].nextWithKeyImage = head->second;
+        head->second = id;
+
+        return id;
     }
 
     /**
      * \pre m_mutex is locked.
      */
-    void TransfersContainer::deleteTransactionTransfers(const Hash &transactionHash)
+    void TransfersContainer::eraseOutput(uint32_t outputId)
     {
-        auto &spendingTransactionIndex = m_spentTransfers.get<SpendingTransactionIndex>();
-        auto spentTransfersRange = spendingTransactionIndex.equal_range(transactionHash);
-        for (auto it = spentTransfersRange.first; it != spentTransfersRange.second;)
+        auto &output = m_outputs[outputId];
+
+        if (output.state == OutputState::Spent)
         {
-            assert(it->blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
-            assert(it->globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
+            unspendOutput(outputId);
+        }
 
-            auto result = m_availableTransfers.insert(static_cast<const TransactionOutputInformationEx &>(*it));
-            assert(result.second);
-            it = spendingTransactionIndex.erase(it);
+        removeFromList(m_outputs, output.transaction->firstOutput, &OutputRecord::nextInTransaction, outputId);
 
-            if (result.first->type == TransactionTypes::OutputType::Key)
-            {
-                updateTransfersVisibility(result.first->keyImage);
-            }
+        auto head = m_keyImageIndex.find(keyImagePrefix(output.keyImage));
+        assert(head != m_keyImageIndex.end());
+
+        removeFromList(m_outputs, head->second, &OutputRecord::nextWithKeyImage, outputId);
+
+        if (head->second == NO_OUTPUT)
+        {
+            m_keyImageIndex.erase(head);
         }
 
-        auto unconfirmedTransfersRange =
-            m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-        for (auto it = unconfirmedTransfersRange.first; it != unconfirmedTransfersRange.second;)
+        setOutputState(outputId, OutputState::Free);
+        output.transaction = nullptr;
+        output.visible = false;
+
+        m_freeOutputs.push_back(outputId);
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    void TransfersContainer::setOutputState(uint32_t outputId, OutputState state)
+    {
+        auto &output = m_outputs[outputId];
+
+        if (output.state != OutputState::Free)
         {
-            if (it->type == TransactionTypes::OutputType::Key)
+            auto &list = m_stateLists[static_cast<size_t>(output.state)];
+
+            if (output.previousInState == NO_OUTPUT)
             {
-                KeyImage keyImage = it->keyImage;
-                it = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(it);
-                updateTransfersVisibility(keyImage);
+                list.head = output.nextInState;
+            }
+            else
+            {
+                m_outputs[output.previousInState].nextInState = output.nextInState;
+            }
+
+            if (output.nextInState == NO_OUTPUT)
+            {
+                list.tail = output.previousInState;
             }
             else
             {
-                it = m_unconfirmedTransfers.get<ContainingTransactionIndex>().erase(it);
+                m_outputs[output.nextInState].previousInState = output.previousInState;
             }
+
+            list.count--;
         }
 
-        auto &transactionTransfersIndex = m_availableTransfers.get<ContainingTransactionIndex>();
-        auto transactionTransfersRange = transactionTransfersIndex.equal_range(transactionHash);
-        for (auto it = transactionTransfersRange.first; it != transactionTransfersRange.second;)
+        output.state = state;
+        output.previousInState = NO_OUTPUT;
+        output.nextInState = NO_OUTPUT;
+
+        if (state != OutputState::Free)
         {
-            if (it->type == TransactionTypes::OutputType::Key)
+            auto &list = m_stateLists[static_cast<size_t>(state)];
+
+            if (list.tail == NO_OUTPUT)
             {
-                KeyImage keyImage = it->keyImage;
-                it = transactionTransfersIndex.erase(it);
-                updateTransfersVisibility(keyImage);
+                list.head = outputId;
             }
             else
             {
-                it = transactionTransfersIndex.erase(it);
+                m_outputs[list.tail].nextInState = outputId;
+                output.previousInState = list.tail;
             }
+
+            list.tail = outputId;
+            list.count++;
         }
     }
 
-    /**
-     * \pre m_mutex is locked.
-     */
-    void TransfersContainer::copyToSpent(
-        const TransactionBlockInfo &block,
-        const ITransactionReader &tx,
-        size_t inputIndex,
-        const TransactionOutputInformationEx &output)
+    const TransfersContainer::StateList &TransfersContainer::stateList(OutputState state) const
     {
-        assert(output.blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT);
-        assert(output.globalOutputIndex != UNCONFIRMED_TRANSACTION_GLOBAL_OUTPUT_INDEX);
+        return m_stateLists[static_cast<size_t>(state)];
+    }
 
-        SpentTransactionOutput spentOutput;
-        static_cast<TransactionOutputInformationEx &>(spentOutput) = output;
-        spentOutput.spendingBlock = block;
-        spentOutput.spendingTransactionHash = tx.getTransactionHash();
-        spentOutput.inputInTransaction = static_cast<uint32_t>(inputIndex);
-        auto result = m_spentTransfers.insert(std::move(spentOutput));
-        (void)result; // Disable unused warning
-        assert(result.second);
+    void TransfersContainer::clearStateLists()
+    {
+        for (auto &list : m_stateLists)
+        {
+            list.head = NO_OUTPUT;
+            list.tail = NO_OUTPUT;
+            list.count = 0;
+        }
+    }
+
+    uint32_t TransfersContainer::findKeyImageListHead(const KeyImage &keyImage) const
+    {
+        const auto head = m_keyImageIndex.find(keyImagePrefix(keyImage));
+        return head == m_keyImageIndex.end() ? NO_OUTPUT : head->second;
+    }
+
+    TransactionOutputInformationEx TransfersContainer::getOutputInformation(const OutputRecord &output) const
+    {
+        TransactionOutputInformationEx info;
+        info.type = output.type;
+        info.amount = output.amount;
+        info.globalOutputIndex = output.globalOutputIndex;
+        info.outputInTransaction = output.outputInTransaction;
+        info.transactionHash = output.transaction->transactionHash;
+        info.transactionPublicKey = output.transaction->publicKey;
+        info.outputKey = output.outputKey;
+        info.keyImage = output.keyImage;
+        info.unlockTime = output.transaction->unlockTime;
+        info.blockHeight = output.transaction->blockHeight;
+        info.transactionIndex = output.transaction->transactionIndex;
+        info.visible = output.visible;
+
+        return info;
+    }
+
+    SpentTransactionOutput TransfersContainer::getSpentOutput(const OutputRecord &output) const
+    {
+        assert(output.state == OutputState::Spent);
+
+        SpentTransactionOutput spent;
+        static_cast<TransactionOutputInformationEx &>(spent) = getOutputInformation(output);
+        spent.spendingBlock.height = output.spendingTransaction->blockHeight;
+        spent.spendingBlock.timestamp = output.spendingTransaction->timestamp;
+        spent.spendingBlock.transactionIndex = output.spendingTransaction->transactionIndex;
+        spent.spendingTransactionHash = output.spendingTransaction->transactionHash;
+        spent.inputInTransaction = output.inputInTransaction;
+
+        return spent;
     }
 
     std::vector<Hash> TransfersContainer::detach(uint32_t height)
@@ -662,7 +720,6 @@ namespace CryptoNote
         std::lock_guard<std::mutex> lk(m_mutex);
 
         std::vector<Hash> deletedTransactions;
-        auto &spendingTransactionIndex = m_spentTransfers.get<SpendingTransactionIndex>();
         auto &blockHeightIndex = m_transactions.get<1>();
         auto it = blockHeightIndex.end();
         while (it != blockHeightIndex.begin())
@@ -672,10 +729,9 @@ namespace CryptoNote
             bool doDelete = false;
             if (it->blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
             {
-                auto range = spendingTransactionIndex.equal_range(it->transactionHash);
-                for (auto spentTransferIt = range.first; spentTransferIt != range.second; ++spentTransferIt)
+                for (uint32_t id = it->firstSpentOutput; id != NO_OUTPUT; id = m_outputs[id].nextSpentInTransaction)
                 {
-                    if (spentTransferIt->blockHeight >= height)
+                    if (m_outputs[id].transaction->blockHeight >= height)
                     {
                         doDelete = true;
                         break;
@@ -693,7 +749,7 @@ namespace CryptoNote
 
             if (doDelete)
             {
-                deleteTransactionTransfers(it->transactionHash);
+                deleteTransactionTransfers(*it);
                 deletedTransactions.emplace_back(it->transactionHash);
                 it = blockHeightIndex.erase(it);
             }
@@ -705,60 +761,72 @@ namespace CryptoNote
         return deletedTransactions;
     }
 
-    namespace
-    {
-        template<typename C, typename T> void updateVisibility(C &collection, const T &range, bool visible)
-        {
-            for (auto it = range.first; it != range.second; ++it)
-            {
-                auto updated = *it;
-                updated.visible = visible;
-                collection.replace(it, updated);
-            }
-        }
-    } // namespace
-
     /**
      * \pre m_mutex is locked.
      */
     void TransfersContainer::updateTransfersVisibility(const KeyImage &keyImage)
     {
-        auto &unconfirmedIndex = m_unconfirmedTransfers.get<SpentOutputDescriptorIndex>();
-        auto &availableIndex = m_availableTransfers.get<SpentOutputDescriptorIndex>();
-        auto &spentIndex = m_spentTransfers.get<SpentOutputDescriptorIndex>();
-
-        SpentOutputDescriptor descriptor(&keyImage);
-        auto unconfirmedRange = unconfirmedIndex.equal_range(descriptor);
-        auto availableRange = availableIndex.equal_range(descriptor);
-        auto spentRange = spentIndex.equal_range(descriptor);
-
-        size_t unconfirmedCount = std::distance(unconfirmedRange.first, unconfirmedRange.second);
-        size_t availableCount = std::distance(availableRange.first, availableRange.second);
-        size_t spentCount = std::distance(spentRange.first, spentRange.second);
-        assert(spentCount == 0 || spentCount == 1);
+        const uint32_t head = findKeyImageListHead(keyImage);
 
-        if (spentCount > 0)
-        {
-            updateVisibility(unconfirmedIndex, unconfirmedRange, false);
-            updateVisibility(availableIndex, availableRange, false);
-            updateVisibility(spentIndex, spentRange, true);
-        }
-        else if (availableCount > 0)
+        size_t unconfirmedCount = 0;
+        size_t availableCount = 0;
+        size_t spentCount = 0;
+        uint32_t earliestAvailable = NO_OUTPUT;
+
+        for (uint32_t id = head; id != NO_OUTPUT; id = m_outputs[id].nextWithKeyImage)
         {
-            updateVisibility(unconfirmedIndex, unconfirmedRange, false);
-            updateVisibility(availableIndex, availableRange, false);
+            const auto &output = m_outputs[id];
 
-            auto iteratorList = createTransferIteratorList(availableRange);
-            auto earliestTransferIt = iteratorList.minElement();
-            assert(earliestTransferIt != availableRange.second);
+            if (!(output.keyImage == keyImage))
+            {
+                continue;
+            }
 
-            auto earliestTransfer = *earliestTransferIt;
-            earliestTransfer.visible = true;
-            availableIndex.replace(earliestTransferIt, earliestTransfer);
+            if (output.state == OutputState::Unconfirmed)
+            {
+                unconfirmedCount++;
+            }
+            else if (output.state == OutputState::Available)
+            {
+                availableCount++;
+
+                if (earliestAvailable == NO_OUTPUT || isEarlier(output, m_outputs[earliestAvailable]))
+                {
+                    earliestAvailable = id;
+                }
+            }
+            else
+            {
+                spentCount++;
+            }
         }
-        else
+
+        assert(spentCount == 0 || spentCount == 1);
+
+        /* If the key image is spent, only the spent output is visible.
+           Otherwise, the earliest available output is, and failing that,
+           an unconfirmed output if it is the only one */
+        for (uint32_t id = head; id != NO_OUTPUT; id = m_outputs[id].nextWithKeyImage)
         {
-            updateVisibility(unconfirmedIndex, unconfirmedRange, unconfirmedCount == 1);
+            auto &output = m_outputs[id];
+
+            if (!(output.keyImage == keyImage))
+            {
+                continue;
+            }
+
+            if (spentCount > 0)
+            {
+                output.visible = output.state == OutputState::Spent;
+            }
+            else if (availableCount > 0)
+            {
+                output.visible = id == earliestAvailable;
+            }
+            else
+            {
+                output.visible = unconfirmedCount == 1;
+            }
         }
     }
 
@@ -786,21 +854,26 @@ namespace CryptoNote
         std::lock_guard<std::mutex> lk(m_mutex);
         uint64_t amount = 0;
 
-        for (const auto &t : m_availableTransfers)
+        for (uint32_t id = stateList(OutputState::Available).head; id != NO_OUTPUT; id = m_outputs[id].nextInState)
         {
-            if (t.visible && isIncluded(t, flags))
+            const auto &output = m_outputs[id];
+
+            if (output.visible && isIncluded(output, flags))
             {
-                amount += t.amount;
+                amount += output.amount;
             }
         }
 
         if ((flags & IncludeStateLocked) != 0)
         {
-            for (const auto &t : m_unconfirmedTransfers)
+            for (uint32_t id = stateList(OutputState::Unconfirmed).head; id != NO_OUTPUT;
+                 id = m_outputs[id].nextInState)
             {
-                if (t.visible && isIncluded(t.type, IncludeStateLocked, flags))
+                const auto &output = m_outputs[id];
+
+                if (output.visible && isIncluded(output.type, IncludeStateLocked, flags))
                 {
-                    amount += t.amount;
+                    amount += output.amount;
                 }
             }
         }
@@ -810,15 +883,20 @@ namespace CryptoNote
 
     std::vector<SpentTransactionOutput> TransfersContainer::getUnspentInputs() const
     {
+        std::lock_guard<std::mutex> lk(m_mutex);
+
         std::vector<SpentTransactionOutput> result;
 
-        for (const auto &input : m_availableTransfers)
+        for (uint32_t id = stateList(OutputState::Available).head; id != NO_OUTPUT; id = m_outputs[id].nextInState)
         {
-            if (input.blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
+            const auto &output = m_outputs[id];
+
+            if (output.transaction->blockHeight != WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
             {
-                /* "cast" TransactionOutputInformationEx to SpentTransactionOutput,
-                   leaving other members default constructed */
-                result.push_back({input});
+                /* Leave the spending members default constructed */
+                SpentTransactionOutput input {};
+                static_cast<TransactionOutputInformationEx &>(input) = getOutputInformation(output);
+                result.push_back(input);
             }
         }
 
@@ -827,11 +905,14 @@ namespace CryptoNote
 
     std::vector<SpentTransactionOutput> TransfersContainer::getSpentInputs() const
     {
+        std::lock_guard<std::mutex> lk(m_mutex);
+
         std::vector<SpentTransactionOutput> result;
+        result.reserve(stateList(OutputState::Spent).count);
 
-        for (const auto &input : m_spentTransfers)
+        for (uint32_t id = stateList(OutputState::Spent).head; id != NO_OUTPUT; id = m_outputs[id].nextInState)
         {
-            result.push_back(input);
+            result.push_back(getSpentOutput(m_outputs[id]));
         }
 
         return result;
@@ -840,21 +921,27 @@ namespace CryptoNote
     void TransfersContainer::getOutputs(std::vector<TransactionOutputInformation> &transfers, uint32_t flags) const
     {
         std::lock_guard<std::mutex> lk(m_mutex);
-        for (const auto &t : m_availableTransfers)
+
+        for (uint32_t id = stateList(OutputState::Available).head; id != NO_OUTPUT; id = m_outputs[id].nextInState)
         {
-            if (t.visible && isIncluded(t, flags))
+            const auto &output = m_outputs[id];
+
+            if (output.visible && isIncluded(output, flags))
             {
-                transfers.push_back(t);
+                transfers.push_back(getOutputInformation(output));
             }
         }
 
         if ((flags & IncludeStateLocked) != 0)
         {
-            for (const auto &t : m_unconfirmedTransfers)
+            for (uint32_t id = stateList(OutputState::Unconfirmed).head; id != NO_OUTPUT;
+                 id = m_outputs[id].nextInState)
             {
-                if (t.visible && isIncluded(t.type, IncludeStateLocked, flags))
+                const auto &output = m_outputs[id];
+
+                if (output.visible && isIncluded(output.type, IncludeStateLocked, flags))
                 {
-                    transfers.push_back(t);
+                    transfers.push_back(getOutputInformation(output));
                 }
             }
         }
@@ -875,44 +962,26 @@ namespace CryptoNote
 
         info = *it;
 
+        /* An unconfirmed transaction's outputs are all unconfirmed, and a
+           confirmed transaction's are all either available or spent, so
+           every output counts */
         if (amountOut != nullptr)
         {
             *amountOut = 0;
 
-            if (info.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
+            for (uint32_t id = it->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
             {
-                auto unconfirmedOutputsRange =
-                    m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-                for (auto it = unconfirmedOutputsRange.first; it != unconfirmedOutputsRange.second; ++it)
-                {
-                    *amountOut += it->amount;
-                }
-            }
-            else
-            {
-                auto availableOutputsRange =
-                    m_availableTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-                for (auto it = availableOutputsRange.first; it != availableOutputsRange.second; ++it)
-                {
-                    *amountOut += it->amount;
-                }
-
-                auto spentOutputsRange =
-                    m_spentTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-                for (auto it = spentOutputsRange.first; it != spentOutputsRange.second; ++it)
-                {
-                    *amountOut += it->amount;
-                }
+                *amountOut += m_outputs[id].amount;
             }
         }
 
         if (amountIn != nullptr)
         {
             *amountIn = 0;
-            auto rangeInputs = m_spentTransfers.get<SpendingTransactionIndex>().equal_range(transactionHash);
-            for (auto it = rangeInputs.first; it != rangeInputs.second; ++it)
+
+            for (uint32_t id = it->firstSpentOutput; id != NO_OUTPUT; id = m_outputs[id].nextSpentInTransaction)
             {
-                *amountIn += it->amount;
+                *amountIn += m_outputs[id].amount;
             }
         }
 
@@ -926,37 +995,44 @@ namespace CryptoNote
 
         std::vector<TransactionOutputInformation> result;
 
-        auto availableRange = m_availableTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-        for (auto i = availableRange.first; i != availableRange.second; ++i)
+        auto it = m_transactions.find(transactionHash);
+        if (it == m_transactions.end())
+        {
+            return result;
+        }
+
+        for (uint32_t id = it->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
         {
-            const auto &t = *i;
-            if (isIncluded(t, flags))
+            const auto &output = m_outputs[id];
+
+            if (output.state == OutputState::Available && isIncluded(output, flags))
             {
-                result.push_back(t);
+                result.push_back(getOutputInformation(output));
             }
         }
 
         if ((flags & IncludeStateLocked) != 0)
         {
-            auto unconfirmedRange =
-                m_unconfirmedTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-            for (auto i = unconfirmedRange.first; i != unconfirmedRange.second; ++i)
+            for (uint32_t id = it->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
             {
-                if (isIncluded(i->type, IncludeStateLocked, flags))
+                const auto &output = m_outputs[id];
+
+                if (output.state == OutputState::Unconfirmed && isIncluded(output.type, IncludeStateLocked, flags))
                 {
-                    result.push_back(*i);
+                    result.push_back(getOutputInformation(output));
                 }
             }
         }
 
         if ((flags & IncludeStateSpent) != 0)
         {
-            auto spentRange = m_spentTransfers.get<ContainingTransactionIndex>().equal_range(transactionHash);
-            for (auto i = spentRange.first; i != spentRange.second; ++i)
+            for (uint32_t id = it->firstOutput; id != NO_OUTPUT; id = m_outputs[id].nextInTransaction)
             {
-                if (isIncluded(i->type, IncludeStateAll, flags))
+                const auto &output = m_outputs[id];
+
+                if (output.state == OutputState::Spent && isIncluded(output.type, IncludeStateAll, flags))
                 {
-                    result.push_back(*i);
+                    result.push_back(getOutputInformation(output));
                 }
             }
         }
@@ -974,12 +1050,18 @@ namespace CryptoNote
         std::lock_guard<std::mutex> lk(m_mutex);
 
         std::vector<TransactionOutputInformation> result;
-        auto transactionInputsRange = m_spentTransfers.get<SpendingTransactionIndex>().equal_range(transactionHash);
-        for (auto it = transactionInputsRange.first; it != transactionInputsRange.second; ++it)
+
+        auto it = m_transactions.find(transactionHash);
+        if (it == m_transactions.end())
         {
-            if (isIncluded(it->type, IncludeStateUnlocked, flags))
+            return result;
+        }
+
+        for (uint32_t id = it->firstSpentOutput; id != NO_OUTPUT; id = m_outputs[id].nextSpentInTransaction)
+        {
+            if (isIncluded(m_outputs[id].type, IncludeStateUnlocked, flags))
             {
-                result.push_back(*it);
+                result.push_back(getOutputInformation(m_outputs[id]));
             }
         }
 
@@ -994,11 +1076,13 @@ namespace CryptoNote
         {
             if (element.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT)
             {
-                transactions.push_back(*reinterpret_cast<const Crypto::Hash *>(&element.transactionHash));
+                transactions.push_back(element.transactionHash);
             }
         }
     }
 
+    /* The storage format predates the packed layout, so the outputs are
+       expanded back into the full records as they are written */
     void TransfersContainer::save(std::ostream &os)
     {
         std::lock_guard<std::mutex> lk(m_mutex);
@@ -1008,12 +1092,49 @@ namespace CryptoNote
         s(const_cast<uint32_t &>(TRANSFERS_CONTAINER_STORAGE_VERSION), "version");
 
         s(m_currentHeight, "height");
-        writeSequence<TransactionInformation>(m_transactions.begin(), m_transactions.end(), "transactions", s);
-        writeSequence<TransactionOutputInformationEx>(
-            m_unconfirmedTransfers.begin(), m_unconfirmedTransfers.end(), "unconfirmedTransfers", s);
-        writeSequence<TransactionOutputInformationEx>(
-            m_availableTransfers.begin(), m_availableTransfers.end(), "availableTransfers", s);
-        writeSequence<SpentTransactionOutput>(m_spentTransfers.begin(), m_spentTransfers.end(), "spentTransfers", s);
+
+        uint64_t transactionCount = m_transactions.size();
+        s.beginArray(transactionCount, "transactions");
+
+        for (const auto &transaction : m_transactions)
+        {
+            TransactionInformation info = transaction;
+            s(info, "");
+        }
+
+        s.endArray();
+
+        writeOutputs(s, OutputState::Unconfirmed, "unconfirmedTransfers");
+        writeOutputs(s, OutputState::Available, "availableTransfers");
+        writeOutputs(s, OutputState::Spent, "spentTransfers");
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    void TransfersContainer::writeOutputs(ISerializer &s, OutputState state, Common::StringView name)
+    {
+        uint64_t count = stateList(state).count;
+
+        s.beginArray(count, name);
+
+        for (uint32_t id = stateList(state).head; id != NO_OUTPUT; id = m_outputs[id].nextInState)
+        {
+            const auto &output = m_outputs[id];
+
+            if (state == OutputState::Spent)
+            {
+                auto spent = getSpentOutput(output);
+                s(spent, "");
+            }
+            else
+            {
+                auto info = getOutputInformation(output);
+                s(info, "");
+            }
+        }
+
+        s.endArray();
     }
 
     void TransfersContainer::load(std::istream &in)
@@ -1034,24 +1155,97 @@ namespace CryptoNote
         }
 
         uint32_t currentHeight = 0;
-        TransactionMultiIndex transactions;
-        UnconfirmedTransfersMultiIndex unconfirmedTransfers;
-        AvailableTransfersMultiIndex availableTransfers;
-        SpentTransfersMultiIndex spentTransfers;
+        std::vector<TransactionInformation> transactions;
+        std::vector<TransactionOutputInformationEx> unconfirmedTransfers;
+        std::vector<TransactionOutputInformationEx> availableTransfers;
+        std::vector<SpentTransactionOutput> spentTransfers;
 
         s(currentHeight, "height");
-        readSequence<TransactionInformation>(std::inserter(transactions, transactions.end()), "transactions", s);
+        readSequence<TransactionInformation>(std::back_inserter(transactions), "transactions", s);
         readSequence<TransactionOutputInformationEx>(
-            std::inserter(unconfirmedTransfers, unconfirmedTransfers.end()), "unconfirmedTransfers", s);
-        readSequence<TransactionOutputInformationEx>(
-            std::inserter(availableTransfers, availableTransfers.end()), "availableTransfers", s);
-        readSequence<SpentTransactionOutput>(std::inserter(spentTransfers, spentTransfers.end()), "spentTransfers", s);
+            std::back_inserter(unconfirmedTransfers), "unconfirmedTransfers", s);
+        readSequence<TransactionOutputInformationEx>(std::back_inserter(availableTransfers), "availableTransfers", s);
+        readSequence<SpentTransactionOutput>(std::back_inserter(spentTransfers), "spentTransfers", s);
+
+        /* Everything is read, now swap in the new data */
+        m_transactions.clear();
+        m_outputs.clear();
+        m_freeOutputs.clear();
+        m_keyImageIndex.clear();
+        clearStateLists();
+
+        m_outputs.reserve(unconfirmedTransfers.size() + availableTransfers.size() + spentTransfers.size());
+
+        for (auto &info : transactions)
+        {
+            TransactionEntry transaction;
+            static_cast<TransactionInformation &>(transaction) = std::move(info);
+            transaction.transactionIndex = 0;
+            transaction.firstOutput = NO_OUTPUT;
+            transaction.firstSpentOutput = NO_OUTPUT;
+
+            m_transactions.insert(std::move(transaction));
+        }
+
+        for (const auto &output : unconfirmedTransfers)
+        {
+            loadOutput(output, OutputState::Unconfirmed);
+        }
+
+        for (const auto &output : availableTransfers)
+        {
+            loadOutput(output, OutputState::Available);
+        }
+
+        for (const auto &output : spentTransfers)
+        {
+            const uint32_t id = loadOutput(output, OutputState::Available);
+
+            if (id == NO_OUTPUT)
+            {
+                continue;
+            }
+
+            auto spendingTransaction = m_transactions.find(output.spendingTransactionHash);
+
+            if (spendingTransaction == m_transactions.end())
+            {
+                m_logger(WARNING, BRIGHT_YELLOW) << "Spending transaction " << output.spendingTransactionHash
+                                                 << " of output with key image " << output.keyImage
+                                                 << " is missing, marking output as unspent";
+                updateTransfersVisibility(output.keyImage);
+                continue;
+            }
+
+            m_transactions.modify(spendingTransaction, [&output](TransactionEntry &transaction) {
+                transaction.transactionIndex = output.spendingBlock.transactionIndex;
+            });
+
+            spendOutput(*spendingTransaction, output.inputInTransaction, id);
+        }
 
         m_currentHeight = currentHeight;
-        m_transactions = std::move(transactions);
-        m_unconfirmedTransfers = std::move(unconfirmedTransfers);
-        m_availableTransfers = std::move(availableTransfers);
-        m_spentTransfers = std::move(spentTransfers);
+    }
+
+    /**
+     * \pre m_mutex is locked.
+     */
+    uint32_t TransfersContainer::loadOutput(const TransactionOutputInformationEx &output, OutputState state)
+    {
+        auto transaction = m_transactions.find(output.transactionHash);
+
+        if (transaction == m_transactions.end())
+        {
+            m_logger(WARNING, BRIGHT_YELLOW) << "Transaction " << output.transactionHash << " of output with key image "
+                                             << output.keyImage << " is missing, skipping output";
+            return NO_OUTPUT;
+        }
+
+        m_transactions.modify(transaction, [&output](TransactionEntry &entry) {
+            entry.transactionIndex = output.transactionIndex;
+        });
+
+        return insertOutput(output, *transaction, state, output.visible);
     }
 
     bool TransfersContainer::isSpendTimeUnlocked(uint64_t unlockTime) const
@@ -1071,14 +1265,15 @@ namespace CryptoNote
         return false;
     }
 
-    bool TransfersContainer::isIncluded(const TransactionOutputInformationEx &info, uint32_t flags) const
+    bool TransfersContainer::isIncluded(const OutputRecord &output, uint32_t flags) const
     {
         uint32_t state;
-        if (info.blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT || !isSpendTimeUnlocked(info.unlockTime))
+        if (output.transaction->blockHeight == WALLET_UNCONFIRMED_TRANSACTION_HEIGHT
+            || !isSpendTimeUnlocked(output.transaction->unlockTime))
         {
             state = IncludeStateLocked;
         }
-        else if (m_currentHeight < info.blockHeight + m_transactionSpendableAge)
+        else if (m_currentHeight < output.transaction->blockHeight + m_transactionSpendableAge)
         {
             state = IncludeStateSoftLocked;
         }
@@ -1087,7 +1282,7 @@ namespace CryptoNote
             state = IncludeStateUnlocked;
         }
 
-        return isIncluded(info.type, state, flags);
+        return isIncluded(output.type, state, flags);
     }
 
     bool TransfersContainer::isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags)
@@ -1098,5 +1293,4 @@ namespace CryptoNote
             // filter by state
             ((flags & state) != 0);
     }
-
 } // namespace CryptoNote
@@ -16,54 +16,16 @@
 #include "serialization/SerializationOverloads.h"
 
 #include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 #include <cstdint>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace CryptoNote
 {
-    struct TransactionOutputInformationIn;
-
-    class SpentOutputDescriptor
-    {
-      public:
-        SpentOutputDescriptor();
-
-        SpentOutputDescriptor(const TransactionOutputInformationIn &transactionInfo);
-
-        SpentOutputDescriptor(const Crypto::KeyImage *keyImage);
-
-        void assign(const Crypto::KeyImage *keyImage);
-
-        bool operator==(const SpentOutputDescriptor &other) const;
-
-        size_t hash() const;
-
-      private:
-        TransactionTypes::OutputType m_type;
-
-        union {
-            const Crypto::KeyImage *m_keyImage;
-            struct
-            {
-                uint64_t m_amount;
-                uint32_t m_globalOutputIndex;
-            };
-        };
-    };
-
-    struct SpentOutputDescriptorHasher
-    {
-        size_t operator()(const SpentOutputDescriptor &descriptor) const
-        {
-            return descriptor.hash();
-        }
-    };
-
     struct TransactionOutputInformationIn : public TransactionOutputInformation
     {
         Crypto::KeyImage keyImage; //!< \attention Used only for TransactionTypes::OutputType::Key
@@ -79,16 +41,6 @@ namespace CryptoNote
 
         bool visible;
 
-        SpentOutputDescriptor getSpentOutputDescriptor() const
-        {
-            return SpentOutputDescriptor(*this);
-        }
-
-        const Crypto::Hash &getTransactionHash() const
-        {
-            return transactionHash;
-        }
-
         void serialize(CryptoNote::ISerializer &s)
         {
             s(reinterpret_cast<uint8_t &>(type), "type");
@@ -134,11 +86,6 @@ namespace CryptoNote
 
         uint32_t inputInTransaction;
 
-        const Crypto::Hash &getSpendingTransactionHash() const
-        {
-            return spendingTransactionHash;
-        }
-
         void serialize(ISerializer &s)
         {
             TransactionOutputInformationEx::serialize(s);
@@ -217,18 +164,79 @@ namespace CryptoNote
         virtual void load(std::istream &in) override;
 
       private:
-        struct ContainingTransactionIndex
+        enum class OutputState : uint8_t
         {
+            Free,
+            Unconfirmed,
+            Available,
+            Spent
         };
-        struct SpendingTransactionIndex
+
+        /* The transaction data, along with the fields which are the same for
+           every output of the transaction, so they are stored once rather
+           than copied into every output */
+        struct TransactionEntry : TransactionInformation
         {
+            uint32_t transactionIndex;
+
+            /* Heads of the lists of outputs this transaction created, and of
+               outputs it spent, threaded through the output records */
+            mutable uint32_t firstOutput;
+
+            mutable uint32_t firstSpentOutput;
+        };
+
+        struct OutputRecord
+        {
+            Crypto::PublicKey outputKey;
+
+            Crypto::KeyImage keyImage;
+
+            uint64_t amount;
+
+            const TransactionEntry *transaction;
+
+            /* Only set when the output is spent */
+            const TransactionEntry *spendingTransaction;
+
+            uint32_t globalOutputIndex;
+
+            uint32_t outputInTransaction;
+
+            uint32_t inputInTransaction;
+
+            uint32_t nextInTransaction;
+
+            uint32_t nextSpentInTransaction;
+
+            uint32_t nextWithKeyImage;
+
+            /* Links in the list of outputs in the same state, so queries
+               only visit the outputs they can return */
+            uint32_t previousInState;
+
+            uint32_t nextInState;
+
+            TransactionTypes::OutputType type;
+
+            OutputState state;
+
+            bool visible;
         };
-        struct SpentOutputDescriptorIndex
+
+        struct StateList
         {
+            uint32_t head;
+
+            uint32_t tail;
+
+            size_t count;
         };
 
+        /* Nodes are never moved, so the outputs can point at their
+           transactions */
         typedef boost::multi_index_container<
-            TransactionInformation,
+            TransactionEntry,
             boost::multi_index::indexed_by<
                 boost::multi_index::hashed_unique<
                     BOOST_MULTI_INDEX_MEMBER(TransactionInformation, Crypto::Hash, transactionHash)>,
@@ -236,100 +244,73 @@ namespace CryptoNote
                     BOOST_MULTI_INDEX_MEMBER(TransactionInformation, uint32_t, blockHeight)>>>
             TransactionMultiIndex;
 
-        typedef boost::multi_index_container<
-            TransactionOutputInformationEx,
-            boost::multi_index::indexed_by<
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<SpentOutputDescriptorIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        SpentOutputDescriptor,
-                        &TransactionOutputInformationEx::getSpentOutputDescriptor>,
-                    SpentOutputDescriptorHasher>,
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<ContainingTransactionIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        const Crypto::Hash &,
-                        &TransactionOutputInformationEx::getTransactionHash>>>>
-            UnconfirmedTransfersMultiIndex;
-
-        typedef boost::multi_index_container<
-            TransactionOutputInformationEx,
-            boost::multi_index::indexed_by<
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<SpentOutputDescriptorIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        SpentOutputDescriptor,
-                        &TransactionOutputInformationEx::getSpentOutputDescriptor>,
-                    SpentOutputDescriptorHasher>,
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<ContainingTransactionIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        const Crypto::Hash &,
-                        &TransactionOutputInformationEx::getTransactionHash>>>>
-            AvailableTransfersMultiIndex;
-
-        typedef boost::multi_index_container<
-            SpentTransactionOutput,
-            boost::multi_index::indexed_by<
-                boost::multi_index::hashed_unique<
-                    boost::multi_index::tag<SpentOutputDescriptorIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        SpentOutputDescriptor,
-                        &TransactionOutputInformationEx::getSpentOutputDescriptor>,
-                    SpentOutputDescriptorHasher>,
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<ContainingTransactionIndex>,
-                    boost::multi_index::const_mem_fun<
-                        TransactionOutputInformationEx,
-                        const Crypto::Hash &,
-                        &SpentTransactionOutput::getTransactionHash>>,
-                boost::multi_index::hashed_non_unique<
-                    boost::multi_index::tag<SpendingTransactionIndex>,
-                    boost::multi_index::const_mem_fun<
-                        SpentTransactionOutput,
-                        const Crypto::Hash &,
-                        &SpentTransactionOutput::getSpendingTransactionHash>>>>
-            SpentTransfersMultiIndex;
-
       private:
-        void addTransaction(const TransactionBlockInfo &block, const ITransactionReader &tx);
+        const TransactionEntry &addTransaction(const TransactionBlockInfo &block, const ITransactionReader &tx);
 
         bool addTransactionOutputs(
-            const TransactionBlockInfo &block,
+            const TransactionEntry &transaction,
             const ITransactionReader &tx,
             const std::vector<TransactionOutputInformationIn> &transfers);
 
-        bool addTransactionInputs(const TransactionBlockInfo &block, const ITransactionReader &tx);
+        bool addTransactionInputs(const TransactionEntry &transaction, const ITransactionReader &tx);
 
-        void deleteTransactionTransfers(const Crypto::Hash &transactionHash);
+        void deleteTransactionTransfers(const TransactionEntry &transaction);
 
         bool isSpendTimeUnlocked(uint64_t unlockTime) const;
 
-        bool isIncluded(const TransactionOutputInformationEx &info, uint32_t flags) const;
+        bool isIncluded(const OutputRecord &output, uint32_t flags) const;
 
         static bool isIncluded(TransactionTypes::OutputType type, uint32_t state, uint32_t flags);
 
         void updateTransfersVisibility(const Crypto::KeyImage &keyImage);
 
-        void copyToSpent(
-            const TransactionBlockInfo &block,
-            const ITransactionReader &tx,
-            size_t inputIndex,
-            const TransactionOutputInformationEx &output);
+        void spendOutput(const TransactionEntry &transaction, size_t inputIndex, uint32_t outputId);
+
+        void unspendOutput(uint32_t outputId);
+
+        uint32_t insertOutput(
+            const TransactionOutputInformationIn &output,
+            const TransactionEntry &transaction,
+            OutputState state,
+            bool visible);
+
+        void eraseOutput(uint32_t outputId);
+
+        void setOutputState(uint32_t outputId, OutputState state);
+
+        const StateList &stateList(OutputState state) const;
+
+        void clearStateLists();
+
+        uint32_t findKeyImageListHead(const Crypto::KeyImage &keyImage) const;
+
+        TransactionOutputInformationEx getOutputInformation(const OutputRecord &output) const;
+
+        SpentTransactionOutput getSpentOutput(const OutputRecord &output) const;
+
+        void writeOutputs(ISerializer &s, OutputState state, Common::StringView name);
+
+        uint32_t loadOutput(const TransactionOutputInformationEx &output, OutputState state);
 
       private:
         TransactionMultiIndex m_transactions;
 
-        UnconfirmedTransfersMultiIndex m_unconfirmedTransfers;
+        /* Every output, whatever its state. Erased records are reused, so
+           an output keeps its position (which the lists link through) for
+           as long as it exists. */
+        std::vector<OutputRecord> m_outputs;
+
+        std::vector<uint32_t> m_freeOutputs;
 
-        AvailableTransfersMultiIndex m_availableTransfers;
+        /* The outputs in each state, indexed by OutputState. Free slots are
+           tracked by m_freeOutputs instead, so that list stays empty. */
+        StateList m_stateLists[4];
 
-        SpentTransfersMultiIndex m_spentTransfers;
+        /* The first output in each list of outputs sharing the leading bytes
+           of their key image, linked through OutputRecord::nextWithKeyImage.
+           This is the only index over the outputs - the per transaction
+           lists cover lookups by transaction. */
+        std::unordered_map<uint64_t, uint32_t> m_keyImageIndex;
 
         uint32_t m_currentHeight; // current height is needed to check if a transfer is unlocked
         size_t m_transactionSpendableAge;
@@ -0,0 +1,219 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include <chrono>
+#include <iostream>
+
+#include <config/CliHeader.h>
+#include <crypto/random.h>
+#include <cryptonotecore/Currency.h>
+#include <cryptonotecore/TransactionApi.h>
+#include <cxxopts.hpp>
+#include <logging/DummyLogger.h>
+#include <transfers/TransfersContainer.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+using namespace CryptoNote;
+
+namespace
+{
+    template<typename T> T randomPod()
+    {
+        T result;
+        Random::randomBytes(sizeof(result), reinterpret_cast<uint8_t *>(&result));
+        return result;
+    }
+
+    /* Bytes allocated on the heap, or -1 if we can't tell */
+    int64_t heapUsage()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        const auto info = mallinfo2();
+        return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+        return -1;
+#endif
+    }
+
+    /* An output we've received, so a later transaction can spend it */
+    struct OwnedOutput
+    {
+        Crypto::KeyImage keyImage;
+        uint64_t amount;
+        uint32_t globalOutputIndex;
+    };
+} // namespace
+
+/* Fills a TransfersContainer with a wallet's worth of transactions, then
+   reports the heap it takes and how long balance() takes. Only uses the
+   public TransfersContainer interface, so the same file can be built against
+   an older TransfersContainer to compare the two. */
+int main(int argc, char **argv)
+{
+    bool help;
+    bool version;
+
+    uint32_t transactionCount;
+    uint32_t outputsPerTransaction;
+    uint32_t inputsPerTransaction;
+
+    cxxopts::Options options(argv[0], getProjectCLIHeader());
+
+    options.add_options("Core")(
+        "h,help", "Display this help message", cxxopts::value<bool>(help)->implicit_value("true"))(
+        "v,version",
+        "Output software version information",
+        cxxopts::value<bool>(version)->default_value("false")->implicit_value("true"));
+
+    options.add_options("Wallet")(
+        "transactions",
+        "The number of transactions paying the wallet",
+        cxxopts::value<uint32_t>(transactionCount)->default_value("500000"),
+        "#")(
+        "outputs",
+        "The number of outputs each transaction pays the wallet",
+        cxxopts::value<uint32_t>(outputsPerTransaction)->default_value("4"),
+        "#")(
+        "inputs",
+        "The number of earlier outputs each transaction spends",
+        cxxopts::value<uint32_t>(inputsPerTransaction)->default_value("4"),
+        "#");
+
+    try
+    {
+        options.parse(argc, argv);
+    }
+    catch (const cxxopts::OptionException &e)
+    {
+        std::cout << "Error: Unable to parse command line argument options: " << e.what() << std::endl << std::endl;
+        std::cout << options.help({}) << std::endl;
+        exit(1);
+    }
+
+    if (help) // Do we want to display the help message?
+    {
+        std::cout << options.help({}) << std::endl;
+        exit(0);
+    }
+    else if (version) // Do we want to display the software version?
+    {
+        std::cout << getProjectCLIHeader() << std::endl;
+        exit(0);
+    }
+
+    if (heapUsage() < 0)
+    {
+        std::cout << "Memory usage can only be measured with glibc 2.33 or later" << std::endl;
+        return 1;
+    }
+
+    const auto logger = std::make_shared<Logging::DummyLogger>();
+
+    const Currency currency = CurrencyBuilder(logger).currency();
+
+    std::vector<OwnedOutput> owned;
+    owned.reserve(static_cast<size_t>(transactionCount) * outputsPerTransaction);
+
+    size_t nextToSpend = 0;
+    uint64_t spentCount = 0;
+
+    std::vector<TransactionOutputInformationIn> transfers(outputsPerTransaction);
+
+    /* Everything we keep outside the container is allocated by now */
+    const int64_t startUsage = heapUsage();
+
+    const auto startTimer = std::chrono::steady_clock::now();
+
+    TransfersContainer container(currency, logger, 10);
+
+    for (uint32_t i = 0; i < transactionCount; i++)
+    {
+        Transaction transaction;
+        transaction.version = 1;
+        transaction.unlockTime = 0;
+
+        for (uint32_t j = 0; j < outputsPerTransaction; j++)
+        {
+            TransactionOutput output;
+            output.amount = 1000 + j;
+            output.target = KeyOutput {randomPod<Crypto::PublicKey>()};
+
+            transaction.outputs.push_back(output);
+        }
+
+        /* Spend the oldest outputs, leaving the last few transactions' worth
+           unspent */
+        for (uint32_t j = 0; j < inputsPerTransaction && nextToSpend + 4 * outputsPerTransaction < owned.size(); j++)
+        {
+            const auto &spent = owned[nextToSpend++];
+
+            KeyInput input;
+            input.amount = spent.amount;
+            input.outputIndexes = {spent.globalOutputIndex};
+            input.keyImage = spent.keyImage;
+
+            transaction.inputs.push_back(input);
+            transaction.signatures.push_back({randomPod<Crypto::Signature>()});
+
+            spentCount++;
+        }
+
+        const auto publicKey = randomPod<Crypto::PublicKey>();
+
+        transaction.extra.push_back(0x01);
+        transaction.extra.insert(transaction.extra.end(), publicKey.data, publicKey.data + sizeof(publicKey.data));
+
+        for (uint32_t j = 0; j < outputsPerTransaction; j++)
+        {
+            auto &transfer = transfers[j];
+
+            transfer.type = TransactionTypes::OutputType::Key;
+            transfer.amount = transaction.outputs[j].amount;
+            transfer.globalOutputIndex = static_cast<uint32_t>(owned.size());
+            transfer.outputInTransaction = j;
+            transfer.transactionPublicKey = publicKey;
+            transfer.outputKey = boost::get<KeyOutput>(transaction.outputs[j].target).key;
+            transfer.keyImage = randomPod<Crypto::KeyImage>();
+
+            owned.push_back({transfer.keyImage, transfer.amount, transfer.globalOutputIndex});
+        }
+
+        const auto reader = createTransactionPrefix(transaction);
+
+        container.addTransaction({i + 1, 1545000000 + i, 0}, *reader, transfers);
+    }
+
+    const int64_t usage = heapUsage() - startUsage;
+
+    const auto fillTime = std::chrono::steady_clock::now() - startTimer;
+
+    container.advanceHeight(transactionCount + 100);
+
+    const uint32_t balanceIterations = 100;
+
+    uint64_t balance = 0;
+
+    const auto balanceStartTimer = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < balanceIterations; i++)
+    {
+        balance += container.balance(ITransfersContainer::IncludeAllUnlocked);
+    }
+
+    const auto balanceTime = (std::chrono::steady_clock::now() - balanceStartTimer) / balanceIterations;
+
+    const uint64_t outputCount = owned.size();
+
+    std::cout << transactionCount << " transactions, " << outputCount << " outputs, " << spentCount << " spent"
+              << std::endl
+              << "Heap usage: " << usage / (1024 * 1024) << " MiB, " << usage / std::max<uint64_t>(outputCount, 1)
+              << " bytes per output" << std::endl
+              << "Time to add transactions: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(fillTime).count() << " ms" << std::endl
+              << "Time to get balance: " << std::chrono::duration_cast<std::chrono::microseconds>(balanceTime).count()
+              << " us (balance " << balance / balanceIterations << ")" << std::endl;
+}
@@ -0,0 +1,32 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace Tests
+{
+    /* Prints whether the named check passed. If it failed, prints the detail
+       given, if any, and exits - the tests are run by CI, which only looks at
+       the exit code. */
+    inline void check(const std::string &name, const bool success, const std::string &detail = "")
+    {
+        std::cout << name << ": " << (success ? "passed" : "failed") << std::endl;
+
+        if (!success)
+        {
+            if (!detail.empty())
+            {
+                std::cout << detail << std::endl;
+            }
+
+            std::cout << "Terminating." << std::endl;
+
+            exit(1);
+        }
+    }
+} // namespace Tests
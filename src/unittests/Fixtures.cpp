@@ -0,0 +1,105 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+///////////////////////////////
+#include <unittests/Fixtures.h>
+///////////////////////////////
+
+#include <common/TransactionExtra.h>
+#include <config/CryptoNoteConfig.h>
+#include <limits>
+
+using namespace CryptoNote;
+using namespace Crypto;
+
+namespace Tests
+{
+    Transaction makeTransaction(const size_t inputCount, const size_t outputCount)
+    {
+        Transaction transaction;
+
+        transaction.version = 1;
+        transaction.unlockTime = 1234567890123;
+
+        for (size_t i = 0; i < inputCount; i++)
+        {
+            KeyInput input;
+            input.amount = 100000 * (i + 1);
+            /* Some indexes big enough to take multiple varint bytes */
+            input.outputIndexes = {static_cast<uint32_t>(i), 127, 128, 16384, 4000000000};
+            input.keyImage = randomPod<Crypto::KeyImage>();
+
+            transaction.inputs.push_back(input);
+            transaction.signatures.push_back(std::vector<Crypto::Signature>(input.outputIndexes.size()));
+
+            for (auto &signature : transaction.signatures.back())
+            {
+                signature = randomPod<Crypto::Signature>();
+            }
+        }
+
+        for (size_t i = 0; i < outputCount; i++)
+        {
+            TransactionOutput output;
+            output.amount = std::numeric_limits<uint64_t>::max() >> i;
+            output.target = KeyOutput {randomPod<PublicKey>()};
+
+            transaction.outputs.push_back(output);
+        }
+
+        /* Transaction public key, then a payment ID nonce */
+        transaction.extra.push_back(0x01);
+        const auto publicKey = randomPod<PublicKey>();
+        transaction.extra.insert(transaction.extra.end(), publicKey.data, publicKey.data + sizeof(publicKey.data));
+
+        transaction.extra.push_back(0x02);
+        transaction.extra.push_back(33);
+        transaction.extra.push_back(0x00);
+        const auto paymentID = randomPod<Hash>();
+        transaction.extra.insert(transaction.extra.end(), paymentID.data, paymentID.data + sizeof(paymentID.data));
+
+        return transaction;
+    }
+
+    Transaction makeMinerTransaction(const uint32_t height)
+    {
+        Transaction transaction = makeTransaction(0, 3);
+
+        transaction.unlockTime = height + 40;
+        transaction.inputs.insert(transaction.inputs.begin(), BaseInput {height});
+
+        return transaction;
+    }
+
+    BlockTemplate makeBlockTemplate(const uint8_t majorVersion)
+    {
+        BlockTemplate block;
+
+        block.majorVersion = majorVersion;
+        block.minorVersion = 1;
+        block.nonce = 0xdeadbeef;
+        block.timestamp = 1545000000;
+        block.previousBlockHash = randomPod<Hash>();
+        block.baseTransaction = makeMinerTransaction(300000);
+        block.transactionHashes = {randomPod<Hash>(), randomPod<Hash>(), randomPod<Hash>()};
+
+        if (majorVersion >= BLOCK_MAJOR_VERSION_2)
+        {
+            block.parentBlock.majorVersion = BLOCK_MAJOR_VERSION_1;
+            block.parentBlock.minorVersion = 0;
+            block.parentBlock.previousBlockHash = randomPod<Hash>();
+            block.parentBlock.transactionCount = 1;
+
+            static_cast<TransactionPrefix &>(block.parentBlock.baseTransaction) = makeMinerTransaction(0);
+
+            TransactionExtraMergeMiningTag mmTag;
+            mmTag.depth = 0;
+            mmTag.merkleRoot = randomPod<Hash>();
+
+            appendMergeMiningTagToExtra(block.parentBlock.baseTransaction.extra, mmTag);
+        }
+
+        return block;
+    }
+} // namespace Tests
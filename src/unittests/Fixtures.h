@@ -0,0 +1,40 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "CryptoNote.h"
+#include "common/VectorOutputStream.h"
+#include "crypto/random.h"
+#include "serialization/BinaryOutputStreamSerializer.h"
+#include "serialization/CryptoNoteSerialization.h"
+
+namespace Tests
+{
+    template<typename T> T randomPod()
+    {
+        T result;
+        Random::randomBytes(sizeof(result), reinterpret_cast<uint8_t *>(&result));
+        return result;
+    }
+
+    /* Serializes with BinaryOutputStreamSerializer directly, since toBinaryArray()
+       goes through BinaryFast for some types */
+    template<typename T> CryptoNote::BinaryArray referenceBinaryArray(const T &object)
+    {
+        CryptoNote::BinaryArray result;
+        Common::VectorOutputStream stream(result);
+        CryptoNote::BinaryOutputStreamSerializer serializer(stream);
+        serialize(const_cast<T &>(object), serializer);
+        return result;
+    }
+
+    /* A transaction with random keys, signatures and payment ID */
+    CryptoNote::Transaction makeTransaction(const size_t inputCount, const size_t outputCount);
+
+    CryptoNote::Transaction makeMinerTransaction(const uint32_t height);
+
+    /* Includes a merge mining parent block for major version 2 and up */
+    CryptoNote::BlockTemplate makeBlockTemplate(const uint8_t majorVersion);
+} // namespace Tests
@@ -0,0 +1,107 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+/////////////////////////////////////////
+#include <unittests/SerializationTests.h>
+/////////////////////////////////////////
+
+#include <common/StringTools.h>
+#include <serialization/SerializationTools.h>
+#include <unittests/Check.h>
+#include <unittests/Fixtures.h>
+
+using namespace Crypto;
+using namespace CryptoNote;
+
+namespace Tests
+{
+    namespace
+    {
+        void testSerialization(const std::string name, const BinaryArray &fast, const BinaryArray &reference)
+        {
+            check(
+                name,
+                fast == reference,
+                "Fast serialization differs from BinaryOutputStreamSerializer!\nExpected: " + Common::toHex(reference)
+                    + "\nActual: " + Common::toHex(fast));
+        }
+    } // namespace
+
+    void testSerializations()
+    {
+        KeyInput keyInput;
+        keyInput.amount = 1000000000000;
+        keyInput.outputIndexes = {0, 1, 127, 128, 300000, 4000000000};
+        keyInput.keyImage = randomPod<Crypto::KeyImage>();
+
+        testSerialization("KeyInput", BinaryFast::toBinaryArray(keyInput), referenceBinaryArray(keyInput));
+
+        const KeyOutput keyOutput {randomPod<PublicKey>()};
+
+        testSerialization("KeyOutput", BinaryFast::toBinaryArray(keyOutput), referenceBinaryArray(keyOutput));
+
+        for (const size_t inputCount : {0, 1, 3})
+        {
+            const Transaction transaction = makeTransaction(inputCount, 2);
+            const TransactionPrefix &prefix = transaction;
+
+            const std::string suffix = " (" + std::to_string(inputCount) + " inputs)";
+
+            testSerialization("TransactionPrefix" + suffix, toBinaryArray(prefix), referenceBinaryArray(prefix));
+            testSerialization("Transaction" + suffix, toBinaryArray(transaction), referenceBinaryArray(transaction));
+        }
+
+        const Transaction minerTransaction = makeMinerTransaction(300000);
+
+        testSerialization(
+            "Transaction (miner)", toBinaryArray(minerTransaction), referenceBinaryArray(minerTransaction));
+
+        for (const uint8_t majorVersion : {BLOCK_MAJOR_VERSION_1, BLOCK_MAJOR_VERSION_2, BLOCK_MAJOR_VERSION_5})
+        {
+            const BlockTemplate block = makeBlockTemplate(majorVersion);
+            const BlockHeader &header = block;
+
+            const std::string suffix = " (v" + std::to_string(majorVersion) + ")";
+
+            testSerialization("BlockHeader" + suffix, toBinaryArray(header), referenceBinaryArray(header));
+
+            /* No fast path for a whole block, but it's made of the header, the
+               parent block, the miner transaction and the transaction hashes, and
+               the parts we do have fast paths for must come out the same */
+            const BinaryArray reference = referenceBinaryArray(block);
+
+            BinaryArray expectedTail = toBinaryArray(block.baseTransaction);
+
+            /* Fewer than 128 hashes, so the count is a single varint byte */
+            expectedTail.push_back(static_cast<uint8_t>(block.transactionHashes.size()));
+
+            for (const auto &hash : block.transactionHashes)
+            {
+                expectedTail.insert(expectedTail.end(), hash.data, hash.data + sizeof(hash.data));
+            }
+
+            BinaryArray expectedHead = toBinaryArray(header);
+
+            const size_t headSize = std::min(expectedHead.size(), reference.size());
+            const size_t tailSize = std::min(expectedTail.size(), reference.size());
+
+            testSerialization(
+                "BlockTemplate header" + suffix,
+                expectedHead,
+                BinaryArray(reference.begin(), reference.begin() + headSize));
+
+            testSerialization(
+                "BlockTemplate miner transaction" + suffix,
+                expectedTail,
+                BinaryArray(reference.end() - tailSize, reference.end()));
+
+            if (majorVersion == BLOCK_MAJOR_VERSION_1)
+            {
+                expectedHead.insert(expectedHead.end(), expectedTail.begin(), expectedTail.end());
+
+                testSerialization("BlockTemplate" + suffix, expectedHead, reference);
+            }
+        }
+    }
+} // namespace Tests
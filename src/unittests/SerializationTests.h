@@ -0,0 +1,12 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+namespace Tests
+{
+    /* Checks the BinaryFast serializers give the same bytes as
+       BinaryOutputStreamSerializer */
+    void testSerializations();
+} // namespace Tests
@@ -0,0 +1,99 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+////////////////////////////////////////
+#include <unittests/WalletJournalTests.h>
+////////////////////////////////////////
+
+#include <common/FileSystemShim.h>
+#include <common/StringTools.h>
+#include <fstream>
+#include <logging/DummyLogger.h>
+#include <unittests/Check.h>
+#include <unittests/Fixtures.h>
+#include <wallet/WalletJournal.h>
+
+using namespace Crypto;
+using namespace CryptoNote;
+
+namespace Tests
+{
+    namespace
+    {
+        void testWalletJournalResult(const std::string name, const bool success)
+        {
+            check(name, success, "Wallet journal round trip failed!");
+        }
+    } // namespace
+
+    void testWalletJournal()
+    {
+        const std::string path = (fs::temp_directory_path() / ("unittests-" + Common::podToHex(randomPod<Hash>())))
+                                     .string()
+                                 + WalletJournal::FILE_SUFFIX;
+
+        const auto key = randomPod<Crypto::chacha8_key>();
+        const auto containerId = randomPod<Hash>();
+
+        const auto logger = std::make_shared<Logging::DummyLogger>();
+
+        /* Big enough to be split into many chunks */
+        const auto bytes = Random::randomBytes(4 * 1024 * 1024);
+        const std::string original(bytes.begin(), bytes.end());
+
+        /* An edit in the middle, as appending a transaction would make */
+        std::string edited = original;
+        edited.insert(edited.size() / 2, "an edit in the middle of the container");
+
+        {
+            WalletJournal journal(logger);
+            journal.open(path, key, containerId);
+
+            testWalletJournalResult("WalletJournal (new journal is empty)", !journal.hasData());
+
+            journal.write(original);
+            journal.write(edited);
+        }
+
+        {
+            WalletJournal journal(logger);
+            journal.open(path, key, containerId);
+
+            testWalletJournalResult("WalletJournal (reopened)", journal.hasData() && journal.read() == edited);
+        }
+
+        /* As if we crashed part way through appending a record */
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            file << std::string(100, 'x');
+        }
+
+        {
+            WalletJournal journal(logger);
+            journal.open(path, key, containerId);
+
+            testWalletJournalResult("WalletJournal (torn record)", journal.hasData() && journal.read() == edited);
+
+            journal.write(original.substr(0, original.size() / 3));
+        }
+
+        {
+            WalletJournal journal(logger);
+            journal.open(path, key, containerId);
+
+            testWalletJournalResult(
+                "WalletJournal (rewritten after torn record)",
+                journal.hasData() && journal.read() == original.substr(0, original.size() / 3));
+        }
+
+        {
+            WalletJournal journal(logger);
+            journal.open(path, key, randomPod<Hash>());
+
+            testWalletJournalResult("WalletJournal (different container)", !journal.hasData());
+        }
+
+        fs::remove(path);
+    }
+} // namespace Tests
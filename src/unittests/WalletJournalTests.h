@@ -0,0 +1,12 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+namespace Tests
+{
+    /* Writes, reopens, tears and rewrites a wallet journal in the temp
+       directory, checking we read back what was last written */
+    void testWalletJournal();
+} // namespace Tests
@@ -0,0 +1,30 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include <config/CliHeader.h>
+#include <iostream>
+#include <unittests/SerializationTests.h>
+#include <unittests/WalletJournalTests.h>
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::cout << CryptoNote::getProjectCLIHeader() << std::endl;
+
+        Tests::testSerializations();
+
+        std::cout << std::endl;
+
+        Tests::testWalletJournal();
+
+        std::cout << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Something went terribly wrong...\n" << e.what() << "\n\n";
+
+        return 1;
+    }
+}
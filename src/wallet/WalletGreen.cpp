@@ -151,6 +151,7 @@ namespace CryptoNote
         m_node(node),
         m_logger(logger, "WalletGreen/empty"),
         m_stopped(false),
+        m_journal(logger),
         m_blockchainSynchronizerStarted(false),
         m_blockchainSynchronizer(node, logger, currency.genesisBlockHash()),
         m_synchronizer(currency, logger, m_blockchainSynchronizer, node),
@@ -235,6 +236,7 @@ namespace CryptoNote
         m_blockchainSynchronizer.removeObserver(this);
 
         m_containerStorage.close();
+        m_journal.close();
         m_walletsContainer.clear();
 
         clearCaches(true, true);
@@ -421,6 +423,8 @@ namespace CryptoNote
         m_containerStorage.swap(newStorage);
         incNextIv();
 
+        openJournal(path);
+
         m_viewPublicKey = viewPublicKey;
         m_viewSecretKey = viewSecretKey;
         m_password = password;
@@ -446,7 +450,18 @@ namespace CryptoNote
 
         try
         {
-            saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+            /* Lower save levels drop data, so they can't be expressed as
+               an update on top of the saved container data */
+            if (saveLevel == WalletSaveLevel::SAVE_ALL && m_journal.isOpen())
+            {
+                m_journal.write(serializeWalletCache(saveLevel, extra));
+                m_extra = extra;
+            }
+            else
+            {
+                saveWalletCache(m_containerStorage, m_key, saveLevel, extra);
+                m_journal.reset(m_key, getContainerId());
+            }
         }
         catch (const std::exception &e)
         {
@@ -552,9 +567,10 @@ namespace CryptoNote
             walletFileStream.close();
 
             loadContainerStorage(path);
+            openJournal(path);
             subscribeWallets();
 
-            if (m_containerStorage.suffixSize() > 0)
+            if (m_containerStorage.suffixSize() > 0 || m_journal.hasData())
             {
                 try
                 {
@@ -580,6 +596,7 @@ namespace CryptoNote
                     if (!addedSpendKeys.empty() || !deletedSpendKeys.empty())
                     {
                         saveWalletCache(m_containerStorage, m_key, WalletSaveLevel::SAVE_ALL, extra);
+                        m_journal.reset(m_key, getContainerId());
                     }
                 }
                 catch (const std::exception &e)
@@ -587,6 +604,7 @@ namespace CryptoNote
                     m_logger(ERROR, BRIGHT_RED) << "Failed to load cache: " << e.what() << ", reset wallet data";
                     clearCaches(true, true);
                     subscribeWallets();
+                    m_journal.reset(m_key, getContainerId());
                 }
             }
         }
@@ -694,7 +712,17 @@ namespace CryptoNote
         assert(m_containerStorage.isOpened());
 
         BinaryArray contanerData;
-        loadAndDecryptContainerData(m_containerStorage, m_key, contanerData);
+
+        /* The journal, if any, is newer than the container data */
+        if (m_journal.hasData())
+        {
+            const std::string journalData = m_journal.read();
+            contanerData.assign(journalData.begin(), journalData.end());
+        }
+        else
+        {
+            loadAndDecryptContainerData(m_containerStorage, m_key, contanerData);
+        }
 
         WalletSerializerV2 s(
             *this,
@@ -724,6 +752,18 @@ namespace CryptoNote
         const Crypto::chacha8_key &key,
         WalletSaveLevel saveLevel,
         const std::string &extra)
+    {
+        const std::string containerData = serializeWalletCache(saveLevel, extra);
+
+        encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
+        storage.flush();
+
+        m_extra = extra;
+
+        m_logger(DEBUGGING) << "Container saving finished";
+    }
+
+    std::string WalletGreen::serializeWalletCache(WalletSaveLevel saveLevel, const std::string &extra)
     {
         m_logger(DEBUGGING) << "Saving cache...";
 
@@ -771,12 +811,37 @@ namespace CryptoNote
 
         s.save(containerStream, saveLevel);
 
-        encryptAndSaveContainerData(storage, key, containerData.data(), containerData.size());
-        storage.flush();
+        return containerData;
+    }
 
-        m_extra = extra;
+    Crypto::Hash WalletGreen::getContainerId() const
+    {
+        const auto prefix = reinterpret_cast<const ContainerStoragePrefix *>(m_containerStorage.prefix());
 
-        m_logger(DEBUGGING) << "Container saving finished";
+        std::string id(reinterpret_cast<const char *>(&prefix->encryptedViewKeys), sizeof(prefix->encryptedViewKeys));
+
+        /* The container data starts with the IV it was encrypted with, which
+           is never reused, so this changes every time the container data is
+           saved in full */
+        const size_t ivSize = std::min<uint64_t>(m_containerStorage.suffixSize(), sizeof(Crypto::chacha8_iv));
+        id.append(reinterpret_cast<const char *>(m_containerStorage.suffix()), ivSize);
+
+        return Crypto::cn_fast_hash(id.data(), id.size());
+    }
+
+    void WalletGreen::openJournal(const std::string &path)
+    {
+        try
+        {
+            m_journal.open(path + WalletJournal::FILE_SUFFIX, m_key, getContainerId());
+        }
+        catch (const std::exception &e)
+        {
+            /* Not fatal, we can still save the container in full */
+            m_logger(WARNING, BRIGHT_YELLOW) << "Failed to open container journal: " << e.what()
+                                             << ", saving the container in full";
+            m_journal.close();
+        }
     }
 
     void WalletGreen::copyContainerStorageKeys(
@@ -1036,7 +1101,14 @@ namespace CryptoNote
             copyContainerStoragePrefix(m_containerStorage, m_key, newStorage, newKey);
             copyContainerStorageKeys(m_containerStorage, m_key, newStorage, newKey);
 
-            if (m_containerStorage.suffixSize() > 0)
+            /* Fold the journal into the container, since it's encrypted with
+               the old key */
+            if (m_journal.hasData())
+            {
+                const std::string containerData = m_journal.read();
+                encryptAndSaveContainerData(newStorage, newKey, containerData.data(), containerData.size());
+            }
+            else if (m_containerStorage.suffixSize() > 0)
             {
                 BinaryArray containerData;
                 loadAndDecryptContainerData(m_containerStorage, m_key, containerData);
@@ -1047,6 +1119,8 @@ namespace CryptoNote
         m_key = newKey;
         m_password = newPassword;
 
+        m_journal.reset(m_key, getContainerId());
+
         m_logger(INFO, BRIGHT_WHITE) << "Container password changed";
     }
 
@@ -1567,15 +1641,7 @@ namespace CryptoNote
 
     WalletGreen::TransfersRange WalletGreen::getTransactionTransfersRange(size_t transactionIndex) const
     {
-        auto val = std::make_pair(transactionIndex, WalletTransfer());
-
-        auto bounds = std::equal_range(
-            m_transfers.begin(),
-            m_transfers.end(),
-            val,
-            [](const TransactionTransferPair &a, const TransactionTransferPair &b) { return a.first < b.first; });
-
-        return bounds;
+        return m_transfers.equal_range(transactionIndex);
     }
 
     size_t WalletGreen::transfer(const PreparedTransaction &preparedTransaction)
@@ -2215,7 +2281,7 @@ namespace CryptoNote
             d.address = dest.address;
             d.amount = dest.amount;
 
-            m_transfers.emplace_back(txId, std::move(d));
+            m_transfers.emplace(txId, std::move(d));
         }
     }
 
@@ -2269,7 +2335,7 @@ namespace CryptoNote
         auto it = std::next(txIdIndex.begin(), transactionId);
 
         bool updated = false;
-        bool r = txIdIndex.modify(it, [&info, totalAmount, &updated](WalletTransaction &transaction) {
+        bool r = txIdIndex.modify(it, [&info, totalAmount, &updated](WalletTransactionRecord &transaction) {
             if (transaction.blockHeight != info.blockHeight)
             {
                 transaction.blockHeight = info.blockHeight;
@@ -2305,6 +2371,7 @@ namespace CryptoNote
             if (transaction.extra.empty() && !info.extra.empty())
             {
                 transaction.extra = Common::asString(info.extra);
+                transaction.paymentId = getPaymentIdFromExtra(transaction.extra);
                 updated = true;
             }
 
@@ -2374,11 +2441,7 @@ namespace CryptoNote
 
         bool updated = false;
 
-        auto transfersRange = getTransactionTransfersRange(transactionId);
-        // Iterators can be invalidated, so the first transfer is addressed by its index
-        size_t firstTransferIdx = std::distance(m_transfers.cbegin(), transfersRange.first);
-
-        TransfersMap initialTransfers = getKnownTransfersMap(transactionId, firstTransferIdx);
+        TransfersMap initialTransfers = getKnownTransfersMap(transactionId);
 
         std::unordered_set<std::string> myInputAddresses;
         std::unordered_set<std::string> myOutputAddresses;
@@ -2391,13 +2454,11 @@ namespace CryptoNote
 
             updated |= updateAddressTransfers(
                 transactionId,
-                firstTransferIdx,
                 addressString,
                 initialTransfers[addressString].input,
                 containerAmount.amounts.input);
             updated |= updateAddressTransfers(
                 transactionId,
-                firstTransferIdx,
                 addressString,
                 initialTransfers[addressString].output,
                 containerAmount.amounts.output);
@@ -2421,7 +2482,7 @@ namespace CryptoNote
 
         int64_t knownInputsAmount = 0;
         int64_t knownOutputsAmount = 0;
-        auto updatedTransfers = getKnownTransfersMap(transactionId, firstTransferIdx);
+        auto updatedTransfers = getKnownTransfersMap(transactionId);
         for (const auto &pair : updatedTransfers)
         {
             knownInputsAmount += pair.second.input;
@@ -2433,7 +2494,6 @@ namespace CryptoNote
 
         updated |= updateUnknownTransfers(
             transactionId,
-            firstTransferIdx,
             myInputAddresses,
             knownInputsAmount,
             myInputsAmount,
@@ -2441,7 +2501,6 @@ namespace CryptoNote
             false);
         updated |= updateUnknownTransfers(
             transactionId,
-            firstTransferIdx,
             myOutputAddresses,
             knownOutputsAmount,
             myOutputsAmount,
@@ -2451,13 +2510,13 @@ namespace CryptoNote
         return updated;
     }
 
-    WalletGreen::TransfersMap WalletGreen::getKnownTransfersMap(size_t transactionId, size_t firstTransferIdx) const
+    WalletGreen::TransfersMap WalletGreen::getKnownTransfersMap(size_t transactionId) const
     {
         TransfersMap result;
 
-        for (auto it = std::next(m_transfers.begin(), firstTransferIdx);
-             it != m_transfers.end() && it->first == transactionId;
-             ++it)
+        const auto [begin, end] = getTransactionTransfersRange(transactionId);
+
+        for (auto it = begin; it != end; ++it)
         {
             const auto &address = it->second.address;
 
@@ -2480,7 +2539,6 @@ namespace CryptoNote
 
     bool WalletGreen::updateAddressTransfers(
         size_t transactionId,
-        size_t firstTransferIdx,
         const std::string &address,
         int64_t knownAmount,
         int64_t targetAmount)
@@ -2495,17 +2553,17 @@ namespace CryptoNote
         {
             if (knownAmount == 0)
             {
-                appendTransfer(transactionId, firstTransferIdx, address, targetAmount);
+                appendTransfer(transactionId, address, targetAmount);
                 updated = true;
             }
             else if (targetAmount == 0)
             {
                 assert(knownAmount != 0);
-                updated |= eraseTransfersByAddress(transactionId, firstTransferIdx, address, knownAmount > 0);
+                updated |= eraseTransfersByAddress(transactionId, address, knownAmount > 0);
             }
             else
             {
-                updated |= adjustTransfer(transactionId, firstTransferIdx, address, targetAmount);
+                updated |= adjustTransfer(transactionId, address, targetAmount);
             }
         }
 
@@ -2514,7 +2572,6 @@ namespace CryptoNote
 
     bool WalletGreen::updateUnknownTransfers(
         size_t transactionId,
-        size_t firstTransferIdx,
         const std::unordered_set<std::string> &myAddresses,
         int64_t knownAmount,
         int64_t myAmount,
@@ -2525,59 +2582,47 @@ namespace CryptoNote
 
         if (std::abs(knownAmount) > std::abs(totalAmount))
         {
-            updated |= eraseForeignTransfers(transactionId, firstTransferIdx, myAddresses, isOutput);
+            updated |= eraseForeignTransfers(transactionId, myAddresses, isOutput);
             if (totalAmount == myAmount)
             {
-                updated |= eraseTransfersByAddress(transactionId, firstTransferIdx, std::string(), isOutput);
+                updated |= eraseTransfersByAddress(transactionId, std::string(), isOutput);
             }
             else
             {
                 assert(std::abs(totalAmount) > std::abs(myAmount));
-                updated |= adjustTransfer(transactionId, firstTransferIdx, std::string(), totalAmount - myAmount);
+                updated |= adjustTransfer(transactionId, std::string(), totalAmount - myAmount);
             }
         }
         else if (knownAmount == totalAmount)
         {
-            updated |= eraseTransfersByAddress(transactionId, firstTransferIdx, std::string(), isOutput);
+            updated |= eraseTransfersByAddress(transactionId, std::string(), isOutput);
         }
         else
         {
             assert(std::abs(totalAmount) > std::abs(knownAmount));
-            updated |= adjustTransfer(transactionId, firstTransferIdx, std::string(), totalAmount - knownAmount);
+            updated |= adjustTransfer(transactionId, std::string(), totalAmount - knownAmount);
         }
 
         return updated;
     }
 
-    void WalletGreen::appendTransfer(
-        size_t transactionId,
-        size_t firstTransferIdx,
-        const std::string &address,
-        int64_t amount)
+    void WalletGreen::appendTransfer(size_t transactionId, const std::string &address, int64_t amount)
     {
-        auto it = std::next(m_transfers.begin(), firstTransferIdx);
-        auto insertIt = std::upper_bound(
-            it, m_transfers.end(), transactionId, [](size_t transactionId, const TransactionTransferPair &pair) {
-                return transactionId < pair.first;
-            });
-
         WalletTransfer transfer {WalletTransferType::USUAL, address, amount};
+
+        /* Inserted after any existing transfers for this transaction */
         m_transfers.emplace(
-            insertIt, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+            std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
     }
 
-    bool WalletGreen::adjustTransfer(
-        size_t transactionId,
-        size_t firstTransferIdx,
-        const std::string &address,
-        int64_t amount)
+    bool WalletGreen::adjustTransfer(size_t transactionId, const std::string &address, int64_t amount)
     {
         assert(amount != 0);
 
         bool updated = false;
         bool updateOutputTransfers = amount > 0;
         bool firstAddressTransferFound = false;
-        auto it = std::next(m_transfers.begin(), firstTransferIdx);
+        auto it = m_transfers.lower_bound(transactionId);
         while (it != m_transfers.end() && it->first == transactionId)
         {
             assert(it->second.amount != 0);
@@ -2593,7 +2638,8 @@ namespace CryptoNote
                 {
                     if (it->second.amount != amount)
                     {
-                        it->second.amount = amount;
+                        m_transfers.modify(
+                            it, [amount](TransactionTransferPair &pair) { pair.second.amount = amount; });
                         updated = true;
                     }
 
@@ -2609,22 +2655,17 @@ namespace CryptoNote
 
         if (!firstAddressTransferFound)
         {
-            WalletTransfer transfer {WalletTransferType::USUAL, address, amount};
-            m_transfers.emplace(
-                it, std::piecewise_construct, std::forward_as_tuple(transactionId), std::forward_as_tuple(transfer));
+            appendTransfer(transactionId, address, amount);
             updated = true;
         }
 
         return updated;
     }
 
-    bool WalletGreen::eraseTransfers(
-        size_t transactionId,
-        size_t firstTransferIdx,
-        std::function<bool(bool, const std::string &)> &&predicate)
+    bool WalletGreen::eraseTransfers(size_t transactionId, std::function<bool(bool, const std::string &)> &&predicate)
     {
         bool erased = false;
-        auto it = std::next(m_transfers.begin(), firstTransferIdx);
+        auto it = m_transfers.lower_bound(transactionId);
         while (it != m_transfers.end() && it->first == transactionId)
         {
             bool transferIsOutput = it->second.amount > 0;
@@ -2644,13 +2685,11 @@ namespace CryptoNote
 
     bool WalletGreen::eraseTransfersByAddress(
         size_t transactionId,
-        size_t firstTransferIdx,
         const std::string &address,
         bool eraseOutputTransfers)
     {
         return eraseTransfers(
             transactionId,
-            firstTransferIdx,
             [&address, eraseOutputTransfers](bool isOutput, const std::string &transferAddress) {
                 return eraseOutputTransfers == isOutput && address == transferAddress;
             });
@@ -2658,13 +2697,11 @@ namespace CryptoNote
 
     bool WalletGreen::eraseForeignTransfers(
         size_t transactionId,
-        size_t firstTransferIdx,
         const std::unordered_set<std::string> &knownAddresses,
         bool eraseOutputTransfers)
     {
         return eraseTransfers(
             transactionId,
-            firstTransferIdx,
             [&knownAddresses, eraseOutputTransfers](bool isOutput, const std::string &transferAddress) {
                 return eraseOutputTransfers == isOutput && knownAddresses.count(transferAddress) == 0;
             });
@@ -3137,6 +3174,39 @@ namespace CryptoNote
         return getTransactionsInBlocks(blockIndex, count);
     }
 
+    std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsWithPaymentId(
+        const Crypto::Hash &blockHash,
+        size_t count,
+        const Crypto::Hash &paymentId) const
+    {
+        throwIfNotInitialized();
+        throwIfStopped();
+
+        auto &hashIndex = m_blockchain.get<BlockHashIndex>();
+        auto it = hashIndex.find(blockHash);
+        if (it == hashIndex.end())
+        {
+            return std::vector<TransactionsInBlockInfo>();
+        }
+
+        auto heightIt = m_blockchain.project<BlockHeightIndex>(it);
+
+        uint32_t blockIndex =
+            static_cast<uint32_t>(std::distance(m_blockchain.get<BlockHeightIndex>().begin(), heightIt));
+        return getTransactionsInBlocksWithPaymentId(blockIndex, count, paymentId);
+    }
+
+    std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsWithPaymentId(
+        uint32_t blockIndex,
+        size_t count,
+        const Crypto::Hash &paymentId) const
+    {
+        throwIfNotInitialized();
+        throwIfStopped();
+
+        return getTransactionsInBlocksWithPaymentId(blockIndex, count, paymentId);
+    }
+
     std::vector<Crypto::Hash> WalletGreen::getBlockHashes(uint32_t blockIndex, size_t count) const
     {
         throwIfNotInitialized();
@@ -4143,7 +4213,7 @@ namespace CryptoNote
         return trimmedSelectedOuts;
     }
 
-    std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32_t blockIndex, size_t count) const
+    std::vector<TransactionsInBlockInfo> WalletGreen::getBlocksInRange(uint32_t blockIndex, size_t count) const
     {
         if (count == 0)
         {
@@ -4164,32 +4234,69 @@ namespace CryptoNote
             return result;
         }
 
-        auto &blockHeightIndex = m_transactions.get<BlockHeightIndex>();
         uint32_t stopIndex = static_cast<uint32_t>(std::min(m_blockchain.size(), blockIndex + count));
 
+        result.resize(stopIndex - blockIndex);
+
         for (uint32_t height = blockIndex; height < stopIndex; ++height)
         {
-            TransactionsInBlockInfo info;
-            info.blockHash = m_blockchain[height - 1];
+            result[height - blockIndex].blockHash = m_blockchain[height - 1];
+        }
 
-            auto lowerBound = blockHeightIndex.lower_bound(height);
-            auto upperBound = blockHeightIndex.upper_bound(height);
-            for (auto it = lowerBound; it != upperBound; ++it)
-            {
-                if (it->state != WalletTransactionState::SUCCEEDED)
-                {
-                    continue;
-                }
+        return result;
+    }
 
-                WalletTransactionWithTransfers transaction;
-                transaction.transaction = *it;
+    void WalletGreen::addTransactionToBlocks(
+        const WalletTransaction &transaction,
+        uint32_t blockIndex,
+        std::vector<TransactionsInBlockInfo> &blocks) const
+    {
+        if (transaction.state != WalletTransactionState::SUCCEEDED)
+        {
+            return;
+        }
 
-                transaction.transfers = getTransactionTransfers(*it);
+        WalletTransactionWithTransfers transactionWithTransfers;
+        transactionWithTransfers.transaction = transaction;
+        transactionWithTransfers.transfers = getTransactionTransfers(transaction);
 
-                info.transactions.emplace_back(std::move(transaction));
-            }
+        blocks[transaction.blockHeight - blockIndex].transactions.emplace_back(std::move(transactionWithTransfers));
+    }
+
+    std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocks(uint32_t blockIndex, size_t count) const
+    {
+        std::vector<TransactionsInBlockInfo> result = getBlocksInRange(blockIndex, count);
+
+        const uint32_t stopIndex = blockIndex + static_cast<uint32_t>(result.size());
+
+        /* One pass over the transactions in the range, rather than a lookup
+           per block */
+        auto &blockHeightIndex = m_transactions.get<BlockHeightIndex>();
+        const auto upperBound = blockHeightIndex.lower_bound(stopIndex);
+
+        for (auto it = blockHeightIndex.lower_bound(blockIndex); it != upperBound; ++it)
+        {
+            addTransactionToBlocks(*it, blockIndex, result);
+        }
 
-            result.emplace_back(std::move(info));
+        return result;
+    }
+
+    std::vector<TransactionsInBlockInfo> WalletGreen::getTransactionsInBlocksWithPaymentId(
+        uint32_t blockIndex,
+        size_t count,
+        const Crypto::Hash &paymentId) const
+    {
+        std::vector<TransactionsInBlockInfo> result = getBlocksInRange(blockIndex, count);
+
+        const uint32_t stopIndex = blockIndex + static_cast<uint32_t>(result.size());
+
+        auto &paymentIdIndex = m_transactions.get<PaymentIdIndex>();
+        const auto upperBound = paymentIdIndex.lower_bound(boost::make_tuple(paymentId, stopIndex));
+
+        for (auto it = paymentIdIndex.lower_bound(boost::make_tuple(paymentId, blockIndex)); it != upperBound; ++it)
+        {
+            addTransactionToBlocks(*it, blockIndex, result);
         }
 
         return result;
@@ -4230,10 +4337,9 @@ namespace CryptoNote
         size_t cancelledTransactions = 0;
 
         transactions.reserve(m_transactions.size());
-        transfers.reserve(m_transfers.size());
 
         auto &index = m_transactions.get<RandomAccessIndex>();
-        size_t transferIdx = 0;
+        auto transferIt = m_transfers.begin();
         for (size_t i = 0; i < m_transactions.size(); ++i)
         {
             const WalletTransaction &transaction = index[i];
@@ -4242,19 +4348,19 @@ namespace CryptoNote
             {
                 ++cancelledTransactions;
 
-                while (transferIdx < m_transfers.size() && m_transfers[transferIdx].first == i)
+                while (transferIt != m_transfers.end() && transferIt->first == i)
                 {
-                    ++transferIdx;
+                    ++transferIt;
                 }
             }
             else
             {
                 transactions.push_back(transaction);
 
-                while (transferIdx < m_transfers.size() && m_transfers[transferIdx].first == i)
+                while (transferIt != m_transfers.end() && transferIt->first == i)
                 {
-                    transfers.emplace_back(i - cancelledTransactions, m_transfers[transferIdx].second);
-                    ++transferIdx;
+                    transfers.emplace_hint(transfers.end(), i - cancelledTransactions, transferIt->second);
+                    ++transferIt;
                 }
             }
         }
@@ -4314,91 +4420,81 @@ namespace CryptoNote
     {
         assert(!address.empty());
 
-        int64_t deletedInputs = 0;
-        int64_t deletedOutputs = 0;
+        std::vector<size_t> updatedTransactions;
 
-        int64_t unknownInputs = 0;
+        auto it = m_transfers.begin();
 
-        bool transfersLeft = false;
-        size_t firstTransactionTransfer = 0;
+        while (it != m_transfers.end())
+        {
+            const size_t transactionId = it->first;
 
-        std::vector<size_t> updatedTransactions;
+            int64_t deletedInputs = 0;
+            int64_t deletedOutputs = 0;
 
-        for (size_t i = 0; i < m_transfers.size(); ++i)
-        {
-            WalletTransfer &transfer = m_transfers[i].second;
+            int64_t unknownInputs = 0;
+
+            bool transfersLeft = false;
 
-            if (transfer.address == address)
+            for (; it != m_transfers.end() && it->first == transactionId; ++it)
             {
-                if (transfer.amount >= 0)
+                const WalletTransfer &transfer = it->second;
+
+                if (transfer.address == address)
                 {
-                    deletedOutputs += transfer.amount;
+                    if (transfer.amount >= 0)
+                    {
+                        deletedOutputs += transfer.amount;
+                    }
+                    else
+                    {
+                        deletedInputs += transfer.amount;
+                        m_transfers.modify(it, [](TransactionTransferPair &pair) { pair.second.address = ""; });
+                    }
                 }
-                else
+                else if (transfer.address.empty())
                 {
-                    deletedInputs += transfer.amount;
-                    transfer.address = "";
+                    if (transfer.amount < 0)
+                    {
+                        unknownInputs += transfer.amount;
+                    }
                 }
-            }
-            else if (transfer.address.empty())
-            {
-                if (transfer.amount < 0)
+                else if (isMyAddress(transfer.address))
                 {
-                    unknownInputs += transfer.amount;
+                    transfersLeft = true;
                 }
             }
-            else if (isMyAddress(transfer.address))
-            {
-                transfersLeft = true;
-            }
 
-            size_t transactionId = m_transfers[i].first;
-            if ((i == m_transfers.size() - 1) || (transactionId != m_transfers[i + 1].first))
+            /* `it` now points at the next transaction, so merging the
+               transfers for this one doesn't invalidate it */
+            if (deletedInputs != 0)
             {
-                // the last transfer for current transaction
-
-                size_t transfersBeforeMerge = m_transfers.size();
-                if (deletedInputs != 0)
-                {
-                    adjustTransfer(transactionId, firstTransactionTransfer, "", deletedInputs + unknownInputs);
-                }
-
-                assert(transfersBeforeMerge >= m_transfers.size());
-                i -= transfersBeforeMerge - m_transfers.size();
+                adjustTransfer(transactionId, "", deletedInputs + unknownInputs);
+            }
 
-                auto &randomIndex = m_transactions.get<RandomAccessIndex>();
+            auto &randomIndex = m_transactions.get<RandomAccessIndex>();
 
-                randomIndex.modify(
-                    std::next(randomIndex.begin(), transactionId),
-                    [this, transactionId, transfersLeft, deletedInputs, deletedOutputs](
-                        WalletTransaction &transaction) {
-                        transaction.totalAmount -= deletedInputs + deletedOutputs;
+            randomIndex.modify(
+                std::next(randomIndex.begin(), transactionId),
+                [this, transactionId, transfersLeft, deletedInputs, deletedOutputs](WalletTransaction &transaction) {
+                    transaction.totalAmount -= deletedInputs + deletedOutputs;
 
-                        if (!transfersLeft)
-                        {
-                            transaction.state = WalletTransactionState::DELETED;
-                            transaction.blockHeight = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
-                            m_logger(DEBUGGING) << "Transaction state changed, ID " << transactionId << ", hash "
-                                                << transaction.hash << ", new state " << transaction.state;
-                        }
-                    });
-
-                if (!transfersLeft)
-                {
-                    deletedTransactions.push_back(transactionId);
-                }
+                    if (!transfersLeft)
+                    {
+                        transaction.state = WalletTransactionState::DELETED;
+                        transaction.blockHeight = WALLET_UNCONFIRMED_TRANSACTION_HEIGHT;
+                        m_logger(DEBUGGING) << "Transaction state changed, ID " << transactionId << ", hash "
+                                            << transaction.hash << ", new state " << transaction.state;
+                    }
+                });
 
-                if (deletedInputs != 0 || deletedOutputs != 0)
-                {
-                    updatedTransactions.push_back(transactionId);
-                }
+            if (!transfersLeft)
+            {
+                deletedTransactions.push_back(transactionId);
+            }
 
-                // reset values for next transaction
-                deletedInputs = 0;
-                deletedOutputs = 0;
-                unknownInputs = 0;
-                transfersLeft = false;
-                firstTransactionTransfer = i + 1;
+            if (deletedInputs != 0 || deletedOutputs != 0)
+            {
+                updatedTransactions.push_back(transactionId);
             }
         }
 
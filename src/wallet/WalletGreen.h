@@ -7,6 +7,7 @@
 
 #include "IFusionManager.h"
 #include "WalletIndices.h"
+#include "WalletJournal.h"
 #include "logging/LoggerRef.h"
 #include "transfers/BlockchainSynchronizer.h"
 #include "transfers/TransfersSynchronizer.h"
@@ -110,6 +111,16 @@ namespace CryptoNote
 
         virtual std::vector<TransactionsInBlockInfo> getTransactions(uint32_t blockIndex, size_t count) const;
 
+        /* Same as getTransactions(), but only includes transactions with the
+           given payment ID */
+        virtual std::vector<TransactionsInBlockInfo> getTransactionsWithPaymentId(
+            const Crypto::Hash &blockHash,
+            size_t count,
+            const Crypto::Hash &paymentId) const;
+
+        virtual std::vector<TransactionsInBlockInfo>
+            getTransactionsWithPaymentId(uint32_t blockIndex, size_t count, const Crypto::Hash &paymentId) const;
+
         virtual std::vector<Crypto::Hash> getBlockHashes(uint32_t blockIndex, size_t count) const;
 
         virtual uint32_t getBlockCount() const;
@@ -464,42 +475,32 @@ namespace CryptoNote
             int64_t allInputsAmount,
             int64_t allOutputsAmount);
 
-        TransfersMap getKnownTransfersMap(size_t transactionId, size_t firstTransferIdx) const;
+        TransfersMap getKnownTransfersMap(size_t transactionId) const;
 
         bool updateAddressTransfers(
             size_t transactionId,
-            size_t firstTransferIdx,
             const std::string &address,
             int64_t knownAmount,
             int64_t targetAmount);
 
         bool updateUnknownTransfers(
             size_t transactionId,
-            size_t firstTransferIdx,
             const std::unordered_set<std::string> &myAddresses,
             int64_t knownAmount,
             int64_t myAmount,
             int64_t totalAmount,
             bool isOutput);
 
-        void appendTransfer(size_t transactionId, size_t firstTransferIdx, const std::string &address, int64_t amount);
+        void appendTransfer(size_t transactionId, const std::string &address, int64_t amount);
 
-        bool adjustTransfer(size_t transactionId, size_t firstTransferIdx, const std::string &address, int64_t amount);
+        bool adjustTransfer(size_t transactionId, const std::string &address, int64_t amount);
 
-        bool eraseTransfers(
-            size_t transactionId,
-            size_t firstTransferIdx,
-            std::function<bool(bool, const std::string &)> &&predicate);
+        bool eraseTransfers(size_t transactionId, std::function<bool(bool, const std::string &)> &&predicate);
 
-        bool eraseTransfersByAddress(
-            size_t transactionId,
-            size_t firstTransferIdx,
-            const std::string &address,
-            bool eraseOutputTransfers);
+        bool eraseTransfersByAddress(size_t transactionId, const std::string &address, bool eraseOutputTransfers);
 
         bool eraseForeignTransfers(
             size_t transactionId,
-            size_t firstTransferIdx,
             const std::unordered_set<std::string> &knownAddresses,
             bool eraseOutputTransfers);
 
@@ -562,6 +563,14 @@ namespace CryptoNote
             WalletSaveLevel saveLevel,
             const std::string &extra);
 
+        std::string serializeWalletCache(WalletSaveLevel saveLevel, const std::string &extra);
+
+        /* Identifies the container data currently saved in the container
+           storage, which the journal applies on top of */
+        Crypto::Hash getContainerId() const;
+
+        void openJournal(const std::string &path);
+
         void subscribeWallets();
 
         std::vector<OutputToTransfer> pickRandomFusionInputs(
@@ -589,8 +598,20 @@ namespace CryptoNote
 
         TransfersRange getTransactionTransfersRange(size_t transactionIndex) const;
 
+        std::vector<TransactionsInBlockInfo> getBlocksInRange(uint32_t blockIndex, size_t count) const;
+
+        void addTransactionToBlocks(
+            const WalletTransaction &transaction,
+            uint32_t blockIndex,
+            std::vector<TransactionsInBlockInfo> &blocks) const;
+
         std::vector<TransactionsInBlockInfo> getTransactionsInBlocks(uint32_t blockIndex, size_t count) const;
 
+        std::vector<TransactionsInBlockInfo> getTransactionsInBlocksWithPaymentId(
+            uint32_t blockIndex,
+            size_t count,
+            const Crypto::Hash &paymentId) const;
+
         Crypto::Hash getBlockHashByIndex(uint32_t blockIndex) const;
 
         std::vector<WalletTransfer> getTransactionTransfers(const WalletTransaction &transaction) const;
@@ -650,11 +671,15 @@ namespace CryptoNote
 
         ContainerStorage m_containerStorage;
 
+        /* Incremental saves of the container data, since it was last saved
+           to the container storage in full */
+        WalletJournal m_journal;
+
         UnlockTransactionJobs m_unlockTransactionsJob;
 
         WalletTransactions m_transactions;
 
-        WalletTransfers m_transfers; // sorted
+        WalletTransfers m_transfers;
         mutable std::unordered_map<size_t, bool> m_fusionTxsCache; // txIndex -> isFusion
         UncommitedTransactions m_uncommitedTransactions;
 
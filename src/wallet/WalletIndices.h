@@ -8,6 +8,9 @@
 #include "ITransfersContainer.h"
 #include "WalletGreenTypes.h"
 #include "common/FileMappedVector.h"
+#include "common/StringTools.h"
+#include "common/TransactionExtra.h"
+#include "config/Constants.h"
 #include "crypto/chacha8.h"
 
 #include <boost/multi_index/composite_key.hpp>
@@ -16,6 +19,7 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/random_access_index.hpp>
 #include <boost/multi_index_container.hpp>
+#include <cstring>
 #include <map>
 #include <unordered_map>
 
@@ -71,6 +75,55 @@ namespace CryptoNote
     struct BlockHashIndex
     {
     };
+    struct PaymentIdIndex
+    {
+    };
+
+    /* Extracts the payment ID from the transaction extra, or a null hash if
+       it doesn't have one */
+    inline Crypto::Hash getPaymentIdFromExtra(const std::string &extra)
+    {
+        Crypto::Hash paymentId = Constants::NULL_HASH;
+
+        try
+        {
+            if (!getPaymentIdFromTxExtra(Common::asBinaryArray(extra), paymentId))
+            {
+                return Constants::NULL_HASH;
+            }
+        }
+        catch (const std::exception &)
+        {
+            return Constants::NULL_HASH;
+        }
+
+        return paymentId;
+    }
+
+    /* A wallet transaction along with its payment ID, which is parsed from the
+       extra once when the transaction is stored, rather than on every
+       comparison the payment ID index makes. If you change the extra of a
+       stored transaction, update the payment ID with it. */
+    struct WalletTransactionRecord : public CryptoNote::WalletTransaction
+    {
+        WalletTransactionRecord() = default;
+
+        WalletTransactionRecord(const CryptoNote::WalletTransaction &transaction):
+            CryptoNote::WalletTransaction(transaction),
+            paymentId(getPaymentIdFromExtra(transaction.extra))
+        {
+        }
+
+        Crypto::Hash paymentId = Constants::NULL_HASH;
+    };
+
+    struct PaymentIdLess
+    {
+        bool operator()(const Crypto::Hash &left, const Crypto::Hash &right) const
+        {
+            return std::memcmp(left.data, right.data, sizeof(left.data)) < 0;
+        }
+    };
 
     typedef boost::multi_index_container<
         WalletRecord,
@@ -103,7 +156,7 @@ namespace CryptoNote
         UnlockTransactionJobs;
 
     typedef boost::multi_index_container<
-        CryptoNote::WalletTransaction,
+        WalletTransactionRecord,
         boost::multi_index::indexed_by<
             boost::multi_index::random_access<boost::multi_index::tag<RandomAccessIndex>>,
             boost::multi_index::hashed_unique<
@@ -113,14 +166,32 @@ namespace CryptoNote
             boost::multi_index::ordered_non_unique<
                 boost::multi_index::tag<BlockHeightIndex>,
                 boost::multi_index::
-                    member<CryptoNote::WalletTransaction, uint32_t, &CryptoNote::WalletTransaction::blockHeight>>>>
+                    member<CryptoNote::WalletTransaction, uint32_t, &CryptoNote::WalletTransaction::blockHeight>>,
+            /* Sorted by block height within each payment ID, so we can do
+               range queries for a payment ID over a set of blocks */
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<PaymentIdIndex>,
+                boost::multi_index::composite_key<
+                    WalletTransactionRecord,
+                    boost::multi_index::
+                        member<WalletTransactionRecord, Crypto::Hash, &WalletTransactionRecord::paymentId>,
+                    boost::multi_index::
+                        member<CryptoNote::WalletTransaction, uint32_t, &CryptoNote::WalletTransaction::blockHeight>>,
+                boost::multi_index::composite_key_compare<PaymentIdLess, std::less<uint32_t>>>>>
         WalletTransactions;
 
     typedef Common::FileMappedVector<EncryptedWalletRecord> ContainerStorage;
 
     typedef std::pair<uint64_t, CryptoNote::WalletTransfer> TransactionTransferPair;
 
-    typedef std::vector<TransactionTransferPair> WalletTransfers;
+    /* Transfers sorted by transaction ID. Transfers with the same transaction
+       ID are kept in insertion order. */
+    typedef boost::multi_index_container<
+        TransactionTransferPair,
+        boost::multi_index::indexed_by<boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<TransactionIndex>,
+            boost::multi_index::member<TransactionTransferPair, uint64_t, &TransactionTransferPair::first>>>>
+        WalletTransfers;
 
     typedef std::map<uint64_t, CryptoNote::Transaction> UncommitedTransactions;
 
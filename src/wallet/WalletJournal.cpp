@@ -0,0 +1,626 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#include "WalletJournal.h"
+
+#include <array>
+#include <common/FileSystemShim.h>
+#include <common/MemoryInputStream.h>
+#include <common/StringOutputStream.h>
+#include <crypto/hash.h>
+#include <cstring>
+#include <serialization/BinaryInputStreamSerializer.h>
+#include <serialization/BinaryOutputStreamSerializer.h>
+#include <serialization/CryptoNoteSerialization.h>
+#include <serialization/SerializationOverloads.h>
+#include <unordered_set>
+
+using namespace Logging;
+
+namespace CryptoNote
+{
+    namespace
+    {
+        const char JOURNAL_MAGIC[8] = {'W', 'L', 'T', 'J', 'R', 'N', 'L', '1'};
+
+        const uint8_t JOURNAL_VERSION = 1;
+
+        const uint64_t JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(JOURNAL_VERSION) + sizeof(Crypto::Hash);
+
+        /* Chunks are cut where the rolling hash has its top 16 bits clear,
+           giving an average chunk size of around 64KiB on top of the minimum */
+        const size_t MIN_CHUNK_SIZE = 16 * 1024;
+
+        const size_t MAX_CHUNK_SIZE = 256 * 1024;
+
+        const uint64_t CHUNK_BOUNDARY_MASK = 0xffff000000000000;
+
+        /* Don't bother compacting small journals */
+        const uint64_t MIN_COMPACTION_SIZE = 16 * 1024 * 1024;
+
+        /* Compact once the journal is this many times bigger than its live data */
+        const uint64_t COMPACTION_RATIO = 2;
+
+#pragma pack(push, 1)
+        struct RecordHeader
+        {
+            uint8_t type;
+            Crypto::chacha8_iv iv;
+            uint64_t size;
+        };
+#pragma pack(pop)
+
+        std::array<uint64_t, 256> generateGearTable()
+        {
+            std::array<uint64_t, 256> table;
+
+            /* splitmix64 with a fixed seed, so chunk boundaries are the same
+               every time the wallet is opened */
+            uint64_t state = 0;
+
+            for (auto &value : table)
+            {
+                state += 0x9e3779b97f4a7c15;
+
+                uint64_t z = state;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+                value = z ^ (z >> 31);
+            }
+
+            return table;
+        }
+
+        const std::array<uint64_t, 256> GEAR_TABLE = generateGearTable();
+
+        /* Splits the data into content defined chunks, returned as offset,
+           size pairs. Since the boundaries depend on the data around them,
+           inserting or removing data only changes the chunks near the edit,
+           rather than shifting every chunk after it. */
+        std::vector<std::pair<size_t, size_t>> splitChunks(const std::string &data)
+        {
+            std::vector<std::pair<size_t, size_t>> chunks;
+
+            size_t start = 0;
+
+            while (start < data.size())
+            {
+                const size_t remaining = data.size() - start;
+
+                size_t length = std::min(remaining, MAX_CHUNK_SIZE);
+
+                if (remaining > MIN_CHUNK_SIZE)
+                {
+                    uint64_t hash = 0;
+
+                    for (size_t i = MIN_CHUNK_SIZE; i < length; i++)
+                    {
+                        hash = (hash << 1) + GEAR_TABLE[static_cast<uint8_t>(data[start + i])];
+
+                        if ((hash & CHUNK_BOUNDARY_MASK) == 0)
+                        {
+                            length = i + 1;
+                            break;
+                        }
+                    }
+                }
+
+                chunks.emplace_back(start, length);
+                start += length;
+            }
+
+            return chunks;
+        }
+    } // namespace
+
+    const std::string WalletJournal::FILE_SUFFIX = ".journal";
+
+    WalletJournal::WalletJournal(std::shared_ptr<Logging::ILogger> logger): m_logger(logger, "WalletJournal") {}
+
+    WalletJournal::~WalletJournal()
+    {
+        waitForCompaction();
+    }
+
+    void WalletJournal::open(const std::string &path, const Crypto::chacha8_key &key, const Crypto::Hash &containerId)
+    {
+        waitForCompaction();
+
+        std::scoped_lock lock(m_mutex);
+
+        m_file.close();
+
+        m_path = path;
+        m_key = key;
+        m_containerId = containerId;
+
+        if (!fs::exists(path))
+        {
+            create();
+            return;
+        }
+
+        m_file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+
+        if (!m_file || !readHeader())
+        {
+            m_file.close();
+            create();
+            return;
+        }
+
+        scanRecords();
+    }
+
+    void WalletJournal::close()
+    {
+        waitForCompaction();
+
+        std::scoped_lock lock(m_mutex);
+
+        m_file.close();
+        m_chunks.clear();
+        m_manifest.clear();
+        m_haveManifest = false;
+    }
+
+    bool WalletJournal::isOpen() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_file.is_open();
+    }
+
+    bool WalletJournal::hasData() const
+    {
+        std::scoped_lock lock(m_mutex);
+        return m_haveManifest;
+    }
+
+    std::string WalletJournal::read()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        std::string data;
+
+        if (!m_haveManifest)
+        {
+            return data;
+        }
+
+        data.reserve(m_dataSize);
+
+        for (const auto &hash : m_manifest)
+        {
+            RecordType type;
+            std::string chunk;
+            uint64_t recordSize;
+
+            if (!readRecord(m_chunks.at(hash).offset, type, chunk, recordSize) || type != CHUNK)
+            {
+                throw std::runtime_error("Wallet journal chunk is corrupted");
+            }
+
+            data += chunk;
+        }
+
+        if (data.size() != m_dataSize)
+        {
+            throw std::runtime_error("Wallet journal data has the wrong size");
+        }
+
+        return data;
+    }
+
+    void WalletJournal::write(const std::string &data)
+    {
+        bool compactionNeeded = false;
+
+        {
+            std::scoped_lock lock(m_mutex);
+
+            if (!m_file.is_open())
+            {
+                throw std::runtime_error("Wallet journal is not open");
+            }
+
+            std::vector<Crypto::Hash> manifest;
+
+            uint64_t written = 0;
+
+            for (const auto &[offset, size] : splitChunks(data))
+            {
+                const Crypto::Hash hash = Crypto::cn_fast_hash(data.data() + offset, size);
+
+                manifest.push_back(hash);
+
+                if (m_chunks.find(hash) == m_chunks.end())
+                {
+                    m_chunks[hash] = appendRecord(CHUNK, data.substr(offset, size));
+                    written += size;
+                }
+            }
+
+            uint64_t dataSize = data.size();
+
+            std::string manifestData;
+            Common::StringOutputStream stream(manifestData);
+            BinaryOutputStreamSerializer s(stream);
+
+            s(dataSize, "dataSize");
+            s(manifest, "chunks");
+
+            const RecordLocation location = appendRecord(MANIFEST, manifestData);
+
+            m_file.flush();
+
+            if (!m_file)
+            {
+                throw std::runtime_error("Failed to write wallet journal");
+            }
+
+            m_manifest = std::move(manifest);
+            m_manifestLocation = location;
+            m_dataSize = dataSize;
+            m_haveManifest = true;
+
+            m_logger(DEBUGGING) << "Journaled " << written << " of " << dataSize << " bytes of container data";
+
+            compactionNeeded = shouldCompact();
+        }
+
+        if (compactionNeeded)
+        {
+            startCompaction();
+        }
+    }
+
+    void WalletJournal::reset(const Crypto::chacha8_key &key, const Crypto::Hash &containerId)
+    {
+        waitForCompaction();
+
+        std::scoped_lock lock(m_mutex);
+
+        m_key = key;
+        m_containerId = containerId;
+
+        if (!m_file.is_open())
+        {
+            return;
+        }
+
+        m_file.close();
+        create();
+    }
+
+    void WalletJournal::create()
+    {
+        m_chunks.clear();
+        m_manifest.clear();
+        m_haveManifest = false;
+        m_dataSize = 0;
+
+        m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+        m_file.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        m_file.write(reinterpret_cast<const char *>(&JOURNAL_VERSION), sizeof(JOURNAL_VERSION));
+        m_file.write(reinterpret_cast<const char *>(&m_containerId), sizeof(m_containerId));
+        m_file.flush();
+
+        if (!m_file)
+        {
+            throw std::runtime_error("Failed to create wallet journal " + m_path);
+        }
+
+        m_fileSize = JOURNAL_HEADER_SIZE;
+    }
+
+    bool WalletJournal::readHeader()
+    {
+        char magic[sizeof(JOURNAL_MAGIC)];
+        uint8_t version;
+        Crypto::Hash containerId;
+
+        m_file.read(magic, sizeof(magic));
+        m_file.read(reinterpret_cast<char *>(&version), sizeof(version));
+        m_file.read(reinterpret_cast<char *>(&containerId), sizeof(containerId));
+
+        if (!m_file || std::memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0 || version != JOURNAL_VERSION)
+        {
+            m_logger(WARNING) << "Wallet journal " << m_path << " is not valid, discarding it";
+            return false;
+        }
+
+        /* The container was saved in full since, or this is the journal of
+           an older container at the same path */
+        if (containerId != m_containerId)
+        {
+            m_logger(DEBUGGING) << "Wallet journal " << m_path << " is out of date, discarding it";
+            return false;
+        }
+
+        return true;
+    }
+
+    void WalletJournal::scanRecords()
+    {
+        m_chunks.clear();
+        m_manifest.clear();
+        m_haveManifest = false;
+
+        m_fileSize = fs::file_size(m_path);
+
+        uint64_t offset = JOURNAL_HEADER_SIZE;
+
+        while (offset < m_fileSize)
+        {
+            RecordType type;
+            std::string data;
+            uint64_t recordSize;
+
+            if (!readRecord(offset, type, data, recordSize))
+            {
+                m_logger(WARNING) << "Dropping " << (m_fileSize - offset) << " bytes of incomplete data from the end "
+                                  << "of the wallet journal";
+                break;
+            }
+
+            const RecordLocation location {offset, recordSize};
+
+            if (type == CHUNK)
+            {
+                m_chunks[Crypto::cn_fast_hash(data.data(), data.size())] = location;
+            }
+            else
+            {
+                try
+                {
+                    loadManifest(data, location);
+                }
+                catch (const std::exception &e)
+                {
+                    m_logger(WARNING) << "Ignoring invalid wallet journal manifest: " << e.what();
+                }
+            }
+
+            offset += recordSize;
+        }
+
+        /* Cut off the torn record, so new records follow the last good one */
+        if (offset < m_fileSize)
+        {
+            m_file.close();
+            fs::resize_file(m_path, offset);
+            m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+
+            m_fileSize = offset;
+        }
+    }
+
+    bool WalletJournal::readRecord(uint64_t offset, RecordType &type, std::string &data, uint64_t &recordSize)
+    {
+        m_file.clear();
+
+        if (m_fileSize - offset < sizeof(RecordHeader) + sizeof(Crypto::Hash))
+        {
+            return false;
+        }
+
+        RecordHeader header;
+
+        m_file.seekg(offset);
+        m_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+        if (!m_file || header.type > MANIFEST
+            || header.size > m_fileSize - offset - sizeof(RecordHeader) - sizeof(Crypto::Hash))
+        {
+            m_file.clear();
+            return false;
+        }
+
+        std::string record(sizeof(header) + header.size, '\0');
+        std::memcpy(&record[0], &header, sizeof(header));
+
+        Crypto::Hash checksum;
+
+        m_file.read(&record[sizeof(header)], header.size);
+        m_file.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+
+        if (!m_file || Crypto::cn_fast_hash(record.data(), record.size()) != checksum)
+        {
+            m_file.clear();
+            return false;
+        }
+
+        data.resize(header.size);
+        Crypto::chacha8(&record[sizeof(header)], header.size, m_key, header.iv, &data[0]);
+
+        type = static_cast<RecordType>(header.type);
+        recordSize = record.size() + sizeof(checksum);
+
+        return true;
+    }
+
+    WalletJournal::RecordLocation WalletJournal::appendRecord(RecordType type, const std::string &data)
+    {
+        RecordHeader header;
+        header.type = type;
+        header.iv = Crypto::randomChachaIV();
+        header.size = data.size();
+
+        std::string record(sizeof(header) + data.size(), '\0');
+        std::memcpy(&record[0], &header, sizeof(header));
+        Crypto::chacha8(data.data(), data.size(), m_key, header.iv, &record[sizeof(header)]);
+
+        const Crypto::Hash checksum = Crypto::cn_fast_hash(record.data(), record.size());
+
+        m_file.clear();
+        m_file.seekp(m_fileSize);
+        m_file.write(record.data(), record.size());
+        m_file.write(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+
+        if (!m_file)
+        {
+            throw std::runtime_error("Failed to write wallet journal");
+        }
+
+        const RecordLocation location {m_fileSize, record.size() + sizeof(checksum)};
+
+        m_fileSize += location.size;
+
+        return location;
+    }
+
+    void WalletJournal::loadManifest(const std::string &data, const RecordLocation &location)
+    {
+        uint64_t dataSize;
+        std::vector<Crypto::Hash> manifest;
+
+        Common::MemoryInputStream stream(data.data(), data.size());
+        BinaryInputStreamSerializer s(stream);
+
+        s(dataSize, "dataSize");
+        s(manifest, "chunks");
+
+        for (const auto &hash : manifest)
+        {
+            if (m_chunks.find(hash) == m_chunks.end())
+            {
+                throw std::runtime_error("Manifest references a missing chunk");
+            }
+        }
+
+        m_manifest = std::move(manifest);
+        m_manifestLocation = location;
+        m_dataSize = dataSize;
+        m_haveManifest = true;
+    }
+
+    bool WalletJournal::shouldCompact() const
+    {
+        return m_haveManifest && m_fileSize > MIN_COMPACTION_SIZE && m_fileSize > COMPACTION_RATIO * liveSize();
+    }
+
+    uint64_t WalletJournal::liveSize() const
+    {
+        uint64_t size = JOURNAL_HEADER_SIZE + m_manifestLocation.size;
+
+        std::unordered_set<Crypto::Hash> counted;
+
+        for (const auto &hash : m_manifest)
+        {
+            if (counted.insert(hash).second)
+            {
+                size += m_chunks.at(hash).size;
+            }
+        }
+
+        return size;
+    }
+
+    void WalletJournal::startCompaction()
+    {
+        waitForCompaction();
+
+        m_compactionThread = std::thread(&WalletJournal::compact, this);
+    }
+
+    /* Copies the records the latest manifest needs into a new file, and
+       swaps it in place of the journal. The records are copied as is, so
+       there is no need to decrypt them. */
+    void WalletJournal::compact()
+    {
+        std::scoped_lock lock(m_mutex);
+
+        /* Another write may have queued a compaction before this one ran */
+        if (!m_file.is_open() || !shouldCompact())
+        {
+            return;
+        }
+
+        const std::string tmpPath = m_path + ".tmp";
+
+        try
+        {
+            std::ofstream output(tmpPath, std::ios::binary | std::ios::trunc);
+
+            output.write(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+            output.write(reinterpret_cast<const char *>(&JOURNAL_VERSION), sizeof(JOURNAL_VERSION));
+            output.write(reinterpret_cast<const char *>(&m_containerId), sizeof(m_containerId));
+
+            uint64_t offset = JOURNAL_HEADER_SIZE;
+
+            const auto copyRecord = [&](const RecordLocation &location) {
+                std::string record(location.size, '\0');
+
+                m_file.clear();
+                m_file.seekg(location.offset);
+                m_file.read(&record[0], location.size);
+
+                if (!m_file)
+                {
+                    throw std::runtime_error("Failed to read wallet journal");
+                }
+
+                output.write(record.data(), record.size());
+
+                const RecordLocation newLocation {offset, location.size};
+                offset += location.size;
+
+                return newLocation;
+            };
+
+            std::unordered_map<Crypto::Hash, RecordLocation> chunks;
+
+            for (const auto &hash : m_manifest)
+            {
+                if (chunks.find(hash) == chunks.end())
+                {
+                    chunks[hash] = copyRecord(m_chunks.at(hash));
+                }
+            }
+
+            const RecordLocation manifestLocation = copyRecord(m_manifestLocation);
+
+            output.close();
+
+            if (!output)
+            {
+                throw std::runtime_error("Failed to write compacted wallet journal");
+            }
+
+            m_file.close();
+
+            fs::rename(tmpPath, m_path);
+
+            m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+
+            m_logger(DEBUGGING) << "Compacted wallet journal from " << m_fileSize << " to " << offset << " bytes";
+
+            m_chunks = std::move(chunks);
+            m_manifestLocation = manifestLocation;
+            m_fileSize = offset;
+        }
+        catch (const std::exception &e)
+        {
+            m_logger(WARNING) << "Failed to compact wallet journal: " << e.what();
+
+            std::error_code ec;
+            fs::remove(tmpPath, ec);
+
+            if (!m_file.is_open())
+            {
+                m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary);
+            }
+        }
+    }
+
+    void WalletJournal::waitForCompaction()
+    {
+        if (m_compactionThread.joinable())
+        {
+            m_compactionThread.join();
+        }
+    }
+} // namespace CryptoNote
@@ -0,0 +1,141 @@
+// Copyright (c) 2018-2019, The TurtleCoin Developers
+//
+// Please see the included LICENSE file for more information.
+
+#pragma once
+
+#include "CryptoTypes.h"
+#include "crypto/chacha8.h"
+#include "logging/LoggerRef.h"
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace CryptoNote
+{
+    /* An append only, encrypted log of the wallet container data, stored next
+       to the container.
+
+       Rewriting the whole container on every save is slow for large wallets,
+       so instead the serialized container data is split into content defined
+       chunks, and only the chunks which have changed since the last save are
+       appended to the journal, followed by a manifest listing the chunks
+       which make up the latest data. Appending transactions or synced blocks
+       only changes the chunks around them, so a save writes a small fraction
+       of the data.
+
+       Chunks no longer referenced by the latest manifest are dropped by
+       compacting the journal, which happens on a background thread once
+       the dead data outweighs the live data.
+
+       The journal is tied to a specific snapshot of the container data, and
+       is discarded if the container is saved in full, or the journal was
+       written for a different container. */
+    class WalletJournal
+    {
+      public:
+        WalletJournal(std::shared_ptr<Logging::ILogger> logger);
+
+        ~WalletJournal();
+
+        /* Opens (or creates) the journal at the given path. Any existing
+           contents are discarded if they were written for a different
+           container snapshot. A torn record at the end of the journal, from a
+           crash mid write, is dropped. */
+        void open(const std::string &path, const Crypto::chacha8_key &key, const Crypto::Hash &containerId);
+
+        void close();
+
+        bool isOpen() const;
+
+        /* Whether the journal has container data newer than the container */
+        bool hasData() const;
+
+        /* Reads the most recently journaled container data */
+        std::string read();
+
+        /* Journals a new version of the container data */
+        void write(const std::string &data);
+
+        /* Discards the contents of the journal, for example once the container
+           has been saved in full. The key is updated in case it was changed
+           along with the container. */
+        void reset(const Crypto::chacha8_key &key, const Crypto::Hash &containerId);
+
+        /* Added to the container path to get the journal path */
+        static const std::string FILE_SUFFIX;
+
+      private:
+        enum RecordType : uint8_t
+        {
+            CHUNK = 0,
+            MANIFEST = 1
+        };
+
+        struct RecordLocation
+        {
+            uint64_t offset;
+
+            /* Size of the whole record, including header and checksum */
+            uint64_t size;
+        };
+
+        void create();
+
+        bool readHeader();
+
+        void scanRecords();
+
+        bool readRecord(uint64_t offset, RecordType &type, std::string &data, uint64_t &recordSize);
+
+        RecordLocation appendRecord(RecordType type, const std::string &data);
+
+        void loadManifest(const std::string &data, const RecordLocation &location);
+
+        bool shouldCompact() const;
+
+        uint64_t liveSize() const;
+
+        void startCompaction();
+
+        void compact();
+
+        void waitForCompaction();
+
+        Logging::LoggerRef m_logger;
+
+        std::string m_path;
+
+        Crypto::chacha8_key m_key;
+
+        /* Identifies the container snapshot this journal applies on top of */
+        Crypto::Hash m_containerId;
+
+        std::fstream m_file;
+
+        uint64_t m_fileSize = 0;
+
+        /* Every chunk in the journal, by the hash of its plaintext */
+        std::unordered_map<Crypto::Hash, RecordLocation> m_chunks;
+
+        /* The chunks making up the latest container data, in order */
+        std::vector<Crypto::Hash> m_manifest;
+
+        RecordLocation m_manifestLocation {0, 0};
+
+        /* Size of the container data the manifest describes */
+        uint64_t m_dataSize = 0;
+
+        bool m_haveManifest = false;
+
+        /* Guards the file and the indexes above, which the compaction thread
+           rewrites */
+        mutable std::mutex m_mutex;
+
+        std::thread m_compactionThread;
+    };
+} // namespace CryptoNote
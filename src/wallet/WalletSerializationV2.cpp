@@ -318,8 +318,6 @@ namespace CryptoNote
         uint64_t count = 0;
         serializer(count, "transferCount");
 
-        m_transfers.reserve(count);
-
         for (uint64_t i = 0; i < count; ++i)
         {
             uint64_t txId = 0;
@@ -333,8 +331,12 @@ namespace CryptoNote
             tr.amount = dto.amount;
             tr.type = static_cast<WalletTransferType>(dto.type);
 
-            m_transfers.emplace_back(
-                std::piecewise_construct, std::forward_as_tuple(txId), std::forward_as_tuple(std::move(tr)));
+            /* Transfers are saved in order, so this is always the end */
+            m_transfers.emplace_hint(
+                m_transfers.end(),
+                std::piecewise_construct,
+                std::forward_as_tuple(txId),
+                std::forward_as_tuple(std::move(tr)));
         }
     }
 
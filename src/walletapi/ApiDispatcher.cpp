@@ -8,6 +8,8 @@
 
 #include "json.hpp"
 
+#include <common/ScopeExit.h>
+#include <config/Config.h>
 #include <config/CryptoNoteConfig.h>
 #include <common/StringTools.h>
 #include <crypto/random.h>
@@ -23,12 +25,25 @@
 #include <walletapi/Constants.h>
 #include <walletbackend/JsonSerialization.h>
 
+namespace
+{
+    /* When hosting multiple wallets, the wallet the request being handled on
+       this thread is for. Each request is handled start to finish on one
+       thread. */
+    thread_local std::shared_ptr<HostedWallet> requestHostedWallet;
+
+    /* Our copy of the wallet it holds, which the handlers use, and replace
+       when opening or closing it */
+    thread_local std::shared_ptr<WalletBackend> requestWallet;
+} // namespace
+
 ApiDispatcher::ApiDispatcher(
     const uint16_t bindPort,
     const std::string rpcBindIp,
     const std::string rpcPassword,
     const std::string corsHeader,
-    unsigned int walletSyncThreads):
+    unsigned int walletSyncThreads,
+    const bool multiWallet):
     m_port(bindPort),
     m_host(rpcBindIp),
     m_corsHeader(corsHeader),
@@ -41,6 +56,13 @@ ApiDispatcher::ApiDispatcher(
 
     m_walletSyncThreads = walletSyncThreads;
 
+    m_multiWallet = multiWallet;
+
+    if (m_multiWallet)
+    {
+        m_blockCache = std::make_shared<SharedBlockCache>(Config::config.wallet.skipCoinbaseTransactions);
+    }
+
     /* Generate the salt used for pbkdf2 api authentication */
     Random::randomBytes(16, m_salt);
 
@@ -64,164 +86,171 @@ ApiDispatcher::ApiDispatcher(
         };
     };
 
+    /* When hosting multiple wallets, requests for a wallet are prefixed with
+       /wallets/<walletId> */
+    const auto route = [this](const std::string &path) {
+        if (m_multiWallet)
+        {
+            return ApiConstants::walletsPath + ApiConstants::walletIdRegex + path;
+        }
+
+        return path;
+    };
+
     const bool viewWalletsAllowed = true;
     const bool viewWalletsBanned = false;
 
     /* POST */
     m_server
-        .Post("/wallet/open", router(&ApiDispatcher::openWallet, WalletMustBeClosed, viewWalletsAllowed))
+        .Post(route("/wallet/open"), router(&ApiDispatcher::openWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Import wallet with keys */
-        .Post("/wallet/import/key", router(&ApiDispatcher::keyImportWallet, WalletMustBeClosed, viewWalletsAllowed))
+        .Post(
+            route("/wallet/import/key"),
+            router(&ApiDispatcher::keyImportWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Import wallet with seed */
-        .Post("/wallet/import/seed", router(&ApiDispatcher::seedImportWallet, WalletMustBeClosed, viewWalletsAllowed))
+        .Post(
+            route("/wallet/import/seed"),
+            router(&ApiDispatcher::seedImportWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Import view wallet */
-        .Post("/wallet/import/view", router(&ApiDispatcher::importViewWallet, WalletMustBeClosed, viewWalletsAllowed))
+        .Post(
+            route("/wallet/import/view"),
+            router(&ApiDispatcher::importViewWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Create wallet */
-        .Post("/wallet/create", router(&ApiDispatcher::createWallet, WalletMustBeClosed, viewWalletsAllowed))
+        .Post(route("/wallet/create"), router(&ApiDispatcher::createWallet, WalletMustBeClosed, viewWalletsAllowed))
 
         /* Create a random address */
-        .Post("/addresses/create", router(&ApiDispatcher::createAddress, WalletMustBeOpen, viewWalletsBanned))
+        .Post(route("/addresses/create"), router(&ApiDispatcher::createAddress, WalletMustBeOpen, viewWalletsBanned))
 
         /* Import an address with a spend secret key */
-        .Post("/addresses/import", router(&ApiDispatcher::importAddress, WalletMustBeOpen, viewWalletsBanned))
+        .Post(route("/addresses/import"), router(&ApiDispatcher::importAddress, WalletMustBeOpen, viewWalletsBanned))
 
         /* Import a view only address with a public spend key */
-        .Post("/addresses/import/view", router(&ApiDispatcher::importViewAddress, WalletMustBeOpen, viewWalletsAllowed))
+        .Post(
+            route("/addresses/import/view"),
+            router(&ApiDispatcher::importViewAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Validate an address */
         .Post("/addresses/validate", router(&ApiDispatcher::validateAddress, DoesntMatter, viewWalletsAllowed))
 
         /* Send a transaction */
-        .Post(
-            "/transactions/send/basic",
+        .Post(route("/transactions/send/basic"),
             router(&ApiDispatcher::sendBasicTransaction, WalletMustBeOpen, viewWalletsBanned))
 
         /* Send a transaction, more parameters specified */
-        .Post(
-            "/transactions/send/advanced",
+        .Post(route("/transactions/send/advanced"),
             router(&ApiDispatcher::sendAdvancedTransaction, WalletMustBeOpen, viewWalletsBanned))
 
         /* Send a fusion transaction */
-        .Post(
-            "/transactions/send/fusion/basic",
+        .Post(route("/transactions/send/fusion/basic"),
             router(&ApiDispatcher::sendBasicFusionTransaction, WalletMustBeOpen, viewWalletsBanned))
 
         /* Send a fusion transaction, more parameters specified */
-        .Post(
-            "/transactions/send/fusion/advanced",
+        .Post(route("/transactions/send/fusion/advanced"),
             router(&ApiDispatcher::sendAdvancedFusionTransaction, WalletMustBeOpen, viewWalletsBanned))
 
         /* DELETE */
 
         /* Close the current wallet */
-        .Delete("/wallet", router(&ApiDispatcher::closeWallet, WalletMustBeOpen, viewWalletsAllowed))
+        .Delete(route("/wallet"), router(&ApiDispatcher::closeWallet, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Delete the given address */
-        .Delete(
-            "/addresses/" + ApiConstants::addressRegex,
+        .Delete(route("/addresses/" + ApiConstants::addressRegex),
             router(&ApiDispatcher::deleteAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* PUT */
 
         /* Save the wallet */
-        .Put("/save", router(&ApiDispatcher::saveWallet, WalletMustBeOpen, viewWalletsAllowed))
+        .Put(route("/save"), router(&ApiDispatcher::saveWallet, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Reset the wallet from zero, or given scan height */
-        .Put("/reset", router(&ApiDispatcher::resetWallet, WalletMustBeOpen, viewWalletsAllowed))
+        .Put(route("/reset"), router(&ApiDispatcher::resetWallet, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Swap node details */
-        .Put("/node", router(&ApiDispatcher::setNodeInfo, WalletMustBeOpen, viewWalletsAllowed))
+        .Put(route("/node"), router(&ApiDispatcher::setNodeInfo, WalletMustBeOpen, viewWalletsAllowed))
 
         /* GET */
 
         /* Get node details */
-        .Get("/node", router(&ApiDispatcher::getNodeInfo, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/node"), router(&ApiDispatcher::getNodeInfo, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the shared private view key */
-        .Get("/keys", router(&ApiDispatcher::getPrivateViewKey, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/keys"), router(&ApiDispatcher::getPrivateViewKey, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the spend keys for the given address */
-        .Get(
-            "/keys/" + ApiConstants::addressRegex,
+        .Get(route("/keys/" + ApiConstants::addressRegex),
             router(&ApiDispatcher::getSpendKeys, WalletMustBeOpen, viewWalletsBanned))
 
         /* Get the mnemonic seed for the given address */
-        .Get(
-            "/keys/mnemonic/" + ApiConstants::addressRegex,
+        .Get(route("/keys/mnemonic/" + ApiConstants::addressRegex),
             router(&ApiDispatcher::getMnemonicSeed, WalletMustBeOpen, viewWalletsBanned))
 
         /* Get the wallet status */
-        .Get("/status", router(&ApiDispatcher::getStatus, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/status"), router(&ApiDispatcher::getStatus, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get a list of all addresses */
-        .Get("/addresses", router(&ApiDispatcher::getAddresses, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/addresses"), router(&ApiDispatcher::getAddresses, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the primary address */
-        .Get("/addresses/primary", router(&ApiDispatcher::getPrimaryAddress, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(
+            route("/addresses/primary"),
+            router(&ApiDispatcher::getPrimaryAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Creates an integrated address from the given address and payment ID */
-        .Get(
-            "/addresses/" + ApiConstants::addressRegex + "/" + ApiConstants::hashRegex,
+        .Get(route("/addresses/" + ApiConstants::addressRegex + "/" + ApiConstants::hashRegex),
             router(&ApiDispatcher::createIntegratedAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get all transactions */
-        .Get("/transactions", router(&ApiDispatcher::getTransactions, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/transactions"), router(&ApiDispatcher::getTransactions, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get all (outgoing) unconfirmed transactions */
-        .Get(
-            "/transactions/unconfirmed",
+        .Get(route("/transactions/unconfirmed"),
             router(&ApiDispatcher::getUnconfirmedTransactions, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get all (outgoing) unconfirmed transactions, belonging to the given address */
-        .Get(
-            "/transactions/unconfirmed/" + ApiConstants::addressRegex,
+        .Get(route("/transactions/unconfirmed/" + ApiConstants::addressRegex),
             router(&ApiDispatcher::getUnconfirmedTransactionsForAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the transactions starting at the given block, for 1000 blocks */
-        .Get(
-            "/transactions/\\d+",
+        .Get(route("/transactions/\\d+"),
             router(&ApiDispatcher::getTransactionsFromHeight, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the transactions starting at the given block, and ending at the given block */
-        .Get(
-            "/transactions/\\d+/\\d+",
+        .Get(route("/transactions/\\d+/\\d+"),
             router(&ApiDispatcher::getTransactionsFromHeightToHeight, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the transactions starting at the given block, for 1000 blocks, belonging to the given address */
-        .Get(
-            "/transactions/address/" + ApiConstants::addressRegex + "/\\d+",
+        .Get(route("/transactions/address/" + ApiConstants::addressRegex + "/\\d+"),
             router(&ApiDispatcher::getTransactionsFromHeightWithAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the transactions starting at the given block, and ending at the given block, belonging to the given
            address */
-        .Get(
-            "/transactions/address/" + ApiConstants::addressRegex + "/\\d+/\\d+",
+        .Get(route("/transactions/address/" + ApiConstants::addressRegex + "/\\d+/\\d+"),
             router(&ApiDispatcher::getTransactionsFromHeightToHeightWithAddress, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get the transaction private key for the given hash */
-        .Get(
-            "/transactions/privatekey/" + ApiConstants::hashRegex,
+        .Get(route("/transactions/privatekey/" + ApiConstants::hashRegex),
             router(&ApiDispatcher::getTxPrivateKey, WalletMustBeOpen, viewWalletsBanned))
 
         /* Get details for the given transaction hash, if known */
-        .Get(
-            "/transactions/hash/" + ApiConstants::hashRegex,
+        .Get(route("/transactions/hash/" + ApiConstants::hashRegex),
             router(&ApiDispatcher::getTransactionDetails, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get balance for the wallet */
-        .Get("/balance", router(&ApiDispatcher::getBalance, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/balance"), router(&ApiDispatcher::getBalance, WalletMustBeOpen, viewWalletsAllowed))
 
         /* Get balance for a specific address */
-        .Get(
-            "/balance/" + ApiConstants::addressRegex,
+        .Get(route("/balance/" + ApiConstants::addressRegex),
             router(&ApiDispatcher::getBalanceForAddress, WalletMustBeOpen, viewWalletsAllowed))
 
+        /* Get the IDs of the open wallets, when hosting multiple wallets */
+        .Get("/wallets", router(&ApiDispatcher::getWallets, DoesntMatter, viewWalletsAllowed))
+
         /* Get balances for each address */
-        .Get("/balances", router(&ApiDispatcher::getBalances, WalletMustBeOpen, viewWalletsAllowed))
+        .Get(route("/balances"), router(&ApiDispatcher::getBalances, WalletMustBeOpen, viewWalletsAllowed))
 
         /* OPTIONS */
 
@@ -289,6 +318,96 @@ void ApiDispatcher::middleware(
         return;
     }
 
+    /* The handlers see the path without the /wallets/<walletId> prefix, so
+       they work the same when hosting multiple wallets */
+    httplib::Request walletRequest;
+
+    const httplib::Request *request = &req;
+
+    /* Make sure later requests on this thread don't see this wallet */
+    Tools::ScopeExit clearRequestWallet([] {
+        requestHostedWallet = nullptr;
+        requestWallet = nullptr;
+    });
+
+    std::string walletId;
+
+    /* Runs before clearRequestWallet. Drops the entry again if the request
+       failed to open a wallet, or closed it, so requests for wallets which
+       don't exist can't grow m_wallets. Other requests holding the same
+       entry may still open it, so leave it alone while they have it. */
+    Tools::ScopeExit eraseClosedWallet([this, &walletId] {
+        if (requestHostedWallet == nullptr)
+        {
+            return;
+        }
+
+        std::scoped_lock lock(m_walletsMutex);
+
+        const auto hostedWallet = m_wallets.find(walletId);
+
+        if (requestHostedWallet->wallet == nullptr && hostedWallet != m_wallets.end()
+            && hostedWallet->second == requestHostedWallet && requestHostedWallet.use_count() == 2)
+        {
+            m_wallets.erase(hostedWallet);
+        }
+    });
+
+    if (m_multiWallet && req.path.rfind(ApiConstants::walletsPath, 0) == 0)
+    {
+        const size_t walletIdEnd = req.path.find('/', ApiConstants::walletsPath.size());
+
+        if (walletIdEnd != std::string::npos)
+        {
+            walletId =
+                req.path.substr(ApiConstants::walletsPath.size(), walletIdEnd - ApiConstants::walletsPath.size());
+
+            walletRequest = req;
+            walletRequest.path = req.path.substr(walletIdEnd);
+
+            request = &walletRequest;
+
+            std::scoped_lock lock(m_walletsMutex);
+
+            /* Only opening a wallet adds a new one */
+            if (walletState == WalletMustBeClosed)
+            {
+                auto &hostedWallet = m_wallets[walletId];
+
+                if (hostedWallet == nullptr)
+                {
+                    hostedWallet = std::make_shared<HostedWallet>();
+                }
+
+                requestHostedWallet = hostedWallet;
+            }
+            else if (const auto wallet = m_wallets.find(walletId); wallet != m_wallets.end())
+            {
+                requestHostedWallet = wallet->second;
+            }
+        }
+    }
+
+    /* Opening a wallet checks none is open before opening one, so hold the
+       lock throughout, or two requests could both open one */
+    std::unique_lock<std::mutex> openLock;
+
+    if (walletState == WalletMustBeClosed)
+    {
+        openLock = std::unique_lock<std::mutex>(walletMutex());
+    }
+
+    /* The wallet before the handler runs, to see if it opened or closed it */
+    std::shared_ptr<WalletBackend> originalWallet;
+
+    if (requestHostedWallet != nullptr)
+    {
+        std::scoped_lock lock(m_walletsMutex);
+
+        requestWallet = requestHostedWallet->wallet;
+        originalWallet = requestWallet;
+    }
+
     /* Wallet must be open for this operation, and it is not */
     if (walletState == WalletMustBeOpen && !assertWalletOpen())
     {
@@ -304,7 +423,7 @@ void ApiDispatcher::middleware(
 
     /* We have a wallet open, view wallets are not permitted, and the wallet is
        a view wallet (wew!) */
-    if (m_walletBackend != nullptr && !viewWalletPermitted && !assertIsNotViewWallet())
+    if (walletBackend() != nullptr && !viewWalletPermitted && !assertIsNotViewWallet())
     {
         /* Bad request */
         res.status = 400;
@@ -321,7 +440,25 @@ void ApiDispatcher::middleware(
 
     try
     {
-        const auto [error, statusCode] = handler(req, res, body);
+        const auto [error, statusCode] = handler(*request, res, body);
+
+        /* Store the wallet the handler opened or closed, unless a request
+           for the same wallet beat us to it */
+        if (requestHostedWallet != nullptr && requestWallet != originalWallet)
+        {
+            std::scoped_lock lock(m_walletsMutex);
+
+            if (requestHostedWallet->wallet == originalWallet)
+            {
+                requestHostedWallet->wallet = requestWallet;
+            }
+        }
+
+        /* Share blocks between the wallets we're hosting */
+        if (!error && walletState == WalletMustBeClosed && m_blockCache != nullptr && walletBackend() != nullptr)
+        {
+            walletBackend()->setSharedBlockCache(m_blockCache);
+        }
 
         if (error)
         {
@@ -387,13 +524,11 @@ bool ApiDispatcher::checkAuthenticated(const httplib::Request &req, httplib::Res
 
 std::tuple<Error, uint16_t> ApiDispatcher::openWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
-
     const auto [daemonHost, daemonPort, daemonSSL, filename, password] = getDefaultWalletParams(body);
 
     Error error;
 
-    std::tie(error, m_walletBackend) =
+    std::tie(error, walletBackend()) =
         WalletBackend::openWallet(filename, password, daemonHost, daemonPort, daemonSSL, m_walletSyncThreads);
 
     return {error, 200};
@@ -402,8 +537,6 @@ std::tuple<Error, uint16_t> ApiDispatcher::openWallet(const httplib::Request &re
 std::tuple<Error, uint16_t>
     ApiDispatcher::keyImportWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
-
     const auto [daemonHost, daemonPort, daemonSSL, filename, password] = getDefaultWalletParams(body);
 
     const auto privateViewKey = getJsonValue<Crypto::SecretKey>(body, "privateViewKey");
@@ -418,7 +551,7 @@ std::tuple<Error, uint16_t>
 
     Error error;
 
-    std::tie(error, m_walletBackend) = WalletBackend::importWalletFromKeys(
+    std::tie(error, walletBackend()) = WalletBackend::importWalletFromKeys(
         privateSpendKey,
         privateViewKey,
         filename,
@@ -435,8 +568,6 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::seedImportWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
-
     const auto [daemonHost, daemonPort, daemonSSL, filename, password] = getDefaultWalletParams(body);
 
     const std::string mnemonicSeed = getJsonValue<std::string>(body, "mnemonicSeed");
@@ -450,7 +581,7 @@ std::tuple<Error, uint16_t>
 
     Error error;
 
-    std::tie(error, m_walletBackend) = WalletBackend::importWalletFromSeed(
+    std::tie(error, walletBackend()) = WalletBackend::importWalletFromSeed(
         mnemonicSeed, filename, password, scanHeight, daemonHost, daemonPort, daemonSSL, m_walletSyncThreads);
 
     return {error, 200};
@@ -459,8 +590,6 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::importViewWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
-
     const auto [daemonHost, daemonPort, daemonSSL, filename, password] = getDefaultWalletParams(body);
 
     const std::string address = getJsonValue<std::string>(body, "address");
@@ -475,7 +604,7 @@ std::tuple<Error, uint16_t>
 
     Error error;
 
-    std::tie(error, m_walletBackend) = WalletBackend::importViewWallet(
+    std::tie(error, walletBackend()) = WalletBackend::importViewWallet(
         privateViewKey,
         address,
         filename,
@@ -491,13 +620,11 @@ std::tuple<Error, uint16_t>
 
 std::tuple<Error, uint16_t> ApiDispatcher::createWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
-
     const auto [daemonHost, daemonPort, daemonSSL, filename, password] = getDefaultWalletParams(body);
 
     Error error;
 
-    std::tie(error, m_walletBackend) =
+    std::tie(error, walletBackend()) =
         WalletBackend::createWallet(filename, password, daemonHost, daemonPort, daemonSSL, m_walletSyncThreads);
 
     return {error, 200};
@@ -505,7 +632,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::createWallet(const httplib::Request &
 
 std::tuple<Error, uint16_t> ApiDispatcher::createAddress(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    const auto [error, address, privateSpendKey] = m_walletBackend->addSubWallet();
+    const auto [error, address, privateSpendKey] = walletBackend()->addSubWallet();
 
     const auto [publicSpendKey, publicViewKey] = Utilities::addressToKeys(address);
 
@@ -529,7 +656,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::importAddress(const httplib::Request
 
     const auto privateSpendKey = getJsonValue<Crypto::SecretKey>(body, "privateSpendKey");
 
-    const auto [error, address] = m_walletBackend->importSubWallet(privateSpendKey, scanHeight);
+    const auto [error, address] = walletBackend()->importSubWallet(privateSpendKey, scanHeight);
 
     if (error)
     {
@@ -557,7 +684,7 @@ std::tuple<Error, uint16_t>
 
     const auto publicSpendKey = getJsonValue<Crypto::PublicKey>(body, "publicSpendKey");
 
-    const auto [error, address] = m_walletBackend->importViewSubWallet(publicSpendKey, scanHeight);
+    const auto [error, address] = walletBackend()->importViewSubWallet(publicSpendKey, scanHeight);
 
     if (error)
     {
@@ -622,7 +749,7 @@ std::tuple<Error, uint16_t>
         paymentID = getJsonValue<std::string>(body, "paymentID");
     }
 
-    auto [error, hash] = m_walletBackend->sendTransactionBasic(address, amount, paymentID);
+    auto [error, hash] = walletBackend()->sendTransactionBasic(address, amount, paymentID);
 
     if (error)
     {
@@ -660,7 +787,7 @@ std::tuple<Error, uint16_t>
     {
         /* Get the default mixin */
         std::tie(std::ignore, std::ignore, mixin) =
-            Utilities::getMixinAllowableRange(m_walletBackend->getStatus().networkBlockCount);
+            Utilities::getMixinAllowableRange(walletBackend()->getStatus().networkBlockCount);
     }
 
     uint64_t fee = WalletConfig::defaultFee;
@@ -710,7 +837,7 @@ std::tuple<Error, uint16_t>
         }
     }
 
-    auto [error, hash] = m_walletBackend->sendTransactionAdvanced(
+    auto [error, hash] = walletBackend()->sendTransactionAdvanced(
         destinations, mixin, fee, paymentID, subWalletsToTakeFrom, changeAddress, unlockTime, extraData);
 
     if (error)
@@ -728,7 +855,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::sendBasicFusionTransaction(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    auto [error, hash] = m_walletBackend->sendFusionTransactionBasic();
+    auto [error, hash] = walletBackend()->sendFusionTransactionBasic();
 
     if (error)
     {
@@ -757,7 +884,7 @@ std::tuple<Error, uint16_t>
     {
         /* Get the default mixin */
         std::tie(std::ignore, std::ignore, mixin) =
-            Utilities::getMixinAllowableRange(m_walletBackend->getStatus().networkBlockCount);
+            Utilities::getMixinAllowableRange(walletBackend()->getStatus().networkBlockCount);
     }
 
     std::vector<std::string> subWalletsToTakeFrom;
@@ -779,7 +906,7 @@ std::tuple<Error, uint16_t>
         }
     }
 
-    auto [error, hash] = m_walletBackend->sendFusionTransactionAdvanced(mixin, subWalletsToTakeFrom, destination, extraData);
+    auto [error, hash] = walletBackend()->sendFusionTransactionAdvanced(mixin, subWalletsToTakeFrom, destination, extraData);
 
     if (error)
     {
@@ -799,9 +926,9 @@ std::tuple<Error, uint16_t>
 
 std::tuple<Error, uint16_t> ApiDispatcher::closeWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
+    std::scoped_lock lock(walletMutex());
 
-    m_walletBackend = nullptr;
+    walletBackend() = nullptr;
 
     return {SUCCESS, 200};
 }
@@ -816,7 +943,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::deleteAddress(const httplib::Request
         return {error, 400};
     }
 
-    Error error = m_walletBackend->deleteSubWallet(address);
+    Error error = walletBackend()->deleteSubWallet(address);
 
     if (error)
     {
@@ -833,16 +960,16 @@ std::tuple<Error, uint16_t> ApiDispatcher::deleteAddress(const httplib::Request
 std::tuple<Error, uint16_t>
     ApiDispatcher::saveWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    std::scoped_lock lock(m_mutex);
+    std::scoped_lock lock(walletMutex());
 
-    m_walletBackend->save();
+    walletBackend()->save();
 
     return {SUCCESS, 200};
 }
 
 std::tuple<Error, uint16_t> ApiDispatcher::resetWallet(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
+    std::scoped_lock lock(walletMutex());
 
     uint64_t scanHeight = 0;
     uint64_t timestamp = 0;
@@ -852,14 +979,14 @@ std::tuple<Error, uint16_t> ApiDispatcher::resetWallet(const httplib::Request &r
         scanHeight = getJsonValue<uint64_t>(body, "scanHeight");
     }
 
-    m_walletBackend->reset(scanHeight, timestamp);
+    walletBackend()->reset(scanHeight, timestamp);
 
     return {SUCCESS, 200};
 }
 
 std::tuple<Error, uint16_t> ApiDispatcher::setNodeInfo(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body)
 {
-    std::scoped_lock lock(m_mutex);
+    std::scoped_lock lock(walletMutex());
 
     uint16_t daemonPort = CryptoNote::RPC_DEFAULT_PORT;
     bool daemonSSL = false;
@@ -878,7 +1005,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::setNodeInfo(const httplib::Request &r
         daemonSSL = getJsonValue<bool>(body, "daemonSSL");
     }
 
-    m_walletBackend->swapNode(daemonHost, daemonPort, daemonSSL);
+    walletBackend()->swapNode(daemonHost, daemonPort, daemonSSL);
 
     return {SUCCESS, 200};
 }
@@ -890,9 +1017,9 @@ std::tuple<Error, uint16_t> ApiDispatcher::setNodeInfo(const httplib::Request &r
 std::tuple<Error, uint16_t>
     ApiDispatcher::getNodeInfo(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    const auto [daemonHost, daemonPort, daemonSSL] = m_walletBackend->getNodeAddress();
+    const auto [daemonHost, daemonPort, daemonSSL] = walletBackend()->getNodeAddress();
 
-    const auto [nodeFee, nodeAddress] = m_walletBackend->getNodeFee();
+    const auto [nodeFee, nodeAddress] = walletBackend()->getNodeFee();
 
     nlohmann::json j {{"daemonHost", daemonHost},
                       {"daemonPort", daemonPort},
@@ -908,7 +1035,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getPrivateViewKey(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"privateViewKey", m_walletBackend->getPrivateViewKey()}};
+    nlohmann::json j {{"privateViewKey", walletBackend()->getPrivateViewKey()}};
 
     res.set_content(j.dump(4) + "\n", "application/json");
 
@@ -927,7 +1054,7 @@ std::tuple<Error, uint16_t>
         return {error, 400};
     }
 
-    const auto [error, publicSpendKey, privateSpendKey] = m_walletBackend->getSpendKeys(address);
+    const auto [error, publicSpendKey, privateSpendKey] = walletBackend()->getSpendKeys(address);
 
     if (error)
     {
@@ -953,7 +1080,7 @@ std::tuple<Error, uint16_t>
         return {error, 400};
     }
 
-    const auto [error, mnemonicSeed] = m_walletBackend->getMnemonicSeedForAddress(address);
+    const auto [error, mnemonicSeed] = walletBackend()->getMnemonicSeedForAddress(address);
 
     if (error)
     {
@@ -970,15 +1097,15 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getStatus(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    const WalletTypes::WalletStatus status = m_walletBackend->getStatus();
+    const WalletTypes::WalletStatus status = walletBackend()->getStatus();
 
     nlohmann::json j {{"walletBlockCount", status.walletBlockCount},
                       {"localDaemonBlockCount", status.localDaemonBlockCount},
                       {"networkBlockCount", status.networkBlockCount},
                       {"peerCount", status.peerCount},
                       {"hashrate", status.lastKnownHashrate},
-                      {"isViewWallet", m_walletBackend->isViewWallet()},
-                      {"subWalletCount", m_walletBackend->getWalletCount()}};
+                      {"isViewWallet", walletBackend()->isViewWallet()},
+                      {"subWalletCount", walletBackend()->getWalletCount()}};
 
     res.set_content(j.dump(4) + "\n", "application/json");
 
@@ -988,7 +1115,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getAddresses(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"addresses", m_walletBackend->getAddresses()}};
+    nlohmann::json j {{"addresses", walletBackend()->getAddresses()}};
 
     res.set_content(j.dump(4) + "\n", "application/json");
 
@@ -998,7 +1125,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getPrimaryAddress(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"address", m_walletBackend->getPrimaryAddress()}};
+    nlohmann::json j {{"address", walletBackend()->getPrimaryAddress()}};
 
     res.set_content(j.dump(4) + "\n", "application/json");
 
@@ -1034,7 +1161,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getTransactions(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"transactions", m_walletBackend->getTransactions()}};
+    nlohmann::json j {{"transactions", walletBackend()->getTransactions()}};
 
     publicKeysToAddresses(j);
 
@@ -1046,7 +1173,7 @@ std::tuple<Error, uint16_t>
 std::tuple<Error, uint16_t>
     ApiDispatcher::getUnconfirmedTransactions(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    nlohmann::json j {{"transactions", m_walletBackend->getUnconfirmedTransactions()}};
+    nlohmann::json j {{"transactions", walletBackend()->getUnconfirmedTransactions()}};
 
     publicKeysToAddresses(j);
 
@@ -1062,14 +1189,14 @@ std::tuple<Error, uint16_t> ApiDispatcher::getUnconfirmedTransactionsForAddress(
 {
     std::string address = req.path.substr(std::string("/transactions/unconfirmed").size());
 
-    const auto txs = m_walletBackend->getUnconfirmedTransactions();
+    const auto txs = walletBackend()->getUnconfirmedTransactions();
 
     std::vector<WalletTypes::Transaction> result;
 
     std::copy_if(txs.begin(), txs.end(), std::back_inserter(result), [address, this](const auto tx) {
         for (const auto [key, transfer] : tx.transfers)
         {
-            const auto [error, actualAddress] = m_walletBackend->getAddress(key);
+            const auto [error, actualAddress] = walletBackend()->getAddress(key);
 
             /* If the transfer contains our address, keep it, else skip */
             if (actualAddress == address)
@@ -1101,7 +1228,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeight(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, startHeight + 1000);
+        const auto txs = walletBackend()->getTransactionsRange(startHeight, startHeight + 1000);
 
         nlohmann::json j {{"transactions", txs}};
 
@@ -1150,7 +1277,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeight(
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, endHeight);
+        const auto txs = walletBackend()->getTransactionsRange(startHeight, endHeight);
 
         nlohmann::json j {{"transactions", txs}};
 
@@ -1195,14 +1322,14 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightWithAddress(
     {
         uint64_t startHeight = std::stoull(startHeightStr);
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, startHeight + 1000);
+        const auto txs = walletBackend()->getTransactionsRange(startHeight, startHeight + 1000);
 
         std::vector<WalletTypes::Transaction> result;
 
         std::copy_if(txs.begin(), txs.end(), std::back_inserter(result), [address, this](const auto tx) {
             for (const auto [key, transfer] : tx.transfers)
             {
-                const auto [error, actualAddress] = m_walletBackend->getAddress(key);
+                const auto [error, actualAddress] = walletBackend()->getAddress(key);
 
                 /* If the transfer contains our address, keep it, else skip */
                 if (actualAddress == address)
@@ -1272,14 +1399,14 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionsFromHeightToHeightWith
             return {SUCCESS, 400};
         }
 
-        const auto txs = m_walletBackend->getTransactionsRange(startHeight, endHeight);
+        const auto txs = walletBackend()->getTransactionsRange(startHeight, endHeight);
 
         std::vector<WalletTypes::Transaction> result;
 
         std::copy_if(txs.begin(), txs.end(), std::back_inserter(result), [address, this](const auto tx) {
             for (const auto [key, transfer] : tx.transfers)
             {
-                const auto [error, actualAddress] = m_walletBackend->getAddress(key);
+                const auto [error, actualAddress] = walletBackend()->getAddress(key);
 
                 /* If the transfer contains our address, keep it, else skip */
                 if (actualAddress == address)
@@ -1322,7 +1449,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
 
     Common::podFromHex(hashStr, hash.data);
 
-    for (const auto tx : m_walletBackend->getTransactions())
+    for (const auto tx : walletBackend()->getTransactions())
     {
         if (tx.hash == hash)
         {
@@ -1335,7 +1462,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
                 Crypto::PublicKey spendKey = tx.at("publicKey").get<Crypto::PublicKey>();
 
                 /* Get the address it belongs to */
-                const auto [error, address] = m_walletBackend->getAddress(spendKey);
+                const auto [error, address] = walletBackend()->getAddress(spendKey);
 
                 /* Add the address to the json */
                 tx["address"] = address;
@@ -1357,7 +1484,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTransactionDetails(
 std::tuple<Error, uint16_t>
     ApiDispatcher::getBalance(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    const auto [unlocked, locked] = m_walletBackend->getTotalBalance();
+    const auto [unlocked, locked] = walletBackend()->getTotalBalance();
 
     nlohmann::json j {{"unlocked", unlocked}, {"locked", locked}};
 
@@ -1373,7 +1500,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getBalanceForAddress(
 {
     std::string address = req.path.substr(std::string("/balance/").size());
 
-    const auto [error, unlocked, locked] = m_walletBackend->getBalance(address);
+    const auto [error, unlocked, locked] = walletBackend()->getBalance(address);
 
     if (error)
     {
@@ -1390,7 +1517,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getBalanceForAddress(
 std::tuple<Error, uint16_t>
     ApiDispatcher::getBalances(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
 {
-    const auto balances = m_walletBackend->getBalances();
+    const auto balances = walletBackend()->getBalances();
 
     nlohmann::json j;
 
@@ -1415,7 +1542,7 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTxPrivateKey(
 
     Common::podFromHex(txHashStr, txHash.data);
 
-    const auto [error, key] = m_walletBackend->getTxPrivateKey(txHash);
+    const auto [error, key] = walletBackend()->getTxPrivateKey(txHash);
 
     if (error)
     {
@@ -1429,6 +1556,30 @@ std::tuple<Error, uint16_t> ApiDispatcher::getTxPrivateKey(
     return {SUCCESS, 200};
 }
 
+std::tuple<Error, uint16_t>
+    ApiDispatcher::getWallets(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const
+{
+    std::vector<std::string> walletIds;
+
+    {
+        std::scoped_lock lock(m_walletsMutex);
+
+        for (const auto &[walletId, hostedWallet] : m_wallets)
+        {
+            if (hostedWallet->wallet != nullptr)
+            {
+                walletIds.push_back(walletId);
+            }
+        }
+    }
+
+    nlohmann::json j {{"wallets", walletIds}};
+
+    res.set_content(j.dump(4) + "\n", "application/json");
+
+    return {SUCCESS, 200};
+}
+
 //////////////////////
 /* OPTIONS REQUESTS */
 //////////////////////
@@ -1495,9 +1646,39 @@ std::tuple<std::string, uint16_t, bool, std::string, std::string>
 /* END OF API FUNCTIONS */
 //////////////////////////
 
+std::shared_ptr<WalletBackend> &ApiDispatcher::walletBackend()
+{
+    if (m_multiWallet && requestHostedWallet != nullptr)
+    {
+        return requestWallet;
+    }
+
+    return m_walletBackend;
+}
+
+const std::shared_ptr<WalletBackend> &ApiDispatcher::walletBackend() const
+{
+    if (m_multiWallet && requestHostedWallet != nullptr)
+    {
+        return requestWallet;
+    }
+
+    return m_walletBackend;
+}
+
+std::mutex &ApiDispatcher::walletMutex() const
+{
+    if (m_multiWallet && requestHostedWallet != nullptr)
+    {
+        return requestHostedWallet->mutex;
+    }
+
+    return m_mutex;
+}
+
 bool ApiDispatcher::assertIsNotViewWallet() const
 {
-    if (m_walletBackend->isViewWallet())
+    if (walletBackend()->isViewWallet())
     {
         std::cout << "Client requested to perform an operation which requires "
                      "a non view wallet, but wallet is a view wallet"
@@ -1510,7 +1691,7 @@ bool ApiDispatcher::assertIsNotViewWallet() const
 
 bool ApiDispatcher::assertIsViewWallet() const
 {
-    if (!m_walletBackend->isViewWallet())
+    if (!walletBackend()->isViewWallet())
     {
         std::cout << "Client requested to perform an operation which requires "
                      "a view wallet, but wallet is a non view wallet"
@@ -1523,7 +1704,7 @@ bool ApiDispatcher::assertIsViewWallet() const
 
 bool ApiDispatcher::assertWalletClosed() const
 {
-    if (m_walletBackend != nullptr)
+    if (walletBackend() != nullptr)
     {
         std::cout << "Client requested to open a wallet, whilst one is already open" << std::endl;
         return false;
@@ -1534,7 +1715,7 @@ bool ApiDispatcher::assertWalletClosed() const
 
 bool ApiDispatcher::assertWalletOpen() const
 {
-    if (m_walletBackend == nullptr)
+    if (walletBackend() == nullptr)
     {
         std::cout << "Client requested to modify a wallet, whilst no wallet is open" << std::endl;
         return false;
@@ -1554,7 +1735,7 @@ void ApiDispatcher::publicKeysToAddresses(nlohmann::json &j) const
             Crypto::PublicKey spendKey = tx.at("publicKey").get<Crypto::PublicKey>();
 
             /* Get the address it belongs to */
-            const auto [error, address] = m_walletBackend->getAddress(spendKey);
+            const auto [error, address] = walletBackend()->getAddress(spendKey);
 
             /* Add the address to the json */
             tx["address"] = address;
@@ -16,6 +16,18 @@ enum WalletState
     DoesntMatter,
 };
 
+/* A wallet hosted at /wallets/<walletId> */
+struct HostedWallet
+{
+    /* Only set or read under the dispatchers m_walletsMutex. Requests take a
+       copy, so closing the wallet doesn't free it while they're using it */
+    std::shared_ptr<WalletBackend> wallet;
+
+    /* Takes the place of the dispatchers m_mutex for this wallet, so actions
+       on one wallet don't hold up the others */
+    std::mutex mutex;
+};
+
 /* Functions the same as body.at(key).get<T>(), but gives better error messages */
 template<typename T> T getJsonValue(const nlohmann::json &body, const std::string key)
 {
@@ -55,7 +67,8 @@ class ApiDispatcher
         const std::string rpcBindIp,
         const std::string rpcPassword,
         std::string corsHeader,
-        unsigned int walletSyncThreads = std::thread::hardware_concurrency());
+        unsigned int walletSyncThreads = std::thread::hardware_concurrency(),
+        const bool multiWallet = false);
 
     /////////////////////////////
     /* Public member functions */
@@ -247,6 +260,10 @@ class ApiDispatcher
     std::tuple<Error, uint16_t>
         getTxPrivateKey(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const;
 
+    /* Gets the IDs of the open wallets, when hosting multiple wallets */
+    std::tuple<Error, uint16_t>
+        getWallets(const httplib::Request &req, httplib::Response &res, const nlohmann::json &body) const;
+
     //////////////////////
     /* OPTIONS REQUESTS */
     //////////////////////
@@ -262,6 +279,14 @@ class ApiDispatcher
     std::tuple<std::string, uint16_t, bool, std::string, std::string>
         getDefaultWalletParams(const nlohmann::json body) const;
 
+    /* The wallet the request is for */
+    std::shared_ptr<WalletBackend> &walletBackend();
+
+    const std::shared_ptr<WalletBackend> &walletBackend() const;
+
+    /* The lock for mutating actions on the wallet the request is for */
+    std::mutex &walletMutex() const;
+
     /* Assert the wallet is not a view only wallet */
     bool assertIsNotViewWallet() const;
 
@@ -285,6 +310,19 @@ class ApiDispatcher
 
     std::shared_ptr<WalletBackend> m_walletBackend = nullptr;
 
+    /* Whether we host many wallets, addressed by /wallets/<walletId> */
+    bool m_multiWallet = false;
+
+    /* The wallets we are hosting, by ID, if m_multiWallet is set */
+    std::unordered_map<std::string, std::shared_ptr<HostedWallet>> m_wallets;
+
+    /* Guards m_wallets, and the wallet held by each of them */
+    mutable std::mutex m_walletsMutex;
+
+    /* Blocks downloaded by any of the wallets we are hosting, so the others
+       don't download them again */
+    std::shared_ptr<SharedBlockCache> m_blockCache = nullptr;
+
     /* Our server instance */
     httplib::Server m_server;
 
@@ -295,7 +333,7 @@ class ApiDispatcher
     std::string m_rpcPassword;
 
     /* Need a mutex for some actions, mainly mutating actions, like opening
-       wallets, sending transfers, etc */
+       wallets, sending transfers, etc. Each hosted wallet has its own. */
     mutable std::mutex m_mutex;
 
     /* The server host */
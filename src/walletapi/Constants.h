@@ -21,4 +21,11 @@ namespace ApiConstants
 
     /* 64 char, hex */
     const std::string hashRegex = "[a-fA-F0-9]{64}";
+
+    /* Prefix of the routes for a specific wallet, when hosting multiple
+       wallets */
+    const std::string walletsPath = "/wallets/";
+
+    /* The IDs wallets are given when hosting multiple wallets */
+    const std::string walletIdRegex = "[a-zA-Z0-9_-]{1,64}";
 } // namespace ApiConstants
@@ -21,7 +21,7 @@ ApiConfig parseArguments(int argc, char **argv)
 
     cxxopts::Options options(argv[0], CryptoNote::getProjectCLIHeader());
 
-    bool help, version, scanCoinbaseTransactions, noConsole;
+    bool help, version, scanCoinbaseTransactions, noConsole, multiWallet;
 
     int logLevel;
 
@@ -35,6 +35,11 @@ ApiConfig parseArguments(int argc, char **argv)
          cxxopts::value<int>(logLevel)->default_value(std::to_string(config.logLevel)),
          "#")
 
+        ("multi-wallet",
+         "Host many wallets at once, each accessed under /wallets/<walletId>/. Blocks are downloaded from the daemon "
+         "once and shared between the wallets.",
+         cxxopts::value<bool>(multiWallet)->default_value("false")->implicit_value("true"))
+
         ("no-console",
          "If set, will not provide an interactive console",
          cxxopts::value<bool>(noConsole)->default_value("false")->implicit_value("true"))
@@ -120,6 +125,11 @@ ApiConfig parseArguments(int argc, char **argv)
         config.noConsole = true;
     }
 
+    if (multiWallet)
+    {
+        config.multiWallet = true;
+    }
+
     if (threads == 0)
     {
         std::cout << "Thread count must be at least 1" << std::endl;
@@ -28,6 +28,9 @@ struct ApiConfig
     bool noConsole = false;
 
     unsigned int threads;
+
+    /* Host many wallets at once, sharing the blocks they download */
+    bool multiWallet = false;
 };
 
 ApiConfig parseArguments(int argc, char **argv);
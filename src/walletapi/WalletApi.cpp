@@ -33,7 +33,7 @@ int main(int argc, char **argv)
 
         /* Init the API */
         api = std::make_shared<ApiDispatcher>(
-            config.port, config.rpcBindIp, config.rpcPassword, config.corsHeader, config.threads);
+            config.port, config.rpcBindIp, config.rpcPassword, config.corsHeader, config.threads, config.multiWallet);
 
         /* Launch the API */
         apiThread = std::thread(&ApiDispatcher::start, api.get());
@@ -9,16 +9,98 @@
 #include <config/Constants.h>
 #include <config/WalletConfig.h>
 #include <common/CheckDifficulty.h>
+#include <common/ScopeExit.h>
 #include <common/Varint.h>
 #include <errors/ValidateParameters.h>
 #include <utilities/Addresses.h>
 #include <utilities/FormatTools.h>
 #include <utilities/Mixins.h>
+#include <utilities/ThreadPool.h>
 #include <utilities/Utilities.h>
 #include <walletbackend/WalletBackend.h>
 
 namespace SendTransaction
 {
+    namespace
+    {
+        const uint64_t THREAD_COUNT = std::max(1u, std::thread::hardware_concurrency());
+
+        /* Shared by the proof of work and signing, and reused between
+           transactions, so we don't launch a new set of threads for each one */
+        Utilities::ThreadPool<bool> &getThreadPool()
+        {
+            static Utilities::ThreadPool<bool> threadPool(THREAD_COUNT);
+
+            return threadPool;
+        }
+
+        /* Calls func with every index in [0, count), spread over the thread
+           pool. Returns false if any call returned false, in which case the
+           remaining indexes may be skipped. */
+        bool parallelFor(const size_t count, const std::function<bool(size_t)> &func)
+        {
+            /* Not worth handing a single item to another thread */
+            if (count == 1)
+            {
+                return func(0);
+            }
+
+            std::atomic<size_t> nextIndex = 0;
+
+            std::atomic<bool> failed = false;
+
+            /* The thread pool can't pass exceptions back, so the first one
+               thrown is kept and rethrown here */
+            std::exception_ptr exception;
+
+            std::mutex exceptionMutex;
+
+            std::vector<std::future<bool>> results;
+
+            for (uint64_t i = 0; i < std::min<uint64_t>(THREAD_COUNT, count); i++)
+            {
+                results.push_back(getThreadPool().addJob([&] {
+                    for (size_t index = nextIndex++; index < count && !failed; index = nextIndex++)
+                    {
+                        try
+                        {
+                            if (!func(index))
+                            {
+                                failed = true;
+                            }
+                        }
+                        catch (...)
+                        {
+                            std::scoped_lock lock(exceptionMutex);
+
+                            if (!exception)
+                            {
+                                exception = std::current_exception();
+                            }
+
+                            failed = true;
+                        }
+                    }
+
+                    return true;
+                }));
+            }
+
+            /* The jobs reference our locals, so wait for all of them */
+            for (auto &result : results)
+            {
+                result.wait();
+            }
+
+            if (exception)
+            {
+                std::rethrow_exception(exception);
+            }
+
+            return !failed;
+        }
+    } // namespace
+
     std::tuple<Error, Crypto::Hash>
         sendFusionTransactionBasic(const std::shared_ptr<Nigel> daemon, const std::shared_ptr<SubWallets> subWallets)
     {
@@ -539,7 +621,7 @@ namespace SendTransaction
             return destination.input.amount;
         });
 
-        const auto [success, fakeOuts] = daemon->getRandomOutsByAmounts(amounts, requestedOuts);
+        auto [success, fakeOuts] = daemon->getRandomOutsByAmounts(amounts, requestedOuts);
 
         if (!success)
         {
@@ -585,7 +667,7 @@ namespace SendTransaction
             return {NOT_ENOUGH_FAKE_OUTPUTS, fakeOuts};
         }
 
-        for (auto fakeOut : fakeOuts)
+        for (auto &fakeOut : fakeOuts)
         {
             /* Do the same check as above here, again. The reason being that
                we just find the first set of outputs matching the amount above,
@@ -638,9 +720,11 @@ namespace SendTransaction
             return {error, result};
         }
 
+        result.reserve(sources.size());
+
         size_t i = 0;
 
-        for (const auto walletAmount : sources)
+        for (const auto &walletAmount : sources)
         {
             WalletTypes::GlobalIndexKey realOutput {*walletAmount.input.globalOutputIndex, walletAmount.input.key};
 
@@ -659,10 +743,14 @@ namespace SendTransaction
 
             obscuredInput.ownerPrivateSpendKey = walletAmount.privateSpendKey;
 
+            /* Room for the fakes and our real output, so inserting the real
+               output doesn't reallocate */
+            obscuredInput.outputs.reserve(mixin + 1);
+
             if (mixin != 0)
             {
                 /* Add the fake outputs to the transaction */
-                for (const auto fakeOut : fakeOuts[i].outs)
+                for (const auto &fakeOut : fakeOuts[i].outs)
                 {
                     /* This fake output is our output! Skip. */
                     if (walletAmount.input.globalOutputIndex == fakeOut.global_amount_index)
@@ -699,7 +787,7 @@ namespace SendTransaction
                has a globalOutputIndex of 6, we would place it like so:
                [1, 3, 5, 6, 7]. */
             const auto insertPosition = std::find_if(
-                obscuredInput.outputs.begin(), obscuredInput.outputs.end(), [&walletAmount](const auto output) {
+                obscuredInput.outputs.begin(), obscuredInput.outputs.end(), [&walletAmount](const auto &output) {
                     return output.index >= walletAmount.input.globalOutputIndex;
                 });
 
@@ -709,7 +797,7 @@ namespace SendTransaction
             /* Indicate which of the outputs is the real one, e.g. number 4 */
             obscuredInput.realOutput = newPosition - obscuredInput.outputs.begin();
 
-            result.push_back(obscuredInput);
+            result.push_back(std::move(obscuredInput));
 
             i++;
         }
@@ -718,7 +806,7 @@ namespace SendTransaction
     }
 
     std::tuple<CryptoNote::KeyPair, Crypto::KeyImage>
-        genKeyImage(const WalletTypes::ObscuredInput input, const Crypto::SecretKey privateViewKey)
+        genKeyImage(const WalletTypes::ObscuredInput &input, const Crypto::SecretKey &privateViewKey)
     {
         Crypto::KeyDerivation derivation;
 
@@ -726,6 +814,12 @@ namespace SendTransaction
            view key */
         Crypto::generate_key_derivation(input.realTransactionPublicKey, privateViewKey, derivation);
 
+        return genKeyImage(input, derivation);
+    }
+
+    std::tuple<CryptoNote::KeyPair, Crypto::KeyImage>
+        genKeyImage(const WalletTypes::ObscuredInput &input, const Crypto::KeyDerivation &derivation)
+    {
         CryptoNote::KeyPair tmpKeyPair;
 
         /* Derive the public key of the tmp key pair */
@@ -745,55 +839,80 @@ namespace SendTransaction
     }
 
     std::tuple<Error, std::vector<CryptoNote::KeyInput>, std::vector<Crypto::SecretKey>> setupInputs(
-        const std::vector<WalletTypes::ObscuredInput> inputsAndFakes,
-        const Crypto::SecretKey privateViewKey)
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const Crypto::SecretKey &privateViewKey)
     {
-        std::vector<CryptoNote::KeyInput> inputs;
+        std::vector<CryptoNote::KeyInput> inputs(inputsAndFakes.size());
 
-        std::vector<Crypto::SecretKey> tmpSecretKeys;
+        std::vector<Crypto::SecretKey> tmpSecretKeys(inputsAndFakes.size());
 
-        for (const auto input : inputsAndFakes)
+        /* Inputs from the same transaction share a derivation, which is one of
+           the more expensive parts of generating the key image, so only work
+           it out once per transaction */
+        std::unordered_map<Crypto::PublicKey, Crypto::KeyDerivation> derivations;
+
+        for (const auto &input : inputsAndFakes)
         {
-            const auto [tmpKeyPair, keyImage] = genKeyImage(input, privateViewKey);
+            derivations.try_emplace(input.realTransactionPublicKey);
+        }
+
+        /* The map isn't changed from here on, so each thread can fill in its
+           own entries */
+        std::vector<std::pair<const Crypto::PublicKey, Crypto::KeyDerivation> *> derivationEntries;
+
+        for (auto &entry : derivations)
+        {
+            derivationEntries.push_back(&entry);
+        }
+
+        bool success = parallelFor(derivationEntries.size(), [&](const size_t i) {
+            auto &[transactionPublicKey, derivation] = *derivationEntries[i];
+
+            return Crypto::generate_key_derivation(transactionPublicKey, privateViewKey, derivation);
+        });
+
+        if (!success)
+        {
+            return {INVALID_GENERATED_KEYIMAGE, {}, {}};
+        }
+
+        success = parallelFor(inputsAndFakes.size(), [&](const size_t i) {
+            const auto &input = inputsAndFakes[i];
+
+            const auto [tmpKeyPair, keyImage] = genKeyImage(input, derivations.at(input.realTransactionPublicKey));
 
             if (tmpKeyPair.publicKey != input.outputs[input.realOutput].key)
             {
-                return {INVALID_GENERATED_KEYIMAGE, inputs, tmpSecretKeys};
+                return false;
             }
 
-            tmpSecretKeys.push_back(tmpKeyPair.secretKey);
+            tmpSecretKeys[i] = tmpKeyPair.secretKey;
 
-            CryptoNote::KeyInput keyInput;
+            CryptoNote::KeyInput &keyInput = inputs[i];
 
             keyInput.amount = input.amount;
             keyInput.keyImage = keyImage;
 
-            /* Add each output index from the fake outs */
-            std::transform(
-                input.outputs.begin(),
-                input.outputs.end(),
-                std::back_inserter(keyInput.outputIndexes),
-                [](const auto output) { return static_cast<uint32_t>(output.index); });
+            keyInput.outputIndexes.reserve(input.outputs.size());
 
-            /* Make a copy */
-            auto copy = keyInput.outputIndexes;
+            /* Convert our indexes to relative indexes - for example, if we
+               originally had [5, 10, 20, 21, 22], this would become
+               [5, 5, 10, 1, 1]. Due to this, the indexes MUST be sorted - they
+               are serialized as a uint32_t, so negative values will overflow! */
+            uint64_t previousIndex = 0;
 
-            if (!keyInput.outputIndexes.empty())
+            for (const auto &output : input.outputs)
             {
-                /* Convert our indexes to relative indexes - for example, if we
-                   originally had [5, 10, 20, 21, 22], this would become
-                   [5, 5, 10, 1, 1]. Due to this, the indexes MUST be sorted - they
-                   are serialized as a uint32_t, so negative values will overflow! */
-                for (size_t i = 1; i < copy.size(); i++)
-                {
-                    copy[i] = keyInput.outputIndexes[i] - keyInput.outputIndexes[i - 1];
-                }
-
-                keyInput.outputIndexes = copy;
+                keyInput.outputIndexes.push_back(static_cast<uint32_t>(output.index - previousIndex));
+                previousIndex = output.index;
             }
 
-            /* Store the key input */
-            inputs.push_back(keyInput);
+            return true;
+        });
+
+        if (!success)
+        {
+            return {INVALID_GENERATED_KEYIMAGE, {}, {}};
         }
 
         return {SUCCESS, inputs, tmpSecretKeys};
@@ -845,67 +964,58 @@ namespace SendTransaction
 
     std::tuple<Error, CryptoNote::Transaction> generateRingSignatures(
         CryptoNote::Transaction tx,
-        const std::vector<WalletTypes::ObscuredInput> inputsAndFakes,
-        const std::vector<Crypto::SecretKey> tmpSecretKeys)
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::vector<Crypto::SecretKey> &tmpSecretKeys)
     {
         /* Hash the transaction prefix (Prefix is just a subset of transaction, so
            we can just do a cast here) */
-        Crypto::Hash txPrefixHash = getTransactionHash(static_cast<CryptoNote::TransactionPrefix>(tx));
+        const Crypto::Hash txPrefixHash = getTransactionHash(static_cast<CryptoNote::TransactionPrefix>(tx));
 
-        size_t i = 0;
+        tx.signatures.resize(inputsAndFakes.size());
+
+        /* Each input is signed independently, so large transactions are signed
+           on every core at once */
+        const bool success = parallelFor(inputsAndFakes.size(), [&](const size_t i) {
+            const auto &input = inputsAndFakes[i];
 
-        /* Add the transaction signatures */
-        for (const auto input : inputsAndFakes)
-        {
             std::vector<Crypto::PublicKey> publicKeys;
 
+            publicKeys.reserve(input.outputs.size());
+
             /* Add all the fake outs public keys to a vector */
-            for (const auto output : input.outputs)
+            for (const auto &output : input.outputs)
             {
                 publicKeys.push_back(output.key);
             }
 
+            const auto &keyImage = boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage;
+
             /* Generate the ring signatures - note - modifying the transaction
                post signature generation will invalidate the signatures. */
-            const auto [success, signatures] = Crypto::crypto_ops::generateRingSignatures(
-                txPrefixHash,
-                boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage,
-                publicKeys,
-                tmpSecretKeys[i],
-                input.realOutput);
-
-            if (!success)
-            {
-                return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
-            }
-
-            /* Add the signatures to the transaction */
-            tx.signatures.push_back(signatures);
-
-            i++;
-        }
+            auto [generated, signatures] = Crypto::crypto_ops::generateRingSignatures(
+                txPrefixHash, keyImage, publicKeys, tmpSecretKeys[i], input.realOutput);
 
-        i = 0;
-
-        for (const auto input : inputsAndFakes)
-        {
-            std::vector<Crypto::PublicKey> publicKeys;
-
-            for (const auto output : input.outputs)
+            if (!generated)
             {
-                publicKeys.push_back(output.key);
+                return false;
             }
 
-            if (!Crypto::crypto_ops::checkRingSignature(
-                    txPrefixHash,
-                    boost::get<CryptoNote::KeyInput>(tx.inputs[i]).keyImage,
-                    publicKeys,
-                    tx.signatures[i]))
+            /* Verify them before we send them off - the keys are all to hand */
+            if (!Crypto::crypto_ops::checkRingSignature(txPrefixHash, keyImage, publicKeys, signatures))
             {
-                return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
+                return false;
             }
 
-            i++;
+            /* Add the signatures to the transaction. Each input has its own
+               slot, so there's no need to lock. */
+            tx.signatures[i] = std::move(signatures);
+
+            return true;
+        });
+
+        if (!success)
+        {
+            return {FAILED_TO_CREATE_RING_SIGNATURE, tx};
         }
 
         return {SUCCESS, tx};
@@ -1148,47 +1258,51 @@ namespace SendTransaction
         return expectedFee == actualFee;
     }
 
-    void generateTransactionPowWorker(
-        std::vector<uint8_t> &finalExtra,
-        const int threadCount,
+    bool generateTransactionPowWorker(
+        std::vector<uint8_t> data,
+        const size_t nonceOffset,
         uint64_t nonce,
+        const uint64_t threadCount,
         std::atomic<bool> &shouldStop,
-        CryptoNote::Transaction tx)
+        uint64_t &foundNonce)
     {
-        /* Make a thread local copy */
-        auto extra = finalExtra;
+        /* Don't allocate and free the scratchpad for every hash. The pool
+           threads live for the whole process and do other jobs too, so the
+           scratchpad is released again once we're done, rather than staying
+           allocated in every pool thread. */
+        Crypto::slow_hash_retain_state();
 
-        /* Get a pointer to the start of where we want to insert our nonce */
-        const auto noncePosition = &extra[extra.size() - 8];
+        Tools::ScopeExit releaseState([] { Crypto::slow_hash_release_state(); });
 
-        while (true)
+        while (!shouldStop)
         {
-            if (shouldStop)
-            {
-                return;
-            }
-
-            /* Copy in the nonce */
-            std::memcpy(noncePosition, &nonce, sizeof(nonce));
+            /* Patch the nonce straight into the serialized prefix, rather than
+               reserializing the whole transaction for every attempt */
+            std::memcpy(&data[nonceOffset], &nonce, sizeof(nonce));
 
             Crypto::Hash hash;
 
-            tx.extra = extra;
-
-            std::vector<uint8_t> data = toBinaryArray(static_cast<CryptoNote::TransactionPrefix>(tx));
-
             Crypto::cn_turtle_lite_slow_hash_v2(data.data(), data.size(), hash);
 
             if (CryptoNote::check_hash(hash, CryptoNote::parameters::TRANSACTION_POW_DIFFICULTY))
             {
-                finalExtra = extra;
-                shouldStop = true;
+                bool expected = false;
+
+                /* Another thread may have found a nonce at the same time, only
+                   one of them gets to store it */
+                if (shouldStop.compare_exchange_strong(expected, true))
+                {
+                    foundNonce = nonce;
+                    return true;
+                }
 
-                return;
+                return false;
             }
 
             nonce += threadCount;
         }
+
+        return false;
     }
 
     std::vector<uint8_t> generateTransactionPoW(
@@ -1199,31 +1313,41 @@ namespace SendTransaction
         extra.push_back(Constants::TX_EXTRA_TRANSACTION_POW_NONCE_IDENTIFIER);
 
         /* Add extra room for the nonce */
-        extra.resize(extra.size() + 8);
+        extra.resize(extra.size() + sizeof(uint64_t));
 
-        std::vector<std::thread> threads;
+        tx.extra = extra;
 
-        const int threadCount = std::max(1u, std::thread::hardware_concurrency());
+        /* Extra is the last field of the prefix, so the nonce is always the
+           last 8 bytes of the serialized prefix */
+        const std::vector<uint8_t> data = toBinaryArray(static_cast<CryptoNote::TransactionPrefix>(tx));
+
+        const size_t nonceOffset = data.size() - sizeof(uint64_t);
+
+        const uint64_t threadCount = THREAD_COUNT;
+
+        auto &threadPool = getThreadPool();
 
         std::atomic<bool> shouldStop = false;
 
-        for (int i = 0; i < threadCount; i++)
+        uint64_t foundNonce = 0;
+
+        std::vector<std::future<bool>> results;
+
+        for (uint64_t i = 0; i < threadCount; i++)
         {
-            threads.push_back(std::thread(
-                generateTransactionPowWorker,
-                std::ref(extra),
-                threadCount,
-                i,
-                std::ref(shouldStop),
-                tx
-            ));
+            results.push_back(threadPool.addJob([&, i] {
+                return generateTransactionPowWorker(data, nonceOffset, i, threadCount, shouldStop, foundNonce);
+            }));
         }
 
-        for (auto &thread : threads)
+        /* Wait for every worker to stop, as they reference our locals */
+        for (auto &result : results)
         {
-            thread.join();
+            result.wait();
         }
 
+        std::memcpy(&extra[extra.size() - sizeof(uint64_t)], &foundNonce, sizeof(foundNonce));
+
         return extra;
     }
 
@@ -53,16 +53,16 @@ namespace SendTransaction
         const std::shared_ptr<Nigel> daemon);
 
     std::tuple<Error, std::vector<CryptoNote::KeyInput>, std::vector<Crypto::SecretKey>> setupInputs(
-        const std::vector<WalletTypes::ObscuredInput> inputsAndFakes,
-        const Crypto::SecretKey privateViewKey);
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const Crypto::SecretKey &privateViewKey);
 
     std::tuple<std::vector<WalletTypes::KeyOutput>, CryptoNote::KeyPair>
         setupOutputs(std::vector<WalletTypes::TransactionDestination> destinations);
 
     std::tuple<Error, CryptoNote::Transaction> generateRingSignatures(
         CryptoNote::Transaction tx,
-        const std::vector<WalletTypes::ObscuredInput> inputsAndFakes,
-        const std::vector<Crypto::SecretKey> tmpSecretKeys);
+        const std::vector<WalletTypes::ObscuredInput> &inputsAndFakes,
+        const std::vector<Crypto::SecretKey> &tmpSecretKeys);
 
     std::vector<uint64_t> splitAmountIntoDenominations(uint64_t amount);
 
@@ -107,7 +107,12 @@ namespace SendTransaction
         relayTransaction(const CryptoNote::Transaction tx, const std::shared_ptr<Nigel> daemon);
 
     std::tuple<CryptoNote::KeyPair, Crypto::KeyImage>
-        genKeyImage(const WalletTypes::ObscuredInput input, const Crypto::SecretKey privateViewKey);
+        genKeyImage(const WalletTypes::ObscuredInput &input, const Crypto::SecretKey &privateViewKey);
+
+    /* As above, with the derivation of the input's transaction already worked
+       out */
+    std::tuple<CryptoNote::KeyPair, Crypto::KeyImage>
+        genKeyImage(const WalletTypes::ObscuredInput &input, const Crypto::KeyDerivation &derivation);
 
     void storeSentTransaction(
         const Crypto::Hash hash,
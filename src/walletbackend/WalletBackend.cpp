@@ -1067,6 +1067,11 @@ void WalletBackend::swapNode(std::string daemonHost, uint16_t daemonPort, bool d
     });
 }
 
+void WalletBackend::setSharedBlockCache(const std::shared_ptr<SharedBlockCache> blockCache)
+{
+    m_daemon->setBlockCache(blockCache);
+}
+
 bool WalletBackend::daemonOnline() const
 {
     return m_daemon->isOnline();
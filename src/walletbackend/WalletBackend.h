@@ -240,6 +240,10 @@ class WalletBackend
     /* Swap to a different daemon node */
     void swapNode(std::string daemonHost, uint16_t daemonPort, bool daemonSSL);
 
+    /* Share the blocks we download with other wallets using the same cache,
+       and use the blocks they download */
+    void setSharedBlockCache(const std::shared_ptr<SharedBlockCache> blockCache);
+
     /* Whether we have recieved info from the daemon at some point */
     bool daemonOnline() const;
 
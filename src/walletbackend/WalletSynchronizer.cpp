@@ -159,6 +159,10 @@ void WalletSynchronizer::mainLoop()
                 completeBlockProcessing(block, ourInputs);
                 m_processedBlocks.pop_unsafe();
             }
+
+            /* Make the changes from this batch of blocks visible to the
+               balance / transaction getters in one go */
+            m_subWallets->publishSnapshot();
         }
 
         /* If we're synced, check any transactions that may be in the pool */
@@ -1759,10 +1759,16 @@ namespace PaymentService
         wallet.reset(scanHeight);
     }
 
-    std::vector<CryptoNote::TransactionsInBlockInfo>
-        WalletService::getTransactions(const Crypto::Hash &blockHash, size_t blockCount) const
+    std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(
+        const Crypto::Hash &blockHash,
+        size_t blockCount,
+        const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(blockHash, blockCount);
+        /* Use the payment ID index if we can, rather than fetching every
+           transaction in the range and filtering them afterwards */
+        std::vector<CryptoNote::TransactionsInBlockInfo> result =
+            filter.havePaymentId ? wallet.getTransactionsWithPaymentId(blockHash, blockCount, filter.paymentId)
+                                 : wallet.getTransactions(blockHash, blockCount);
         if (result.empty())
         {
             throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
@@ -1771,10 +1777,14 @@ namespace PaymentService
         return result;
     }
 
-    std::vector<CryptoNote::TransactionsInBlockInfo>
-        WalletService::getTransactions(uint32_t firstBlockIndex, size_t blockCount) const
+    std::vector<CryptoNote::TransactionsInBlockInfo> WalletService::getTransactions(
+        uint32_t firstBlockIndex,
+        size_t blockCount,
+        const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> result = wallet.getTransactions(firstBlockIndex, blockCount);
+        std::vector<CryptoNote::TransactionsInBlockInfo> result =
+            filter.havePaymentId ? wallet.getTransactionsWithPaymentId(firstBlockIndex, blockCount, filter.paymentId)
+                                 : wallet.getTransactions(firstBlockIndex, blockCount);
         if (result.empty())
         {
             throw std::system_error(make_error_code(CryptoNote::error::WalletServiceErrorCode::OBJECT_NOT_FOUND));
@@ -1788,7 +1798,8 @@ namespace PaymentService
         size_t blockCount,
         const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
+        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions =
+            getTransactions(blockHash, blockCount, filter);
         std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions =
             filterTransactions(allTransactions, filter);
         return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
@@ -1799,7 +1810,8 @@ namespace PaymentService
         size_t blockCount,
         const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
+        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions =
+            getTransactions(firstBlockIndex, blockCount, filter);
         std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions =
             filterTransactions(allTransactions, filter);
         return convertTransactionsInBlockInfoToTransactionHashesInBlockRpcInfo(filteredTransactions);
@@ -1810,7 +1822,8 @@ namespace PaymentService
         size_t blockCount,
         const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(blockHash, blockCount);
+        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions =
+            getTransactions(blockHash, blockCount, filter);
         std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions =
             filterTransactions(allTransactions, filter);
         return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
@@ -1821,7 +1834,8 @@ namespace PaymentService
         size_t blockCount,
         const TransactionsInBlockInfoFilter &filter) const
     {
-        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions = getTransactions(firstBlockIndex, blockCount);
+        std::vector<CryptoNote::TransactionsInBlockInfo> allTransactions =
+            getTransactions(firstBlockIndex, blockCount, filter);
         std::vector<CryptoNote::TransactionsInBlockInfo> filteredTransactions =
             filterTransactions(allTransactions, filter);
         return convertTransactionsInBlockInfoToTransactionsInBlockRpcInfo(filteredTransactions);
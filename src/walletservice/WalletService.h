@@ -198,11 +198,15 @@ namespace PaymentService
 
         void getNodeFee();
 
-        std::vector<CryptoNote::TransactionsInBlockInfo>
-            getTransactions(const Crypto::Hash &blockHash, size_t blockCount) const;
+        std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(
+            const Crypto::Hash &blockHash,
+            size_t blockCount,
+            const TransactionsInBlockInfoFilter &filter) const;
 
-        std::vector<CryptoNote::TransactionsInBlockInfo>
-            getTransactions(uint32_t firstBlockIndex, size_t blockCount) const;
+        std::vector<CryptoNote::TransactionsInBlockInfo> getTransactions(
+            uint32_t firstBlockIndex,
+            size_t blockCount,
+            const TransactionsInBlockInfoFilter &filter) const;
 
         std::vector<TransactionHashesInBlockRpcInfo> getRpcTransactionHashes(
             const Crypto::Hash &blockHash,